@@ -0,0 +1,711 @@
+#include "BVH.h"
+#include "ThreadPool.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+const AABB kEmptyAABB = { { kInfinity, kInfinity, kInfinity }, { -kInfinity, -kInfinity, -kInfinity } };
+
+//SAHで分ける位置の候補の数(中心の範囲をこの数の区間に分ける)
+constexpr uint32_t kBinCount = 16;
+//三角形の葉の要素数の上限(1つのTrianglePacketに入る数)
+constexpr uint32_t kMaxTrianglesPerLeaf = 4;
+//インスタンスは1つずつ葉にする(葉の中でメッシュのBVHをたどるので、範囲を小さくする方が速い)
+constexpr uint32_t kMaxInstancesPerLeaf = 1;
+//これより深いノードはSAHをやめて中央で分け、木の深さを抑える
+constexpr uint32_t kMaxSAHDepth = 32;
+//これ以下の要素数の部分木は1つのスレッドがまとめて作る
+constexpr uint32_t kParallelSubtreeSize = 16384;
+//要素のAABBを求めるときに1スレッドが受け持つ数
+constexpr size_t kParallelGrainSize = 16384;
+//Refitで1スレッドが受け持つノードの数
+constexpr size_t kRefitGrainSize = 4096;
+//たどるときのスタックの大きさ。1段下りるごとに3つまでしか増えないので、深さ(kMaxSAHDepth + 中央で分けた段)に足りる
+constexpr size_t kTraversalStackSize = 256;
+
+#pragma region 作成
+/// <summary>
+/// 要素の範囲[begin, end)と、それを囲むAABB
+/// </summary>
+struct Range {
+	uint32_t begin;
+	uint32_t end;
+	AABB bounds;
+	//要素の中心を囲むAABB。分ける軸と位置を決めるのに使う
+	AABB centroidBounds;
+
+	uint32_t GetCount() const { return end - begin; }
+};
+
+/// <summary>
+/// 別のスレッドで作る部分木
+/// </summary>
+struct SubtreeTask {
+	//親のノードと、その中の子の位置
+	uint32_t parent;
+	uint32_t slot;
+	Range range;
+	uint32_t depth;
+};
+
+inline void Grow(AABB& aabb, const AABB& other) {
+	aabb.min = { std::min(aabb.min.x, other.min.x), std::min(aabb.min.y, other.min.y), std::min(aabb.min.z, other.min.z) };
+	aabb.max = { std::max(aabb.max.x, other.max.x), std::max(aabb.max.y, other.max.y), std::max(aabb.max.z, other.max.z) };
+}
+
+inline void Grow(AABB& aabb, const Vector3& point) {
+	aabb.min = { std::min(aabb.min.x, point.x), std::min(aabb.min.y, point.y), std::min(aabb.min.z, point.z) };
+	aabb.max = { std::max(aabb.max.x, point.x), std::max(aabb.max.y, point.y), std::max(aabb.max.z, point.z) };
+}
+
+/// <summary>
+/// 表面積の半分。SAHでは比だけを使うので半分でよい
+/// </summary>
+inline float HalfArea(const AABB& aabb) {
+	Vector3 size = aabb.max - aabb.min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+inline float GetAxis(const Vector3& vector, uint32_t axis) {
+	return (&vector.x)[axis];
+}
+
+BVHNode4 MakeEmptyNode() {
+	BVHNode4 node{};
+	for (uint32_t slot = 0; slot < 4; slot++) {
+		node.minX[slot] = node.minY[slot] = node.minZ[slot] = kInfinity;
+		node.maxX[slot] = node.maxY[slot] = node.maxZ[slot] = kInfinity;
+	}
+	return node;
+}
+
+inline bool IsEmptySlot(const BVHNode4& node, uint32_t slot) {
+	//ノード0は根なので、子として指されることはない
+	return node.count[slot] == 0 && node.child[slot] == 0;
+}
+
+inline void SetSlotBounds(BVHNode4& node, uint32_t slot, const AABB& aabb) {
+	node.minX[slot] = aabb.min.x;
+	node.minY[slot] = aabb.min.y;
+	node.minZ[slot] = aabb.min.z;
+	node.maxX[slot] = aabb.max.x;
+	node.maxY[slot] = aabb.max.y;
+	node.maxZ[slot] = aabb.max.z;
+}
+
+inline AABB GetSlotBounds(const BVHNode4& node, uint32_t slot) {
+	return { { node.minX[slot], node.minY[slot], node.minZ[slot] }, { node.maxX[slot], node.maxY[slot], node.maxZ[slot] } };
+}
+
+/// <summary>
+/// ノードの子をすべて囲むAABB。使わない子(+∞)はmaxを-∞に置き換えて除く
+/// </summary>
+inline AABB GetNodeBounds(const BVHNode4& node) {
+	const __m128 infinity = _mm_set1_ps(kInfinity);
+	const __m128 negativeInfinity = _mm_set1_ps(-kInfinity);
+	__m128 minX = _mm_load_ps(node.minX);
+	__m128 minY = _mm_load_ps(node.minY);
+	__m128 minZ = _mm_load_ps(node.minZ);
+	__m128 used = _mm_cmplt_ps(minX, infinity);
+	__m128 maxX = _mm_or_ps(_mm_and_ps(used, _mm_load_ps(node.maxX)), _mm_andnot_ps(used, negativeInfinity));
+	__m128 maxY = _mm_or_ps(_mm_and_ps(used, _mm_load_ps(node.maxY)), _mm_andnot_ps(used, negativeInfinity));
+	__m128 maxZ = _mm_or_ps(_mm_and_ps(used, _mm_load_ps(node.maxZ)), _mm_andnot_ps(used, negativeInfinity));
+	//4つの値の最小・最大をそれぞれ全要素に広げる
+	auto horizontalMin = [](__m128 v) {
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(_mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2))));
+	};
+	auto horizontalMax = [](__m128 v) {
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(_mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2))));
+	};
+	return {
+		{ horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ) },
+		{ horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ) } };
+}
+
+/// <summary>
+/// 要素のAABBから子を4つ持つBVHを作る
+/// 2つに分けることを、分けた範囲のうち一番表面積が大きいものに対して子が4つになるまで繰り返し、1つのノードにする
+/// </summary>
+class BVHBuilder {
+public:
+	BVHBuilder(std::span<const AABB> bounds, uint32_t maxLeafSize) : bounds_(bounds), maxLeafSize_(maxLeafSize) {
+		centroids_.resize(bounds.size());
+		order_.resize(bounds.size());
+		ThreadPool::GetInstance().ParallelFor(bounds.size(), kParallelGrainSize, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				centroids_[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+				order_[i] = static_cast<uint32_t>(i);
+			}
+		});
+	}
+
+	void Build() {
+		nodes_.clear();
+		if (bounds_.empty()) {
+			return;
+		}
+		nodes_.push_back(MakeEmptyNode());
+		Range root = MakeRange(0, static_cast<uint32_t>(bounds_.size()));
+		if (root.GetCount() <= kParallelSubtreeSize) {
+			BuildNode(nodes_, 0, root, 0, nullptr);
+			return;
+		}
+
+		//上の方は1つのスレッドで分け、小さくなった部分木をスレッドごとに別の配列に作ってから後ろにつなげる
+		std::vector<SubtreeTask> tasks;
+		BuildNode(nodes_, 0, root, 0, &tasks);
+		std::vector<std::vector<BVHNode4>> subtrees(tasks.size());
+		ThreadPool::GetInstance().ParallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				subtrees[i].push_back(MakeEmptyNode());
+				BuildNode(subtrees[i], 0, tasks[i].range, tasks[i].depth, nullptr);
+			}
+		});
+		for (size_t i = 0; i < tasks.size(); i++) {
+			uint32_t offset = static_cast<uint32_t>(nodes_.size());
+			nodes_[tasks[i].parent].child[tasks[i].slot] = offset;
+			for (BVHNode4& node : subtrees[i]) {
+				for (uint32_t slot = 0; slot < 4; slot++) {
+					if (node.count[slot] == 0 && !IsEmptySlot(node, slot)) {
+						node.child[slot] += offset;
+					}
+				}
+			}
+			nodes_.insert(nodes_.end(), subtrees[i].begin(), subtrees[i].end());
+		}
+	}
+
+	std::vector<BVHNode4>& GetNodes() { return nodes_; }
+	std::vector<uint32_t>& GetOrder() { return order_; }
+
+private:
+	Range MakeRange(uint32_t begin, uint32_t end) const {
+		Range range = { begin, end, kEmptyAABB, kEmptyAABB };
+		for (uint32_t i = begin; i < end; i++) {
+			Grow(range.bounds, bounds_[order_[i]]);
+			Grow(range.centroidBounds, centroids_[order_[i]]);
+		}
+		return range;
+	}
+
+	/// <summary>
+	/// 範囲を2つに分ける。SAHの見積もりが一番小さくなる軸と位置で分け、分けられなければ要素の数で半分にする
+	/// </summary>
+	void Split(const Range& range, Range& left, Range& right, bool useMedian) {
+		Vector3 extent = range.centroidBounds.max - range.centroidBounds.min;
+		uint32_t bestAxis = 0;
+		uint32_t bestBin = 0;
+		if (!useMedian) {
+			uint32_t binCounts[3][kBinCount] = {};
+			AABB binBounds[3][kBinCount];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				std::fill(std::begin(binBounds[axis]), std::end(binBounds[axis]), kEmptyAABB);
+			}
+			Vector3 scale = {
+				extent.x > 0.0f ? static_cast<float>(kBinCount) / extent.x : 0.0f,
+				extent.y > 0.0f ? static_cast<float>(kBinCount) / extent.y : 0.0f,
+				extent.z > 0.0f ? static_cast<float>(kBinCount) / extent.z : 0.0f };
+			for (uint32_t i = range.begin; i < range.end; i++) {
+				uint32_t element = order_[i];
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					uint32_t bin = GetBin(centroids_[element], range.centroidBounds.min, scale, axis);
+					binCounts[axis][bin]++;
+					Grow(binBounds[axis][bin], bounds_[element]);
+				}
+			}
+
+			//左から累積した範囲と右から累積した範囲で、区切りごとの 面積 * 要素数 を比べる
+			float bestCost = kInfinity;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				if (GetAxis(extent, axis) <= 0.0f) {
+					continue;
+				}
+				float rightCosts[kBinCount] = {};
+				AABB rightBounds = kEmptyAABB;
+				uint32_t rightCount = 0;
+				for (uint32_t bin = kBinCount - 1; bin > 0; bin--) {
+					Grow(rightBounds, binBounds[axis][bin]);
+					rightCount += binCounts[axis][bin];
+					rightCosts[bin] = rightCount != 0 ? HalfArea(rightBounds) * static_cast<float>(rightCount) : 0.0f;
+				}
+				AABB leftBounds = kEmptyAABB;
+				uint32_t leftCount = 0;
+				for (uint32_t bin = 1; bin < kBinCount; bin++) {
+					Grow(leftBounds, binBounds[axis][bin - 1]);
+					leftCount += binCounts[axis][bin - 1];
+					//どちらかが空になる区切りは使わない
+					if (leftCount == 0 || leftCount == range.GetCount()) {
+						continue;
+					}
+					float cost = HalfArea(leftBounds) * static_cast<float>(leftCount) + rightCosts[bin];
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = bin;
+					}
+				}
+			}
+			if (bestBin != 0) {
+				float axisMin = GetAxis(range.centroidBounds.min, bestAxis);
+				float axisScale = GetAxis(scale, bestAxis);
+				uint32_t* middle = std::partition(order_.data() + range.begin, order_.data() + range.end, [&](uint32_t element) {
+					return GetBin(GetAxis(centroids_[element], bestAxis), axisMin, axisScale) < bestBin;
+				});
+				uint32_t mid = static_cast<uint32_t>(middle - order_.data());
+				left = MakeRange(range.begin, mid);
+				right = MakeRange(mid, range.end);
+				return;
+			}
+		}
+
+		//中心がすべて重なっているか深くなりすぎたときは、一番長い軸の中央値で半分にする
+		bestAxis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		uint32_t mid = range.begin + range.GetCount() / 2;
+		std::nth_element(order_.data() + range.begin, order_.data() + mid, order_.data() + range.end, [&](uint32_t a, uint32_t b) {
+			return GetAxis(centroids_[a], bestAxis) < GetAxis(centroids_[b], bestAxis);
+		});
+		left = MakeRange(range.begin, mid);
+		right = MakeRange(mid, range.end);
+	}
+
+	static uint32_t GetBin(float value, float min, float scale) {
+		//範囲の端はkBinCountになるので1つ戻す
+		return std::min(static_cast<uint32_t>((value - min) * scale), kBinCount - 1);
+	}
+
+	static uint32_t GetBin(const Vector3& centroid, const Vector3& min, const Vector3& scale, uint32_t axis) {
+		return GetBin(GetAxis(centroid, axis), GetAxis(min, axis), GetAxis(scale, axis));
+	}
+
+	/// <summary>
+	/// ノードを作り、葉にできない子を続けて作る
+	/// </summary>
+	/// <param name="nodes">ノードの書き込み先</param>
+	/// <param name="nodeIndex">作るノード(追加済み)</param>
+	/// <param name="range">ノードが囲む要素</param>
+	/// <param name="depth">ノードの深さ</param>
+	/// <param name="tasks">小さい部分木を後で別のスレッドで作るときの書き込み先。nullptrならここで作る</param>
+	void BuildNode(std::vector<BVHNode4>& nodes, uint32_t nodeIndex, const Range& range, uint32_t depth, std::vector<SubtreeTask>* tasks) {
+		Range ranges[4] = { range };
+		uint32_t rangeCount = 1;
+		while (rangeCount < 4) {
+			int largest = -1;
+			float largestArea = -1.0f;
+			for (uint32_t i = 0; i < rangeCount; i++) {
+				float area = HalfArea(ranges[i].bounds);
+				if (ranges[i].GetCount() > maxLeafSize_ && area > largestArea) {
+					largest = static_cast<int>(i);
+					largestArea = area;
+				}
+			}
+			if (largest < 0) {
+				break;
+			}
+			Range left, right;
+			Split(ranges[largest], left, right, depth >= kMaxSAHDepth);
+			ranges[largest] = left;
+			ranges[rangeCount++] = right;
+		}
+
+		//子のノードを先に追加して番号を決める(親の番号は子より小さくなるので、Refitは後ろから順に行える)
+		BVHNode4 node = MakeEmptyNode();
+		bool isDeferred[4] = {};
+		for (uint32_t slot = 0; slot < rangeCount; slot++) {
+			SetSlotBounds(node, slot, ranges[slot].bounds);
+			if (ranges[slot].GetCount() <= maxLeafSize_) {
+				node.child[slot] = ranges[slot].begin;
+				node.count[slot] = ranges[slot].GetCount();
+			} else if (tasks && ranges[slot].GetCount() <= kParallelSubtreeSize) {
+				tasks->push_back({ nodeIndex, slot, ranges[slot], depth + 1 });
+				isDeferred[slot] = true;
+			} else {
+				node.child[slot] = static_cast<uint32_t>(nodes.size());
+				nodes.push_back(MakeEmptyNode());
+			}
+		}
+		nodes[nodeIndex] = node;
+		for (uint32_t slot = 0; slot < rangeCount; slot++) {
+			if (node.count[slot] == 0 && !isDeferred[slot]) {
+				BuildNode(nodes, node.child[slot], ranges[slot], depth + 1, tasks);
+			}
+		}
+	}
+
+	std::span<const AABB> bounds_;
+	uint32_t maxLeafSize_;
+	std::vector<Vector3> centroids_;
+	std::vector<uint32_t> order_;
+	std::vector<BVHNode4> nodes_;
+};
+#pragma endregion
+
+#pragma region たどる
+/// <summary>
+/// 向きの成分の逆数。0のときは無限大の代わりに大きな値にして、0 * ∞ のNaNが出ないようにする
+/// </summary>
+inline float SafeInverse(float value) {
+	constexpr float kMinValue = 1.0e-20f;
+	return std::fabs(value) > kMinValue ? 1.0f / value : std::copysign(1.0f / kMinValue, value);
+}
+
+/// <summary>
+/// レイと当たる子を近い順にたどり、葉ごとにleafを呼ぶ
+/// </summary>
+/// <param name="nodes">ノード。先頭が根</param>
+/// <param name="ray">レイ</param>
+/// <param name="maxDistance">これより遠い子は調べない。leafの中で縮めると、それより遠い子を飛ばす</param>
+/// <param name="leaf">葉の(先頭, 要素数)を受け取る関数</param>
+template<class LeafFunction>
+void Traverse(std::span<const BVHNode4> nodes, const Ray& ray, const float& maxDistance, const LeafFunction& leaf) {
+	if (nodes.empty()) {
+		return;
+	}
+	const __m128 originX = _mm_set1_ps(ray.origin.x);
+	const __m128 originY = _mm_set1_ps(ray.origin.y);
+	const __m128 originZ = _mm_set1_ps(ray.origin.z);
+	const __m128 inverseX = _mm_set1_ps(SafeInverse(ray.direction.x));
+	const __m128 inverseY = _mm_set1_ps(SafeInverse(ray.direction.y));
+	const __m128 inverseZ = _mm_set1_ps(SafeInverse(ray.direction.z));
+
+	struct Entry {
+		uint32_t child;
+		uint32_t count;
+		float distance;
+	};
+	Entry stack[kTraversalStackSize];
+	size_t stackSize = 0;
+	stack[stackSize++] = { 0, 0, 0.0f };
+	while (stackSize > 0) {
+		Entry entry = stack[--stackSize];
+		if (entry.distance > maxDistance) {
+			continue;
+		}
+		if (entry.count != 0) {
+			leaf(entry.child, entry.count);
+			continue;
+		}
+
+		//4つの子のAABBとスラブ法で判定する。使わない子は近い側も遠い側も±∞になって外れる
+		const BVHNode4& node = nodes[entry.child];
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), originX), inverseX);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), originX), inverseX);
+		__m128 tNear = _mm_min_ps(t0, t1);
+		__m128 tFar = _mm_max_ps(t0, t1);
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), originY), inverseY);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), originY), inverseY);
+		tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+		tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), originZ), inverseZ);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), originZ), inverseZ);
+		tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+		tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+		tNear = _mm_max_ps(tNear, _mm_setzero_ps());
+		//maxDistanceが∞でも使わない子(+∞)が当たらないように、有限の値で抑える
+		tFar = _mm_min_ps(tFar, _mm_set1_ps(std::min(maxDistance, std::numeric_limits<float>::max())));
+		int mask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+		if (mask == 0) {
+			continue;
+		}
+
+		//当たった子を遠い順にスタックへ積み、近いものから調べる
+		alignas(16) float distances[4];
+		_mm_store_ps(distances, tNear);
+		Entry hits[4];
+		uint32_t hitCount = 0;
+		for (uint32_t slot = 0; slot < 4; slot++) {
+			if (mask & (1 << slot)) {
+				Entry hit = { node.child[slot], node.count[slot], distances[slot] };
+				uint32_t i = hitCount++;
+				for (; i > 0 && hits[i - 1].distance < hit.distance; i--) {
+					hits[i] = hits[i - 1];
+				}
+				hits[i] = hit;
+			}
+		}
+		assert(stackSize + hitCount <= kTraversalStackSize);
+		for (uint32_t i = 0; i < hitCount; i++) {
+			stack[stackSize++] = hits[i];
+		}
+	}
+}
+
+/// <summary>
+/// レイと4つの三角形をまとめて判定する(Möller-Trumboreの方法)
+/// </summary>
+/// <param name="packet">三角形</param>
+/// <param name="origin">レイの始点のxyzをそれぞれ4つに広げたもの</param>
+/// <param name="direction">レイの向きのxyzをそれぞれ4つに広げたもの</param>
+/// <param name="hit">hit.distanceより近ければ書き換える</param>
+/// <returns>近い三角形があったか</returns>
+bool IntersectPacket(const MeshBVH::TrianglePacket& packet, const __m128 origin[3], const __m128 direction[3], RayHit& hit) {
+	__m128 edge1X = _mm_load_ps(packet.edge1X);
+	__m128 edge1Y = _mm_load_ps(packet.edge1Y);
+	__m128 edge1Z = _mm_load_ps(packet.edge1Z);
+	__m128 edge2X = _mm_load_ps(packet.edge2X);
+	__m128 edge2Y = _mm_load_ps(packet.edge2Y);
+	__m128 edge2Z = _mm_load_ps(packet.edge2Z);
+
+	//p = direction × edge2
+	__m128 pX = _mm_sub_ps(_mm_mul_ps(direction[1], edge2Z), _mm_mul_ps(direction[2], edge2Y));
+	__m128 pY = _mm_sub_ps(_mm_mul_ps(direction[2], edge2X), _mm_mul_ps(direction[0], edge2Z));
+	__m128 pZ = _mm_sub_ps(_mm_mul_ps(direction[0], edge2Y), _mm_mul_ps(direction[1], edge2X));
+	__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+
+	//s = origin - v0, q = s × edge1
+	__m128 sX = _mm_sub_ps(origin[0], _mm_load_ps(packet.v0X));
+	__m128 sY = _mm_sub_ps(origin[1], _mm_load_ps(packet.v0Y));
+	__m128 sZ = _mm_sub_ps(origin[2], _mm_load_ps(packet.v0Z));
+	__m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(sZ, edge1Y));
+	__m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(sX, edge1Z));
+	__m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(sY, edge1X));
+
+	__m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+	__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, pX), _mm_mul_ps(sY, pY)), _mm_mul_ps(sZ, pZ)), inverseDeterminant);
+	__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction[0], qX), _mm_mul_ps(direction[1], qY)), _mm_mul_ps(direction[2], qZ)),
+		inverseDeterminant);
+	__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+	//レイと平行な三角形と足りない分の三角形は行列式が0になる。NaNとの比較は偽なのでそれも外れる
+	const __m128 zero = _mm_setzero_ps();
+	__m128 mask = _mm_cmpneq_ps(determinant, zero);
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+	mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(hit.distance)));
+	int hitMask = _mm_movemask_ps(mask);
+	if (hitMask == 0) {
+		return false;
+	}
+
+	//当たったものの中で一番近いものを選ぶ
+	__m128 distance = _mm_or_ps(_mm_and_ps(mask, t), _mm_andnot_ps(mask, _mm_set1_ps(kInfinity)));
+	__m128 nearest = _mm_min_ps(distance, _mm_shuffle_ps(distance, distance, _MM_SHUFFLE(2, 3, 0, 1)));
+	nearest = _mm_min_ps(nearest, _mm_shuffle_ps(nearest, nearest, _MM_SHUFFLE(1, 0, 3, 2)));
+	uint32_t lane = static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(distance, nearest)) & hitMask)));
+
+	alignas(16) float us[4];
+	alignas(16) float vs[4];
+	_mm_store_ps(us, u);
+	_mm_store_ps(vs, v);
+	hit.distance = _mm_cvtss_f32(nearest);
+	hit.triangle = packet.triangle[lane];
+	hit.u = us[lane];
+	hit.v = vs[lane];
+	return true;
+}
+#pragma endregion
+
+template<class Index>
+std::vector<Vector3> GatherTrianglePositions(std::span<const VertexData> vertices, std::span<const Index> indices) {
+	assert(indices.size() % 3 == 0);
+	std::vector<Vector3> positions(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		const Vector4& position = vertices[indices[i]].position;
+		positions[i] = { position.x, position.y, position.z };
+	}
+	return positions;
+}
+
+}
+
+#pragma region MeshBVH
+void MeshBVH::Build(std::span<const VertexData> vertices, std::span<const uint32_t> indices) {
+	Build(GatherTrianglePositions(vertices, indices));
+}
+
+void MeshBVH::Build(std::span<const VertexData> vertices, std::span<const uint16_t> indices) {
+	Build(GatherTrianglePositions(vertices, indices));
+}
+
+void MeshBVH::Build(std::span<const Vector3> positions) {
+	Clear();
+	triangleCount_ = positions.size() / 3;
+	if (triangleCount_ == 0) {
+		return;
+	}
+
+	std::vector<AABB> triangleBounds(triangleCount_);
+	ThreadPool::GetInstance().ParallelFor(triangleCount_, kParallelGrainSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			AABB aabb = { positions[i * 3], positions[i * 3] };
+			Grow(aabb, positions[i * 3 + 1]);
+			Grow(aabb, positions[i * 3 + 2]);
+			triangleBounds[i] = aabb;
+		}
+	});
+	BVHBuilder builder(triangleBounds, kMaxTrianglesPerLeaf);
+	builder.Build();
+	nodes_ = std::move(builder.GetNodes());
+	const std::vector<uint32_t>& order = builder.GetOrder();
+
+	//葉ごとに三角形をSoAにまとめ、葉の子の番号をまとめたものの番号に置き換える
+	bounds_ = GetNodeBounds(nodes_[0]);
+	for (BVHNode4& node : nodes_) {
+		for (uint32_t slot = 0; slot < 4; slot++) {
+			if (node.count[slot] == 0) {
+				continue;
+			}
+			TrianglePacket packet{};
+			for (uint32_t i = 0; i < node.count[slot]; i++) {
+				uint32_t triangle = order[node.child[slot] + i];
+				const Vector3& v0 = positions[triangle * 3];
+				Vector3 edge1 = positions[triangle * 3 + 1] - v0;
+				Vector3 edge2 = positions[triangle * 3 + 2] - v0;
+				packet.v0X[i] = v0.x;
+				packet.v0Y[i] = v0.y;
+				packet.v0Z[i] = v0.z;
+				packet.edge1X[i] = edge1.x;
+				packet.edge1Y[i] = edge1.y;
+				packet.edge1Z[i] = edge1.z;
+				packet.edge2X[i] = edge2.x;
+				packet.edge2Y[i] = edge2.y;
+				packet.edge2Z[i] = edge2.z;
+				packet.triangle[i] = triangle;
+			}
+			node.child[slot] = static_cast<uint32_t>(packets_.size());
+			packets_.push_back(packet);
+		}
+	}
+}
+
+bool MeshBVH::Raycast(const Ray& ray, RayHit& hit) const {
+	const __m128 origin[3] = { _mm_set1_ps(ray.origin.x), _mm_set1_ps(ray.origin.y), _mm_set1_ps(ray.origin.z) };
+	const __m128 direction[3] = { _mm_set1_ps(ray.direction.x), _mm_set1_ps(ray.direction.y), _mm_set1_ps(ray.direction.z) };
+	bool isHit = false;
+	Traverse(nodes_, ray, hit.distance, [&](uint32_t first, uint32_t) {
+		if (IntersectPacket(packets_[first], origin, direction, hit)) {
+			isHit = true;
+		}
+	});
+	return isHit;
+}
+
+void MeshBVH::Clear() {
+	nodes_.clear();
+	packets_.clear();
+	bounds_ = kEmptyAABB;
+	triangleCount_ = 0;
+}
+#pragma endregion
+
+#pragma region SceneBVH
+uint32_t SceneBVH::AddInstance(const MeshBVH* mesh, const Matrix4x4& world) {
+	assert(mesh);
+	uint32_t instance = static_cast<uint32_t>(meshes_.size());
+	meshes_.push_back(mesh);
+	inverseWorlds_.emplace_back();
+	bounds_.emplace_back();
+	isHittable_.push_back(false);
+	SetTransform(instance, world);
+	return instance;
+}
+
+void SceneBVH::SetTransform(uint32_t instance, const Matrix4x4& world) {
+	assert(instance < meshes_.size());
+	//スケールが0の行列は逆行列がない(InverseAffineと同じ3x3部分の行列式で確かめる)。デノーマルでも逆数が∞になるので除く
+	const float det = Dot(Vector3{ world.m[0][0], world.m[0][1], world.m[0][2] },
+		Cross(Vector3{ world.m[1][0], world.m[1][1], world.m[1][2] }, Vector3{ world.m[2][0], world.m[2][1], world.m[2][2] }));
+	isHittable_[instance] = !meshes_[instance]->IsEmpty() && std::isnormal(det);
+	if (!isHittable_[instance]) {
+		//三角形のないメッシュと潰れたインスタンスは位置だけの点にしておき、Raycastでは調べない
+		//(空のAABBにすると木を作るときの中心が∞ - ∞でNaNになる)
+		Vector3 position = { world.m[3][0], world.m[3][1], world.m[3][2] };
+		bounds_[instance] = { position, position };
+	} else {
+		inverseWorlds_[instance] = InverseAffine(world);
+		bounds_[instance] = TransformAABB(meshes_[instance]->GetBounds(), world);
+	}
+}
+
+void SceneBVH::Build() {
+	BVHBuilder builder(bounds_, kMaxInstancesPerLeaf);
+	builder.Build();
+	nodes_ = std::move(builder.GetNodes());
+	order_ = std::move(builder.GetOrder());
+}
+
+void SceneBVH::Refit() {
+	//葉の範囲はインスタンスのAABBを番号の順ではなく飛び飛びに読むので、先にノードごとに分担して直す
+	ThreadPool::GetInstance().ParallelFor(nodes_.size(), kRefitGrainSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			BVHNode4& node = nodes_[i];
+			for (uint32_t slot = 0; slot < 4; slot++) {
+				if (node.count[slot] == 0) {
+					continue;
+				}
+				AABB aabb = bounds_[order_[node.child[slot]]];
+				for (uint32_t k = 1; k < node.count[slot]; k++) {
+					Grow(aabb, bounds_[order_[node.child[slot] + k]]);
+				}
+				SetSlotBounds(node, slot, aabb);
+			}
+		}
+	});
+
+	//子は親より後ろにあるので、後ろから順に直せば子の範囲は先に直っている
+	//子のノードを読み直すとキャッシュから外れていることが多いので、直したノードの範囲を小さい配列に書いておいて親で読む
+	nodeBounds_.resize(nodes_.size());
+	for (size_t i = nodes_.size(); i-- > 0;) {
+		BVHNode4& node = nodes_[i];
+		for (uint32_t slot = 0; slot < 4; slot++) {
+			if (node.count[slot] == 0 && !IsEmptySlot(node, slot)) {
+				SetSlotBounds(node, slot, nodeBounds_[node.child[slot]]);
+			}
+		}
+		nodeBounds_[i] = GetNodeBounds(node);
+	}
+}
+
+RayHit SceneBVH::Raycast(const Vector3& origin, const Vector3& direction, float maxDistance) const {
+	RayHit hit;
+	hit.distance = maxDistance;
+	Traverse(nodes_, { origin, direction }, hit.distance, [&](uint32_t first, uint32_t count) {
+		for (uint32_t k = 0; k < count; k++) {
+			uint32_t instance = order_[first + k];
+			if (!isHittable_[instance]) {
+				continue;
+			}
+			//向きは正規化し直さないので、ローカル空間でも距離の値はワールド空間と同じになる
+			const Matrix4x4& inverseWorld = inverseWorlds_[instance];
+			Ray localRay = { Transform(origin, inverseWorld), TransformNormal(direction, inverseWorld) };
+			if (meshes_[instance]->Raycast(localRay, hit)) {
+				hit.instance = instance;
+			}
+		}
+	});
+	if (!hit.IsHit()) {
+		hit.distance = kInfinity;
+	}
+	return hit;
+}
+
+void SceneBVH::Clear() {
+	meshes_.clear();
+	inverseWorlds_.clear();
+	bounds_.clear();
+	isHittable_.clear();
+	nodes_.clear();
+	order_.clear();
+	nodeBounds_.clear();
+}
+#pragma endregion
+
+Ray ScreenPointToRay(const Vector2& screenPosition, const Vector2& screenSize, const Matrix4x4& inverseViewProjection) {
+	//ピクセルからNDC(xとyは-1～1でyは上向き、zはD3Dの0～1)へ
+	float x = screenPosition.x / screenSize.x * 2.0f - 1.0f;
+	float y = 1.0f - screenPosition.y / screenSize.y * 2.0f;
+	//Transformはwで割るので、射影の逆変換でもそのままワールド空間の点になる
+	Vector3 nearPoint = Transform(Vector3{ x, y, 0.0f }, inverseViewProjection);
+	Vector3 farPoint = Transform(Vector3{ x, y, 1.0f }, inverseViewProjection);
+	return { nearPoint, Normalize(farPoint - nearPoint) };
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "Bounds.h"
+#include "Matrix4x4.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "VertexData.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+//レイキャスト(ピッキングやゲーム中の当たり判定)のためのBVH
+//
+//  ・MeshBVH : メッシュの三角形をSAH(表面積の見積もり)で分けたBVH。メッシュごとに1回作る
+//  ・SceneBVH: インスタンスのワールド空間のAABBをまとめたBVH。動いたインスタンスはSetTransformで直し、毎フレームRefitで範囲だけ作り直す
+//
+//どちらも子を4つ持つノードにまとめ、子の4つのAABBとレイをSIMDで一度に判定する。葉の三角形も4つずつSoAで並べて一度に判定する
+//インスタンスの中はレイをローカル空間に移して調べる。向きを正規化し直さないので、当たった距離はワールド空間のまま比べられる
+
+//当たらなかったときの番号
+constexpr uint32_t kInvalidRayHit = 0xFFFFFFFF;
+
+/// <summary>
+/// 半直線
+/// </summary>
+struct Ray {
+	Vector3 origin;
+	//正規化していなくてもよい。そのときdistanceは向きの長さを1とした値になる
+	Vector3 direction;
+};
+
+/// <summary>
+/// レイキャストの結果
+/// </summary>
+struct RayHit {
+	//origin + direction * distance が当たった位置
+	float distance = std::numeric_limits<float>::infinity();
+	//SceneBVHのインスタンスの番号
+	uint32_t instance = kInvalidRayHit;
+	//メッシュのインデックスの中の三角形の番号(インデックスの位置 / 3)
+	uint32_t triangle = kInvalidRayHit;
+	//当たった位置の重心座標。三角形の頂点0, 1, 2の重みは 1 - u - v, u, v
+	float u = 0.0f;
+	float v = 0.0f;
+
+	bool IsHit() const { return triangle != kInvalidRayHit; }
+};
+
+/// <summary>
+/// 子を4つ持つノード。子のAABBは要素ごとの配列で並べる(SoA)
+/// 使わない子はminとmaxを+∞にして、どのレイとも当たらないようにする
+/// </summary>
+struct alignas(16) BVHNode4 {
+	float minX[4];
+	float minY[4];
+	float minZ[4];
+	float maxX[4];
+	float maxY[4];
+	float maxZ[4];
+	//countが0ならノードの番号、それ以外は葉の先頭の番号
+	uint32_t child[4];
+	//葉の要素数。0なら内側のノード
+	uint32_t count[4];
+};
+
+/// <summary>
+/// メッシュの三角形のBVH(ローカル空間)
+/// </summary>
+class MeshBVH {
+public:
+	/// <summary>
+	/// 三角形リストからBVHを作る。三角形の数が多いときは部分木をスレッドプールで分担する
+	/// </summary>
+	/// <param name="vertices">頂点。positionのxyzだけを使う</param>
+	/// <param name="indices">三角形リストのインデックス</param>
+	void Build(std::span<const VertexData> vertices, std::span<const uint32_t> indices);
+
+	/// <summary>
+	/// 16bitのインデックスの三角形リストからBVHを作る
+	/// </summary>
+	void Build(std::span<const VertexData> vertices, std::span<const uint16_t> indices);
+
+	/// <summary>
+	/// 一番近い三角形との交差を求める。裏面にも当たる
+	/// </summary>
+	/// <param name="ray">ローカル空間のレイ</param>
+	/// <param name="hit">これまでの結果。hit.distanceより近い三角形が見つかったときだけ書き換える(instanceはそのまま)</param>
+	/// <returns>近い三角形が見つかったか</returns>
+	bool Raycast(const Ray& ray, RayHit& hit) const;
+
+	void Clear();
+
+	bool IsEmpty() const { return nodes_.empty(); }
+	//三角形全体を囲むAABB
+	const AABB& GetBounds() const { return bounds_; }
+	size_t GetTriangleCount() const { return triangleCount_; }
+	size_t GetNodeCount() const { return nodes_.size(); }
+
+	/// <summary>
+	/// 4つの三角形を要素ごとの配列で並べたもの。足りない分は辺を0にして当たらないようにする
+	/// </summary>
+	struct alignas(16) TrianglePacket {
+		float v0X[4];
+		float v0Y[4];
+		float v0Z[4];
+		float edge1X[4];
+		float edge1Y[4];
+		float edge1Z[4];
+		float edge2X[4];
+		float edge2Y[4];
+		float edge2Z[4];
+		uint32_t triangle[4];
+	};
+
+private:
+	void Build(std::span<const Vector3> positions);
+
+	std::vector<BVHNode4> nodes_;
+	//葉の子の番号はここを指す
+	std::vector<TrianglePacket> packets_;
+	AABB bounds_{};
+	size_t triangleCount_ = 0;
+};
+
+/// <summary>
+/// インスタンスのBVH(ワールド空間)
+/// </summary>
+class SceneBVH {
+public:
+	/// <summary>
+	/// インスタンスを加える。Buildを呼ぶまでレイキャストの対象にならない
+	/// </summary>
+	/// <param name="mesh">形。SceneBVHより長く残すこと</param>
+	/// <param name="world">ワールド行列(アフィン変換)</param>
+	/// <returns>インスタンスの番号</returns>
+	uint32_t AddInstance(const MeshBVH* mesh, const Matrix4x4& world);
+
+	/// <summary>
+	/// インスタンスのワールド行列を変える。ノードの範囲はRefitかBuildを呼ぶまで古いまま
+	/// 逆行列のない(スケールが0の)行列なら、戻すまでレイキャストに当たらなくなる
+	/// </summary>
+	/// <param name="instance">インスタンスの番号</param>
+	/// <param name="world">ワールド行列(アフィン変換)</param>
+	void SetTransform(uint32_t instance, const Matrix4x4& world);
+
+	/// <summary>
+	/// 今のインスタンスの位置で木を作り直す。インスタンスを加えたときと、Refitを続けて範囲が広がりすぎたときに呼ぶ
+	/// </summary>
+	void Build();
+
+	/// <summary>
+	/// 木の形はそのままで、インスタンスのAABBに合わせてノードの範囲を下から作り直す。毎フレーム呼ぶ
+	/// </summary>
+	void Refit();
+
+	/// <summary>
+	/// 一番近いインスタンスの三角形との交差を求める
+	/// </summary>
+	/// <param name="origin">ワールド空間の始点</param>
+	/// <param name="direction">ワールド空間の向き</param>
+	/// <param name="maxDistance">これより遠いものは調べない</param>
+	/// <returns>当たらなければIsHitがfalse</returns>
+	RayHit Raycast(const Vector3& origin, const Vector3& direction, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+	void Clear();
+
+	size_t GetInstanceCount() const { return meshes_.size(); }
+	size_t GetNodeCount() const { return nodes_.size(); }
+	const AABB& GetInstanceBounds(uint32_t instance) const { return bounds_[instance]; }
+
+private:
+	std::vector<const MeshBVH*> meshes_;
+	//レイをローカル空間へ移す行列
+	std::vector<Matrix4x4> inverseWorlds_;
+	//ワールド空間のAABB
+	std::vector<AABB> bounds_;
+	//三角形があり、ワールド行列に逆行列があるか。falseならRaycastで調べない
+	std::vector<bool> isHittable_;
+	std::vector<BVHNode4> nodes_;
+	//葉の子の番号はここを指し、ここにインスタンスの番号が入っている
+	std::vector<uint32_t> order_;
+	//Refitの途中で使う、ノードごとの範囲
+	std::vector<AABB> nodeBounds_;
+};
+
+/// <summary>
+/// 画面上の点を通るレイを作る(ピッキング用)。近クリップ面の点から遠クリップ面の点へ向かう
+/// </summary>
+/// <param name="screenPosition">クライアント領域の座標(ピクセル、左上が原点)</param>
+/// <param name="screenSize">クライアント領域の大きさ(ピクセル)</param>
+/// <param name="inverseViewProjection">ビュープロジェクション行列の逆行列</param>
+/// <returns>始点は近クリップ面の上、向きは正規化したもの</returns>
+Ray ScreenPointToRay(const Vector2& screenPosition, const Vector2& screenSize, const Matrix4x4& inverseViewProjection);
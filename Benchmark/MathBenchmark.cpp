@@ -0,0 +1,1344 @@
+//数学ライブラリ(Matrix4x4.h / Vector3_Math.hpp など)のマイクロベンチマーク
+//D3D12を使わないので単体でビルドできる。ビルド方法はBenchmark/Makefileを参照
+//
+//使い方
+// MathBenchmark [--filter 名前の一部] [--batch 16,256,4096] [--min-time ミリ秒] [--out 結果.json]
+// MathBenchmark --compare 基準.json [--threshold 10] [その他の引数]
+//
+//各関数をbatch個の入力に対して呼び出し、最低min-time経過するまで繰り返す
+//これを5回行って一番速かった回のns/opとスループット(百万回/秒)を出力する
+//--compareを指定すると基準のjsonと比べ、threshold%以上遅くなったものを表示して終了コード1を返す
+#include "../Matrix4x4.h"
+#include "../Matrix4x4_SIMD.h"
+#include "../Vector3_Math.hpp"
+#include "../TransformBatch.h"
+#include "../Quaternion.h"
+#include "../Frustum.h"
+#include "../Bounds.h"
+#include "../MathFunction.h"
+#include "../CpuFeature.h"
+#include "../VertexFormat.h"
+#include "../BVH.h"
+#include "../SphereMesh.h"
+#include "../Primitive.h"
+#include "../MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//計測を繰り返す回数。一番速かった回を結果にする
+constexpr int kSampleCount = 5;
+
+/// <summary>
+/// 1つの関数・バッチサイズの計測結果
+/// </summary>
+struct BenchmarkResult {
+	std::string name;
+	size_t batch;
+	double nsPerOp;
+	double mopsPerSec;
+};
+
+/// <summary>
+/// 計測する関数。batch個の入力を処理する
+/// </summary>
+struct Benchmark {
+	std::string name;
+	std::function<void(size_t batch)> run;
+};
+
+/// <summary>
+/// コマンドライン引数
+/// </summary>
+struct Options {
+	std::string filter;
+	std::vector<size_t> batches = { 16, 256, 4096, 65536 };
+	double minTimeMs = 20.0;
+	std::string outPath;
+	std::string comparePath;
+	double threshold = 10.0;
+	bool isAccuracy = false;
+};
+
+/// <summary>
+/// ベンチマークの入力と出力。最大のバッチサイズ分だけ確保しておく
+/// </summary>
+struct BenchmarkData {
+	std::vector<Matrix4x4> matrices1;
+	std::vector<Matrix4x4> matrices2;
+	std::vector<Matrix4x4> affineMatrices;
+	std::vector<Matrix3x4> affineMatrices3x4;
+	std::vector<Matrix4x4> rigidMatrices;
+	std::vector<Matrix3x4> rigidMatrices3x4;
+	std::vector<Vector3> vectors1;
+	std::vector<Vector3> vectors2;
+	std::vector<Vector3> triangles;
+	std::vector<float> scalars;
+	std::vector<float> units;
+	std::vector<TransformStructure> transforms;
+	std::vector<float> transformSoA[9];
+	std::vector<VertexData> vertices;
+	std::vector<VertexDataCompact> compactVertices;
+	std::vector<VertexDataQuantized> quantizedVertices;
+	PositionQuantization quantization;
+	std::vector<Quaternion> quaternions1;
+	std::vector<Quaternion> quaternions2;
+	std::vector<float> boxMax[3];
+	std::vector<AABB> boxes;
+
+	std::vector<Matrix4x4> matrixResults;
+	std::vector<Matrix3x4> matrix3x4Results;
+	std::vector<Vector3> vectorResults;
+	std::vector<float> floatResults;
+	std::vector<Quaternion> quaternionResults;
+	std::vector<float> soaResults[3];
+	std::vector<uint32_t> indexResults;
+	std::vector<AABB> boxResults;
+	std::vector<VertexData> vertexResults;
+	std::vector<VertexDataCompact> compactResults;
+	std::vector<VertexDataQuantized> quantizedResults;
+};
+
+//最適化で計算が消されないように結果を書き込む先
+volatile float gSink;
+
+void Consume(const BenchmarkData& data, size_t batch) {
+	float sum = 0.0f;
+	for (size_t i = 0; i < batch; i++) {
+		sum += data.matrixResults[i].m[3][3] + data.vectorResults[i].x + data.floatResults[i] + data.quaternionResults[i].w + data.soaResults[0][i];
+	}
+	gSink = sum;
+}
+
+BenchmarkData MakeBenchmarkData(size_t count) {
+	std::mt19937 engine(12345);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	auto randomVector = [&]() { return Vector3{ unit(engine), unit(engine), unit(engine) }; };
+
+	BenchmarkData data;
+	data.matrices1.resize(count);
+	data.matrices2.resize(count);
+	data.affineMatrices.resize(count);
+	data.rigidMatrices.resize(count);
+	data.vectors1.resize(count);
+	data.vectors2.resize(count);
+	data.triangles.resize(count * 3);
+	data.scalars.resize(count);
+	data.units.resize(count);
+	data.transforms.resize(count);
+	data.vertices.resize(count);
+	data.quaternions1.resize(count);
+	data.quaternions2.resize(count);
+	for (std::vector<float>& soa : data.transformSoA) {
+		soa.resize(count);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		Vector3 rotate = { angle(engine), angle(engine), angle(engine) };
+		Vector3 translate = randomVector() * 10.0f;
+		data.transforms[i] = { { scale(engine), scale(engine), scale(engine) }, rotate, translate };
+		data.affineMatrices[i] = MakeAffineMatrix(data.transforms[i].scale, rotate, translate);
+		data.affineMatrices3x4.push_back(ToMatrix3x4(data.affineMatrices[i]));
+		data.rigidMatrices[i] = MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, rotate, translate);
+		data.rigidMatrices3x4.push_back(ToMatrix3x4(data.rigidMatrices[i]));
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				data.matrices1[i].m[row][colmun] = unit(engine);
+				data.matrices2[i].m[row][colmun] = unit(engine);
+			}
+			//正則になるように対角成分を大きくしておく
+			data.matrices1[i].m[row][row] += 4.0f;
+		}
+		data.vectors1[i] = randomVector();
+		data.vectors2[i] = randomVector();
+		for (size_t j = 0; j < 3; j++) {
+			data.triangles[i * 3 + j] = randomVector();
+		}
+		data.scalars[i] = scale(engine);
+		data.units[i] = unit(engine);
+		const float* srt = &data.transforms[i].scale.x;
+		for (int element = 0; element < 9; element++) {
+			data.transformSoA[element][i] = srt[element];
+		}
+		Vector3 position = randomVector();
+		data.vertices[i].position = { position.x, position.y, position.z, 1.0f };
+		data.vertices[i].texcoode = { unit(engine) * 0.5f + 0.5f, unit(engine) * 0.5f + 0.5f };
+		data.vertices[i].normal = Normalize(position);
+		data.quaternions1[i] = MakeRotateQuaternion(rotate);
+		data.quaternions2[i] = MakeRotateQuaternion(Vector3{ angle(engine), angle(engine), angle(engine) });
+		for (int axis = 0; axis < 3; axis++) {
+			data.boxMax[axis].push_back(data.transformSoA[6 + axis][i] + data.transformSoA[axis][i]);
+		}
+		data.boxes.push_back({ translate, { data.boxMax[0][i], data.boxMax[1][i], data.boxMax[2][i] } });
+	}
+
+	data.matrixResults.resize(count);
+	data.matrix3x4Results.resize(count);
+	data.vectorResults.resize(count);
+	data.floatResults.resize(count);
+	data.quaternionResults.resize(count);
+	for (std::vector<float>& soa : data.soaResults) {
+		soa.resize(count);
+	}
+	data.indexResults.resize(count);
+	data.boxResults.resize(count);
+
+	//頂点形式の変換の入力と結果
+	data.quantization = MakePositionQuantization(data.vertices);
+	data.compactVertices.resize(count);
+	data.quantizedVertices.resize(count);
+	EncodeVertices(data.vertices, data.compactVertices);
+	EncodeVertices(data.vertices, data.quantization, data.quantizedVertices);
+	data.vertexResults.resize(count);
+	data.compactResults.resize(count);
+	data.quantizedResults.resize(count);
+	return data;
+}
+
+/// <summary>
+/// 計測する関数の一覧を作る
+/// </summary>
+std::vector<Benchmark> MakeBenchmarks(BenchmarkData& data) {
+	std::vector<Benchmark> benchmarks;
+	BenchmarkData& d = data;
+
+	//1要素ずつ呼び出す関数を登録する
+	auto addMatrix = [&](const char* name, auto function) {
+		benchmarks.push_back({ name, [&d, function](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				d.matrixResults[i] = function(i);
+			}
+		} });
+	};
+	auto addVector = [&](const char* name, auto function) {
+		benchmarks.push_back({ name, [&d, function](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				d.vectorResults[i] = function(i);
+			}
+		} });
+	};
+	auto addFloat = [&](const char* name, auto function) {
+		benchmarks.push_back({ name, [&d, function](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				d.floatResults[i] = function(i);
+			}
+		} });
+	};
+	auto addQuaternion = [&](const char* name, auto function) {
+		benchmarks.push_back({ name, [&d, function](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				d.quaternionResults[i] = function(i);
+			}
+		} });
+	};
+
+#pragma region Matrix4x4.h
+	addMatrix("Add", [&d](size_t i) { return Add(d.matrices1[i], d.matrices2[i]); });
+	addMatrix("Subtract", [&d](size_t i) { return Subtract(d.matrices1[i], d.matrices2[i]); });
+	addMatrix("Multiply", [&d](size_t i) { return Multiply(d.matrices1[i], d.matrices2[i]); });
+	addFloat("Det", [&d](size_t i) { return Det(d.matrices1[i]); });
+	addMatrix("Inverse", [&d](size_t i) { return Inverse(d.matrices1[i]); });
+	addMatrix("InverseAffine", [&d](size_t i) { return InverseAffine(d.affineMatrices[i]); });
+	addMatrix("InverseRigid", [&d](size_t i) { return InverseRigid(d.rigidMatrices[i]); });
+	addMatrix("Transpose", [&d](size_t i) { return Transpose(d.matrices1[i]); });
+	addMatrix("MakeIdentity4x4", [](size_t) { return MakeIdentity4x4(); });
+	addMatrix("MakeRotateXMatrix", [&d](size_t i) { return MakeRotateXMatrix(d.transforms[i].rotate.x); });
+	addMatrix("MakeRotateYMatrix", [&d](size_t i) { return MakeRotateYMatrix(d.transforms[i].rotate.y); });
+	addMatrix("MakeRotateZMatrix", [&d](size_t i) { return MakeRotateZMatrix(d.transforms[i].rotate.z); });
+	addMatrix("MakeRotateXYZMatrix", [&d](size_t i) { return MakeRotateXYZMatrix(d.matrices1[i], d.matrices2[i], d.affineMatrices[i]); });
+	addMatrix("MakeRotateMatrix", [&d](size_t i) { return MakeRotateMatrix(d.transforms[i].rotate); });
+	addMatrix("MakeTranslateMatrix", [&d](size_t i) { return MakeTranslateMatrix(d.transforms[i].translate); });
+	addMatrix("MakeScaleMatrix", [&d](size_t i) { return MakeScaleMatrix(d.transforms[i].scale); });
+	addMatrix("MakeAffineMatrix", [&d](size_t i) { return MakeAffineMatrix(d.transforms[i].scale, d.transforms[i].rotate, d.transforms[i].translate); });
+	benchmarks.push_back({ "MakeAffineMatrices(AoS)", [&d](size_t batch) {
+		MakeAffineMatrices(std::span<const TransformStructure>(d.transforms.data(), batch), d.matrixResults);
+	} });
+	benchmarks.push_back({ "MakeAffineMatrices(SoA)", [&d](size_t batch) {
+		TransformStructureSoA soa{};
+		for (int axis = 0; axis < 3; axis++) {
+			soa.scale[axis] = d.transformSoA[axis].data();
+			soa.rotate[axis] = d.transformSoA[3 + axis].data();
+			soa.translate[axis] = d.transformSoA[6 + axis].data();
+		}
+		soa.count = batch;
+		MakeAffineMatrices(soa, d.matrixResults);
+	} });
+	addVector("Transform", [&d](size_t i) { return Transform(d.vectors1[i], d.affineMatrices[i]); });
+	addMatrix("MakePerspectiveFovMatrix", [&d](size_t i) { return MakePerspectiveFovMatrix(0.45f, d.scalars[i], 0.1f, 100.0f); });
+	addMatrix("MakeOrthographicMatrix", [&d](size_t i) { return MakeOrthographicMatrix(0.0f, 0.0f, d.scalars[i] * 1280.0f, 720.0f, 0.0f, 100.0f); });
+	addMatrix("MakeViewportMatrix", [&d](size_t i) { return MakeViewportMatrix(0.0f, 0.0f, d.scalars[i] * 1280.0f, 720.0f, 0.0f, 1.0f); });
+#pragma endregion
+
+#pragma region Matrix.h
+	//アフィン変換の合成は4x4のMultiplyと比べる(入力はアフィン行列同士)
+	addMatrix("Multiply(affine 4x4)", [&d](size_t i) { return Multiply(d.affineMatrices[i], d.rigidMatrices[i]); });
+	benchmarks.push_back({ "Multiply(3x4)", [&d](size_t batch) {
+		for (size_t i = 0; i < batch; i++) {
+			d.matrix3x4Results[i] = Multiply(d.affineMatrices3x4[i], d.rigidMatrices3x4[i]);
+		}
+	} });
+	addMatrix("Multiply(3x4, 4x4)", [&d](size_t i) { return Multiply(d.affineMatrices3x4[i], d.matrices2[i]); });
+	addVector("Transform(3x4)", [&d](size_t i) { return Transform(d.vectors1[i], d.affineMatrices3x4[i]); });
+	benchmarks.push_back({ "MakeAffineMatrix3x4", [&d](size_t batch) {
+		for (size_t i = 0; i < batch; i++) {
+			d.matrix3x4Results[i] = MakeAffineMatrix3x4(d.transforms[i].scale, d.transforms[i].rotate, d.transforms[i].translate);
+		}
+	} });
+#pragma endregion
+
+#pragma region SIMD段階ごとの行列演算
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE4, SimdLevel::AVX2 }) {
+		if (level > GetSimdLevel()) {
+			continue;
+		}
+		const MatrixKernel* kernel = &GetMatrixKernel(level);
+		std::string suffix = std::string("[") + GetSimdLevelName(level) + "]";
+		benchmarks.push_back({ "Multiply" + suffix, [&d, kernel](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				kernel->multiply(d.matrices1[i], d.matrices2[i], d.matrixResults[i]);
+			}
+		} });
+		benchmarks.push_back({ "Transform" + suffix, [&d, kernel](size_t batch) {
+			for (size_t i = 0; i < batch; i++) {
+				d.vectorResults[i] = kernel->transform(d.vectors1[i], d.affineMatrices[i]);
+			}
+		} });
+	}
+#pragma endregion
+
+#pragma region Vector3_Math.hpp
+	addVector("Vector3::Add", [&d](size_t i) { return Add(d.vectors1[i], d.vectors2[i]); });
+	addVector("Vector3::Subtract", [&d](size_t i) { return Subtract(d.vectors1[i], d.vectors2[i]); });
+	addVector("Vector3::Multiply", [&d](size_t i) { return Multiply(d.scalars[i], d.vectors1[i]); });
+	addFloat("Dot", [&d](size_t i) { return Dot(d.vectors1[i], d.vectors2[i]); });
+	addFloat("Length<Exact>", [&d](size_t i) { return Length(d.vectors1[i]); });
+	addFloat("Length<Fast>", [&d](size_t i) { return Length<Precision::Fast>(d.vectors1[i]); });
+	addFloat("Length<Approx>", [&d](size_t i) { return Length<Precision::Approx>(d.vectors1[i]); });
+	addVector("Normalize<Exact>", [&d](size_t i) { return Normalize(d.vectors1[i]); });
+	addVector("Normalize<Fast>", [&d](size_t i) { return Normalize<Precision::Fast>(d.vectors1[i]); });
+	addVector("Normalize<Approx>", [&d](size_t i) { return Normalize<Precision::Approx>(d.vectors1[i]); });
+	addVector("Cross", [&d](size_t i) { return Cross(d.vectors1[i], d.vectors2[i]); });
+	addFloat("IsFront", [&d](size_t i) { return IsFront(d.vectors1[i], &d.triangles[i * 3]) ? 1.0f : 0.0f; });
+	addVector("TransformNormal", [&d](size_t i) { return TransformNormal(d.vectors1[i], d.affineMatrices[i]); });
+#pragma endregion
+
+#pragma region TransformBatch.h
+	benchmarks.push_back({ "TransformPoints(AoS)", [&d](size_t batch) {
+		TransformPoints(std::span<const Vector3>(d.vectors1.data(), batch), d.affineMatrices[0], d.vectorResults);
+	} });
+	benchmarks.push_back({ "TransformPoints(VertexData)", [&d](size_t batch) {
+		TransformPoints(std::span<const VertexData>(d.vertices.data(), batch), d.affineMatrices[0], d.vectorResults);
+	} });
+	benchmarks.push_back({ "TransformPoints(SoA)", [&d](size_t batch) {
+		ConstVector3SoA points = { d.transformSoA[6].data(), d.transformSoA[7].data(), d.transformSoA[8].data() };
+		Vector3SoA result = { d.soaResults[0].data(), d.soaResults[1].data(), d.soaResults[2].data() };
+		TransformPoints(points, batch, d.affineMatrices[0], result);
+	} });
+	benchmarks.push_back({ "TransformPointsProjective(AoS)", [&d](size_t batch) {
+		TransformPointsProjective(std::span<const Vector3>(d.vectors1.data(), batch), d.affineMatrices[0], d.vectorResults);
+	} });
+	benchmarks.push_back({ "TransformNormals(AoS)", [&d](size_t batch) {
+		TransformNormals(std::span<const Vector3>(d.vectors1.data(), batch), d.affineMatrices[0], d.vectorResults);
+	} });
+#pragma endregion
+
+#pragma region Quaternion.h
+	addQuaternion("Quaternion::Multiply", [&d](size_t i) { return Multiply(d.quaternions1[i], d.quaternions2[i]); });
+	addMatrix("Quaternion::MakeRotateMatrix", [&d](size_t i) { return MakeRotateMatrix(d.quaternions1[i]); });
+	addVector("Quaternion::RotateVector", [&d](size_t i) { return RotateVector(d.vectors1[i], d.quaternions1[i]); });
+	addQuaternion("Nlerp", [&d](size_t i) { return Nlerp(d.quaternions1[i], d.quaternions2[i], d.scalars[i] - 0.5f); });
+	addQuaternion("Slerp", [&d](size_t i) { return Slerp(d.quaternions1[i], d.quaternions2[i], d.scalars[i] - 0.5f); });
+	benchmarks.push_back({ "Slerp(batch)", [&d](size_t batch) {
+		Slerp(std::span<const Quaternion>(d.quaternions1.data(), batch), d.quaternions2, d.scalars, d.quaternionResults);
+	} });
+#pragma endregion
+
+#pragma region Frustum.h
+	//平行移動の成分を球の中心やAABBの最小点、スケールを半径や大きさとして、半分くらいが見える視錐台でカリングする
+	Frustum frustum = MakeFrustum(Multiply(MakeTranslateMatrix({ 0.0f, 0.0f, 5.0f }), MakePerspectiveFovMatrix(1.5f, 1.0f, 0.1f, 100.0f)));
+	benchmarks.push_back({ "CullSpheres", [&d, frustum](size_t batch) {
+		BoundingSphereSoA spheres = { d.transformSoA[6].data(), d.transformSoA[7].data(), d.transformSoA[8].data(), d.transformSoA[0].data() };
+		d.floatResults[0] = float(CullSpheres(frustum, spheres, batch, d.indexResults.data()));
+	} });
+	benchmarks.push_back({ "CullAABBs", [&d, frustum](size_t batch) {
+		AABBSoA boxes = { d.transformSoA[6].data(), d.transformSoA[7].data(), d.transformSoA[8].data(), d.boxMax[0].data(), d.boxMax[1].data(), d.boxMax[2].data() };
+		d.floatResults[0] = float(CullAABBs(frustum, boxes, batch, d.indexResults.data()));
+	} });
+#pragma endregion
+
+#pragma region Bounds.h
+	benchmarks.push_back({ "TransformAABBs", [&d](size_t batch) {
+		TransformAABBs(std::span<const AABB>(d.boxes.data(), batch), d.affineMatrices[0], d.boxResults);
+		d.floatResults[0] = d.boxResults[batch - 1].max.x;
+	} });
+	benchmarks.push_back({ "MergeAABBs", [&d](size_t batch) {
+		d.floatResults[0] = MergeAABBs(std::span<const AABB>(d.boxes.data(), batch)).max.x;
+	} });
+	benchmarks.push_back({ "ComputeAABB", [&d](size_t batch) {
+		d.floatResults[0] = ComputeAABB(std::span<const VertexData>(d.vertices.data(), batch)).max.x;
+	} });
+	benchmarks.push_back({ "ComputeBoundingSphere", [&d](size_t batch) {
+		d.floatResults[0] = ComputeBoundingSphere(std::span<const VertexData>(d.vertices.data(), batch)).radius;
+	} });
+#pragma endregion
+
+#pragma region VertexFormat.h
+	benchmarks.push_back({ "EncodeVertices(Compact)", [&d](size_t batch) {
+		EncodeVertices(std::span<const VertexData>(d.vertices.data(), batch), d.compactResults);
+		d.floatResults[0] = d.compactResults[batch - 1].position.x;
+	} });
+	benchmarks.push_back({ "EncodeVertices(Quantized)", [&d](size_t batch) {
+		EncodeVertices(std::span<const VertexData>(d.vertices.data(), batch), d.quantization, d.quantizedResults);
+		d.floatResults[0] = float(d.quantizedResults[batch - 1].position[0]);
+	} });
+	benchmarks.push_back({ "DecodeVertices(Compact)", [&d](size_t batch) {
+		DecodeVertices(std::span<const VertexDataCompact>(d.compactVertices.data(), batch), d.vertexResults);
+		d.floatResults[0] = d.vertexResults[batch - 1].normal.x;
+	} });
+	benchmarks.push_back({ "DecodeVertices(Quantized)", [&d](size_t batch) {
+		DecodeVertices(std::span<const VertexDataQuantized>(d.quantizedVertices.data(), batch), d.quantization, d.vertexResults);
+		d.floatResults[0] = d.vertexResults[batch - 1].normal.x;
+	} });
+#pragma endregion
+
+#pragma region BVH.h
+	//球を10万個ばらまいたシーンに、batch本のレイを1本ずつ飛ばす。1回の時間がピッキング1回の時間になる
+	//シーンを作るのに時間がかかるので、最初に呼ばれたときに作る
+	struct RaycastScene {
+		MeshBVH sphere;
+		SceneBVH scene;
+		std::vector<Ray> rays;
+	};
+	auto raycastScene = std::make_shared<RaycastScene>();
+	benchmarks.push_back({ "SceneBVH::Raycast(100k)", [&d, raycastScene](size_t batch) {
+		RaycastScene& r = *raycastScene;
+		if (r.rays.empty()) {
+			std::mt19937 engine(54321);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+			r.sphere.Build(kSphereIndexedVertices<16>, kSphereIndices<16>);
+			for (int i = 0; i < 100000; i++) {
+				r.scene.AddInstance(&r.sphere, MakeAffineMatrix(Vector3{ 0.5f, 0.5f, 0.5f }, Vector3{ 0.0f, 0.0f, 0.0f },
+					Vector3{ unit(engine) * 200.0f, unit(engine) * 20.0f, unit(engine) * 200.0f }));
+			}
+			r.scene.Build();
+			//上から少し斜めに見下ろすレイ
+			r.rays.resize(4096);
+			for (Ray& ray : r.rays) {
+				ray.origin = { unit(engine) * 200.0f, 30.0f, unit(engine) * 200.0f };
+				ray.direction = Normalize(Vector3{ unit(engine) * 0.3f, -1.0f, unit(engine) * 0.3f });
+			}
+		}
+		for (size_t i = 0; i < batch; i++) {
+			const Ray& ray = r.rays[i % r.rays.size()];
+			d.floatResults[i] = r.scene.Raycast(ray.origin, ray.direction).u;
+		}
+	} });
+#pragma endregion
+
+#pragma region MathFunction.h
+	//まとめて計算する版と、標準ライブラリで1つずつ計算する場合を比べる
+	const std::vector<float>& radians = d.transformSoA[3];
+	benchmarks.push_back({ "SinCos(batch)", [&d, &radians](size_t batch) {
+		SinCos(std::span<const float>(radians.data(), batch), d.soaResults[0], d.soaResults[1]);
+	} });
+	benchmarks.push_back({ "std::sin+cos", [&d, &radians](size_t batch) {
+		for (size_t i = 0; i < batch; i++) {
+			d.soaResults[0][i] = std::sin(radians[i]);
+			d.soaResults[1][i] = std::cos(radians[i]);
+		}
+	} });
+	benchmarks.push_back({ "Acos(batch)", [&d](size_t batch) {
+		Acos(std::span<const float>(d.units.data(), batch), d.floatResults);
+	} });
+	addFloat("std::acos", [&d](size_t i) { return std::acos(d.units[i]); });
+	benchmarks.push_back({ "Exp2(batch)", [&d, &radians](size_t batch) {
+		Exp2(std::span<const float>(radians.data(), batch), d.floatResults);
+	} });
+	addFloat("std::exp2", [&radians](size_t i) { return std::exp2(radians[i]); });
+	benchmarks.push_back({ "Log2(batch)", [&d](size_t batch) {
+		Log2(std::span<const float>(d.scalars.data(), batch), d.floatResults);
+	} });
+	addFloat("std::log2", [&d](size_t i) { return std::log2(d.scalars[i]); });
+	benchmarks.push_back({ "Pow(batch)", [&d, &radians](size_t batch) {
+		Pow(std::span<const float>(d.scalars.data(), batch), radians, d.floatResults);
+	} });
+	addFloat("std::pow", [&d, &radians](size_t i) { return std::pow(d.scalars[i], radians[i]); });
+#pragma endregion
+
+	return benchmarks;
+}
+
+/// <summary>
+/// 1つの関数を指定したバッチサイズで計測する
+/// </summary>
+BenchmarkResult Measure(const Benchmark& benchmark, const BenchmarkData& data, size_t batch, double minTimeMs) {
+	using Clock = std::chrono::steady_clock;
+
+	//1回の計測がminTimeMsを超えるまで繰り返し回数を増やす
+	size_t repeat = 1;
+	double elapsedNs = 0.0;
+	for (;;) {
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < repeat; i++) {
+			benchmark.run(batch);
+		}
+		elapsedNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+		if (elapsedNs >= minTimeMs * 1.0e6) {
+			break;
+		}
+		repeat *= 2;
+	}
+
+	double bestNs = elapsedNs;
+	for (int sample = 1; sample < kSampleCount; sample++) {
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < repeat; i++) {
+			benchmark.run(batch);
+		}
+		double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+		bestNs = std::fmin(bestNs, ns);
+	}
+	Consume(data, batch);
+
+	double nsPerOp = bestNs / double(repeat * batch);
+	return { benchmark.name, batch, nsPerOp, 1.0e3 / nsPerOp };
+}
+
+#pragma region 精度の確認
+/// <summary>
+/// 精度を確認する項目。MathFunction_SIMD.hに書いた誤差の上限と比べる
+/// </summary>
+struct AccuracyCheck {
+	std::string name;
+	std::vector<float> inputs;
+	std::vector<float> results;
+	double (*reference)(double);
+	double limit;     //上限(ulpか絶対誤差)
+	bool isAbsolute;  //trueなら絶対誤差で比べる
+};
+
+/// <summary>
+/// 基準の値での1ulpの大きさ(floatに丸めた値の指数部から求める)
+/// </summary>
+double UnitInLastPlace(double reference) {
+	int exponent = 0;
+	std::frexp(double(float(reference)), &exponent);
+	return std::ldexp(1.0, std::max(exponent - 24, -149));
+}
+
+/// <summary>
+/// 結果と基準の差の最大値。基準がfloatで表せない(∞やNaN)ものは同じ値かだけを調べる
+/// </summary>
+double MeasureError(const AccuracyCheck& check, float& worstInput) {
+	double worst = 0.0;
+	for (size_t i = 0; i < check.inputs.size(); i++) {
+		double reference = check.reference(check.inputs[i]);
+		float result = check.results[i];
+		double error = 0.0;
+		if (!std::isfinite(float(reference))) {
+			bool isSame = std::isnan(reference) ? std::isnan(result) : double(result) == double(float(reference));
+			error = isSame ? 0.0 : INFINITY;
+		} else {
+			error = std::fabs(double(result) - reference);
+			error = check.isAbsolute ? error : error / UnitInLastPlace(reference);
+		}
+		if (error > worst) {
+			worst = error;
+			worstInput = check.inputs[i];
+		}
+	}
+	return worst;
+}
+
+//floatのビット表現をstep個おきに並べる(同じ符号で[first, last]の範囲)
+std::vector<float> MakeFloatRange(float first, float last, uint32_t step) {
+	uint32_t firstBits, lastBits;
+	std::memcpy(&firstBits, &first, sizeof(float));
+	std::memcpy(&lastBits, &last, sizeof(float));
+	std::vector<float> values;
+	for (uint64_t bits = firstBits; bits <= lastBits; bits += step) {
+		uint32_t value = uint32_t(bits);
+		float f;
+		std::memcpy(&f, &value, sizeof(float));
+		values.push_back(f);
+		values.push_back(-f);
+	}
+	return values;
+}
+
+/// <summary>
+/// VertexFormat.hの頂点形式に変換して戻したときの誤差を、ヘッダーに書いた上限と比べる
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckVertexFormatAccuracy() {
+	std::mt19937 engine(24680);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	constexpr size_t kVertexCount = 1 << 20;
+	//軸ごとに大きさの違う範囲に置き、量子化の幅が軸ごとに違っても上限に収まるかを見る
+	std::vector<VertexData> vertices(kVertexCount);
+	for (VertexData& vertex : vertices) {
+		vertex.position = { unit(engine) * 50.0f + 20.0f, unit(engine) * 5.0f, unit(engine) * 0.5f, 1.0f };
+		vertex.texcoode = { unit(engine) * 4.0f, unit(engine) };
+		vertex.normal = { unit(engine), unit(engine), unit(engine) };
+	}
+	PositionQuantization quantization = MakePositionQuantization(vertices);
+	std::vector<VertexDataQuantized> quantized(kVertexCount);
+	std::vector<VertexDataCompact> compact(kVertexCount);
+	std::vector<VertexData> quantizedResults(kVertexCount), compactResults(kVertexCount);
+	EncodeVertices(vertices, quantization, quantized);
+	EncodeVertices(vertices, compact);
+	DecodeVertices(quantized, quantization, quantizedResults);
+	DecodeVertices(compact, compactResults);
+
+	//位置は量子化の半分の幅を1とした値、UVは相対誤差、法線は角度(度)で比べる
+	double positionError = 0.0, compactPositionError = 0.0, texcoordError = 0.0, normalError = 0.0;
+	const float* scale = &quantization.scale.x;
+	for (size_t i = 0; i < kVertexCount; i++) {
+		const float* position = &vertices[i].position.x;
+		for (int axis = 0; axis < 3; axis++) {
+			double halfStep = double(scale[axis]) / 131070.0;
+			positionError = std::max(positionError, std::fabs(double((&quantizedResults[i].position.x)[axis]) - position[axis]) / halfStep);
+			compactPositionError = std::max(compactPositionError, std::fabs(double((&compactResults[i].position.x)[axis]) - position[axis]));
+		}
+		for (const VertexData* result : { &quantizedResults[i], &compactResults[i] }) {
+			const float* texcoord = &vertices[i].texcoode.x;
+			for (int element = 0; element < 2; element++) {
+				if (texcoord[element] != 0.0f) {
+					double error = std::fabs(double((&result->texcoode.x)[element]) - texcoord[element]) / std::fabs(double(texcoord[element]));
+					texcoordError = std::max(texcoordError, error);
+				}
+			}
+			//1に近い内積のacosは誤差が大きいので、外積の長さと内積のatan2で角度を求める
+			double a[3] = { vertices[i].normal.x, vertices[i].normal.y, vertices[i].normal.z };
+			double b[3] = { result->normal.x, result->normal.y, result->normal.z };
+			double cross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+			double sin = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+			double cos = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+			normalError = std::max(normalError, std::atan2(sin, cos) * 180.0 / 3.14159265358979);
+		}
+	}
+
+	struct Result {
+		const char* name;
+		double error;
+		double limit;
+		const char* unit;
+	};
+	//位置の上限はfloatの丸めの分だけ半分の幅より少し大きくしてある
+	const Result results[] = {
+		{ "position (Quantized)", positionError, 1.01, "stp" },
+		{ "position (Compact)", compactPositionError, 0.0, "   " },
+		{ "texcoord (half)", texcoordError, 1.0 / 2048.0, "   " },
+		{ "normal (octahedral)", normalError, 0.003, "deg" },
+	};
+	int failureCount = 0;
+	for (const Result& result : results) {
+		bool isFailed = result.error > result.limit;
+		failureCount += isFailed ? 1 : 0;
+		std::printf("%-28s %10.3g %s %10.3g %s%s\n", result.name, result.error, result.unit, result.limit, result.unit, isFailed ? "  FAILED" : "");
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// GetMatrixKernel(level)の各実装をスカラー実装と比べ、Matrix4x4_SIMD.hに書いた誤差の上限を確認する
+/// 誤差は要素ごとに Σ|a*b| の1ulpを単位にして測る。ビット一致のものは上限を0にしてある
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckMatrixKernelAccuracy() {
+	constexpr size_t kMatrixCount = 1 << 16;
+	const BenchmarkData data = MakeBenchmarkData(kMatrixCount);
+	const MatrixKernel& scalar = GetMatrixKernel(SimdLevel::Scalar);
+
+	//合成の入力。sin/cosは標準ライブラリで求めておく
+	std::vector<float> sines[3], cosines[3];
+	AffineComposeInput input{};
+	for (int axis = 0; axis < 3; axis++) {
+		for (float radian : data.transformSoA[3 + axis]) {
+			sines[axis].push_back(std::sin(radian));
+			cosines[axis].push_back(std::cos(radian));
+		}
+		input.scale[axis] = data.transformSoA[axis].data();
+		input.sin[axis] = sines[axis].data();
+		input.cos[axis] = cosines[axis].data();
+		input.translate[axis] = data.transformSoA[6 + axis].data();
+	}
+	std::vector<Matrix4x4> scalarComposed(kMatrixCount), composed(kMatrixCount);
+	scalar.composeAffine(input, kMatrixCount, scalarComposed.data());
+
+	int failureCount = 0;
+	for (SimdLevel level : { SimdLevel::SSE4, SimdLevel::AVX2 }) {
+		if (level > GetSimdLevel()) {
+			continue;
+		}
+		const MatrixKernel& kernel = GetMatrixKernel(level);
+		//FMAを使うのはAVX2だけ。それ以外はスカラー実装と同じ順番で計算する
+		const double productLimit = level == SimdLevel::AVX2 ? 4.0 : 0.0;
+		kernel.composeAffine(input, kMatrixCount, composed.data());
+
+		double errors[8] = {};
+		auto accumulate = [](double& worst, float result, float reference, double magnitude) {
+			double error = std::fabs(double(result) - double(reference));
+			if (error != 0.0) {
+				worst = std::max(worst, error / UnitInLastPlace(magnitude));
+			}
+		};
+		for (size_t i = 0; i < kMatrixCount; i++) {
+			const Matrix4x4& a = data.matrices1[i];
+			const Matrix4x4& b = data.matrices2[i];
+			Matrix4x4 result, reference;
+			kernel.add(a, b, result);
+			scalar.add(a, b, reference);
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					accumulate(errors[0], result.m[row][colmun], reference.m[row][colmun], std::fabs(reference.m[row][colmun]));
+				}
+			}
+			kernel.subtract(a, b, result);
+			scalar.subtract(a, b, reference);
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					accumulate(errors[1], result.m[row][colmun], reference.m[row][colmun], std::fabs(reference.m[row][colmun]));
+				}
+			}
+			kernel.transpose(a, result);
+			scalar.transpose(a, reference);
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					accumulate(errors[2], result.m[row][colmun], reference.m[row][colmun], std::fabs(reference.m[row][colmun]));
+				}
+			}
+			kernel.multiply(a, b, result);
+			scalar.multiply(a, b, reference);
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					double magnitude = 0.0;
+					for (int k = 0; k < 4; k++) {
+						magnitude += std::fabs(double(a.m[row][k]) * b.m[k][colmun]);
+					}
+					accumulate(errors[3], result.m[row][colmun], reference.m[row][colmun], magnitude);
+				}
+			}
+
+			//アフィン行列ならwは1になるので、割り算で誤差は増えない
+			const Vector3& vector = data.vectors1[i];
+			const Matrix4x4& affine = data.affineMatrices[i];
+			Vector3 transformed = kernel.transform(vector, affine);
+			Vector3 scalarTransformed = scalar.transform(vector, affine);
+			for (int colmun = 0; colmun < 3; colmun++) {
+				double magnitude = std::fabs(double(affine.m[3][colmun]));
+				for (int k = 0; k < 3; k++) {
+					magnitude += std::fabs(double((&vector.x)[k]) * affine.m[k][colmun]);
+				}
+				accumulate(errors[4], (&transformed.x)[colmun], (&scalarTransformed.x)[colmun], magnitude);
+			}
+
+			//合成は各要素が高々2つの積の和になる
+			double s[3], c[3];
+			for (int axis = 0; axis < 3; axis++) {
+				s[axis] = std::fabs(double(sines[axis][i]));
+				c[axis] = std::fabs(double(cosines[axis][i]));
+			}
+			const double composeMagnitude[3][3] = {
+				{ c[1] * c[2], c[1] * s[2], s[1] },
+				{ s[0] * s[1] * c[2] + c[0] * s[2], s[0] * s[1] * s[2] + c[0] * c[2], s[0] * c[1] },
+				{ c[0] * s[1] * c[2] + s[0] * s[2], c[0] * s[1] * s[2] + s[0] * c[2], c[0] * c[1] } };
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					double magnitude = row < 3 && colmun < 3 ? std::fabs(double(input.scale[row][i])) * composeMagnitude[row][colmun] : std::fabs(double(scalarComposed[i].m[row][colmun]));
+					accumulate(errors[5], composed[i].m[row][colmun], scalarComposed[i].m[row][colmun], magnitude);
+				}
+			}
+
+			const Matrix3x4& affine1 = data.affineMatrices3x4[i];
+			const Matrix3x4& affine2 = data.rigidMatrices3x4[i];
+			Matrix3x4 result3x4, reference3x4;
+			kernel.multiply3x4(affine1, affine2, result3x4);
+			scalar.multiply3x4(affine1, affine2, reference3x4);
+			for (int row = 0; row < 3; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					double magnitude = colmun == 3 ? std::fabs(double(affine2.m[row][3])) : 0.0;
+					for (int k = 0; k < 3; k++) {
+						magnitude += std::fabs(double(affine2.m[row][k]) * affine1.m[k][colmun]);
+					}
+					accumulate(errors[6], result3x4.m[row][colmun], reference3x4.m[row][colmun], magnitude);
+				}
+			}
+			kernel.multiply3x4By4x4(affine1, b, result);
+			scalar.multiply3x4By4x4(affine1, b, reference);
+			for (int row = 0; row < 4; row++) {
+				for (int colmun = 0; colmun < 4; colmun++) {
+					double magnitude = row == 3 ? std::fabs(double(b.m[3][colmun])) : 0.0;
+					for (int k = 0; k < 3; k++) {
+						magnitude += std::fabs(double(affine1.m[k][row]) * b.m[k][colmun]);
+					}
+					accumulate(errors[7], result.m[row][colmun], reference.m[row][colmun], magnitude);
+				}
+			}
+		}
+
+		const char* names[8] = { "Add", "Subtract", "Transpose", "Multiply", "Transform", "ComposeAffine", "Multiply(3x4)", "Multiply(3x4,4x4)" };
+		const double limits[8] = { 0.0, 0.0, 0.0, productLimit, productLimit, productLimit, productLimit, productLimit };
+		for (int i = 0; i < 8; i++) {
+			bool isFailed = errors[i] > limits[i];
+			failureCount += isFailed ? 1 : 0;
+			std::string name = std::string(names[i]) + " [" + GetSimdLevelName(level) + "]";
+			std::printf("%-28s %10.3g ulp %10.3g ulp%s\n", name.c_str(), errors[i], limits[i], isFailed ? "  FAILED" : "");
+		}
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// InverseAffineとInverseRigidを一般の行列のInverseと比べる
+/// 誤差は3x3部分の要素の最大値を1とした値で測る。平行移動の行は Σ|t| 倍してから比べる
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckInverseAccuracy() {
+	std::mt19937 engine(13579);
+	std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+	std::uniform_real_distribution<float> translate(-100.0f, 100.0f);
+	constexpr size_t kMatrixCount = 1 << 16;
+	//floatの丸め誤差の30倍ほど。どの方法も3x3部分の誤差は数回の丸めで収まる
+	constexpr double kLimit = 4.0e-6;
+
+	double affineError = 0.0, rigidError = 0.0;
+	auto measure = [](const Matrix4x4& result, const Matrix4x4& reference, const Vector3& translation) {
+		double blockMax = 0.0;
+		for (int row = 0; row < 3; row++) {
+			for (int colmun = 0; colmun < 3; colmun++) {
+				blockMax = std::max(blockMax, std::fabs(double(reference.m[row][colmun])));
+			}
+		}
+		double translationScale = (std::fabs(double(translation.x)) + std::fabs(double(translation.y)) + std::fabs(double(translation.z)) + 1.0) * blockMax;
+		double worst = 0.0;
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				double error = std::fabs(double(result.m[row][colmun]) - double(reference.m[row][colmun]));
+				worst = std::max(worst, error / (row == 3 ? translationScale : blockMax));
+			}
+		}
+		return worst;
+	};
+	for (size_t i = 0; i < kMatrixCount; i++) {
+		Vector3 rotate = { angle(engine), angle(engine), angle(engine) };
+		Vector3 translation = { translate(engine), translate(engine), translate(engine) };
+		Matrix4x4 srt = MakeAffineMatrix(Vector3{ scale(engine), scale(engine), scale(engine) }, rotate, translation);
+		affineError = std::max(affineError, measure(InverseAffine(srt), Inverse(srt), translation));
+		Matrix4x4 rt = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, rotate, translation);
+		rigidError = std::max(rigidError, measure(InverseRigid(rt), Inverse(rt), translation));
+	}
+
+	int failureCount = 0;
+	const std::pair<const char*, double> results[] = { { "InverseAffine (SRT)", affineError }, { "InverseRigid (RT)", rigidError } };
+	for (const auto& [name, error] : results) {
+		bool isFailed = error > kLimit;
+		failureCount += isFailed ? 1 : 0;
+		std::printf("%-28s %10.3g rel %10.3g rel%s\n", name, error, kLimit, isFailed ? "  FAILED" : "");
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// Vector3_Math.hppのLength/Normalizeの誤差を段階ごとに倍精度の結果と比べる
+/// 入力はヘッダーに書いた上限を測ったときと同じく、長さ1～1000のベクトル
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckVectorPrecisionAccuracy() {
+	std::mt19937 engine(97531);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> lengthExponent(0.0f, 3.0f);
+	constexpr size_t kVectorCount = 1 << 21;
+	std::vector<Vector3> vectors;
+	vectors.reserve(kVectorCount);
+	while (vectors.size() < kVectorCount) {
+		Vector3 direction = { unit(engine), unit(engine), unit(engine) };
+		double lengthSq = double(direction.x) * direction.x + double(direction.y) * direction.y + double(direction.z) * direction.z;
+		if (lengthSq < 1.0e-4 || lengthSq > 1.0) {
+			continue;
+		}
+		//長さは対数で一様に散らす
+		float scale = std::pow(10.0f, lengthExponent(engine)) / float(std::sqrt(lengthSq));
+		vectors.push_back(direction * scale);
+	}
+
+	struct Result {
+		const char* name;
+		double lengthError;
+		double normalizeError;
+		double lengthLimit;
+		double normalizeLimit;
+	};
+	Result results[] = {
+		{ "Exact", 0.0, 0.0, 2.0, 3.0 },
+		{ "Fast", 0.0, 0.0, 5.0, 5.0 },
+		{ "Approx", 0.0, 0.0, 6200.0, 6200.0 },
+	};
+	auto measure = [&vectors]<class Policy>(Result& result) {
+		for (const Vector3& vector : vectors) {
+			double x = vector.x, y = vector.y, z = vector.z;
+			double length = std::sqrt(x * x + y * y + z * z);
+			result.lengthError = std::max(result.lengthError, std::fabs(double(Length<Policy>(vector)) - length) / UnitInLastPlace(length));
+			Vector3 normalized = Normalize<Policy>(vector);
+			const double reference[3] = { x / length, y / length, z / length };
+			for (int axis = 0; axis < 3; axis++) {
+				double error = std::fabs(double((&normalized.x)[axis]) - reference[axis]) / UnitInLastPlace(reference[axis]);
+				result.normalizeError = std::max(result.normalizeError, error);
+			}
+		}
+	};
+	measure.operator()<Precision::Exact>(results[0]);
+	measure.operator()<Precision::Fast>(results[1]);
+	measure.operator()<Precision::Approx>(results[2]);
+
+	int failureCount = 0;
+	for (const Result& result : results) {
+		const std::pair<const char*, double> errors[] = { { "Length<", result.lengthError }, { "Normalize<", result.normalizeError } };
+		for (int i = 0; i < 2; i++) {
+			double limit = i == 0 ? result.lengthLimit : result.normalizeLimit;
+			bool isFailed = errors[i].second > limit;
+			failureCount += isFailed ? 1 : 0;
+			std::string name = std::string(errors[i].first) + result.name + ">";
+			std::printf("%-28s %10.3g ulp %10.3g ulp%s\n", name.c_str(), errors[i].second, limit, isFailed ? "  FAILED" : "");
+		}
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// まとめて行うNlerp(SIMD)を1つずつのNlerpと比べる。誤差は成分ごとに1.0の1ulp(2^-24)を単位にして測る
+/// 長さ0になる組み合わせ(零クォータニオン)と正反対の回転も、AVX2とSSE4のブロックの両方に入れておく
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckNlerpAccuracy() {
+	//AVX2で8つずつ、残りの4つをSSE4、最後の3つをスカラーで計算する数
+	constexpr size_t kCount = (1 << 16) + 7;
+	constexpr size_t kSSE4Block = 1 << 16;
+	//正規化の逆数と積の丸め、FMAの有無の差の分
+	constexpr double kLimit = 4.0;
+	BenchmarkData data = MakeBenchmarkData(kCount);
+	std::vector<float> t(data.units.size());
+	for (size_t i = 0; i < t.size(); i++) {
+		t[i] = data.units[i] * 0.5f + 0.5f;
+	}
+	const Quaternion zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const Quaternion identity = IdentityQuaternion();
+	const Quaternion opposite = { 0.0f, 0.0f, 0.0f, -1.0f };
+	struct Special {
+		Quaternion q1;
+		Quaternion q2;
+		float t;
+	};
+	const Special specials[] = {
+		{ identity, opposite, 0.5f },
+		{ zero, zero, 0.5f },
+		{ identity, zero, 1.0f },
+		{ zero, Quaternion{ 1.0f, 0.0f, 0.0f, 0.0f }, 0.0f },
+	};
+	for (size_t first : { size_t(0), kSSE4Block }) {
+		for (size_t i = 0; i < std::size(specials); i++) {
+			data.quaternions1[first + i] = specials[i].q1;
+			data.quaternions2[first + i] = specials[i].q2;
+			t[first + i] = specials[i].t;
+		}
+	}
+
+	std::vector<Quaternion> results(kCount);
+	Nlerp(data.quaternions1, data.quaternions2, t, results);
+	double worst = 0.0;
+	for (size_t i = 0; i < kCount; i++) {
+		Quaternion reference = Nlerp(data.quaternions1[i], data.quaternions2[i], t[i]);
+		for (int element = 0; element < 4; element++) {
+			double error = std::fabs(double((&results[i].x)[element]) - double((&reference.x)[element])) / std::ldexp(1.0, -24);
+			//NaNは上限を必ず超えるようにする
+			worst = std::isnan(error) ? std::numeric_limits<double>::infinity() : std::max(worst, error);
+		}
+	}
+
+	bool isFailed = worst > kLimit;
+	std::string name = std::string("Nlerp (batch) [") + GetSimdLevelName(GetSimdLevel()) + "]";
+	std::printf("%-28s %10.3g ulp %10.3g ulp%s\n", name.c_str(), worst, kLimit, isFailed ? "  FAILED" : "");
+	return isFailed ? 1 : 0;
+}
+
+/// <summary>
+/// 基本形状の三角形と頂点の順番をばらばらにしてからOptimizeMeshを通し、並べ替えの効果と結果が壊れていないことを確かめる
+/// 三角形の集合(頂点の値と巻き順)が変わったか、ACMRが良くならなければ失敗にする
+/// </summary>
+/// <returns>失敗した形状の数</returns>
+int CheckMeshOptimizer() {
+	std::mt19937 engine(24680);
+	//三角形を頂点の値で表し、巻き順を保ったまま回して最小の頂点を先頭にする(頂点番号と三角形の順番によらない形)
+	using Corner = std::array<float, 9>;
+	using Triangle = std::array<Corner, 3>;
+	auto collectTriangles = [](const MeshData& mesh) {
+		std::vector<Triangle> triangles(mesh.indices.size() / 3);
+		for (size_t i = 0; i < triangles.size(); i++) {
+			for (size_t corner = 0; corner < 3; corner++) {
+				std::memcpy(triangles[i][corner].data(), &mesh.vertices[mesh.indices[i * 3 + corner]], sizeof(Corner));
+			}
+			std::rotate(triangles[i].begin(), std::min_element(triangles[i].begin(), triangles[i].end()), triangles[i].end());
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+
+	const std::pair<const char*, PrimitiveType> primitives[] = {
+		{ "Sphere", PrimitiveType::Sphere }, { "Box", PrimitiveType::Box }, { "Plane", PrimitiveType::Plane },
+		{ "Cylinder", PrimitiveType::Cylinder }, { "Cone", PrimitiveType::Cone }, { "Torus", PrimitiveType::Torus },
+		{ "Capsule", PrimitiveType::Capsule },
+	};
+	std::printf("\n%-28s %16s %16s %16s\n", "OptimizeMesh (shuffled)", "ACMR", "ATVR", "overdraw");
+	int failureCount = 0;
+	for (const auto& [name, type] : primitives) {
+		MeshData mesh = MakePrimitiveMesh(type, 32);
+		const size_t triangleCount = mesh.indices.size() / 3;
+
+		//頂点の番号を入れ替えてから、三角形の順番を混ぜる
+		std::vector<uint32_t> remap(mesh.vertices.size());
+		for (uint32_t i = 0; i < remap.size(); i++) {
+			remap[i] = i;
+		}
+		std::shuffle(remap.begin(), remap.end(), engine);
+		std::vector<VertexData> shuffledVertices(mesh.vertices.size());
+		for (size_t i = 0; i < remap.size(); i++) {
+			shuffledVertices[remap[i]] = mesh.vertices[i];
+		}
+		mesh.vertices = std::move(shuffledVertices);
+		std::vector<uint32_t> order(triangleCount);
+		for (uint32_t i = 0; i < order.size(); i++) {
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), engine);
+		std::vector<uint32_t> shuffledIndices(mesh.indices.size());
+		for (size_t i = 0; i < triangleCount; i++) {
+			for (size_t corner = 0; corner < 3; corner++) {
+				shuffledIndices[i * 3 + corner] = remap[mesh.indices[order[i] * 3 + corner]];
+			}
+		}
+		mesh.indices = std::move(shuffledIndices);
+
+		const std::vector<Triangle> trianglesBefore = collectTriangles(mesh);
+		VertexCacheStatistics cacheBefore = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+		OverdrawStatistics overdrawBefore = AnalyzeOverdraw(mesh.indices, mesh.vertices);
+		OptimizeMesh(mesh);
+		VertexCacheStatistics cacheAfter = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+		OverdrawStatistics overdrawAfter = AnalyzeOverdraw(mesh.indices, mesh.vertices);
+
+		bool isSameTriangles = collectTriangles(mesh) == trianglesBefore;
+		bool isFailed = !isSameTriangles || cacheAfter.acmr >= cacheBefore.acmr;
+		failureCount += isFailed ? 1 : 0;
+		std::printf("%-28s %7.3f->%7.3f %7.3f->%7.3f %7.3f->%7.3f%s%s\n", name,
+			cacheBefore.acmr, cacheAfter.acmr, cacheBefore.atvr, cacheAfter.atvr, overdrawBefore.overdraw, overdrawAfter.overdraw,
+			isSameTriangles ? "" : "  triangles changed", isFailed ? "  FAILED" : "");
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// MathFunction.hの関数の誤差を標準ライブラリ(double)と比べる。入力はどの命令セットでも同じものを使う
+/// </summary>
+/// <param name="level">計算に使う命令セット</param>
+/// <returns>上限を超えたものの数</returns>
+int CheckMathFunctionAccuracy(SimdLevel level) {
+	std::mt19937 engine(67890);
+	auto random = [&](float min, float max, size_t count) {
+		std::uniform_real_distribution<float> distribution(min, max);
+		std::vector<float> values(count);
+		for (float& value : values) {
+			value = distribution(engine);
+		}
+		return values;
+	};
+	constexpr float kPi = 3.14159265f;
+	constexpr size_t kSampleCount = 1 << 22;
+	//powは誤差の大きい入力がまれなので、ほかの関数の8倍の数を調べる
+	constexpr size_t kPowBlockCount = 8;
+	const std::string suffix = std::string(" [") + GetSimdLevelName(level) + "]";
+
+	std::vector<AccuracyCheck> checks;
+	auto addSinCos = [&](const char* name, std::vector<float> inputs, double limit, bool isAbsolute) {
+		std::vector<float> sines(inputs.size()), cosines(inputs.size());
+		SinCos(inputs, sines, cosines, level);
+		checks.push_back({ std::string("sin ") + name + suffix, inputs, sines, [](double x) { return std::sin(x); }, limit, isAbsolute });
+		checks.push_back({ std::string("cos ") + name + suffix, inputs, cosines, [](double x) { return std::cos(x); }, limit, isAbsolute });
+	};
+	auto addUnary = [&](const char* name, std::vector<float> inputs, void (*function)(std::span<const float>, std::span<float>, SimdLevel), double (*reference)(double), double limit) {
+		std::vector<float> results(inputs.size());
+		function(inputs, results, level);
+		checks.push_back({ name + suffix, inputs, results, reference, limit, false });
+	};
+	addSinCos("|x|<=pi", MakeFloatRange(0.0f, kPi, 257), 2.0, false);
+	addSinCos("|x|<=8192 (abs)", random(-8192.0f, 8192.0f, kSampleCount), 8.0e-8, true);
+	addUnary("acos", MakeFloatRange(0.0f, 1.0f, 257), Acos, [](double x) { return std::acos(x); }, 2.0);
+	addUnary("exp2", random(-160.0f, 130.0f, kSampleCount), Exp2, [](double x) { return std::exp2(x); }, 2.0);
+	std::vector<float> positives = MakeFloatRange(std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(), 1031);
+	positives.erase(std::remove_if(positives.begin(), positives.end(), [](float x) { return x < 0.0f; }), positives.end());
+	addUnary("log2", positives, Log2, [](double x) { return std::log2(x); }, 2.0);
+
+	int failureCount = 0;
+	for (const AccuracyCheck& check : checks) {
+		float worstInput = 0.0f;
+		double worst = MeasureError(check, worstInput);
+		bool isFailed = worst > check.limit;
+		failureCount += isFailed ? 1 : 0;
+		const char* unit = check.isAbsolute ? "   " : "ulp";
+		std::printf("%-28s %10.3g %s %10.3g %s %16g%s\n", check.name.c_str(), worst, unit, check.limit, unit, worstInput, isFailed ? "  FAILED" : "");
+	}
+	checks.clear();
+
+	//powは指数の範囲ごとに確認する。基準の計算に指数が必要なのでここで比べる
+	for (float exponentLimit : { 2.0f, 32.0f }) {
+		double worst = 0.0;
+		float worstBase = 0.0f, worstExponent = 0.0f;
+		std::vector<float> results(kSampleCount);
+		for (size_t block = 0; block < kPowBlockCount; block++) {
+			std::vector<float> bases = random(-20.0f, 20.0f, kSampleCount);
+			std::vector<float> exponents = random(-exponentLimit, exponentLimit, kSampleCount);
+			for (float& base : bases) {
+				base = std::exp2(base);
+			}
+			Pow(bases, exponents, results, level);
+			for (size_t i = 0; i < kSampleCount; i++) {
+				double reference = std::pow(double(bases[i]), double(exponents[i]));
+				if (!std::isfinite(float(reference)) || float(reference) < std::numeric_limits<float>::min()) {
+					continue;
+				}
+				double error = std::fabs(double(results[i]) - reference) / UnitInLastPlace(reference);
+				if (error > worst) {
+					worst = error;
+					worstBase = bases[i];
+					worstExponent = exponents[i];
+				}
+			}
+		}
+		constexpr double limit = 2.0;
+		bool isFailed = worst > limit;
+		failureCount += isFailed ? 1 : 0;
+		std::string name = "pow |y|<=" + std::to_string(int(exponentLimit)) + suffix;
+		char worstInput[64];
+		std::snprintf(worstInput, sizeof(worstInput), "%g^%g", worstBase, worstExponent);
+		std::printf("%-28s %10.3g ulp %10.3g ulp %16s%s\n", name.c_str(), worst, limit, worstInput, isFailed ? "  FAILED" : "");
+	}
+	return failureCount;
+}
+
+/// <summary>
+/// --accuracyで確認する項目をすべて実行する。SIMDの段階があるものはCPUが対応している段階をすべて確認する
+/// </summary>
+/// <returns>上限を超えたものの数</returns>
+int CheckAccuracy() {
+	int failureCount = 0;
+	std::printf("%-28s %14s %14s %16s\n", "function", "max error", "limit", "worst input");
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE4, SimdLevel::AVX2 }) {
+		if (level <= GetSimdLevel()) {
+			failureCount += CheckMathFunctionAccuracy(level);
+		}
+	}
+	failureCount += CheckVertexFormatAccuracy();
+	failureCount += CheckMatrixKernelAccuracy();
+	failureCount += CheckInverseAccuracy();
+	failureCount += CheckVectorPrecisionAccuracy();
+	failureCount += CheckNlerpAccuracy();
+	failureCount += CheckMeshOptimizer();
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region json
+//出力するjsonは1行に1つの結果を書くので、読み込みも行単位で行う
+
+bool WriteJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fprintf(file, "{\n  \"simdLevel\": \"%s\",\n  \"results\": [\n", GetSimdLevelName(GetSimdLevel()));
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& result = results[i];
+		std::fprintf(file, "    {\"name\": \"%s\", \"batch\": %zu, \"nsPerOp\": %.4f, \"mopsPerSec\": %.3f}%s\n",
+			result.name.c_str(), result.batch, result.nsPerOp, result.mopsPerSec, i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+	std::fclose(file);
+	return true;
+}
+
+//"key": の後ろの値を取り出す
+bool FindValue(const std::string& line, const char* key, std::string& value) {
+	std::string pattern = std::string("\"") + key + "\": ";
+	size_t position = line.find(pattern);
+	if (position == std::string::npos) {
+		return false;
+	}
+	position += pattern.size();
+	if (line[position] == '"') {
+		size_t end = line.find('"', position + 1);
+		value = line.substr(position + 1, end - position - 1);
+	} else {
+		size_t end = line.find_first_of(",}", position);
+		value = line.substr(position, end - position);
+	}
+	return true;
+}
+
+bool ReadJson(const std::string& path, std::vector<BenchmarkResult>& results) {
+	FILE* file = std::fopen(path.c_str(), "r");
+	if (file == nullptr) {
+		return false;
+	}
+	char buffer[1024];
+	while (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+		std::string line = buffer;
+		std::string name, batch, nsPerOp, mopsPerSec;
+		if (FindValue(line, "name", name) && FindValue(line, "batch", batch) && FindValue(line, "nsPerOp", nsPerOp) && FindValue(line, "mopsPerSec", mopsPerSec)) {
+			results.push_back({ name, size_t(std::strtoull(batch.c_str(), nullptr, 10)), std::atof(nsPerOp.c_str()), std::atof(mopsPerSec.c_str()) });
+		}
+	}
+	std::fclose(file);
+	return true;
+}
+#pragma endregion
+
+/// <summary>
+/// 基準の結果と比べて、threshold%以上遅くなったものの数を返す
+/// </summary>
+int Compare(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& results, double threshold) {
+	int regressionCount = 0;
+	std::printf("\n%-36s %8s %12s %12s %9s\n", "name", "batch", "base ns/op", "ns/op", "change");
+	for (const BenchmarkResult& result : results) {
+		for (const BenchmarkResult& base : baseline) {
+			if (base.name != result.name || base.batch != result.batch) {
+				continue;
+			}
+			double change = (result.nsPerOp / base.nsPerOp - 1.0) * 100.0;
+			bool isRegression = change > threshold;
+			regressionCount += isRegression ? 1 : 0;
+			std::printf("%-36s %8zu %12.3f %12.3f %+8.1f%%%s\n", result.name.c_str(), result.batch, base.nsPerOp, result.nsPerOp, change, isRegression ? "  REGRESSION" : "");
+			break;
+		}
+	}
+	return regressionCount;
+}
+
+std::vector<size_t> ParseBatches(const char* text) {
+	std::vector<size_t> batches;
+	const char* current = text;
+	while (*current != '\0') {
+		char* end = nullptr;
+		size_t batch = size_t(std::strtoull(current, &end, 10));
+		if (end == current) {
+			break;
+		}
+		if (batch > 0) {
+			batches.push_back(batch);
+		}
+		current = *end == ',' ? end + 1 : end;
+	}
+	return batches;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (argument == "--filter" && hasValue) {
+			options.filter = argv[++i];
+		} else if (argument == "--batch" && hasValue) {
+			options.batches = ParseBatches(argv[++i]);
+		} else if (argument == "--min-time" && hasValue) {
+			options.minTimeMs = std::atof(argv[++i]);
+		} else if (argument == "--out" && hasValue) {
+			options.outPath = argv[++i];
+		} else if (argument == "--compare" && hasValue) {
+			options.comparePath = argv[++i];
+		} else if (argument == "--threshold" && hasValue) {
+			options.threshold = std::atof(argv[++i]);
+		} else if (argument == "--accuracy") {
+			options.isAccuracy = true;
+		} else {
+			std::fprintf(stderr, "unknown argument: %s\n", argument.c_str());
+			return false;
+		}
+	}
+	return !options.batches.empty();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		std::fprintf(stderr, "usage: %s [--filter name] [--batch 16,256,4096] [--min-time ms] [--out result.json] [--compare baseline.json] [--threshold percent] [--accuracy]\n", argv[0]);
+		return 2;
+	}
+
+	//--accuracyのときは速度を計らずに誤差だけを確認する
+	if (options.isAccuracy) {
+		std::printf("SIMD: %s\n", GetSimdLevelName(GetSimdLevel()));
+		int failureCount = CheckAccuracy();
+		if (failureCount > 0) {
+			std::printf("\n%d function(s) over the documented error\n", failureCount);
+			return 1;
+		}
+		std::printf("\nall functions within the documented error\n");
+		return 0;
+	}
+
+	std::vector<BenchmarkResult> baseline;
+	if (!options.comparePath.empty() && !ReadJson(options.comparePath, baseline)) {
+		std::fprintf(stderr, "failed to read %s\n", options.comparePath.c_str());
+		return 2;
+	}
+
+	size_t maxBatch = 0;
+	for (size_t batch : options.batches) {
+		maxBatch = batch > maxBatch ? batch : maxBatch;
+	}
+	BenchmarkData data = MakeBenchmarkData(maxBatch);
+	std::vector<Benchmark> benchmarks = MakeBenchmarks(data);
+
+	std::printf("SIMD: %s\n", GetSimdLevelName(GetSimdLevel()));
+	std::printf("%-36s %8s %12s %12s\n", "name", "batch", "ns/op", "Mops/s");
+	std::vector<BenchmarkResult> results;
+	for (const Benchmark& benchmark : benchmarks) {
+		if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		for (size_t batch : options.batches) {
+			BenchmarkResult result = Measure(benchmark, data, batch, options.minTimeMs);
+			std::printf("%-36s %8zu %12.3f %12.2f\n", result.name.c_str(), result.batch, result.nsPerOp, result.mopsPerSec);
+			results.push_back(result);
+		}
+	}
+
+	if (!options.outPath.empty() && !WriteJson(options.outPath, results)) {
+		std::fprintf(stderr, "failed to write %s\n", options.outPath.c_str());
+		return 2;
+	}
+
+	if (!baseline.empty()) {
+		int regressionCount = Compare(baseline, results, options.threshold);
+		if (regressionCount > 0) {
+			std::printf("\n%d regression(s) over %.1f%%\n", regressionCount, options.threshold);
+			return 1;
+		}
+		std::printf("\nno regressions over %.1f%%\n", options.threshold);
+	}
+	return 0;
+}
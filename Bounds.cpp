@@ -0,0 +1,211 @@
+#include "Bounds.h"
+#include "Vector_SIMD.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+//これ以上の頂点数のときはスレッドプールで分担する
+constexpr size_t kParallelThreshold = 65536;
+//1スレッドが一度に処理する頂点数
+constexpr size_t kParallelGrainSize = 16384;
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+const AABB kEmptyAABB = { { kInfinity, kInfinity, kInfinity }, { -kInfinity, -kInfinity, -kInfinity } };
+
+inline __m128 Abs(__m128 v) {
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+/// <summary>
+/// 中心と半分の大きさで表したAABBを行列で変換する
+/// </summary>
+inline void TransformCenterExtent(Vector3A center, Vector3A extent, const Matrix4x4& matrix, Vector3A& resultCenter, Vector3A& resultExtent) {
+	resultCenter = TransformPoint(center, matrix);
+	//変換後の各軸の半分の大きさは、元の半分の大きさと3x3部分の絶対値の積
+	__m128 ex = _mm_shuffle_ps(extent.v, extent.v, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 ey = _mm_shuffle_ps(extent.v, extent.v, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 ez = _mm_shuffle_ps(extent.v, extent.v, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 e = _mm_mul_ps(ex, Abs(_mm_loadu_ps(matrix.m[0])));
+	e = VectorSIMD::MultiplyAdd(ey, Abs(_mm_loadu_ps(matrix.m[1])), e);
+	e = VectorSIMD::MultiplyAdd(ez, Abs(_mm_loadu_ps(matrix.m[2])), e);
+	resultExtent = ToVector3A({ e });
+}
+
+inline AABB TransformAABB(const AABB& aabb, const Matrix4x4& matrix, __m128 half) {
+	Vector3A min = Load(aabb.min);
+	Vector3A max = Load(aabb.max);
+	Vector3A center = { _mm_mul_ps(_mm_add_ps(min.v, max.v), half) };
+	Vector3A extent = { _mm_mul_ps(_mm_sub_ps(max.v, min.v), half) };
+	Vector3A resultCenter, resultExtent;
+	TransformCenterExtent(center, extent, matrix, resultCenter, resultExtent);
+	return { ToVector3(resultCenter - resultExtent), ToVector3(resultCenter + resultExtent) };
+}
+
+/// <summary>
+/// 頂点の範囲[begin, end)を囲むAABB
+/// </summary>
+AABB ComputeAABBRange(std::span<const VertexData> vertices, size_t begin, size_t end) {
+	Vector4A min = Load(Vector4{ kInfinity, kInfinity, kInfinity, kInfinity });
+	Vector4A max = Load(Vector4{ -kInfinity, -kInfinity, -kInfinity, -kInfinity });
+	for (size_t i = begin; i < end; i++) {
+		//positionはVertexDataの先頭にあるのでxyzwの16バイトをまとめて読む
+		Vector4A position = Load(vertices[i].position);
+		min = Min(min, position);
+		max = Max(max, position);
+	}
+	return { ToVector3(ToVector3A(min)), ToVector3(ToVector3A(max)) };
+}
+
+/// <summary>
+/// 頂点の範囲[begin, end)のうち中心から一番遠いものまでの距離の2乗
+/// </summary>
+float ComputeMaxDistanceSq(std::span<const VertexData> vertices, Vector3A center, size_t begin, size_t end) {
+	__m128 maxDistanceSq = _mm_setzero_ps();
+	for (size_t i = begin; i < end; i++) {
+		Vector3A difference = ToVector3A(Load(vertices[i].position)) - center;
+		maxDistanceSq = _mm_max_ps(maxDistanceSq, DotSplat(difference, difference));
+	}
+	return _mm_cvtss_f32(maxDistanceSq);
+}
+
+/// <summary>
+/// 頂点数が多いときだけ範囲を分けて並列に処理し、チャンクごとの結果を返す
+/// </summary>
+template<class Result, class Function>
+std::vector<Result> ParallelReduce(size_t count, const Function& function) {
+	if (count < kParallelThreshold) {
+		return { function(0, count) };
+	}
+	std::vector<Result> results((count + kParallelGrainSize - 1) / kParallelGrainSize);
+	ThreadPool::GetInstance().ParallelFor(count, kParallelGrainSize, [&](size_t begin, size_t end) {
+		results[begin / kParallelGrainSize] = function(begin, end);
+	});
+	return results;
+}
+
+}
+
+AABB TransformAABB(const AABB& aabb, const Matrix4x4& matrix) {
+	return TransformAABB(aabb, matrix, _mm_set1_ps(0.5f));
+}
+
+void TransformAABBs(std::span<const AABB> aabbs, const Matrix4x4& matrix, std::span<AABB> result) {
+	assert(result.size() >= aabbs.size());
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (size_t i = 0; i < aabbs.size(); i++) {
+		result[i] = TransformAABB(aabbs[i], matrix, half);
+	}
+}
+
+BoundingSphere TransformSphere(const BoundingSphere& sphere, const Matrix4x4& matrix) {
+	//行ベクトルなので、各行の長さがその軸のスケールになる
+	const float(&m)[4][4] = matrix.m;
+	float scaleSq = 0.0f;
+	for (int row = 0; row < 3; row++) {
+		scaleSq = std::max(scaleSq, m[row][0] * m[row][0] + m[row][1] * m[row][1] + m[row][2] * m[row][2]);
+	}
+	return { ToVector3(TransformPoint(Load(sphere.center), matrix)), sphere.radius * std::sqrt(scaleSq) };
+}
+
+OBB TransformOBB(const OBB& obb, const Matrix4x4& matrix) {
+	OBB result;
+	result.center = ToVector3(TransformPoint(Load(obb.center), matrix));
+	float* size = &result.size.x;
+	const float* sourceSize = &obb.size.x;
+	for (int axis = 0; axis < 3; axis++) {
+		Vector3A orientation = TransformNormal(Load(obb.orientations[axis]) * sourceSize[axis], matrix);
+		float length = Length(orientation);
+		size[axis] = length;
+		result.orientations[axis] = ToVector3(length != 0.0f ? orientation * (1.0f / length) : Load(obb.orientations[axis]));
+	}
+	return result;
+}
+
+OBB MakeOBB(const AABB& aabb, const Matrix4x4& matrix) {
+	OBB local;
+	local.center = (aabb.min + aabb.max) * 0.5f;
+	local.orientations[0] = { 1.0f, 0.0f, 0.0f };
+	local.orientations[1] = { 0.0f, 1.0f, 0.0f };
+	local.orientations[2] = { 0.0f, 0.0f, 1.0f };
+	local.size = (aabb.max - aabb.min) * 0.5f;
+	return TransformOBB(local, matrix);
+}
+
+AABB ToAABB(const OBB& obb) {
+	Vector3A center = Load(obb.center);
+	Vector3A extent = { _mm_mul_ps(Abs(Load(obb.orientations[0]).v), _mm_set1_ps(obb.size.x)) };
+	extent.v = VectorSIMD::MultiplyAdd(Abs(Load(obb.orientations[1]).v), _mm_set1_ps(obb.size.y), extent.v);
+	extent.v = VectorSIMD::MultiplyAdd(Abs(Load(obb.orientations[2]).v), _mm_set1_ps(obb.size.z), extent.v);
+	return { ToVector3(center - extent), ToVector3(center + extent) };
+}
+
+AABB ToAABB(const BoundingSphere& sphere) {
+	Vector3 extent = { sphere.radius, sphere.radius, sphere.radius };
+	return { sphere.center - extent, sphere.center + extent };
+}
+
+BoundingSphere ToSphere(const AABB& aabb) {
+	Vector3A min = Load(aabb.min);
+	Vector3A max = Load(aabb.max);
+	return { ToVector3((min + max) * 0.5f), Length(max - min) * 0.5f };
+}
+
+AABB Merge(const AABB& aabb1, const AABB& aabb2) {
+	return {
+		ToVector3(Min(Load(aabb1.min), Load(aabb2.min))),
+		ToVector3(Max(Load(aabb1.max), Load(aabb2.max)))
+	};
+}
+
+BoundingSphere Merge(const BoundingSphere& sphere1, const BoundingSphere& sphere2) {
+	Vector3A center1 = Load(sphere1.center);
+	Vector3A difference = Load(sphere2.center) - center1;
+	float distance = Length(difference);
+	//片方がもう片方を含んでいる場合はそのまま
+	if (distance + sphere2.radius <= sphere1.radius) {
+		return sphere1;
+	}
+	if (distance + sphere1.radius <= sphere2.radius) {
+		return sphere2;
+	}
+	float radius = (distance + sphere1.radius + sphere2.radius) * 0.5f;
+	return { ToVector3(center1 + difference * ((radius - sphere1.radius) / distance)), radius };
+}
+
+AABB MergeAABBs(std::span<const AABB> aabbs) {
+	if (aabbs.empty()) {
+		return kEmptyAABB;
+	}
+	Vector3A min = Load(aabbs[0].min);
+	Vector3A max = Load(aabbs[0].max);
+	for (size_t i = 1; i < aabbs.size(); i++) {
+		min = Min(min, Load(aabbs[i].min));
+		max = Max(max, Load(aabbs[i].max));
+	}
+	return { ToVector3(min), ToVector3(max) };
+}
+
+AABB ComputeAABB(std::span<const VertexData> vertices) {
+	std::vector<AABB> chunks = ParallelReduce<AABB>(vertices.size(), [vertices](size_t begin, size_t end) {
+		return ComputeAABBRange(vertices, begin, end);
+	});
+	return MergeAABBs(chunks);
+}
+
+BoundingSphere ComputeBoundingSphere(std::span<const VertexData> vertices) {
+	if (vertices.empty()) {
+		return { { 0.0f, 0.0f, 0.0f }, 0.0f };
+	}
+	AABB aabb = ComputeAABB(vertices);
+	Vector3A center = { _mm_mul_ps(_mm_add_ps(Load(aabb.min).v, Load(aabb.max).v), _mm_set1_ps(0.5f)) };
+	std::vector<float> chunks = ParallelReduce<float>(vertices.size(), [vertices, center](size_t begin, size_t end) {
+		return ComputeMaxDistanceSq(vertices, center, begin, end);
+	});
+	return { ToVector3(center), std::sqrt(*std::max_element(chunks.begin(), chunks.end())) };
+}
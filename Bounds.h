@@ -0,0 +1,125 @@
+#pragma once
+#include "Vector3.h"
+#include "VertexData.h"
+#include "Matrix4x4.h"
+#include <span>
+
+/// <summary>
+/// 軸に沿った直方体
+/// </summary>
+struct AABB {
+	Vector3 min;
+	Vector3 max;
+};
+
+/// <summary>
+/// 向きのある直方体
+/// </summary>
+struct OBB {
+	Vector3 center;
+	Vector3 orientations[3]; //各軸の向き(正規化済み)
+	Vector3 size;            //各軸方向の半分の長さ
+};
+
+/// <summary>
+/// 球
+/// </summary>
+struct BoundingSphere {
+	Vector3 center;
+	float radius;
+};
+
+#pragma region 変換
+/// <summary>
+/// AABBを行列で変換して、変換後の形を囲むAABBを求める(Arvoの方法)
+/// 8頂点を変換せずに、中心の変換と半分の大きさ * |行列の3x3部分| で求める
+/// </summary>
+/// <param name="aabb">ローカル空間のAABB</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <returns></returns>
+AABB TransformAABB(const AABB& aabb, const Matrix4x4& matrix);
+
+/// <summary>
+/// AABBをまとめて同じ行列で変換する
+/// </summary>
+/// <param name="aabbs">ローカル空間のAABB</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <param name="result">結果の書き込み先。aabbsと同じ数が必要。aabbsと同じ配列でもよい</param>
+void TransformAABBs(std::span<const AABB> aabbs, const Matrix4x4& matrix, std::span<AABB> result);
+
+/// <summary>
+/// 球を行列で変換する。半径は一番大きいスケールで拡大する
+/// </summary>
+/// <param name="sphere">ローカル空間の球</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <returns></returns>
+BoundingSphere TransformSphere(const BoundingSphere& sphere, const Matrix4x4& matrix);
+
+/// <summary>
+/// OBBを行列で変換する。スケールは大きさに含め、向きは正規化し直す
+/// </summary>
+/// <param name="obb">ローカル空間のOBB</param>
+/// <param name="matrix">アフィン変換行列(せん断を含まないこと)</param>
+/// <returns></returns>
+OBB TransformOBB(const OBB& obb, const Matrix4x4& matrix);
+#pragma endregion
+
+#pragma region 変換(形の種類)
+/// <summary>
+/// AABBを行列で変換したOBBを作る。AABBより隙間が少ない
+/// </summary>
+/// <param name="aabb">ローカル空間のAABB</param>
+/// <param name="matrix">アフィン変換行列(せん断を含まないこと)</param>
+/// <returns></returns>
+OBB MakeOBB(const AABB& aabb, const Matrix4x4& matrix);
+
+/// <summary>
+/// OBBを囲むAABB
+/// </summary>
+AABB ToAABB(const OBB& obb);
+
+/// <summary>
+/// 球を囲むAABB
+/// </summary>
+AABB ToAABB(const BoundingSphere& sphere);
+
+/// <summary>
+/// AABBを囲む球
+/// </summary>
+BoundingSphere ToSphere(const AABB& aabb);
+#pragma endregion
+
+#pragma region 結合
+/// <summary>
+/// 2つのAABBを囲むAABB
+/// </summary>
+AABB Merge(const AABB& aabb1, const AABB& aabb2);
+
+/// <summary>
+/// 2つの球を囲む最小の球
+/// </summary>
+BoundingSphere Merge(const BoundingSphere& sphere1, const BoundingSphere& sphere2);
+
+/// <summary>
+/// 複数のAABBをまとめて囲むAABB。SIMDで最小・最大を求める
+/// </summary>
+/// <param name="aabbs">AABBの配列。空の場合はminが+∞、maxが-∞のAABBを返す</param>
+/// <returns></returns>
+AABB MergeAABBs(std::span<const AABB> aabbs);
+#pragma endregion
+
+#pragma region 頂点から作成
+/// <summary>
+/// 頂点の位置を囲むAABBを求める。頂点数が多いときはスレッドプールで分担する
+/// </summary>
+/// <param name="vertices">頂点。positionのxyzだけを使う</param>
+/// <returns>空の場合はminが+∞、maxが-∞のAABB</returns>
+AABB ComputeAABB(std::span<const VertexData> vertices);
+
+/// <summary>
+/// 頂点の位置を囲む球を求める。中心はAABBの中心、半径は中心から一番遠い頂点までの距離
+/// </summary>
+/// <param name="vertices">頂点。positionのxyzだけを使う</param>
+/// <returns>空の場合は半径0の球</returns>
+BoundingSphere ComputeBoundingSphere(std::span<const VertexData> vertices);
+#pragma endregion
@@ -24,6 +24,8 @@ public:
 	inline Vector3 GetRotate() { return rotate_; }
 	inline Vector3 GetTranslate() { return translate_; }
 	inline Matrix4x4 GetWorldTransform() { return worldMatrix_; }
+	//クライアント領域でのマウスの位置(ピクセル)。ピッキングに使う
+	inline Vector2Int GetMousePosition() { return mousePos_; }
 
 private:
 	Vector3 scale_;
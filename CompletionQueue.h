@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/// <summary>
+/// 複数のスレッドから追加し、1つのスレッドがまとめて取り出すロックフリーのキュー
+/// 追加はCASで先頭につなぎ、取り出しは先頭を丸ごと交換して持っていく。取り出す側は1つなのでABAの問題は起きない
+/// 別のスレッドで終わった処理の結果を、描画スレッドがフレームの初めに受け取るのに使う
+/// </summary>
+template<class T>
+class CompletionQueue {
+public:
+	CompletionQueue() = default;
+	CompletionQueue(const CompletionQueue&) = delete;
+	CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+	~CompletionQueue() {
+		Drain([](T&&) {});
+	}
+
+	/// <summary>
+	/// 追加する。どのスレッドから呼んでもよい
+	/// </summary>
+	/// <param name="value">追加する値</param>
+	void Push(T value) {
+		Node* node = new Node{ std::move(value), head_.load(std::memory_order_relaxed) };
+		while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+
+	/// <summary>
+	/// たまっているものをすべて取り出し、追加された順にfunctionへ渡す。取り出すスレッドは1つに決めておくこと
+	/// </summary>
+	/// <param name="function">function(T&& value)</param>
+	/// <returns>取り出した数</returns>
+	template<class Function>
+	size_t Drain(Function&& function) {
+		Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+		//先頭につないでいるので新しい順になっている。つなぎ直して古い順にする
+		Node* oldest = nullptr;
+		while (node) {
+			Node* next = node->next;
+			node->next = oldest;
+			oldest = node;
+			node = next;
+		}
+		size_t count = 0;
+		while (oldest) {
+			Node* next = oldest->next;
+			function(std::move(oldest->value));
+			delete oldest;
+			oldest = next;
+			count++;
+		}
+		return count;
+	}
+
+	/// <summary>
+	/// 何もたまっていないか。ほかのスレッドが追加している途中なら、すぐに古い値になる
+	/// </summary>
+	bool IsEmpty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+private:
+	struct Node {
+		T value;
+		Node* next;
+	};
+
+	std::atomic<Node*> head_ = nullptr;
+};
@@ -0,0 +1,78 @@
+#include "CpuFeature.h"
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace {
+
+void Cpuid(int info[4], int leaf, int subLeaf) {
+#if defined(_MSC_VER)
+	__cpuidex(info, leaf, subLeaf);
+#else
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	__cpuid_count(leaf, subLeaf, eax, ebx, ecx, edx);
+	info[0] = int(eax);
+	info[1] = int(ebx);
+	info[2] = int(ecx);
+	info[3] = int(edx);
+#endif
+}
+
+uint64_t Xgetbv() {
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t eax = 0, edx = 0;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (uint64_t(edx) << 32) | eax;
+#endif
+}
+
+SimdLevel DetectSimdLevel() {
+	int info[4] = {};
+	Cpuid(info, 0, 0);
+	int maxLeaf = info[0];
+
+	Cpuid(info, 1, 0);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool f16c = (info[2] & (1 << 29)) != 0;
+	if (!sse41) {
+		return SimdLevel::Scalar;
+	}
+
+	//OSがYMMレジスタを保存してくれるかも確認する
+	bool ymmEnabled = osxsave && avx && (Xgetbv() & 0x6) == 0x6;
+	if (ymmEnabled && fma && f16c && maxLeaf >= 7) {
+		Cpuid(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		if (avx2) {
+			return SimdLevel::AVX2;
+		}
+	}
+
+	return SimdLevel::SSE4;
+}
+
+}
+
+SimdLevel GetSimdLevel() {
+	static const SimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::AVX2:
+		return "AVX2";
+	case SimdLevel::SSE4:
+		return "SSE4";
+	default:
+		return "Scalar";
+	}
+}
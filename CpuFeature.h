@@ -0,0 +1,33 @@
+#pragma once
+
+/// <summary>
+/// CPUが対応しているSIMD命令セットの段階
+/// </summary>
+enum class SimdLevel {
+	Scalar, //SIMDを使わない
+	SSE4,   //SSE4.1(128bit)
+	AVX2,   //AVX2 + FMA + F16C(256bit)
+};
+
+/// <summary>
+/// CPUIDを元に使用できるSIMD命令セットを取得。判定は最初の呼び出しで一度だけ行う
+/// </summary>
+/// <returns></returns>
+SimdLevel GetSimdLevel();
+
+/// <summary>
+/// SIMD命令セットの名前を取得
+/// </summary>
+/// <param name="level">命令セットの段階</param>
+/// <returns></returns>
+const char* GetSimdLevelName(SimdLevel level);
+
+//命令セットを指定して関数をコンパイルするための属性
+//MSVCはプロジェクト設定に関係なく組み込み関数が使えるので何もつけない
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET_SSE4
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
@@ -0,0 +1,229 @@
+#include "Frustum.h"
+#include "CpuFeature.h"
+#include "ThreadPool.h"
+#include <immintrin.h>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+//これ以上の数をカリングするときはスレッドプールで分担する
+constexpr size_t kParallelThreshold = 16384;
+//1スレッドが一度に処理する数。8の倍数にしておくとAVX2の端数が最後のチャンクだけになる
+constexpr size_t kParallelGrainSize = 4096;
+
+Plane MakePlane(float a, float b, float c, float d) {
+	float invLength = 1.0f / std::sqrt(a * a + b * b + c * c);
+	return { { a * invLength, b * invLength, c * invLength }, d * invLength };
+}
+
+//マスクのビットが立っているレーンの番号を書き込む
+inline size_t WriteIndices(unsigned int mask, size_t first, uint32_t* visibleIndices) {
+	size_t written = 0;
+	while (mask != 0) {
+		visibleIndices[written++] = uint32_t(first + size_t(std::countr_zero(mask)));
+		mask &= mask - 1;
+	}
+	return written;
+}
+
+#pragma region スカラー実装
+size_t CullSpheresScalar(const Frustum& frustum, const BoundingSphereSoA& spheres, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < end; i++) {
+		if (IsVisible(frustum, { spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i] }, spheres.radius[i])) {
+			visibleIndices[visibleCount++] = uint32_t(i);
+		}
+	}
+	return visibleCount;
+}
+
+size_t CullAABBsScalar(const Frustum& frustum, const AABBSoA& boxes, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < end; i++) {
+		if (IsVisible(frustum, { boxes.minX[i], boxes.minY[i], boxes.minZ[i] }, { boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i] })) {
+			visibleIndices[visibleCount++] = uint32_t(i);
+		}
+	}
+	return visibleCount;
+}
+#pragma endregion
+
+#pragma region SSE4実装
+SIMD_TARGET_SSE4 size_t CullSpheresSSE4(const Frustum& frustum, const BoundingSphereSoA& spheres, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_loadu_ps(spheres.centerX + i);
+		__m128 y = _mm_loadu_ps(spheres.centerY + i);
+		__m128 z = _mm_loadu_ps(spheres.centerZ + i);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes) {
+			__m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.normal.x)), _mm_set1_ps(plane.distance));
+			distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.normal.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.normal.z)));
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+		visibleCount += WriteIndices(unsigned(_mm_movemask_ps(visible)), i, visibleIndices + visibleCount);
+	}
+	return visibleCount + CullSpheresScalar(frustum, spheres, i, end, visibleIndices + visibleCount);
+}
+
+SIMD_TARGET_SSE4 size_t CullAABBsSSE4(const Frustum& frustum, const AABBSoA& boxes, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128 minX = _mm_loadu_ps(boxes.minX + i), minY = _mm_loadu_ps(boxes.minY + i), minZ = _mm_loadu_ps(boxes.minZ + i);
+		__m128 maxX = _mm_loadu_ps(boxes.maxX + i), maxY = _mm_loadu_ps(boxes.maxY + i), maxZ = _mm_loadu_ps(boxes.maxZ + i);
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes) {
+			//法線の符号は全レーン共通なので、使う頂点をレーンごとではなく平面ごとに選べる
+			__m128 x = plane.normal.x >= 0.0f ? maxX : minX;
+			__m128 y = plane.normal.y >= 0.0f ? maxY : minY;
+			__m128 z = plane.normal.z >= 0.0f ? maxZ : minZ;
+			__m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.normal.x)), _mm_set1_ps(plane.distance));
+			distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.normal.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.normal.z)));
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+		visibleCount += WriteIndices(unsigned(_mm_movemask_ps(visible)), i, visibleIndices + visibleCount);
+	}
+	return visibleCount + CullAABBsScalar(frustum, boxes, i, end, visibleIndices + visibleCount);
+}
+#pragma endregion
+
+#pragma region AVX2実装
+SIMD_TARGET_AVX2 size_t CullSpheresAVX2(const Frustum& frustum, const BoundingSphereSoA& spheres, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256 x = _mm256_loadu_ps(spheres.centerX + i);
+		__m256 y = _mm256_loadu_ps(spheres.centerY + i);
+		__m256 z = _mm256_loadu_ps(spheres.centerZ + i);
+		__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+		__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes) {
+			__m256 distance = _mm256_fmadd_ps(x, _mm256_set1_ps(plane.normal.x), _mm256_set1_ps(plane.distance));
+			distance = _mm256_fmadd_ps(y, _mm256_set1_ps(plane.normal.y), distance);
+			distance = _mm256_fmadd_ps(z, _mm256_set1_ps(plane.normal.z), distance);
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+		visibleCount += WriteIndices(unsigned(_mm256_movemask_ps(visible)), i, visibleIndices + visibleCount);
+	}
+	_mm256_zeroupper();
+	return visibleCount + CullSpheresSSE4(frustum, spheres, i, end, visibleIndices + visibleCount);
+}
+
+SIMD_TARGET_AVX2 size_t CullAABBsAVX2(const Frustum& frustum, const AABBSoA& boxes, size_t begin, size_t end, uint32_t* visibleIndices) {
+	size_t visibleCount = 0;
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256 minX = _mm256_loadu_ps(boxes.minX + i), minY = _mm256_loadu_ps(boxes.minY + i), minZ = _mm256_loadu_ps(boxes.minZ + i);
+		__m256 maxX = _mm256_loadu_ps(boxes.maxX + i), maxY = _mm256_loadu_ps(boxes.maxY + i), maxZ = _mm256_loadu_ps(boxes.maxZ + i);
+		__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const Plane& plane : frustum.planes) {
+			__m256 x = plane.normal.x >= 0.0f ? maxX : minX;
+			__m256 y = plane.normal.y >= 0.0f ? maxY : minY;
+			__m256 z = plane.normal.z >= 0.0f ? maxZ : minZ;
+			__m256 distance = _mm256_fmadd_ps(x, _mm256_set1_ps(plane.normal.x), _mm256_set1_ps(plane.distance));
+			distance = _mm256_fmadd_ps(y, _mm256_set1_ps(plane.normal.y), distance);
+			distance = _mm256_fmadd_ps(z, _mm256_set1_ps(plane.normal.z), distance);
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+		visibleCount += WriteIndices(unsigned(_mm256_movemask_ps(visible)), i, visibleIndices + visibleCount);
+	}
+	_mm256_zeroupper();
+	return visibleCount + CullAABBsSSE4(frustum, boxes, i, end, visibleIndices + visibleCount);
+}
+#pragma endregion
+
+/// <summary>
+/// 範囲[begin, end)をカリングする関数の型。見えている数を返す
+/// </summary>
+template<class Bounds>
+using CullFunction = size_t(*)(const Frustum& frustum, const Bounds& bounds, size_t begin, size_t end, uint32_t* visibleIndices);
+
+template<class Bounds>
+size_t Cull(const Frustum& frustum, const Bounds& bounds, size_t count, uint32_t* visibleIndices, CullFunction<Bounds> function) {
+	if (count < kParallelThreshold) {
+		return function(frustum, bounds, 0, count, visibleIndices);
+	}
+
+	//チャンクごとに自分の範囲の先頭から書き込み、最後に前へ詰める
+	//見えている数はチャンクの要素数を超えないので、他のチャンクの領域を壊すことはない
+	size_t chunkCount = (count + kParallelGrainSize - 1) / kParallelGrainSize;
+	std::vector<size_t> visibleCounts(chunkCount);
+	ThreadPool::GetInstance().ParallelFor(count, kParallelGrainSize, [&](size_t begin, size_t end) {
+		visibleCounts[begin / kParallelGrainSize] = function(frustum, bounds, begin, end, visibleIndices + begin);
+	});
+
+	size_t visibleCount = visibleCounts[0];
+	for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+		std::memmove(visibleIndices + visibleCount, visibleIndices + chunk * kParallelGrainSize, visibleCounts[chunk] * sizeof(uint32_t));
+		visibleCount += visibleCounts[chunk];
+	}
+	return visibleCount;
+}
+
+}
+
+Frustum MakeFrustum(const Matrix4x4& viewProjection) {
+	const float(&m)[4][4] = viewProjection.m;
+	//クリップ座標の各成分は行列の列との内積になる
+	//-w <= x <= w, -w <= y <= w, 0 <= z <= w をそれぞれ平面にする
+	Frustum frustum;
+	frustum.planes[0] = MakePlane(m[0][3] + m[0][0], m[1][3] + m[1][0], m[2][3] + m[2][0], m[3][3] + m[3][0]); //左
+	frustum.planes[1] = MakePlane(m[0][3] - m[0][0], m[1][3] - m[1][0], m[2][3] - m[2][0], m[3][3] - m[3][0]); //右
+	frustum.planes[2] = MakePlane(m[0][3] + m[0][1], m[1][3] + m[1][1], m[2][3] + m[2][1], m[3][3] + m[3][1]); //下
+	frustum.planes[3] = MakePlane(m[0][3] - m[0][1], m[1][3] - m[1][1], m[2][3] - m[2][1], m[3][3] - m[3][1]); //上
+	frustum.planes[4] = MakePlane(m[0][2], m[1][2], m[2][2], m[3][2]);                                         //近
+	frustum.planes[5] = MakePlane(m[0][3] - m[0][2], m[1][3] - m[1][2], m[2][3] - m[2][2], m[3][3] - m[3][2]); //遠
+	return frustum;
+}
+
+bool IsVisible(const Frustum& frustum, const Vector3& center, float radius) {
+	for (const Plane& plane : frustum.planes) {
+		float distance = plane.normal.x * center.x + plane.normal.y * center.y + plane.normal.z * center.z + plane.distance;
+		if (distance < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsVisible(const Frustum& frustum, const Vector3& min, const Vector3& max) {
+	for (const Plane& plane : frustum.planes) {
+		float x = plane.normal.x >= 0.0f ? max.x : min.x;
+		float y = plane.normal.y >= 0.0f ? max.y : min.y;
+		float z = plane.normal.z >= 0.0f ? max.z : min.z;
+		if (plane.normal.x * x + plane.normal.y * y + plane.normal.z * z + plane.distance < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereSoA& spheres, size_t count, uint32_t* visibleIndices) {
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		return Cull<BoundingSphereSoA>(frustum, spheres, count, visibleIndices, CullSpheresAVX2);
+	case SimdLevel::SSE4:
+		return Cull<BoundingSphereSoA>(frustum, spheres, count, visibleIndices, CullSpheresSSE4);
+	default:
+		return Cull<BoundingSphereSoA>(frustum, spheres, count, visibleIndices, CullSpheresScalar);
+	}
+}
+
+size_t CullAABBs(const Frustum& frustum, const AABBSoA& boxes, size_t count, uint32_t* visibleIndices) {
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		return Cull<AABBSoA>(frustum, boxes, count, visibleIndices, CullAABBsAVX2);
+	case SimdLevel::SSE4:
+		return Cull<AABBSoA>(frustum, boxes, count, visibleIndices, CullAABBsSSE4);
+	default:
+		return Cull<AABBSoA>(frustum, boxes, count, visibleIndices, CullAABBsScalar);
+	}
+}
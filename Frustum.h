@@ -0,0 +1,89 @@
+#pragma once
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// 平面。Dot(normal, p) + distance >= 0 の側を内側とする
+/// </summary>
+struct Plane {
+	Vector3 normal;
+	float distance;
+};
+
+/// <summary>
+/// 視錐台。左、右、下、上、近、遠の順に6枚の平面を持つ
+/// </summary>
+struct Frustum {
+	Plane planes[6];
+};
+
+/// <summary>
+/// 要素ごとの配列で並べた球(SoA)。各ポインタはcount個の要素を指す
+/// </summary>
+struct BoundingSphereSoA {
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* radius;
+};
+
+/// <summary>
+/// 要素ごとの配列で並べたAABB(SoA)
+/// </summary>
+struct AABBSoA {
+	const float* minX;
+	const float* minY;
+	const float* minZ;
+	const float* maxX;
+	const float* maxY;
+	const float* maxZ;
+};
+
+/// <summary>
+/// ビュープロジェクション行列から視錐台の平面を取り出す(Gribb-Hartmann法)
+/// 行ベクトル(v * M)の行列なので各列から平面を作る。Zの範囲はD3Dの[0, 1]
+/// </summary>
+/// <param name="viewProjection">ビュー行列 * 射影行列。ワールド行列まで掛けたものを渡すとローカル空間の視錐台になる</param>
+/// <returns>法線を正規化した視錐台</returns>
+Frustum MakeFrustum(const Matrix4x4& viewProjection);
+
+/// <summary>
+/// 球が視錐台と重なっているか
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="center">球の中心</param>
+/// <param name="radius">球の半径</param>
+/// <returns>少しでも内側にあればtrue</returns>
+bool IsVisible(const Frustum& frustum, const Vector3& center, float radius);
+
+/// <summary>
+/// AABBが視錐台と重なっているか。平面ごとに法線方向へ一番出ている頂点だけを調べる
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="min">AABBの最小点</param>
+/// <param name="max">AABBの最大点</param>
+/// <returns>少しでも内側にあればtrue(角の近くでは外側でもtrueになることがある)</returns>
+bool IsVisible(const Frustum& frustum, const Vector3& min, const Vector3& max);
+
+/// <summary>
+/// 球をまとめてカリングし、見えているものの番号を詰めて書き込む
+/// AVX2が使えるCPUでは8つずつ、SSE4では4つずつ判定する。要素数が多いときはスレッドプールで分担する
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="spheres">判定する球</param>
+/// <param name="count">球の数</param>
+/// <param name="visibleIndices">見えている球の番号の書き込み先。count個分の領域が必要</param>
+/// <returns>見えている球の数</returns>
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereSoA& spheres, size_t count, uint32_t* visibleIndices);
+
+/// <summary>
+/// AABBをまとめてカリングし、見えているものの番号を詰めて書き込む
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="boxes">判定するAABB</param>
+/// <param name="count">AABBの数</param>
+/// <param name="visibleIndices">見えているAABBの番号の書き込み先。count個分の領域が必要</param>
+/// <returns>見えているAABBの数</returns>
+size_t CullAABBs(const Frustum& frustum, const AABBSoA& boxes, size_t count, uint32_t* visibleIndices);
@@ -0,0 +1,52 @@
+#include "LOD.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+float ComputeScreenRadius(const BoundingSphere& sphere, const Matrix4x4& cameraWorld, float fovY, float screenHeight) {
+	//カメラの位置はワールド行列の平行移動の行
+	float dx = sphere.center.x - cameraWorld.m[3][0];
+	float dy = sphere.center.y - cameraWorld.m[3][1];
+	float dz = sphere.center.z - cameraWorld.m[3][2];
+	float distanceSq = dx * dx + dy * dy + dz * dz;
+	float radiusSq = sphere.radius * sphere.radius;
+	if (distanceSq <= radiusSq) {
+		return screenHeight;
+	}
+	//接線までの距離で割ると、画面の中央に映ったときの投影した半径になる
+	float projected = sphere.radius / (std::sqrt(distanceSq - radiusSq) * std::tan(fovY * 0.5f));
+	return projected * screenHeight * 0.5f;
+}
+
+uint32_t SelectLOD(float screenRadius, std::span<const float> thresholds, uint32_t currentLevel, float hysteresis) {
+	assert(hysteresis >= 0.0f && hysteresis < 1.0f);
+	const uint32_t lastLevel = static_cast<uint32_t>(thresholds.size());
+	uint32_t level = std::min(currentLevel, lastLevel);
+	//大きく映ったら細かい段階へ、小さく映ったら粗い段階へ。どちらも境目を余裕の分だけ越えたときだけ移る
+	while (level > 0 && screenRadius >= thresholds[level - 1] * (1.0f + hysteresis)) {
+		level--;
+	}
+	while (level < lastLevel && screenRadius < thresholds[level] * (1.0f - hysteresis)) {
+		level++;
+	}
+	return level;
+}
+
+uint32_t SelectLODByError(float screenRadius, float radius, std::span<const float> levelErrors, float maxPixelError, uint32_t currentLevel,
+	float hysteresis) {
+	assert(!levelErrors.empty() && hysteresis >= 0.0f && hysteresis < 1.0f);
+	if (radius <= 0.0f) {
+		return 0;
+	}
+	const float pixelsPerUnit = screenRadius / radius;
+	const uint32_t lastLevel = static_cast<uint32_t>(levelErrors.size() - 1);
+	uint32_t level = std::min(currentLevel, lastLevel);
+	//今の段階の誤差が目立つなら細かい段階へ、次の段階でも目立たないなら粗い段階へ移る
+	while (level > 0 && levelErrors[level] * pixelsPerUnit > maxPixelError * (1.0f + hysteresis)) {
+		level--;
+	}
+	while (level < lastLevel && levelErrors[level + 1] * pixelsPerUnit <= maxPixelError * (1.0f - hysteresis)) {
+		level++;
+	}
+	return level;
+}
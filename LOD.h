@@ -0,0 +1,49 @@
+#pragma once
+#include "Bounds.h"
+#include "Matrix4x4.h"
+#include <cstdint>
+#include <span>
+
+/// <summary>
+/// 1つのバッファにまとめたLODの段階ごとの描画範囲。DrawIndexedInstancedの引数にそのまま使う
+/// </summary>
+struct MeshLevel {
+	uint32_t indexCount;
+	uint32_t startIndex;
+	int32_t baseVertex;
+};
+
+/// <summary>
+/// 球が画面上に映ったときの半径(ピクセル)を求める
+/// 距離だけで決めるので、カメラを回しても値は変わらない(回しただけでLODが切り替わらない)
+/// </summary>
+/// <param name="sphere">ワールド空間の境界球</param>
+/// <param name="cameraWorld">カメラのワールド行列(MakePerspectiveFovMatrixと組み合わせるビュー行列の逆行列)</param>
+/// <param name="fovY">MakePerspectiveFovMatrixに渡した縦の画角</param>
+/// <param name="screenHeight">画面の高さ(ピクセル)</param>
+/// <returns>カメラが球の中にあるときは画面全体の高さより大きい値を返す</returns>
+float ComputeScreenRadius(const BoundingSphere& sphere, const Matrix4x4& cameraWorld, float fovY, float screenHeight);
+
+/// <summary>
+/// 画面上の半径からLODの段階を選ぶ。境界の前後で毎フレーム切り替わらないように、今の段階から離れる方向にだけ余裕を持たせる
+/// </summary>
+/// <param name="screenRadius">ComputeScreenRadiusで求めた半径</param>
+/// <param name="thresholds">段階iと段階i+1の境目の半径(ピクセル)。大きい順に並べる。段階の数はthresholds.size() + 1</param>
+/// <param name="currentLevel">前のフレームで選んだ段階</param>
+/// <param name="hysteresis">境目に持たせる余裕の割合。0.15なら境目の±15%を越えるまで今の段階を保つ</param>
+/// <returns>選んだ段階(0が一番細かい)</returns>
+uint32_t SelectLOD(float screenRadius, std::span<const float> thresholds, uint32_t currentLevel, float hysteresis = 0.15f);
+
+/// <summary>
+/// 段階ごとの誤差から、画面上の誤差がmaxPixelError以下になる一番粗い段階を選ぶ(MeshLODChain::errorsなどを使う)
+/// 誤差は球の半径と同じ空間の距離で渡すので、半径が映る大きさとの比で画面上のピクセルに直せる
+/// </summary>
+/// <param name="screenRadius">ComputeScreenRadiusで求めた半径</param>
+/// <param name="radius">screenRadiusを求めた球の半径</param>
+/// <param name="levelErrors">段階ごとの誤差。細かい順に並べ、段階0は0にする</param>
+/// <param name="maxPixelError">許す画面上の誤差(ピクセル)</param>
+/// <param name="currentLevel">前のフレームで選んだ段階</param>
+/// <param name="hysteresis">境目に持たせる余裕の割合</param>
+/// <returns>選んだ段階(0が一番細かい)</returns>
+uint32_t SelectLODByError(float screenRadius, float radius, std::span<const float> levelErrors, float maxPixelError, uint32_t currentLevel,
+	float hysteresis = 0.15f);
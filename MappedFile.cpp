@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)), isOpen_(std::exchange(other.isOpen_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+		isOpen_ = std::exchange(other.isOpen_, false);
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& path) {
+	Close();
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	//大きさ0のファイルはマッピングを作れないので、開いただけにする
+	if (size_ != 0) {
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			data_ = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			//ビューがマッピングを参照し続けるので、ハンドルはすぐに閉じてよい
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	if (size_ != 0 && !data_) {
+		size_ = 0;
+		return false;
+	}
+	isOpen_ = true;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	data_ = nullptr;
+	size_ = 0;
+	isOpen_ = false;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& path) {
+	Close();
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status {};
+	if (fstat(file, &status) != 0) {
+		close(file);
+		return false;
+	}
+	size_ = static_cast<size_t>(status.st_size);
+	if (size_ != 0) {
+		void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+		if (address != MAP_FAILED) {
+			data_ = static_cast<const std::byte*>(address);
+			//複数のスレッドで別々の場所から読むことが多いので、全体の先読みを始めてもらう
+			madvise(address, size_, MADV_WILLNEED);
+		}
+	}
+	close(file);
+	if (size_ != 0 && !data_) {
+		size_ = 0;
+		return false;
+	}
+	isOpen_ = true;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data_) {
+		munmap(const_cast<std::byte*>(data_), size_);
+	}
+	data_ = nullptr;
+	size_ = 0;
+	isOpen_ = false;
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+/// <summary>
+/// 読み込み専用でメモリにマップしたファイル。開いている間はdataからファイルの中身を直接読める
+/// Windowsではファイルマッピング、それ以外ではmmapを使う
+/// </summary>
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/// <summary>
+	/// ファイルを開いてマップする。すでに開いていれば先に閉じる
+	/// </summary>
+	/// <param name="path">ファイルのパス</param>
+	/// <returns>開けなければfalse。大きさ0のファイルは開けるが、dataはnullptrになる</returns>
+	bool Open(const std::filesystem::path& path);
+
+	/// <summary>
+	/// マップを外してファイルを閉じる
+	/// </summary>
+	void Close();
+
+	bool IsOpen() const { return isOpen_; }
+	const std::byte* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+	std::span<const std::byte> GetBytes() const { return { data_, size_ }; }
+
+private:
+	const std::byte* data_ = nullptr;
+	size_t size_ = 0;
+	bool isOpen_ = false;
+};
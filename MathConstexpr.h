@@ -0,0 +1,72 @@
+#pragma once
+
+//定数式で使う三角関数・平方根
+//標準ライブラリのstd::sin/std::sqrtはconstexprではないので、コンパイル時に作るデータ(球のメッシュなど)はこちらを使う
+//doubleで計算するので、floatに丸めた結果はstd::sin/std::cosとほぼ一致する(最大1ulp程度)
+//実行時に呼ぶと遅いので、実行時はstd::やMathFunction.hの関数を使うこと
+namespace MathConstexpr {
+
+constexpr double kPi = 3.14159265358979323846;
+
+/// <summary>
+/// [-π, π]に収めた角度
+/// </summary>
+constexpr double Wrap(double radian) {
+	double turns = radian / (2.0 * kPi);
+	//切り捨てではなく四捨五入で周回数を求める
+	long long count = static_cast<long long>(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+	return radian - static_cast<double>(count) * (2.0 * kPi);
+}
+
+/// <summary>
+/// 正弦
+/// </summary>
+/// <param name="radian">角度(ラジアン)</param>
+/// <returns></returns>
+constexpr double Sin(double radian) {
+	double x = Wrap(radian);
+	//sin(π - x) = sin(x) で [-π/2, π/2] に寄せてからテイラー展開する
+	if (x > kPi / 2.0) {
+		x = kPi - x;
+	} else if (x < -kPi / 2.0) {
+		x = -kPi - x;
+	}
+	double term = x;
+	double sum = x;
+	for (int n = 1; n < 12; n++) {
+		term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+/// <summary>
+/// 余弦
+/// </summary>
+/// <param name="radian">角度(ラジアン)</param>
+/// <returns></returns>
+constexpr double Cos(double radian) {
+	return Sin(radian + kPi / 2.0);
+}
+
+/// <summary>
+/// 平方根(ニュートン法)
+/// </summary>
+/// <param name="value">0以上の値</param>
+/// <returns></returns>
+constexpr double Sqrt(double value) {
+	if (value <= 0.0) {
+		return 0.0;
+	}
+	double x = value > 1.0 ? value : 1.0;
+	for (int i = 0; i < 64; i++) {
+		double next = 0.5 * (x + value / x);
+		if (next == x) {
+			break;
+		}
+		x = next;
+	}
+	return x;
+}
+
+}
@@ -0,0 +1,221 @@
+#include "MathFunction.h"
+#include "MathFunction_SIMD.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+#pragma region SSE4
+//端数は0で埋めた一時配列で計算し、必要な分だけ書き戻す
+
+template<__m128(*Function)(__m128)>
+SIMD_TARGET_SSE4 void ApplySSE4(const float* values, float* results, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(results + i, Function(_mm_loadu_ps(values + i)));
+	}
+	if (i < count) {
+		float buffer[4] = {};
+		std::copy(values + i, values + count, buffer);
+		_mm_storeu_ps(buffer, Function(_mm_loadu_ps(buffer)));
+		std::copy(buffer, buffer + (count - i), results + i);
+	}
+}
+
+SIMD_TARGET_SSE4 void SinCosSSE4(const float* radians, float* sines, float* cosines, size_t count) {
+	__m128 sin, cos;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		MathSIMD::SinCos(_mm_loadu_ps(radians + i), sin, cos);
+		_mm_storeu_ps(sines + i, sin);
+		_mm_storeu_ps(cosines + i, cos);
+	}
+	if (i < count) {
+		float buffer[4] = {}, sinBuffer[4], cosBuffer[4];
+		std::copy(radians + i, radians + count, buffer);
+		MathSIMD::SinCos(_mm_loadu_ps(buffer), sin, cos);
+		_mm_storeu_ps(sinBuffer, sin);
+		_mm_storeu_ps(cosBuffer, cos);
+		std::copy(sinBuffer, sinBuffer + (count - i), sines + i);
+		std::copy(cosBuffer, cosBuffer + (count - i), cosines + i);
+	}
+}
+
+//exponentsがnullptrのときはすべての要素にexponentを使う
+SIMD_TARGET_SSE4 void PowSSE4(const float* bases, const float* exponents, float exponent, float* results, size_t count) {
+	__m128 broadcast = _mm_set1_ps(exponent);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 y = exponents != nullptr ? _mm_loadu_ps(exponents + i) : broadcast;
+		_mm_storeu_ps(results + i, MathSIMD::Pow(_mm_loadu_ps(bases + i), y));
+	}
+	if (i < count) {
+		float buffer[4] = {}, exponentBuffer[4] = {};
+		std::copy(bases + i, bases + count, buffer);
+		if (exponents != nullptr) {
+			std::copy(exponents + i, exponents + count, exponentBuffer);
+		}
+		__m128 y = exponents != nullptr ? _mm_loadu_ps(exponentBuffer) : broadcast;
+		_mm_storeu_ps(buffer, MathSIMD::Pow(_mm_loadu_ps(buffer), y));
+		std::copy(buffer, buffer + (count - i), results + i);
+	}
+}
+#pragma endregion
+
+#pragma region AVX2
+template<__m256(*Function)(__m256)>
+SIMD_TARGET_AVX2 void ApplyAVX2(const float* values, float* results, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(results + i, Function(_mm256_loadu_ps(values + i)));
+	}
+	if (i < count) {
+		float buffer[8] = {};
+		std::copy(values + i, values + count, buffer);
+		_mm256_storeu_ps(buffer, Function(_mm256_loadu_ps(buffer)));
+		std::copy(buffer, buffer + (count - i), results + i);
+	}
+	_mm256_zeroupper();
+}
+
+SIMD_TARGET_AVX2 void SinCosAVX2(const float* radians, float* sines, float* cosines, size_t count) {
+	__m256 sin, cos;
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		MathSIMD::SinCos(_mm256_loadu_ps(radians + i), sin, cos);
+		_mm256_storeu_ps(sines + i, sin);
+		_mm256_storeu_ps(cosines + i, cos);
+	}
+	if (i < count) {
+		float buffer[8] = {}, sinBuffer[8], cosBuffer[8];
+		std::copy(radians + i, radians + count, buffer);
+		MathSIMD::SinCos(_mm256_loadu_ps(buffer), sin, cos);
+		_mm256_storeu_ps(sinBuffer, sin);
+		_mm256_storeu_ps(cosBuffer, cos);
+		std::copy(sinBuffer, sinBuffer + (count - i), sines + i);
+		std::copy(cosBuffer, cosBuffer + (count - i), cosines + i);
+	}
+	_mm256_zeroupper();
+}
+
+SIMD_TARGET_AVX2 void PowAVX2(const float* bases, const float* exponents, float exponent, float* results, size_t count) {
+	__m256 broadcast = _mm256_set1_ps(exponent);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 y = exponents != nullptr ? _mm256_loadu_ps(exponents + i) : broadcast;
+		_mm256_storeu_ps(results + i, MathSIMD::Pow(_mm256_loadu_ps(bases + i), y));
+	}
+	if (i < count) {
+		float buffer[8] = {}, exponentBuffer[8] = {};
+		std::copy(bases + i, bases + count, buffer);
+		if (exponents != nullptr) {
+			std::copy(exponents + i, exponents + count, exponentBuffer);
+		}
+		__m256 y = exponents != nullptr ? _mm256_loadu_ps(exponentBuffer) : broadcast;
+		_mm256_storeu_ps(buffer, MathSIMD::Pow(_mm256_loadu_ps(buffer), y));
+		std::copy(buffer, buffer + (count - i), results + i);
+	}
+	_mm256_zeroupper();
+}
+#pragma endregion
+
+float PowScalar(float base, float exponent) {
+	//SIMD版と同じく負の底はNaN、指数0は1にそろえる
+	if (exponent == 0.0f) {
+		return 1.0f;
+	}
+	return base < 0.0f ? NAN : std::pow(base, exponent);
+}
+
+void Pow(const float* bases, const float* exponents, float exponent, float* results, size_t count, SimdLevel level) {
+	switch (level) {
+	case SimdLevel::AVX2:
+		PowAVX2(bases, exponents, exponent, results, count);
+		break;
+	case SimdLevel::SSE4:
+		PowSSE4(bases, exponents, exponent, results, count);
+		break;
+	default:
+		for (size_t i = 0; i < count; i++) {
+			results[i] = PowScalar(bases[i], exponents != nullptr ? exponents[i] : exponent);
+		}
+		break;
+	}
+}
+
+}
+
+void SinCos(std::span<const float> radians, std::span<float> sines, std::span<float> cosines, SimdLevel level) {
+	assert(sines.size() >= radians.size() && cosines.size() >= radians.size());
+	switch (level) {
+	case SimdLevel::AVX2:
+		SinCosAVX2(radians.data(), sines.data(), cosines.data(), radians.size());
+		break;
+	case SimdLevel::SSE4:
+		SinCosSSE4(radians.data(), sines.data(), cosines.data(), radians.size());
+		break;
+	default:
+		for (size_t i = 0; i < radians.size(); i++) {
+			float radian = radians[i];
+			sines[i] = std::sin(radian);
+			cosines[i] = std::cos(radian);
+		}
+		break;
+	}
+}
+
+void Acos(std::span<const float> values, std::span<float> results, SimdLevel level) {
+	assert(results.size() >= values.size());
+	switch (level) {
+	case SimdLevel::AVX2:
+		ApplyAVX2<MathSIMD::Acos>(values.data(), results.data(), values.size());
+		break;
+	case SimdLevel::SSE4:
+		ApplySSE4<MathSIMD::Acos>(values.data(), results.data(), values.size());
+		break;
+	default:
+		std::transform(values.begin(), values.end(), results.begin(), [](float value) { return std::acos(value); });
+		break;
+	}
+}
+
+void Exp2(std::span<const float> exponents, std::span<float> results, SimdLevel level) {
+	assert(results.size() >= exponents.size());
+	switch (level) {
+	case SimdLevel::AVX2:
+		ApplyAVX2<MathSIMD::Exp2>(exponents.data(), results.data(), exponents.size());
+		break;
+	case SimdLevel::SSE4:
+		ApplySSE4<MathSIMD::Exp2>(exponents.data(), results.data(), exponents.size());
+		break;
+	default:
+		std::transform(exponents.begin(), exponents.end(), results.begin(), [](float exponent) { return std::exp2(exponent); });
+		break;
+	}
+}
+
+void Log2(std::span<const float> values, std::span<float> results, SimdLevel level) {
+	assert(results.size() >= values.size());
+	switch (level) {
+	case SimdLevel::AVX2:
+		ApplyAVX2<MathSIMD::Log2>(values.data(), results.data(), values.size());
+		break;
+	case SimdLevel::SSE4:
+		ApplySSE4<MathSIMD::Log2>(values.data(), results.data(), values.size());
+		break;
+	default:
+		std::transform(values.begin(), values.end(), results.begin(), [](float value) { return std::log2(value); });
+		break;
+	}
+}
+
+void Pow(std::span<const float> bases, std::span<const float> exponents, std::span<float> results, SimdLevel level) {
+	assert(exponents.size() >= bases.size() && results.size() >= bases.size());
+	Pow(bases.data(), exponents.data(), 0.0f, results.data(), bases.size(), level);
+}
+
+void Pow(std::span<const float> bases, float exponent, std::span<float> results, SimdLevel level) {
+	assert(results.size() >= bases.size());
+	Pow(bases.data(), nullptr, exponent, results.data(), bases.size(), level);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "CpuFeature.h"
+#include <span>
+
+//三角関数・指数・対数を配列にまとめて計算する関数
+//AVX2が使えるCPUでは8つずつ、SSE4では4つずつMathFunction_SIMD.hの近似で計算する
+//SIMDが使えない場合は標準ライブラリを使う。誤差の上限はMathFunction_SIMD.hを参照
+//どの関数も結果の書き込み先は入力と同じ配列でもよい
+//levelを指定すると起動時に選ばれたものの代わりにその命令セットで計算する(精度の確認用。CPUが対応していない段階を指定してはいけない)
+
+/// <summary>
+/// sinとcosをまとめて求める
+/// </summary>
+/// <param name="radians">角度(ラジアン)</param>
+/// <param name="sines">sinの書き込み先。radiansと同じ数が必要</param>
+/// <param name="cosines">cosの書き込み先。radiansと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void SinCos(std::span<const float> radians, std::span<float> sines, std::span<float> cosines, SimdLevel level = GetSimdLevel());
+
+/// <summary>
+/// 逆余弦をまとめて求める
+/// </summary>
+/// <param name="values">余弦の値([-1, 1])</param>
+/// <param name="results">結果([0, π])の書き込み先。valuesと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void Acos(std::span<const float> values, std::span<float> results, SimdLevel level = GetSimdLevel());
+
+/// <summary>
+/// 2のx乗をまとめて求める
+/// </summary>
+/// <param name="exponents">指数</param>
+/// <param name="results">結果の書き込み先。exponentsと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void Exp2(std::span<const float> exponents, std::span<float> results, SimdLevel level = GetSimdLevel());
+
+/// <summary>
+/// 2を底とする対数をまとめて求める
+/// </summary>
+/// <param name="values">真数。0は-∞、負の数はNaNになる</param>
+/// <param name="results">結果の書き込み先。valuesと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void Log2(std::span<const float> values, std::span<float> results, SimdLevel level = GetSimdLevel());
+
+/// <summary>
+/// 累乗をまとめて求める
+/// </summary>
+/// <param name="bases">底。負の数はNaNになる</param>
+/// <param name="exponents">指数。basesと同じ数が必要</param>
+/// <param name="results">結果の書き込み先。basesと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void Pow(std::span<const float> bases, std::span<const float> exponents, std::span<float> results, SimdLevel level = GetSimdLevel());
+
+/// <summary>
+/// 同じ指数で累乗をまとめて求める
+/// </summary>
+/// <param name="bases">底。負の数はNaNになる</param>
+/// <param name="exponent">指数</param>
+/// <param name="results">結果の書き込み先。basesと同じ数が必要</param>
+/// <param name="level">使う命令セット。省略すると起動時に選ばれたもの</param>
+void Pow(std::span<const float> bases, float exponent, std::span<float> results, SimdLevel level = GetSimdLevel());
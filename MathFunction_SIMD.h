@@ -0,0 +1,406 @@
+#pragma once
+#include "CpuFeature.h"
+#include <immintrin.h>
+#include <cmath>
+
+//レジスタ単位で三角関数・指数・対数を計算する関数
+//SSE4版は4つずつ、AVX2版は8つずつ計算する。呼び出す側も同じ命令セットの属性をつけた関数にすること
+//
+//最大誤差(double版の標準ライブラリの結果を基準にしたulp。Benchmarkの--accuracyで確認できる)
+//  SinCos : |x| <= π で 2ulp。|x| <= 8192 では絶対誤差 8e-8 以下(0に近い値の相対誤差は大きくなる)
+//  Acos   : [-1, 1] で 2ulp
+//  Exp2   : 2ulp。-126未満はデノーマル、-150未満は0、128以上は∞になる
+//  Log2   : 正の数(デノーマルを含む)で 2ulp
+//  Pow    : |y| <= 32 で 2ulp。y * log2(x)はdoubleで求めるので、yが大きくても誤差は広がらない
+namespace MathSIMD {
+
+//Cody-Waite法で π/4 を3つに分けた値(引数の範囲を狭めるときの丸め誤差を減らす)
+constexpr float kReduce1 = -0.78515625f;
+constexpr float kReduce2 = -2.4187564849853515625e-4f;
+constexpr float kReduce3 = -3.77489497744594108e-8f;
+constexpr float kFourOverPi = 1.27323954473516f;
+constexpr float kPi = 3.14159265358979f;
+constexpr float kHalfPi = 1.57079632679490f;
+constexpr float kSqrt2 = 1.41421356237310f;
+
+//[-π/4, π/4]でのsin, cosの近似多項式の係数
+constexpr float kSin[3] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+constexpr float kCos[3] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+//[0, 0.5]でのasinの近似多項式の係数
+constexpr float kAsin[5] = { 4.2163199048e-2f, 2.4181311049e-2f, 4.5470025998e-2f, 7.4953002686e-2f, 1.6666752422e-1f };
+//[-0.5, 0.5]での2^x - 1の近似多項式の係数
+constexpr float kExp2[6] = { 1.535336188319500e-4f, 1.339887440266574e-3f, 9.618437357674640e-3f, 5.550332471162809e-2f, 2.402264791363012e-1f, 6.931472028550421e-1f };
+//[√2/2 - 1, √2 - 1]でのlog(1 + x)の近似多項式の係数
+constexpr float kLog[9] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+//log2(e) - 1。log(x) * log2(e) を x + x * (log2(e) - 1) に分けて精度を上げる
+constexpr float kLog2eMinus1 = 0.44269504088896341f;
+
+#pragma region SSE4
+/// <summary>
+/// sinとcosを同時に求める
+/// </summary>
+/// <param name="radian">角度(ラジアン)</param>
+/// <param name="sin">sinの書き込み先</param>
+/// <param name="cos">cosの書き込み先</param>
+SIMD_TARGET_SSE4 inline void SinCos(__m128 radian, __m128& sin, __m128& cos) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 x = _mm_andnot_ps(signMask, radian);
+	__m128 sinSign = _mm_and_ps(radian, signMask);
+
+	//π/4単位の番号を偶数に切り上げ、その位置からのずれを[-π/4, π/4]に収める
+	__m128i quadrant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(kFourOverPi)));
+	quadrant = _mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+	__m128 y = _mm_cvtepi32_ps(quadrant);
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(kReduce1)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(kReduce2)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(kReduce3)));
+
+	//象限ごとの符号とsin, cosの入れ替え
+	sinSign = _mm_xor_ps(sinSign, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(4)), 29)));
+	__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(quadrant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+	__m128 isSwap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 cosPolynomial = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kCos[0]), z), _mm_set1_ps(kCos[1]));
+	cosPolynomial = _mm_add_ps(_mm_mul_ps(cosPolynomial, z), _mm_set1_ps(kCos[2]));
+	cosPolynomial = _mm_mul_ps(_mm_mul_ps(cosPolynomial, z), z);
+	cosPolynomial = _mm_add_ps(_mm_sub_ps(cosPolynomial, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+	__m128 sinPolynomial = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kSin[0]), z), _mm_set1_ps(kSin[1]));
+	sinPolynomial = _mm_add_ps(_mm_mul_ps(sinPolynomial, z), _mm_set1_ps(kSin[2]));
+	sinPolynomial = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPolynomial, z), x), x);
+
+	sin = _mm_xor_ps(_mm_blendv_ps(sinPolynomial, cosPolynomial, isSwap), sinSign);
+	cos = _mm_xor_ps(_mm_blendv_ps(cosPolynomial, sinPolynomial, isSwap), cosSign);
+}
+
+/// <summary>
+/// 逆余弦。[-1, 1]の外はNaN
+/// </summary>
+/// <param name="value">余弦の値</param>
+/// <returns>[0, π]の角度</returns>
+SIMD_TARGET_SSE4 inline __m128 Acos(__m128 value) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	__m128 a = _mm_andnot_ps(signMask, value);
+	__m128 isNegative = _mm_cmplt_ps(value, _mm_setzero_ps());
+
+	//|x| > 0.5 は asin(x) = π/2 - 2asin(√((1 - |x|) / 2)) を使い、多項式の範囲を[0, 0.5]にする
+	__m128 isLarge = _mm_cmpgt_ps(a, half);
+	__m128 zLarge = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a), half);
+	__m128 x = _mm_blendv_ps(a, _mm_sqrt_ps(zLarge), isLarge);
+	__m128 z = _mm_blendv_ps(_mm_mul_ps(a, a), zLarge, isLarge);
+
+	__m128 polynomial = _mm_set1_ps(kAsin[0]);
+	for (int i = 1; i < 5; i++) {
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, z), _mm_set1_ps(kAsin[i]));
+	}
+	__m128 asin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(polynomial, z), x), x);
+
+	//|x| > 0.5 : x >= 0 なら 2asin、x < 0 なら π - 2asin
+	__m128 large = _mm_add_ps(asin, asin);
+	large = _mm_blendv_ps(large, _mm_sub_ps(_mm_set1_ps(kPi), large), isNegative);
+	//|x| <= 0.5 : π/2 - asin(x)
+	__m128 small = _mm_sub_ps(_mm_set1_ps(kHalfPi), _mm_xor_ps(asin, _mm_and_ps(value, signMask)));
+	return _mm_blendv_ps(small, large, isLarge);
+}
+
+/// <summary>
+/// 2^n * 2^fを求める(nは整数、|f| <= 0.5)。Exp2とPowで共通の部分
+/// </summary>
+/// <param name="n">整数部。[-300, 300]に収まっていること</param>
+/// <param name="f">小数部</param>
+/// <returns></returns>
+SIMD_TARGET_SSE4 inline __m128 Exp2Parts(__m128 n, __m128 f) {
+	__m128 polynomial = _mm_set1_ps(kExp2[0]);
+	for (int i = 1; i < 6; i++) {
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(kExp2[i]));
+	}
+	polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(1.0f));
+
+	//2^nを指数部に直接書き込む。nが-126未満や127を超えても表せるように2回に分けて掛ける
+	__m128i exponent = _mm_cvtps_epi32(n);
+	__m128i exponent1 = _mm_srai_epi32(exponent, 1);
+	__m128i exponent2 = _mm_sub_epi32(exponent, exponent1);
+	__m128 scale1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent1, _mm_set1_epi32(127)), 23));
+	__m128 scale2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent2, _mm_set1_epi32(127)), 23));
+	return _mm_mul_ps(_mm_mul_ps(polynomial, scale1), scale2);
+}
+
+/// <summary>
+/// 2のx乗
+/// </summary>
+/// <param name="x">指数</param>
+/// <returns></returns>
+SIMD_TARGET_SSE4 inline __m128 Exp2(__m128 x) {
+	__m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-151.0f)), _mm_set1_ps(129.0f));
+	//整数部と[-0.5, 0.5]の小数部に分ける
+	__m128 n = _mm_round_ps(clamped, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m128 result = Exp2Parts(n, _mm_sub_ps(clamped, n));
+	return _mm_blendv_ps(result, x, _mm_cmpunord_ps(x, x));
+}
+
+/// <summary>
+/// x = 2^e * (1 + t) に分け、log(1 + t) = t - t^2 / 2 + t^3 * P(t) の多項式P(t)を求める。Log2PartsとPowで共通の部分
+/// </summary>
+/// <param name="x">正の真数</param>
+/// <param name="exponent">整数部eの書き込み先</param>
+/// <param name="t">tの書き込み先([√2/2 - 1, √2 - 1]。誤差なしで求まる)</param>
+/// <param name="polynomial">P(t)の書き込み先</param>
+SIMD_TARGET_SSE4 inline void Log1pParts(__m128 x, __m128& exponent, __m128& t, __m128& polynomial) {
+	const __m128 one = _mm_set1_ps(1.0f);
+	//デノーマルは2^23倍して正規化数にしてから計算する
+	__m128 isDenormal = _mm_cmplt_ps(x, _mm_set1_ps(1.17549435e-38f));
+	__m128 normalized = _mm_blendv_ps(x, _mm_mul_ps(x, _mm_set1_ps(8388608.0f)), isDenormal);
+	__m128i bits = _mm_castps_si128(normalized);
+
+	//mを[√2/2, √2)に収める
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+	e = _mm_sub_ps(e, _mm_and_ps(isDenormal, _mm_set1_ps(23.0f)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+	__m128 isLarge = _mm_cmpgt_ps(m, _mm_set1_ps(kSqrt2));
+	m = _mm_blendv_ps(m, _mm_mul_ps(m, _mm_set1_ps(0.5f)), isLarge);
+	exponent = _mm_add_ps(e, _mm_and_ps(isLarge, one));
+
+	t = _mm_sub_ps(m, one);
+	polynomial = _mm_set1_ps(kLog[0]);
+	for (int i = 1; i < 9; i++) {
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(kLog[i]));
+	}
+}
+
+/// <summary>
+/// x = 2^e * m のeとlog2(m)に分けて求める。Log2で使う
+/// </summary>
+/// <param name="x">正の真数</param>
+/// <param name="exponent">整数部eの書き込み先</param>
+/// <param name="fraction">log2(m)([-0.5, 0.5])の書き込み先</param>
+SIMD_TARGET_SSE4 inline void Log2Parts(__m128 x, __m128& exponent, __m128& fraction) {
+	__m128 t, polynomial;
+	Log1pParts(x, exponent, t, polynomial);
+	__m128 z = _mm_mul_ps(t, t);
+	__m128 y = _mm_mul_ps(_mm_mul_ps(polynomial, t), z);
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+
+	//(t + y) * log2(e) を誤差の小さい順に足す
+	fraction = _mm_mul_ps(y, _mm_set1_ps(kLog2eMinus1));
+	fraction = _mm_add_ps(fraction, _mm_mul_ps(t, _mm_set1_ps(kLog2eMinus1)));
+	fraction = _mm_add_ps(_mm_add_ps(fraction, y), t);
+}
+
+/// <summary>
+/// 2を底とする対数。0は-∞、負の数はNaN
+/// </summary>
+/// <param name="x">真数</param>
+/// <returns></returns>
+SIMD_TARGET_SSE4 inline __m128 Log2(__m128 x) {
+	const __m128 zero = _mm_setzero_ps();
+	__m128 exponent, fraction;
+	Log2Parts(x, exponent, fraction);
+	__m128 result = _mm_add_ps(fraction, exponent);
+
+	//特別な値
+	result = _mm_blendv_ps(result, x, _mm_cmpeq_ps(x, _mm_set1_ps(INFINITY)));
+	result = _mm_blendv_ps(result, _mm_set1_ps(-INFINITY), _mm_cmpeq_ps(x, zero));
+	return _mm_blendv_ps(result, _mm_set1_ps(NAN), _mm_cmpnge_ps(x, zero));
+}
+
+/// <summary>
+/// xのy乗。2^(y * log2(x))で求めるので負のxはNaNになる
+/// y * log2(x)の整数部を誤差なしで分けてから計算するので、結果が大きくても誤差はyの大きさで決まる
+/// </summary>
+/// <param name="x">底</param>
+/// <param name="y">指数</param>
+/// <returns>yが0のときはxに関係なく1</returns>
+SIMD_TARGET_SSE4 inline __m128 Pow(__m128 x, __m128 y) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 infinity = _mm_set1_ps(INFINITY);
+	__m128 exponent, t, polynomial;
+	Log1pParts(x, exponent, t, polynomial);
+
+	//FMAがないとfloatではlog2(m)の丸め誤差がy倍に広がるので、y * log2(x)はdoubleで2つずつ組み立てる
+	//tとyは24bitなので、t^2やy * log2(x)の積はほぼ丸めなしで求まる
+	const __m128d log2e = _mm_set1_pd(1.4426950408889634);
+	__m128d halves[2][2];
+	for (int half = 0; half < 2; half++) {
+		//下位の2つ、上位の2つの順に取り出す
+		__m128d td = _mm_cvtps_pd(half == 0 ? t : _mm_movehl_ps(t, t));
+		__m128d pd = _mm_cvtps_pd(half == 0 ? polynomial : _mm_movehl_ps(polynomial, polynomial));
+		__m128d ed = _mm_cvtps_pd(half == 0 ? exponent : _mm_movehl_ps(exponent, exponent));
+		__m128d yd = _mm_cvtps_pd(half == 0 ? y : _mm_movehl_ps(y, y));
+		__m128d z = _mm_mul_pd(td, td);
+		__m128d log1p = _mm_sub_pd(_mm_mul_pd(_mm_mul_pd(pd, td), z), _mm_mul_pd(z, _mm_set1_pd(0.5)));
+		__m128d log2x = _mm_add_pd(ed, _mm_mul_pd(_mm_add_pd(td, log1p), log2e));
+		__m128d product = _mm_mul_pd(yd, log2x);
+		__m128d integer = _mm_round_pd(product, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		halves[half][0] = _mm_min_pd(_mm_max_pd(integer, _mm_set1_pd(-151.0)), _mm_set1_pd(129.0));
+		halves[half][1] = _mm_sub_pd(product, integer);
+	}
+	__m128 n = _mm_movelh_ps(_mm_cvtpd_ps(halves[0][0]), _mm_cvtpd_ps(halves[1][0]));
+	__m128 f = _mm_movelh_ps(_mm_cvtpd_ps(halves[0][1]), _mm_cvtpd_ps(halves[1][1]));
+	__m128 result = Exp2Parts(n, f);
+
+	//特別な値
+	__m128 isPositive = _mm_cmpgt_ps(y, zero);
+	result = _mm_blendv_ps(result, _mm_blendv_ps(infinity, zero, isPositive), _mm_cmpeq_ps(x, zero));
+	result = _mm_blendv_ps(result, _mm_blendv_ps(zero, infinity, isPositive), _mm_cmpeq_ps(x, infinity));
+	result = _mm_blendv_ps(result, _mm_set1_ps(NAN), _mm_cmpnge_ps(x, zero));
+	return _mm_blendv_ps(result, _mm_set1_ps(1.0f), _mm_cmpeq_ps(y, zero));
+}
+#pragma endregion
+
+#pragma region AVX2
+SIMD_TARGET_AVX2 inline void SinCos(__m256 radian, __m256& sin, __m256& cos) {
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	__m256 x = _mm256_andnot_ps(signMask, radian);
+	__m256 sinSign = _mm256_and_ps(radian, signMask);
+
+	__m256i quadrant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kFourOverPi)));
+	quadrant = _mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+	__m256 y = _mm256_cvtepi32_ps(quadrant);
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(kReduce1), x);
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(kReduce2), x);
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(kReduce3), x);
+
+	sinSign = _mm256_xor_ps(sinSign, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(4)), 29)));
+	__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(quadrant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+	__m256 isSwap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 cosPolynomial = _mm256_fmadd_ps(_mm256_set1_ps(kCos[0]), z, _mm256_set1_ps(kCos[1]));
+	cosPolynomial = _mm256_fmadd_ps(cosPolynomial, z, _mm256_set1_ps(kCos[2]));
+	cosPolynomial = _mm256_mul_ps(_mm256_mul_ps(cosPolynomial, z), z);
+	cosPolynomial = _mm256_add_ps(_mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), cosPolynomial), _mm256_set1_ps(1.0f));
+
+	__m256 sinPolynomial = _mm256_fmadd_ps(_mm256_set1_ps(kSin[0]), z, _mm256_set1_ps(kSin[1]));
+	sinPolynomial = _mm256_fmadd_ps(sinPolynomial, z, _mm256_set1_ps(kSin[2]));
+	sinPolynomial = _mm256_fmadd_ps(_mm256_mul_ps(sinPolynomial, z), x, x);
+
+	sin = _mm256_xor_ps(_mm256_blendv_ps(sinPolynomial, cosPolynomial, isSwap), sinSign);
+	cos = _mm256_xor_ps(_mm256_blendv_ps(cosPolynomial, sinPolynomial, isSwap), cosSign);
+}
+
+SIMD_TARGET_AVX2 inline __m256 Acos(__m256 value) {
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	__m256 a = _mm256_andnot_ps(signMask, value);
+	__m256 isNegative = _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_LT_OQ);
+
+	__m256 isLarge = _mm256_cmp_ps(a, half, _CMP_GT_OQ);
+	__m256 zLarge = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), a), half);
+	__m256 x = _mm256_blendv_ps(a, _mm256_sqrt_ps(zLarge), isLarge);
+	__m256 z = _mm256_blendv_ps(_mm256_mul_ps(a, a), zLarge, isLarge);
+
+	__m256 polynomial = _mm256_set1_ps(kAsin[0]);
+	for (int i = 1; i < 5; i++) {
+		polynomial = _mm256_fmadd_ps(polynomial, z, _mm256_set1_ps(kAsin[i]));
+	}
+	__m256 asin = _mm256_fmadd_ps(_mm256_mul_ps(polynomial, z), x, x);
+
+	__m256 large = _mm256_add_ps(asin, asin);
+	large = _mm256_blendv_ps(large, _mm256_sub_ps(_mm256_set1_ps(kPi), large), isNegative);
+	__m256 small = _mm256_sub_ps(_mm256_set1_ps(kHalfPi), _mm256_xor_ps(asin, _mm256_and_ps(value, signMask)));
+	return _mm256_blendv_ps(small, large, isLarge);
+}
+
+SIMD_TARGET_AVX2 inline __m256 Exp2Parts(__m256 n, __m256 f) {
+	__m256 polynomial = _mm256_set1_ps(kExp2[0]);
+	for (int i = 1; i < 6; i++) {
+		polynomial = _mm256_fmadd_ps(polynomial, f, _mm256_set1_ps(kExp2[i]));
+	}
+	polynomial = _mm256_fmadd_ps(polynomial, f, _mm256_set1_ps(1.0f));
+
+	__m256i exponent = _mm256_cvtps_epi32(n);
+	__m256i exponent1 = _mm256_srai_epi32(exponent, 1);
+	__m256i exponent2 = _mm256_sub_epi32(exponent, exponent1);
+	__m256 scale1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(exponent1, _mm256_set1_epi32(127)), 23));
+	__m256 scale2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(exponent2, _mm256_set1_epi32(127)), 23));
+	return _mm256_mul_ps(_mm256_mul_ps(polynomial, scale1), scale2);
+}
+
+SIMD_TARGET_AVX2 inline __m256 Exp2(__m256 x) {
+	__m256 clamped = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-151.0f)), _mm256_set1_ps(129.0f));
+	__m256 n = _mm256_round_ps(clamped, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256 result = Exp2Parts(n, _mm256_sub_ps(clamped, n));
+	return _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+SIMD_TARGET_AVX2 inline void Log1pParts(__m256 x, __m256& exponent, __m256& t, __m256& polynomial) {
+	const __m256 one = _mm256_set1_ps(1.0f);
+	__m256 isDenormal = _mm256_cmp_ps(x, _mm256_set1_ps(1.17549435e-38f), _CMP_LT_OQ);
+	__m256 normalized = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(8388608.0f)), isDenormal);
+	__m256i bits = _mm256_castps_si256(normalized);
+
+	__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+	e = _mm256_sub_ps(e, _mm256_and_ps(isDenormal, _mm256_set1_ps(23.0f)));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+	__m256 isLarge = _mm256_cmp_ps(m, _mm256_set1_ps(kSqrt2), _CMP_GT_OQ);
+	m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), isLarge);
+	exponent = _mm256_add_ps(e, _mm256_and_ps(isLarge, one));
+
+	t = _mm256_sub_ps(m, one);
+	polynomial = _mm256_set1_ps(kLog[0]);
+	for (int i = 1; i < 9; i++) {
+		polynomial = _mm256_fmadd_ps(polynomial, t, _mm256_set1_ps(kLog[i]));
+	}
+}
+
+SIMD_TARGET_AVX2 inline void Log2Parts(__m256 x, __m256& exponent, __m256& fraction) {
+	__m256 t, polynomial;
+	Log1pParts(x, exponent, t, polynomial);
+	__m256 z = _mm256_mul_ps(t, t);
+	__m256 y = _mm256_mul_ps(_mm256_mul_ps(polynomial, t), z);
+	y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+
+	fraction = _mm256_mul_ps(y, _mm256_set1_ps(kLog2eMinus1));
+	fraction = _mm256_fmadd_ps(t, _mm256_set1_ps(kLog2eMinus1), fraction);
+	fraction = _mm256_add_ps(_mm256_add_ps(fraction, y), t);
+}
+
+SIMD_TARGET_AVX2 inline __m256 Log2(__m256 x) {
+	const __m256 zero = _mm256_setzero_ps();
+	__m256 exponent, fraction;
+	Log2Parts(x, exponent, fraction);
+	__m256 result = _mm256_add_ps(fraction, exponent);
+
+	result = _mm256_blendv_ps(result, x, _mm256_cmp_ps(x, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ));
+	result = _mm256_blendv_ps(result, _mm256_set1_ps(-INFINITY), _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+	return _mm256_blendv_ps(result, _mm256_set1_ps(NAN), _mm256_cmp_ps(x, zero, _CMP_NGE_UQ));
+}
+
+SIMD_TARGET_AVX2 inline __m256 Pow(__m256 x, __m256 y) {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 infinity = _mm256_set1_ps(INFINITY);
+	__m256 exponent, t, polynomial;
+	Log1pParts(x, exponent, t, polynomial);
+
+	//SSE4版と同じく、y * log2(x)はdoubleで4つずつ組み立てる(floatのlog2(m)の丸め誤差がy倍に広がらないようにする)
+	const __m256d log2e = _mm256_set1_pd(1.4426950408889634);
+	__m128 halves[2][2];
+	for (int half = 0; half < 2; half++) {
+		//下位の4つ、上位の4つの順に取り出す
+		__m256d td = _mm256_cvtps_pd(half == 0 ? _mm256_castps256_ps128(t) : _mm256_extractf128_ps(t, 1));
+		__m256d pd = _mm256_cvtps_pd(half == 0 ? _mm256_castps256_ps128(polynomial) : _mm256_extractf128_ps(polynomial, 1));
+		__m256d ed = _mm256_cvtps_pd(half == 0 ? _mm256_castps256_ps128(exponent) : _mm256_extractf128_ps(exponent, 1));
+		__m256d yd = _mm256_cvtps_pd(half == 0 ? _mm256_castps256_ps128(y) : _mm256_extractf128_ps(y, 1));
+		__m256d z = _mm256_mul_pd(td, td);
+		__m256d log1p = _mm256_fmsub_pd(_mm256_mul_pd(pd, td), z, _mm256_mul_pd(z, _mm256_set1_pd(0.5)));
+		__m256d log2x = _mm256_fmadd_pd(_mm256_add_pd(td, log1p), log2e, ed);
+		__m256d product = _mm256_mul_pd(yd, log2x);
+		__m256d integer = _mm256_round_pd(product, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		halves[half][0] = _mm256_cvtpd_ps(_mm256_min_pd(_mm256_max_pd(integer, _mm256_set1_pd(-151.0)), _mm256_set1_pd(129.0)));
+		halves[half][1] = _mm256_cvtpd_ps(_mm256_sub_pd(product, integer));
+	}
+	__m256 n = _mm256_insertf128_ps(_mm256_castps128_ps256(halves[0][0]), halves[1][0], 1);
+	__m256 f = _mm256_insertf128_ps(_mm256_castps128_ps256(halves[0][1]), halves[1][1], 1);
+	__m256 result = Exp2Parts(n, f);
+
+	__m256 isPositive = _mm256_cmp_ps(y, zero, _CMP_GT_OQ);
+	result = _mm256_blendv_ps(result, _mm256_blendv_ps(infinity, zero, isPositive), _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+	result = _mm256_blendv_ps(result, _mm256_blendv_ps(zero, infinity, isPositive), _mm256_cmp_ps(x, infinity, _CMP_EQ_OQ));
+	result = _mm256_blendv_ps(result, _mm256_set1_ps(NAN), _mm256_cmp_ps(x, zero, _CMP_NGE_UQ));
+	return _mm256_blendv_ps(result, _mm256_set1_ps(1.0f), _mm256_cmp_ps(y, zero, _CMP_EQ_OQ));
+}
+#pragma endregion
+
+}
@@ -0,0 +1,273 @@
+#pragma once
+#include "Vector3.h"
+#include "Matrix4x4_SIMD.h"
+#include <type_traits>
+
+/// <summary>
+/// Row行Colmun列の行列
+/// </summary>
+template<int Row, int Colmun>
+struct Matrix {
+	float m[Row][Colmun];
+};
+
+//3x3行列。回転・スケールだけの線形変換(行ベクトル v * M)
+using Matrix3x3 = Matrix<3, 3>;
+//3x4行列。アフィン変換を列ベクトル用に転置し、固定の(0, 0, 0, 1)の列を省いたもの(HLSLのfloat3x4と同じ並び)
+//m[i]がMatrix4x4のi列目にあたり、m[i][3]が平行移動のi成分になる。Matrix4x4より16バイト小さい
+using Matrix3x4 = Matrix<3, 4>;
+using Matrix4x4 = Matrix<4, 4>;
+
+//Matrix4x4同士の演算はMatrix4x4.hでSIMD版を定義しているので、ここでは他の大きさの行列を扱う
+
+#pragma region 共通の演算
+/// <summary>
+/// 行列の加算
+/// </summary>
+/// <param name="matrix1">行列1</param>
+/// <param name="matrix2">行列2</param>
+/// <returns></returns>
+template<int Row, int Colmun>
+constexpr Matrix<Row, Colmun> Add(const Matrix<Row, Colmun>& matrix1, const Matrix<Row, Colmun>& matrix2) {
+	Matrix<Row, Colmun> matrix{};
+	for (int row = 0; row < Row; row++) {
+		for (int colmun = 0; colmun < Colmun; colmun++) {
+			matrix.m[row][colmun] = matrix1.m[row][colmun] + matrix2.m[row][colmun];
+		}
+	}
+	return matrix;
+}
+
+/// <summary>
+/// 行列の減算
+/// </summary>
+/// <param name="matrix1">行列1</param>
+/// <param name="matrix2">行列2</param>
+/// <returns></returns>
+template<int Row, int Colmun>
+constexpr Matrix<Row, Colmun> Subtract(const Matrix<Row, Colmun>& matrix1, const Matrix<Row, Colmun>& matrix2) {
+	Matrix<Row, Colmun> matrix{};
+	for (int row = 0; row < Row; row++) {
+		for (int colmun = 0; colmun < Colmun; colmun++) {
+			matrix.m[row][colmun] = matrix1.m[row][colmun] - matrix2.m[row][colmun];
+		}
+	}
+	return matrix;
+}
+
+/// <summary>
+/// 正方行列の積
+/// </summary>
+/// <param name="matrix1">先に適用する行列</param>
+/// <param name="matrix2">後に適用する行列</param>
+/// <returns></returns>
+template<int Size>
+constexpr Matrix<Size, Size> Multiply(const Matrix<Size, Size>& matrix1, const Matrix<Size, Size>& matrix2) {
+	Matrix<Size, Size> matrix{};
+	for (int row = 0; row < Size; row++) {
+		for (int colmun = 0; colmun < Size; colmun++) {
+			for (int i = 0; i < Size; i++) {
+				matrix.m[row][colmun] += matrix1.m[row][i] * matrix2.m[i][colmun];
+			}
+		}
+	}
+	return matrix;
+}
+
+/// <summary>
+/// 転置行列
+/// </summary>
+/// <param name="matrix">行列</param>
+/// <returns></returns>
+template<int Row, int Colmun>
+constexpr Matrix<Colmun, Row> Transpose(const Matrix<Row, Colmun>& matrix) {
+	Matrix<Colmun, Row> result{};
+	for (int row = 0; row < Row; row++) {
+		for (int colmun = 0; colmun < Colmun; colmun++) {
+			result.m[colmun][row] = matrix.m[row][colmun];
+		}
+	}
+	return result;
+}
+#pragma endregion
+
+#pragma region 単位行列
+constexpr Matrix3x3 MakeIdentity3x3() {
+	return { {
+		{ 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f } } };
+}
+
+constexpr Matrix3x4 MakeIdentity3x4() {
+	return { {
+		{ 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f } } };
+}
+#pragma endregion
+
+#pragma region 変換
+//大きさの違う行列へは暗黙に変換しないので、これらの関数で明示的に変換する
+
+/// <summary>
+/// 4x4行列の左上3x3(回転・スケール)を取り出す
+/// </summary>
+constexpr Matrix3x3 ToMatrix3x3(const Matrix4x4& matrix) {
+	Matrix3x3 result{};
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 3; colmun++) {
+			result.m[row][colmun] = matrix.m[row][colmun];
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// 3x4行列の回転・スケールの部分を行ベクトル用の3x3行列として取り出す
+/// </summary>
+constexpr Matrix3x3 ToMatrix3x3(const Matrix3x4& matrix) {
+	Matrix3x3 result{};
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 3; colmun++) {
+			result.m[row][colmun] = matrix.m[colmun][row];
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// アフィン変換の4x4行列を3x4行列にする。4列目は(0, 0, 0, 1)として捨てる
+/// </summary>
+constexpr Matrix3x4 ToMatrix3x4(const Matrix4x4& matrix) {
+	Matrix3x4 result{};
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			result.m[row][colmun] = matrix.m[colmun][row];
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// 3x3行列を平行移動なしの4x4行列にする
+/// </summary>
+constexpr Matrix4x4 ToMatrix4x4(const Matrix3x3& matrix) {
+	Matrix4x4 result{};
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 3; colmun++) {
+			result.m[row][colmun] = matrix.m[row][colmun];
+		}
+	}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+
+/// <summary>
+/// 3x4行列を4x4行列に戻す
+/// </summary>
+constexpr Matrix4x4 ToMatrix4x4(const Matrix3x4& matrix) {
+	Matrix4x4 result{};
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 3; colmun++) {
+			result.m[row][colmun] = matrix.m[colmun][row];
+		}
+	}
+	result.m[3][3] = 1.0f;
+	return result;
+}
+#pragma endregion
+
+#pragma region 3x4行列(アフィン変換)
+/// <summary>
+/// アフィン変換の合成。固定の行を計算しないので乗算は36回(4x4では64回)
+/// </summary>
+/// <param name="matrix1">先に適用する変換</param>
+/// <param name="matrix2">後に適用する変換</param>
+/// <returns></returns>
+constexpr Matrix3x4 Multiply(const Matrix3x4& matrix1, const Matrix3x4& matrix2) {
+	Matrix3x4 result{};
+	if (std::is_constant_evaluated()) {
+		//結果の各行はmatrix1の行をmatrix2の係数で足し合わせ、平行移動を加えたもの
+		for (int row = 0; row < 3; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				float value = colmun == 3 ? matrix2.m[row][3] : 0.0f;
+				for (int i = 0; i < 3; i++) {
+					value += matrix2.m[row][i] * matrix1.m[i][colmun];
+				}
+				result.m[row][colmun] = value;
+			}
+		}
+	} else {
+		GetMatrixKernel().multiply3x4(matrix1, matrix2, result);
+	}
+	return result;
+}
+
+/// <summary>
+/// アフィン変換の後に4x4行列(ビュープロジェクションなど)を適用する行列。乗算は48回
+/// </summary>
+/// <param name="matrix1">先に適用するアフィン変換(ワールド行列など)</param>
+/// <param name="matrix2">後に適用する4x4行列</param>
+/// <returns></returns>
+constexpr Matrix4x4 Multiply(const Matrix3x4& matrix1, const Matrix4x4& matrix2) {
+	Matrix4x4 result{};
+	if (std::is_constant_evaluated()) {
+		//matrix1を4x4に戻すと4行目が(0, 0, 0, 1)なので、その分はmatrix2の4行目を足すだけになる
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				float value = row == 3 ? matrix2.m[3][colmun] : 0.0f;
+				for (int i = 0; i < 3; i++) {
+					value += matrix1.m[i][row] * matrix2.m[i][colmun];
+				}
+				result.m[row][colmun] = value;
+			}
+		}
+	} else {
+		GetMatrixKernel().multiply3x4By4x4(matrix1, matrix2, result);
+	}
+	return result;
+}
+
+/// <summary>
+/// 座標をアフィン変換する
+/// </summary>
+/// <param name="vector">座標</param>
+/// <param name="matrix">アフィン変換</param>
+/// <returns></returns>
+constexpr Vector3 Transform(const Vector3& vector, const Matrix3x4& matrix) {
+	const float(&m)[3][4] = matrix.m;
+	return {
+		m[0][0] * vector.x + m[0][1] * vector.y + m[0][2] * vector.z + m[0][3],
+		m[1][0] * vector.x + m[1][1] * vector.y + m[1][2] * vector.z + m[1][3],
+		m[2][0] * vector.x + m[2][1] * vector.y + m[2][2] * vector.z + m[2][3] };
+}
+
+/// <summary>
+/// 方向ベクトルを変換する(平行移動しない)
+/// </summary>
+/// <param name="vector">方向ベクトル</param>
+/// <param name="matrix">アフィン変換</param>
+/// <returns></returns>
+constexpr Vector3 TransformNormal(const Vector3& vector, const Matrix3x4& matrix) {
+	const float(&m)[3][4] = matrix.m;
+	return {
+		m[0][0] * vector.x + m[0][1] * vector.y + m[0][2] * vector.z,
+		m[1][0] * vector.x + m[1][1] * vector.y + m[1][2] * vector.z,
+		m[2][0] * vector.x + m[2][1] * vector.y + m[2][2] * vector.z };
+}
+
+/// <summary>
+/// 方向ベクトルを3x3行列で変換する
+/// </summary>
+/// <param name="vector">方向ベクトル</param>
+/// <param name="matrix">行ベクトル用の3x3行列</param>
+/// <returns></returns>
+constexpr Vector3 TransformNormal(const Vector3& vector, const Matrix3x3& matrix) {
+	const float(&m)[3][3] = matrix.m;
+	return {
+		vector.x * m[0][0] + vector.y * m[1][0] + vector.z * m[2][0],
+		vector.x * m[0][1] + vector.y * m[1][1] + vector.z * m[2][1],
+		vector.x * m[0][2] + vector.y * m[1][2] + vector.z * m[2][2] };
+}
+#pragma endregion
@@ -1,247 +1,160 @@
 #include "Matrix4x4.h"
 #include "Vector3_Math.hpp"
-
-Matrix4x4 Add(Matrix4x4 matrix1, Matrix4x4 matrix2) {
-	Matrix4x4 matrix = {};
-	for (int row = 0; row < 4; row++) {
-		for (int colmun = 0; colmun < 4; colmun++) {
-			matrix.m[row][colmun] = matrix1.m[row][colmun] + matrix2.m[row][colmun];
-		}
-	}
-	return matrix;
+#include "Matrix4x4_SIMD.h"
+#include "MathFunction.h"
+#include "MathFunction_SIMD.h"
+#include <algorithm>
+
+namespace {
+
+//まとめて行列を作るときに一度にSoAへ並べる数
+constexpr size_t kComposeBlockSize = 64;
+
+/// <summary>
+/// 3軸の角度のsinとcosを1つのレジスタでまとめて求める
+/// </summary>
+/// <param name="rotate">各軸の角度(ラジアン)</param>
+/// <param name="sin">sinの書き込み先(4つ目は使わない)</param>
+/// <param name="cos">cosの書き込み先(4つ目は使わない)</param>
+SIMD_TARGET_SSE4 void SinCosSSE4(const Vector3& rotate, float sin[4], float cos[4]) {
+	__m128 sines, cosines;
+	MathSIMD::SinCos(_mm_setr_ps(rotate.x, rotate.y, rotate.z, 0.0f), sines, cosines);
+	_mm_storeu_ps(sin, sines);
+	_mm_storeu_ps(cos, cosines);
 }
 
-Matrix4x4 Subtract(Matrix4x4 matrix1, Matrix4x4 matrix2) {
-	Matrix4x4 matrix = {};
-	for (int row = 0; row < 4; row++) {
-		for (int colmun = 0; colmun < 4; colmun++) {
-			matrix.m[row][colmun] = matrix1.m[row][colmun] - matrix2.m[row][colmun];
-		}
-	}
-	return matrix;
+/// <summary>
+/// 逆行列と行列式で共有する2x2の小行列式
+/// </summary>
+struct SubDeterminant {
+	//上2行から作る小行列式
+	float s0, s1, s2, s3, s4, s5;
+	//下2行から作る小行列式
+	float c0, c1, c2, c3, c4, c5;
+};
+
+SubDeterminant MakeSubDeterminant(const Matrix4x4& matrix) {
+	const float(&m)[4][4] = matrix.m;
+	SubDeterminant sub;
+
+	sub.s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+	sub.s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+	sub.s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+	sub.s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+	sub.s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+	sub.s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+	sub.c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+	sub.c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+	sub.c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+	sub.c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+	sub.c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+	sub.c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+	return sub;
 }
 
-Matrix4x4 Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2) {
-	Matrix4x4 matrix = {};
-	
-	matrix.m[0][0] = matrix1.m[0][0] * matrix2.m[0][0] + matrix1.m[0][1] * matrix2.m[1][0] + matrix1.m[0][2] * matrix2.m[2][0] + matrix1.m[0][3] * matrix2.m[3][0];
-	matrix.m[0][1] = matrix1.m[0][0] * matrix2.m[0][1] + matrix1.m[0][1] * matrix2.m[1][1] + matrix1.m[0][2] * matrix2.m[2][1] + matrix1.m[0][3] * matrix2.m[3][1];
-	matrix.m[0][2] = matrix1.m[0][0] * matrix2.m[0][2] + matrix1.m[0][1] * matrix2.m[1][2] + matrix1.m[0][2] * matrix2.m[2][2] + matrix1.m[0][3] * matrix2.m[3][2];
-	matrix.m[0][3] = matrix1.m[0][0] * matrix2.m[0][3] + matrix1.m[0][1] * matrix2.m[1][3] + matrix1.m[0][2] * matrix2.m[2][3] + matrix1.m[0][3] * matrix2.m[3][3];
-
-	matrix.m[1][0] = matrix1.m[1][0] * matrix2.m[0][0] + matrix1.m[1][1] * matrix2.m[1][0] + matrix1.m[1][2] * matrix2.m[2][0] + matrix1.m[1][3] * matrix2.m[3][0];
-	matrix.m[1][1] = matrix1.m[1][0] * matrix2.m[0][1] + matrix1.m[1][1] * matrix2.m[1][1] + matrix1.m[1][2] * matrix2.m[2][1] + matrix1.m[1][3] * matrix2.m[3][1];
-	matrix.m[1][2] = matrix1.m[1][0] * matrix2.m[0][2] + matrix1.m[1][1] * matrix2.m[1][2] + matrix1.m[1][2] * matrix2.m[2][2] + matrix1.m[1][3] * matrix2.m[3][2];
-	matrix.m[1][3] = matrix1.m[1][0] * matrix2.m[0][3] + matrix1.m[1][1] * matrix2.m[1][3] + matrix1.m[1][2] * matrix2.m[2][3] + matrix1.m[1][3] * matrix2.m[3][3];
-
-	matrix.m[2][0] = matrix1.m[2][0] * matrix2.m[0][0] + matrix1.m[2][1] * matrix2.m[1][0] + matrix1.m[2][2] * matrix2.m[2][0] + matrix1.m[2][3] * matrix2.m[3][0];
-	matrix.m[2][1] = matrix1.m[2][0] * matrix2.m[0][1] + matrix1.m[2][1] * matrix2.m[1][1] + matrix1.m[2][2] * matrix2.m[2][1] + matrix1.m[2][3] * matrix2.m[3][1];
-	matrix.m[2][2] = matrix1.m[2][0] * matrix2.m[0][2] + matrix1.m[2][1] * matrix2.m[1][2] + matrix1.m[2][2] * matrix2.m[2][2] + matrix1.m[2][3] * matrix2.m[3][2];
-	matrix.m[2][3] = matrix1.m[2][0] * matrix2.m[0][3] + matrix1.m[2][1] * matrix2.m[1][3] + matrix1.m[2][2] * matrix2.m[2][3] + matrix1.m[2][3] * matrix2.m[3][3];
-
-	matrix.m[3][0] = matrix1.m[3][0] * matrix2.m[0][0] + matrix1.m[3][1] * matrix2.m[1][0] + matrix1.m[3][2] * matrix2.m[2][0] + matrix1.m[3][3] * matrix2.m[3][0];
-	matrix.m[3][1] = matrix1.m[3][0] * matrix2.m[0][1] + matrix1.m[3][1] * matrix2.m[1][1] + matrix1.m[3][2] * matrix2.m[2][1] + matrix1.m[3][3] * matrix2.m[3][1];
-	matrix.m[3][2] = matrix1.m[3][0] * matrix2.m[0][2] + matrix1.m[3][1] * matrix2.m[1][2] + matrix1.m[3][2] * matrix2.m[2][2] + matrix1.m[3][3] * matrix2.m[3][2];
-	matrix.m[3][3] = matrix1.m[3][0] * matrix2.m[0][3] + matrix1.m[3][1] * matrix2.m[1][3] + matrix1.m[3][2] * matrix2.m[2][3] + matrix1.m[3][3] * matrix2.m[3][3];
-
-	return matrix;
+float Det(const SubDeterminant& sub) {
+	return sub.s0 * sub.c5 - sub.s1 * sub.c4 + sub.s2 * sub.c3 + sub.s3 * sub.c2 - sub.s4 * sub.c1 + sub.s5 * sub.c0;
 }
 
-float Det(Matrix4x4 matrix) {
-	float det = 0.0f;
-
-	det = matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][3]
-		+ matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][1]
-		+ matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][2]
-
-		- matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][1]
-		- matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][3]
-		- matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][2]
-
-		- matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][3]
-		- matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][1]
-		- matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][2]
+}
 
-		+ matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][1]
-		+ matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][3]
-		+ matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][2]
+float Det(const Matrix4x4& matrix) {
+	return Det(MakeSubDeterminant(matrix));
+}
 
-		+ matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][3]
-		+ matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][1]
-		+ matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][2]
+Matrix4x4 Inverse(const Matrix4x4& matrix) {
+	const float(&m)[4][4] = matrix.m;
+	//2x2の小行列式を一度だけ計算して、行列式と全ての余因子で使い回す
+	SubDeterminant sub = MakeSubDeterminant(matrix);
+	float det = Det(sub);
+	assert(det != 0.0f);
+	float invDet = 1.0f / det;
 
-		- matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][1]
-		- matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][3]
-		- matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][2]
+	Matrix4x4 matrix1;
 
-		- matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][0]
-		- matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][0]
-		- matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][0]
+	matrix1.m[0][0] = ( m[1][1] * sub.c5 - m[1][2] * sub.c4 + m[1][3] * sub.c3) * invDet;
+	matrix1.m[0][1] = (-m[0][1] * sub.c5 + m[0][2] * sub.c4 - m[0][3] * sub.c3) * invDet;
+	matrix1.m[0][2] = ( m[3][1] * sub.s5 - m[3][2] * sub.s4 + m[3][3] * sub.s3) * invDet;
+	matrix1.m[0][3] = (-m[2][1] * sub.s5 + m[2][2] * sub.s4 - m[2][3] * sub.s3) * invDet;
 
-		+ matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][0]
-		+ matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][0]
-		+ matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][0];
+	matrix1.m[1][0] = (-m[1][0] * sub.c5 + m[1][2] * sub.c2 - m[1][3] * sub.c1) * invDet;
+	matrix1.m[1][1] = ( m[0][0] * sub.c5 - m[0][2] * sub.c2 + m[0][3] * sub.c1) * invDet;
+	matrix1.m[1][2] = (-m[3][0] * sub.s5 + m[3][2] * sub.s2 - m[3][3] * sub.s1) * invDet;
+	matrix1.m[1][3] = ( m[2][0] * sub.s5 - m[2][2] * sub.s2 + m[2][3] * sub.s1) * invDet;
 
-	return det;
-}
+	matrix1.m[2][0] = ( m[1][0] * sub.c4 - m[1][1] * sub.c2 + m[1][3] * sub.c0) * invDet;
+	matrix1.m[2][1] = (-m[0][0] * sub.c4 + m[0][1] * sub.c2 - m[0][3] * sub.c0) * invDet;
+	matrix1.m[2][2] = ( m[3][0] * sub.s4 - m[3][1] * sub.s2 + m[3][3] * sub.s0) * invDet;
+	matrix1.m[2][3] = (-m[2][0] * sub.s4 + m[2][1] * sub.s2 - m[2][3] * sub.s0) * invDet;
 
-Matrix4x4 Inverse(Matrix4x4 matrix) {
-	Matrix4x4 matrix1 = {};
-	float det = Det(matrix);
-
-	matrix1.m[0][0] = (1.0f / det) * (matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][3]
-		+ matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][1]
-		+ matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][2]
-		- matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][1]
-		- matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][3]
-		- matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][2]);
-	matrix1.m[0][1] = (1.0f / det) * (-1 * matrix.m[0][1] * matrix.m[2][2] * matrix.m[3][3]
-		- matrix.m[0][2] * matrix.m[2][3] * matrix.m[3][1]
-		- matrix.m[0][3] * matrix.m[2][1] * matrix.m[3][2]
-		+ matrix.m[0][3] * matrix.m[2][2] * matrix.m[3][1]
-		+ matrix.m[0][2] * matrix.m[2][1] * matrix.m[3][3]
-		+ matrix.m[0][1] * matrix.m[2][3] * matrix.m[3][2]);
-	matrix1.m[0][2] = (1.0f / det) * (matrix.m[0][1] * matrix.m[1][2] * matrix.m[3][3]
-		+ matrix.m[0][2] * matrix.m[1][3] * matrix.m[3][1]
-		+ matrix.m[0][3] * matrix.m[1][1] * matrix.m[3][2]
-		- matrix.m[0][3] * matrix.m[1][2] * matrix.m[3][1]
-		- matrix.m[0][2] * matrix.m[1][1] * matrix.m[3][3]
-		- matrix.m[0][1] * matrix.m[1][3] * matrix.m[3][2]);
-	matrix1.m[0][3] = (1.0f / det) * (-1 * matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][3]
-		- matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][1]
-		- matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][2]
-		+ matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][1]
-		+ matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][3]
-		+ matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][2]);
-
-	matrix1.m[1][0] = (1.0f / det) * (-1 * matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][3]
-		- matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][0]
-		- matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][2]
-		+ matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][0]
-		+ matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][3]
-		+ matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][2]);
-	matrix1.m[1][1] = (1.0f / det) * (matrix.m[0][0] * matrix.m[2][2] * matrix.m[3][3]
-		+ matrix.m[0][2] * matrix.m[2][3] * matrix.m[3][0]
-		+ matrix.m[0][3] * matrix.m[2][0] * matrix.m[3][2]
-		- matrix.m[0][3] * matrix.m[2][2] * matrix.m[3][0]
-		- matrix.m[0][2] * matrix.m[2][0] * matrix.m[3][3]
-		- matrix.m[0][0] * matrix.m[2][3] * matrix.m[3][2]);
-	matrix1.m[1][2] = (1.0f / det) * (-1 * matrix.m[0][0] * matrix.m[1][2] * matrix.m[3][3]
-		- matrix.m[0][2] * matrix.m[1][3] * matrix.m[3][0]
-		- matrix.m[0][3] * matrix.m[1][0] * matrix.m[3][2]
-		+ matrix.m[0][3] * matrix.m[1][2] * matrix.m[3][0]
-		+ matrix.m[0][2] * matrix.m[1][0] * matrix.m[3][3]
-		+ matrix.m[0][0] * matrix.m[1][3] * matrix.m[3][2]);
-	matrix1.m[1][3] = (1.0f / det) * (matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][3]
-		+ matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][0]
-		+ matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][2]
-		- matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][0]
-		- matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][3]
-		- matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][2]);
-
-	matrix1.m[2][0] = (1.0f / det) * (matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][3]
-		+ matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][0]
-		+ matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][1]
-		- matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][0]
-		- matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][3]
-		- matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][1]);
-	matrix1.m[2][1] = (1.0f / det) * (-1 * matrix.m[0][0] * matrix.m[2][1] * matrix.m[3][3]
-		- matrix.m[0][1] * matrix.m[2][3] * matrix.m[3][0]
-		- matrix.m[0][3] * matrix.m[2][0] * matrix.m[3][1]
-		+ matrix.m[0][3] * matrix.m[2][1] * matrix.m[3][0]
-		+ matrix.m[0][1] * matrix.m[2][0] * matrix.m[3][3]
-		+ matrix.m[0][0] * matrix.m[2][3] * matrix.m[3][1]);
-	matrix1.m[2][2] = (1.0f / det) * (matrix.m[0][0] * matrix.m[1][1] * matrix.m[3][3]
-		+ matrix.m[0][1] * matrix.m[1][3] * matrix.m[3][0]
-		+ matrix.m[0][3] * matrix.m[1][0] * matrix.m[3][1]
-		- matrix.m[0][3] * matrix.m[1][1] * matrix.m[3][0]
-		- matrix.m[0][1] * matrix.m[1][0] * matrix.m[3][3]
-		- matrix.m[0][0] * matrix.m[1][3] * matrix.m[3][1]);
-	matrix1.m[2][3] = (1.0f / det) * (-1 * matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][3]
-		- matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][0]
-		- matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][1]
-		+ matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][0]
-		+ matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][3]
-		+ matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][1]);
-
-	matrix1.m[3][0] = (1.0f / det) * (-1 * matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][2]
-		- matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][0]
-		- matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][1]
-		+ matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][0]
-		+ matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][2]
-		+ matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][1]);
-	matrix1.m[3][1] = (1.0f / det) * (matrix.m[0][0] * matrix.m[2][1] * matrix.m[3][2]
-		+ matrix.m[0][1] * matrix.m[2][2] * matrix.m[3][0]
-		+ matrix.m[0][2] * matrix.m[2][0] * matrix.m[3][1]
-		- matrix.m[0][2] * matrix.m[2][1] * matrix.m[3][0]
-		- matrix.m[0][1] * matrix.m[2][0] * matrix.m[3][2]
-		- matrix.m[0][0] * matrix.m[2][2] * matrix.m[3][1]);
-	matrix1.m[3][2] = (1.0f / det) * (-1 * matrix.m[0][0] * matrix.m[1][1] * matrix.m[3][2]
-		- matrix.m[0][1] * matrix.m[1][2] * matrix.m[3][0]
-		- matrix.m[0][2] * matrix.m[1][0] * matrix.m[3][1]
-		+ matrix.m[0][2] * matrix.m[1][1] * matrix.m[3][0]
-		+ matrix.m[0][1] * matrix.m[1][0] * matrix.m[3][2]
-		+ matrix.m[0][0] * matrix.m[1][2] * matrix.m[3][1]);
-	matrix1.m[3][3] = (1.0f / det) * (matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][2]
-		+ matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][0]
-		+ matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][1]
-		- matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][0]
-		- matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][2]
-		- matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][1]);
+	matrix1.m[3][0] = (-m[1][0] * sub.c3 + m[1][1] * sub.c1 - m[1][2] * sub.c0) * invDet;
+	matrix1.m[3][1] = ( m[0][0] * sub.c3 - m[0][1] * sub.c1 + m[0][2] * sub.c0) * invDet;
+	matrix1.m[3][2] = (-m[3][0] * sub.s3 + m[3][1] * sub.s1 - m[3][2] * sub.s0) * invDet;
+	matrix1.m[3][3] = ( m[2][0] * sub.s3 - m[2][1] * sub.s1 + m[2][2] * sub.s0) * invDet;
 
 	return matrix1;
 }
 
-Matrix4x4 Transpose(Matrix4x4 matrix) {
-	Matrix4x4 matrix1 = {};
-
-	matrix1.m[0][0] = matrix.m[0][0];
-	matrix1.m[0][1] = matrix.m[1][0];
-	matrix1.m[0][2] = matrix.m[2][0];
-	matrix1.m[0][3] = matrix.m[3][0];
-
-	matrix1.m[1][0] = matrix.m[0][1];
-	matrix1.m[1][1] = matrix.m[1][1];
-	matrix1.m[1][2] = matrix.m[2][1];
-	matrix1.m[1][3] = matrix.m[3][1];
-
-	matrix1.m[2][0] = matrix.m[0][2];
-	matrix1.m[2][1] = matrix.m[1][2];
-	matrix1.m[2][2] = matrix.m[2][2];
-	matrix1.m[2][3] = matrix.m[3][2];
-
-	matrix1.m[3][0] = matrix.m[0][3];
-	matrix1.m[3][1] = matrix.m[1][3];
-	matrix1.m[3][2] = matrix.m[2][3];
-	matrix1.m[3][3] = matrix.m[3][3];
+Matrix4x4 InverseAffine(const Matrix4x4& matrix) {
+	const float(&m)[4][4] = matrix.m;
+	//3x3部分の逆行列は各行の外積を列に並べたものを行列式で割ったもの
+	Vector3 row0 = { m[0][0], m[0][1], m[0][2] };
+	Vector3 row1 = { m[1][0], m[1][1], m[1][2] };
+	Vector3 row2 = { m[2][0], m[2][1], m[2][2] };
+	Vector3 cross12 = Cross(row1, row2);
+	Vector3 cross20 = Cross(row2, row0);
+	Vector3 cross01 = Cross(row0, row1);
+	float det = Dot(row0, cross12);
+	assert(det != 0.0f);
+	float invDet = 1.0f / det;
+
+	Matrix4x4 matrix1;
+
+	matrix1.m[0][0] = cross12.x * invDet;
+	matrix1.m[0][1] = cross20.x * invDet;
+	matrix1.m[0][2] = cross01.x * invDet;
+	matrix1.m[0][3] = 0.0f;
+
+	matrix1.m[1][0] = cross12.y * invDet;
+	matrix1.m[1][1] = cross20.y * invDet;
+	matrix1.m[1][2] = cross01.y * invDet;
+	matrix1.m[1][3] = 0.0f;
+
+	matrix1.m[2][0] = cross12.z * invDet;
+	matrix1.m[2][1] = cross20.z * invDet;
+	matrix1.m[2][2] = cross01.z * invDet;
+	matrix1.m[2][3] = 0.0f;
+
+	//平行移動は -t * A^-1
+	for (int colmun = 0; colmun < 3; colmun++) {
+		matrix1.m[3][colmun] = -(m[3][0] * matrix1.m[0][colmun] + m[3][1] * matrix1.m[1][colmun] + m[3][2] * matrix1.m[2][colmun]);
+	}
+	matrix1.m[3][3] = 1.0f;
 
 	return matrix1;
 }
 
-Matrix4x4 MakeIdentity4x4() {
-	Matrix4x4 matrix = {};
-
-	matrix.m[0][0] = 1.0f;
-	matrix.m[0][1] = 0.0f;
-	matrix.m[0][2] = 0.0f;
-	matrix.m[0][3] = 0.0f;
+Matrix4x4 InverseRigid(const Matrix4x4& matrix) {
+	const float(&m)[4][4] = matrix.m;
+	Matrix4x4 matrix1;
 
-	matrix.m[1][0] = 0.0f;
-	matrix.m[1][1] = 1.0f;
-	matrix.m[1][2] = 0.0f;
-	matrix.m[1][3] = 0.0f;
-
-	matrix.m[2][0] = 0.0f;
-	matrix.m[2][1] = 0.0f;
-	matrix.m[2][2] = 1.0f;
-	matrix.m[2][3] = 0.0f;
+	//回転部分は転置するだけ
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 3; colmun++) {
+			matrix1.m[row][colmun] = m[colmun][row];
+		}
+		matrix1.m[row][3] = 0.0f;
+	}
 
-	matrix.m[3][0] = 0.0f;
-	matrix.m[3][1] = 0.0f;
-	matrix.m[3][2] = 0.0f;
-	matrix.m[3][3] = 1.0f;
+	//平行移動は -t * R^T
+	for (int colmun = 0; colmun < 3; colmun++) {
+		matrix1.m[3][colmun] = -(m[3][0] * m[colmun][0] + m[3][1] * m[colmun][1] + m[3][2] * m[colmun][2]);
+	}
+	matrix1.m[3][3] = 1.0f;
 
-	return matrix;
+	return matrix1;
 }
 
 Matrix4x4 MakeRotateXMatrix(float radian) {
@@ -285,54 +198,89 @@ Matrix4x4 MakeRotateXYZMatrix(const Matrix4x4& matrixX, const Matrix4x4& matrixY
 }
 
 Matrix4x4 MakeRotateMatrix(const Vector3& rotate) {
-	Matrix4x4 rotateXMatrix = MakeRotateXMatrix(rotate.x);
-	Matrix4x4 rotateYMatrix = MakeRotateYMatrix(rotate.y);
-	Matrix4x4 rotateZMatrix = MakeRotateZMatrix(rotate.z);
-
-	return MakeRotateXYZMatrix(rotateXMatrix, rotateYMatrix, rotateZMatrix);
-}
-
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate){
-	Matrix4x4 matrix = MakeIdentity4x4();
-	matrix.m[3][0] = translate.x;
-	matrix.m[3][1] = translate.y;
-	matrix.m[3][2] = translate.z;
-
-	return matrix;
+	return MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, rotate, { 0.0f, 0.0f, 0.0f });
 }
 
-Matrix4x4 MakeScaleMatrix(const Vector3& scale) {
-	Matrix4x4 matrix = {};
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	//3軸分のsinとcosを1回でまとめて求める
+	float sin[4], cos[4];
+	if (GetSimdLevel() != SimdLevel::Scalar) {
+		SinCosSSE4(rotate, sin, cos);
+	} else {
+		SinCos(std::span<const float>(&rotate.x, 3), sin, cos);
+	}
 
-	matrix.m[0][0] = scale.x;
-	matrix.m[1][1] = scale.y;
-	matrix.m[2][2] = scale.z;
-	matrix.m[3][3] = 1;
+	AffineComposeInput input{};
+	for (int axis = 0; axis < 3; axis++) {
+		input.scale[axis] = &scale.x + axis;
+		input.sin[axis] = &sin[axis];
+		input.cos[axis] = &cos[axis];
+		input.translate[axis] = &translate.x + axis;
+	}
 
+	//Scale * RotateX * RotateY * RotateZ * Translateを展開した式で直接書き込む
+	Matrix4x4 matrix;
+	ComposeAffineScalar(input, 1, &matrix);
 	return matrix;
 }
 
-Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
-	Vector3 result = {};
-
-	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + 1.0f * matrix.m[3][0];
-	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + 1.0f * matrix.m[3][1];
-	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + 1.0f * matrix.m[3][2];
-	float w  = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + 1.0f * matrix.m[3][3];
-	assert(w != 0.0f);
-	result.x /= w;
-	result.y /= w;
-	result.z /= w;
+Matrix3x4 MakeAffineMatrix3x4(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	return ToMatrix3x4(MakeAffineMatrix(scale, rotate, translate));
+}
 
-	return result;
+void MakeAffineMatrices(std::span<const TransformStructure> transforms, std::span<Matrix4x4> matrices) {
+	assert(matrices.size() >= transforms.size());
+	const MatrixKernel& kernel = GetMatrixKernel();
+
+	//AoSで渡されたものはブロック単位でSoAに並べ替えてから計算する
+	//回転は軸ごとにcount個ずつ続けて並べ(rotate[axis * count + i])、sinとcosを1回でまとめて求める
+	float scale[3][kComposeBlockSize], rotate[3 * kComposeBlockSize], sin[3 * kComposeBlockSize], cos[3 * kComposeBlockSize], translate[3][kComposeBlockSize];
+	for (size_t first = 0; first < transforms.size(); first += kComposeBlockSize) {
+		size_t count = std::min(kComposeBlockSize, transforms.size() - first);
+		for (size_t i = 0; i < count; i++) {
+			const TransformStructure& transform = transforms[first + i];
+			const float* s = &transform.scale.x;
+			const float* r = &transform.rotate.x;
+			const float* t = &transform.translate.x;
+			for (int axis = 0; axis < 3; axis++) {
+				scale[axis][i] = s[axis];
+				rotate[axis * count + i] = r[axis];
+				translate[axis][i] = t[axis];
+			}
+		}
+		SinCos(std::span<const float>(rotate, 3 * count), sin, cos);
+
+		AffineComposeInput input{};
+		for (int axis = 0; axis < 3; axis++) {
+			input.scale[axis] = scale[axis];
+			input.sin[axis] = sin + axis * count;
+			input.cos[axis] = cos + axis * count;
+			input.translate[axis] = translate[axis];
+		}
+		kernel.composeAffine(input, count, matrices.data() + first);
+	}
 }
 
-Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
-	Matrix4x4 scaleMatrix = MakeScaleMatrix(scale);
-	Matrix4x4 rotateXYZMatrix = MakeRotateMatrix(rotate);
-	Matrix4x4 translateMatrix = MakeTranslateMatrix(translate);
+void MakeAffineMatrices(const TransformStructureSoA& transforms, std::span<Matrix4x4> matrices) {
+	assert(matrices.size() >= transforms.count);
+	const MatrixKernel& kernel = GetMatrixKernel();
+
+	float sin[3][kComposeBlockSize], cos[3][kComposeBlockSize];
+	for (size_t first = 0; first < transforms.count; first += kComposeBlockSize) {
+		size_t count = std::min(kComposeBlockSize, transforms.count - first);
+		for (int axis = 0; axis < 3; axis++) {
+			SinCos(std::span<const float>(transforms.rotate[axis] + first, count), sin[axis], cos[axis]);
+		}
 
-	return Multiply(scaleMatrix, Multiply(rotateXYZMatrix, translateMatrix));
+		AffineComposeInput input{};
+		for (int axis = 0; axis < 3; axis++) {
+			input.scale[axis] = transforms.scale[axis] + first;
+			input.sin[axis] = sin[axis];
+			input.cos[axis] = cos[axis];
+			input.translate[axis] = transforms.translate[axis] + first;
+		}
+		kernel.composeAffine(input, count, matrices.data() + first);
+	}
 }
 
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip) {
@@ -348,30 +296,72 @@ Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip
 	return matrix;
 }
 
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
-	Matrix4x4 matrix = MakeIdentity4x4();
-
-	matrix.m[0][0] = 2.0f / (right - left);
-	matrix.m[1][1] = 2.0f / (top - bottom);
-	matrix.m[2][2] = 1.0f / (farClip - nearClip);
-
-	matrix.m[3][0] = (left + right) / (left - right);
-	matrix.m[3][1] = (top + bottom) / (bottom - top);
-	matrix.m[3][2] = (nearClip) / (nearClip - farClip);
+#pragma region コンパイル時の確認
+//ヘッダーのconstexpr関数が定数式で正しく計算できるかをビルド時に確認する
+namespace {
 
-	return matrix;
+constexpr bool IsEqual(const Matrix4x4& matrix1, const Matrix4x4& matrix2) {
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			if (matrix1.m[row][colmun] != matrix2.m[row][colmun]) {
+				return false;
+			}
+		}
+	}
+	return true;
 }
 
-Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth) {
-	Matrix4x4 matrix = MakeIdentity4x4();
-
-	matrix.m[0][0] = width / 2.0f;
-	matrix.m[1][1] = -1 * (height / 2.0f);
-	matrix.m[2][2] = maxDepth - minDepth;
+constexpr bool IsEqual(const Vector3& v1, const Vector3& v2) {
+	return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
+}
 
-	matrix.m[3][0] = left + width / 2.0f;
-	matrix.m[3][1] = top + height / 2.0f;
-	matrix.m[3][2] = minDepth;
+constexpr Matrix4x4 kTestMatrix = { {
+	{ 1.0f, 2.0f, 3.0f, 4.0f },
+	{ 5.0f, 6.0f, 7.0f, 8.0f },
+	{ 9.0f, 10.0f, 11.0f, 12.0f },
+	{ 13.0f, 14.0f, 15.0f, 16.0f },
+} };
+
+static_assert(IsEqual(Multiply(kTestMatrix, MakeIdentity4x4()), kTestMatrix));
+static_assert(IsEqual(Multiply(MakeIdentity4x4(), kTestMatrix), kTestMatrix));
+static_assert(IsEqual(Transpose(Transpose(kTestMatrix)), kTestMatrix));
+static_assert(Transpose(kTestMatrix).m[0][3] == 13.0f);
+static_assert(Multiply(kTestMatrix, kTestMatrix).m[0][0] == 90.0f);
+static_assert(Multiply(kTestMatrix, kTestMatrix).m[3][3] == 600.0f);
+static_assert(IsEqual(Subtract(Add(kTestMatrix, kTestMatrix), kTestMatrix), kTestMatrix));
+
+//S * Tの順に掛けると、点はスケールしてから移動する
+static_assert(IsEqual(Transform({ 1.0f, 2.0f, 3.0f }, Multiply(MakeScaleMatrix({ 2.0f, 2.0f, 2.0f }), MakeTranslateMatrix({ 1.0f, 0.0f, -1.0f }))), { 3.0f, 4.0f, 5.0f }));
+static_assert(IsEqual(TransformNormal({ 1.0f, 2.0f, 3.0f }, MakeTranslateMatrix({ 5.0f, 5.0f, 5.0f })), { 1.0f, 2.0f, 3.0f }));
+
+//スプライト用の正射影行列は画面の左上が(-1, 1)、右下が(1, -1)になる
+constexpr Matrix4x4 kTestOrthographic = MakeOrthographicMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 100.0f);
+static_assert(IsEqual(Transform({ 0.0f, 0.0f, 0.0f }, kTestOrthographic), { -1.0f, 1.0f, 0.0f }));
+static_assert(IsEqual(Transform({ 1280.0f, 720.0f, 100.0f }, kTestOrthographic), { 1.0f, -1.0f, 1.0f }));
+
+//ビューポート変換で(-1, 1)が画面の左上に戻る
+static_assert(IsEqual(Transform({ -1.0f, 1.0f, 0.0f }, MakeViewportMatrix(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f)), { 0.0f, 0.0f, 0.0f }));
+
+//3x4行列の演算は4x4行列に戻して計算したものと一致する
+constexpr Matrix4x4 kTestAffine1 = Multiply(MakeScaleMatrix({ 2.0f, 3.0f, 4.0f }), MakeTranslateMatrix({ 1.0f, 2.0f, 3.0f }));
+constexpr Matrix4x4 kTestAffine2 = { {
+	{ 0.0f, 1.0f, 0.0f, 0.0f },
+	{ -1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f, 0.0f },
+	{ 5.0f, 6.0f, 7.0f, 1.0f },
+} };
+static_assert(sizeof(Matrix3x4) == 48);
+static_assert(IsEqual(ToMatrix4x4(ToMatrix3x4(kTestAffine2)), kTestAffine2));
+static_assert(IsEqual(ToMatrix4x4(Multiply(ToMatrix3x4(kTestAffine1), ToMatrix3x4(kTestAffine2))), Multiply(kTestAffine1, kTestAffine2)));
+static_assert(IsEqual(Multiply(ToMatrix3x4(kTestAffine1), kTestMatrix), Multiply(kTestAffine1, kTestMatrix)));
+static_assert(IsEqual(Transform({ 1.0f, 2.0f, 3.0f }, ToMatrix3x4(kTestAffine2)), Transform({ 1.0f, 2.0f, 3.0f }, kTestAffine2)));
+static_assert(IsEqual(TransformNormal({ 1.0f, 2.0f, 3.0f }, ToMatrix3x4(kTestAffine2)), TransformNormal({ 1.0f, 2.0f, 3.0f }, kTestAffine2)));
+static_assert(IsEqual(TransformNormal({ 1.0f, 2.0f, 3.0f }, ToMatrix3x3(kTestAffine2)), TransformNormal({ 1.0f, 2.0f, 3.0f }, kTestAffine2)));
+static_assert(IsEqual(ToMatrix4x4(Multiply(ToMatrix3x3(kTestAffine1), ToMatrix3x3(kTestAffine2))), ToMatrix4x4(ToMatrix3x3(Multiply(kTestAffine1, kTestAffine2)))));
+
+static_assert(IsEqual(Cross({ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }), { 0.0f, 0.0f, 1.0f }));
+static_assert(Dot({ 1.0f, 2.0f, 3.0f }, { 4.0f, 5.0f, 6.0f }) == 32.0f);
+static_assert(IsEqual(Vector3{ 1.0f, 2.0f, 3.0f } + Vector3{ 1.0f, 1.0f, 1.0f } * 2.0f, { 3.0f, 4.0f, 5.0f }));
 
-	return matrix;
-}
\ No newline at end of file
+}
+#pragma endregion
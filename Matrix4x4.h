@@ -1,12 +1,15 @@
 #pragma once
 #include "Vector3.h"
+#include "TransformStructure.h"
+#include "Matrix.h"
+#include "Matrix4x4_SIMD.h"
 #include <cmath>
 #include <cassert>
-#include <cmath>
+#include <span>
+#include <type_traits>
 
-struct Matrix4x4 {
-	float m[4][4];
-};
+//頻繁に呼ぶ関数はヘッダーでconstexprとして定義している
+//定数式ではスカラーで計算し、実行時はGetMatrixKernel()で選ばれたSIMD実装を呼ぶ
 
 /// <summary>
 /// 4x4行列の加算
@@ -14,7 +17,19 @@ struct Matrix4x4 {
 /// <param name="matrix1">行列1</param>
 /// <param name="matrix2">行列2</param>
 /// <returns></returns>
-Matrix4x4 Add(Matrix4x4 matrix1, Matrix4x4 matrix2);
+constexpr Matrix4x4 Add(const Matrix4x4& matrix1, const Matrix4x4& matrix2) {
+	Matrix4x4 matrix{};
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				matrix.m[row][colmun] = matrix1.m[row][colmun] + matrix2.m[row][colmun];
+			}
+		}
+	} else {
+		GetMatrixKernel().add(matrix1, matrix2, matrix);
+	}
+	return matrix;
+}
 
 /// <summary>
 /// 4x4行列の減算
@@ -22,7 +37,19 @@ Matrix4x4 Add(Matrix4x4 matrix1, Matrix4x4 matrix2);
 /// <param name="matrix1">行列1</param>
 /// <param name="matrix2">行列2</param>
 /// <returns></returns>
-Matrix4x4 Subtract(Matrix4x4 matrix1, Matrix4x4 matrix2);
+constexpr Matrix4x4 Subtract(const Matrix4x4& matrix1, const Matrix4x4& matrix2) {
+	Matrix4x4 matrix{};
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				matrix.m[row][colmun] = matrix1.m[row][colmun] - matrix2.m[row][colmun];
+			}
+		}
+	} else {
+		GetMatrixKernel().subtract(matrix1, matrix2, matrix);
+	}
+	return matrix;
+}
 
 /// <summary>
 /// 4x4行列の積
@@ -30,34 +57,81 @@ Matrix4x4 Subtract(Matrix4x4 matrix1, Matrix4x4 matrix2);
 /// <param name="matrix1">行列1</param>
 /// <param name="matrix2">行列2</param>
 /// <returns></returns>
-Matrix4x4 Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2);
+constexpr Matrix4x4 Multiply(const Matrix4x4& matrix1, const Matrix4x4& matrix2) {
+	Matrix4x4 matrix{};
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				matrix.m[row][colmun] = matrix1.m[row][0] * matrix2.m[0][colmun] + matrix1.m[row][1] * matrix2.m[1][colmun] + matrix1.m[row][2] * matrix2.m[2][colmun] + matrix1.m[row][3] * matrix2.m[3][colmun];
+			}
+		}
+	} else {
+		GetMatrixKernel().multiply(matrix1, matrix2, matrix);
+	}
+	return matrix;
+}
 
 /// <summary>
 /// 4x4行列の行列式
 /// </summary>
 /// <param name="matrix">行列式を求めたい行列</param>
 /// <returns></returns>
-float Det(Matrix4x4 matrix);
+float Det(const Matrix4x4& matrix);
 
 /// <summary>
 /// 4x4行列の逆行列
 /// </summary>
 /// <param name="matrix">逆行列にしたい行列</param>
 /// <returns></returns>
-Matrix4x4 Inverse(Matrix4x4 matrix);
+Matrix4x4 Inverse(const Matrix4x4& matrix);
+
+/// <summary>
+/// アフィン変換行列の逆行列(3x3部分の逆行列と平行移動だけを計算する)
+/// </summary>
+/// <param name="matrix">4列目が(0, 0, 0, 1)の行列</param>
+/// <returns></returns>
+Matrix4x4 InverseAffine(const Matrix4x4& matrix);
+
+/// <summary>
+/// 回転と平行移動だけの行列の逆行列(回転部分を転置する)
+/// </summary>
+/// <param name="matrix">スケールを含まないアフィン変換行列。カメラのワールド行列など</param>
+/// <returns></returns>
+Matrix4x4 InverseRigid(const Matrix4x4& matrix);
 
 /// <summary>
 /// 4x4行列の転置行列
 /// </summary>
 /// <param name="matrix">転置させたい行列</param>
 /// <returns></returns>
-Matrix4x4 Transpose(Matrix4x4 matrix);
+constexpr Matrix4x4 Transpose(const Matrix4x4& matrix) {
+	Matrix4x4 matrix1{};
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int colmun = 0; colmun < 4; colmun++) {
+				matrix1.m[row][colmun] = matrix.m[colmun][row];
+			}
+		}
+	} else {
+		GetMatrixKernel().transpose(matrix, matrix1);
+	}
+	return matrix1;
+}
 
 /// <summary>
 /// 4x4単位行列の作成
 /// </summary>
 /// <returns></returns>
-Matrix4x4 MakeIdentity4x4();
+constexpr Matrix4x4 MakeIdentity4x4() {
+	Matrix4x4 matrix{};
+
+	matrix.m[0][0] = 1.0f;
+	matrix.m[1][1] = 1.0f;
+	matrix.m[2][2] = 1.0f;
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
 
 Matrix4x4 MakeRotateXMatrix(float radian);
 
@@ -69,16 +143,99 @@ Matrix4x4 MakeRotateXYZMatrix(const Matrix4x4& matrixX, const Matrix4x4& matrixY
 
 Matrix4x4 MakeRotateMatrix(const Vector3& rotate);
 
-Matrix4x4 MakeTranslateMatrix(const Vector3& translate);
+constexpr Matrix4x4 MakeTranslateMatrix(const Vector3& translate) {
+	Matrix4x4 matrix = MakeIdentity4x4();
+	matrix.m[3][0] = translate.x;
+	matrix.m[3][1] = translate.y;
+	matrix.m[3][2] = translate.z;
+
+	return matrix;
+}
 
-Matrix4x4 MakeScaleMatrix(const Vector3& scale);
+constexpr Matrix4x4 MakeScaleMatrix(const Vector3& scale) {
+	Matrix4x4 matrix{};
 
+	matrix.m[0][0] = scale.x;
+	matrix.m[1][1] = scale.y;
+	matrix.m[2][2] = scale.z;
+	matrix.m[3][3] = 1;
+
+	return matrix;
+}
+
+/// <summary>
+/// SRTからアフィン変換行列を作成。Scale * RotateXYZ * Translateを展開した式で直接書き込む
+/// </summary>
+/// <param name="scale">スケール</param>
+/// <param name="rotate">回転(X→Y→Zの順に回す)</param>
+/// <param name="translate">平行移動</param>
+/// <returns></returns>
 Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
 
-Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix);
+/// <summary>
+/// アフィン変換行列を3x4行列で作成。GPUへ送るワールド行列など、4列目が不要な場合に使う
+/// </summary>
+/// <param name="scale">スケール</param>
+/// <param name="rotate">回転(ラジアン)</param>
+/// <param name="translate">平行移動</param>
+/// <returns></returns>
+Matrix3x4 MakeAffineMatrix3x4(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
+
+/// <summary>
+/// 複数のTransformStructureからアフィン変換行列をまとめて作成
+/// 回転のsin, cosはMathFunction.hのSinCosでまとめて求めるので、MakeAffineMatrixとは数ulp違うことがある
+/// </summary>
+/// <param name="transforms">SRTの配列</param>
+/// <param name="matrices">結果の書き込み先。transformsと同じ数が必要</param>
+void MakeAffineMatrices(std::span<const TransformStructure> transforms, std::span<Matrix4x4> matrices);
+
+/// <summary>
+/// SoAで並べたSRTからアフィン変換行列をまとめて作成。SIMDで4つか8つずつ計算する
+/// 回転のsin, cosはMathFunction.hのSinCosでまとめて求める
+/// </summary>
+/// <param name="transforms">要素ごとに並べたSRT</param>
+/// <param name="matrices">結果の書き込み先。transforms.count個が必要</param>
+void MakeAffineMatrices(const TransformStructureSoA& transforms, std::span<Matrix4x4> matrices);
+
+constexpr Vector3 Transform(const Vector3& vector, const Matrix4x4& matrix) {
+	if (std::is_constant_evaluated()) {
+		const float(&m)[4][4] = matrix.m;
+		float w = vector.x * m[0][3] + vector.y * m[1][3] + vector.z * m[2][3] + m[3][3];
+		return {
+			(vector.x * m[0][0] + vector.y * m[1][0] + vector.z * m[2][0] + m[3][0]) / w,
+			(vector.x * m[0][1] + vector.y * m[1][1] + vector.z * m[2][1] + m[3][1]) / w,
+			(vector.x * m[0][2] + vector.y * m[1][2] + vector.z * m[2][2] + m[3][2]) / w
+		};
+	}
+	return GetMatrixKernel().transform(vector, matrix);
+}
 
 Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farClip);
 
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip);
+constexpr Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
+	Matrix4x4 matrix = MakeIdentity4x4();
+
+	matrix.m[0][0] = 2.0f / (right - left);
+	matrix.m[1][1] = 2.0f / (top - bottom);
+	matrix.m[2][2] = 1.0f / (farClip - nearClip);
+
+	matrix.m[3][0] = (left + right) / (left - right);
+	matrix.m[3][1] = (top + bottom) / (bottom - top);
+	matrix.m[3][2] = (nearClip) / (nearClip - farClip);
+
+	return matrix;
+}
+
+constexpr Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth) {
+	Matrix4x4 matrix = MakeIdentity4x4();
+
+	matrix.m[0][0] = width / 2.0f;
+	matrix.m[1][1] = -1 * (height / 2.0f);
+	matrix.m[2][2] = maxDepth - minDepth;
+
+	matrix.m[3][0] = left + width / 2.0f;
+	matrix.m[3][1] = top + height / 2.0f;
+	matrix.m[3][2] = minDepth;
 
-Matrix4x4 MakeViewportMatrix(float left, float top, float width, float height, float minDepth, float maxDepth);
\ No newline at end of file
+	return matrix;
+}
\ No newline at end of file
@@ -0,0 +1,463 @@
+#include "Matrix4x4_SIMD.h"
+#include "Matrix4x4.h"
+#include <immintrin.h>
+
+namespace {
+
+#pragma region スカラー実装
+void AddScalar(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			result.m[row][colmun] = matrix1.m[row][colmun] + matrix2.m[row][colmun];
+		}
+	}
+}
+
+void SubtractScalar(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			result.m[row][colmun] = matrix1.m[row][colmun] - matrix2.m[row][colmun];
+		}
+	}
+}
+
+void MultiplyScalar(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	//resultとmatrix1,2が同じ場合があるので一度ローカルで計算する
+	Matrix4x4 matrix = {};
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			matrix.m[row][colmun] = matrix1.m[row][0] * matrix2.m[0][colmun] + matrix1.m[row][1] * matrix2.m[1][colmun]
+				+ matrix1.m[row][2] * matrix2.m[2][colmun] + matrix1.m[row][3] * matrix2.m[3][colmun];
+		}
+	}
+	result = matrix;
+}
+
+void TransposeScalar(const Matrix4x4& matrix, Matrix4x4& result) {
+	Matrix4x4 matrix1 = {};
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			matrix1.m[row][colmun] = matrix.m[colmun][row];
+		}
+	}
+	result = matrix1;
+}
+
+Vector3 TransformScalar(const Vector3& vector, const Matrix4x4& matrix) {
+	Vector3 result = {};
+
+	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + 1.0f * matrix.m[3][0];
+	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + 1.0f * matrix.m[3][1];
+	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + 1.0f * matrix.m[3][2];
+	float w  = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + 1.0f * matrix.m[3][3];
+	assert(w != 0.0f);
+	result.x /= w;
+	result.y /= w;
+	result.z /= w;
+
+	return result;
+}
+
+void Multiply3x4Scalar(const Matrix3x4& matrix1, const Matrix3x4& matrix2, Matrix3x4& result) {
+	Matrix3x4 matrix;
+	for (int row = 0; row < 3; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			float value = colmun == 3 ? matrix2.m[row][3] : 0.0f;
+			for (int i = 0; i < 3; i++) {
+				value += matrix2.m[row][i] * matrix1.m[i][colmun];
+			}
+			matrix.m[row][colmun] = value;
+		}
+	}
+	result = matrix;
+}
+
+void Multiply3x4By4x4Scalar(const Matrix3x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	Matrix4x4 matrix;
+	for (int row = 0; row < 4; row++) {
+		for (int colmun = 0; colmun < 4; colmun++) {
+			float value = row == 3 ? matrix2.m[3][colmun] : 0.0f;
+			for (int i = 0; i < 3; i++) {
+				value += matrix1.m[i][row] * matrix2.m[i][colmun];
+			}
+			matrix.m[row][colmun] = value;
+		}
+	}
+	result = matrix;
+}
+#pragma endregion
+
+#pragma region SSE4実装
+SIMD_TARGET_SSE4 void AddSSE4(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		_mm_storeu_ps(result.m[row], _mm_add_ps(_mm_loadu_ps(matrix1.m[row]), _mm_loadu_ps(matrix2.m[row])));
+	}
+}
+
+SIMD_TARGET_SSE4 void SubtractSSE4(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		_mm_storeu_ps(result.m[row], _mm_sub_ps(_mm_loadu_ps(matrix1.m[row]), _mm_loadu_ps(matrix2.m[row])));
+	}
+}
+
+SIMD_TARGET_SSE4 void MultiplySSE4(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	__m128 b0 = _mm_loadu_ps(matrix2.m[0]);
+	__m128 b1 = _mm_loadu_ps(matrix2.m[1]);
+	__m128 b2 = _mm_loadu_ps(matrix2.m[2]);
+	__m128 b3 = _mm_loadu_ps(matrix2.m[3]);
+
+	//先に全行を読んでおくとresultとmatrix1が同じでも問題ない
+	__m128 a[4];
+	for (int row = 0; row < 4; row++) {
+		a[row] = _mm_loadu_ps(matrix1.m[row]);
+	}
+	for (int row = 0; row < 4; row++) {
+		//行の各要素をブロードキャストしてmatrix2の行に掛けていく(スカラー実装と同じ加算順)
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(a[row], a[row], _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a[row], a[row], _MM_SHUFFLE(1, 1, 1, 1)), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a[row], a[row], _MM_SHUFFLE(2, 2, 2, 2)), b2));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a[row], a[row], _MM_SHUFFLE(3, 3, 3, 3)), b3));
+		_mm_storeu_ps(result.m[row], r);
+	}
+}
+
+SIMD_TARGET_SSE4 void TransposeSSE4(const Matrix4x4& matrix, Matrix4x4& result) {
+	__m128 row0 = _mm_loadu_ps(matrix.m[0]);
+	__m128 row1 = _mm_loadu_ps(matrix.m[1]);
+	__m128 row2 = _mm_loadu_ps(matrix.m[2]);
+	__m128 row3 = _mm_loadu_ps(matrix.m[3]);
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	_mm_storeu_ps(result.m[0], row0);
+	_mm_storeu_ps(result.m[1], row1);
+	_mm_storeu_ps(result.m[2], row2);
+	_mm_storeu_ps(result.m[3], row3);
+}
+
+SIMD_TARGET_SSE4 Vector3 TransformSSE4(const Vector3& vector, const Matrix4x4& matrix) {
+	__m128 r = _mm_mul_ps(_mm_set1_ps(vector.x), _mm_loadu_ps(matrix.m[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vector.y), _mm_loadu_ps(matrix.m[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vector.z), _mm_loadu_ps(matrix.m[2])));
+	r = _mm_add_ps(r, _mm_loadu_ps(matrix.m[3]));
+	__m128 w = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3));
+	assert(_mm_cvtss_f32(w) != 0.0f);
+	r = _mm_div_ps(r, w);
+
+	alignas(16) float result[4];
+	_mm_store_ps(result, r);
+	return { result[0], result[1], result[2] };
+}
+
+SIMD_TARGET_SSE4 void ComposeAffineSSE4(const AffineComposeInput& input, size_t count, Matrix4x4* result) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	size_t i = 0;
+	//4つずつSoAのまま計算して、最後に4x4転置で各行列の行に並べ替える
+	for (; i + 4 <= count; i += 4) {
+		__m128 sinX = _mm_loadu_ps(input.sin[0] + i), sinY = _mm_loadu_ps(input.sin[1] + i), sinZ = _mm_loadu_ps(input.sin[2] + i);
+		__m128 cosX = _mm_loadu_ps(input.cos[0] + i), cosY = _mm_loadu_ps(input.cos[1] + i), cosZ = _mm_loadu_ps(input.cos[2] + i);
+		__m128 scaleX = _mm_loadu_ps(input.scale[0] + i), scaleY = _mm_loadu_ps(input.scale[1] + i), scaleZ = _mm_loadu_ps(input.scale[2] + i);
+		__m128 sinXsinY = _mm_mul_ps(sinX, sinY);
+		__m128 cosXsinY = _mm_mul_ps(cosX, sinY);
+
+		__m128 row0[4] = {
+			_mm_mul_ps(scaleX, _mm_mul_ps(cosY, cosZ)),
+			_mm_mul_ps(scaleX, _mm_mul_ps(cosY, sinZ)),
+			_mm_mul_ps(scaleX, _mm_sub_ps(zero, sinY)),
+			zero };
+		__m128 row1[4] = {
+			_mm_mul_ps(scaleY, _mm_sub_ps(_mm_mul_ps(sinXsinY, cosZ), _mm_mul_ps(cosX, sinZ))),
+			_mm_mul_ps(scaleY, _mm_add_ps(_mm_mul_ps(sinXsinY, sinZ), _mm_mul_ps(cosX, cosZ))),
+			_mm_mul_ps(scaleY, _mm_mul_ps(sinX, cosY)),
+			zero };
+		__m128 row2[4] = {
+			_mm_mul_ps(scaleZ, _mm_add_ps(_mm_mul_ps(cosXsinY, cosZ), _mm_mul_ps(sinX, sinZ))),
+			_mm_mul_ps(scaleZ, _mm_sub_ps(_mm_mul_ps(cosXsinY, sinZ), _mm_mul_ps(sinX, cosZ))),
+			_mm_mul_ps(scaleZ, _mm_mul_ps(cosX, cosY)),
+			zero };
+		__m128 row3[4] = {
+			_mm_loadu_ps(input.translate[0] + i),
+			_mm_loadu_ps(input.translate[1] + i),
+			_mm_loadu_ps(input.translate[2] + i),
+			one };
+
+		__m128* rows[4] = { row0, row1, row2, row3 };
+		for (int row = 0; row < 4; row++) {
+			__m128* r = rows[row];
+			_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+			for (int lane = 0; lane < 4; lane++) {
+				_mm_storeu_ps(result[i + lane].m[row], r[lane]);
+			}
+		}
+	}
+
+	AffineComposeInput rest = input;
+	for (int axis = 0; axis < 3; axis++) {
+		rest.scale[axis] += i;
+		rest.sin[axis] += i;
+		rest.cos[axis] += i;
+		rest.translate[axis] += i;
+	}
+	ComposeAffineScalar(rest, count - i, result + i);
+}
+
+SIMD_TARGET_SSE4 void Multiply3x4SSE4(const Matrix3x4& matrix1, const Matrix3x4& matrix2, Matrix3x4& result) {
+	__m128 a0 = _mm_loadu_ps(matrix1.m[0]);
+	__m128 a1 = _mm_loadu_ps(matrix1.m[1]);
+	__m128 a2 = _mm_loadu_ps(matrix1.m[2]);
+	__m128 b[3] = { _mm_loadu_ps(matrix2.m[0]), _mm_loadu_ps(matrix2.m[1]), _mm_loadu_ps(matrix2.m[2]) };
+	//(0, 0, 0, 1)の行の代わりに、matrix2の平行移動だけを残した値から足し始める
+	const __m128 zero = _mm_setzero_ps();
+	for (int row = 0; row < 3; row++) {
+		__m128 r = _mm_blend_ps(zero, b[row], 0b1000);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(b[row], b[row], _MM_SHUFFLE(0, 0, 0, 0)), a0));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(b[row], b[row], _MM_SHUFFLE(1, 1, 1, 1)), a1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(b[row], b[row], _MM_SHUFFLE(2, 2, 2, 2)), a2));
+		_mm_storeu_ps(result.m[row], r);
+	}
+}
+
+SIMD_TARGET_SSE4 void Multiply3x4By4x4SSE4(const Matrix3x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	__m128 b0 = _mm_loadu_ps(matrix2.m[0]);
+	__m128 b1 = _mm_loadu_ps(matrix2.m[1]);
+	__m128 b2 = _mm_loadu_ps(matrix2.m[2]);
+	__m128 b3 = _mm_loadu_ps(matrix2.m[3]);
+	//matrix1は転置して持っているので、結果のrow行目の係数はmatrix1のrow列目
+	const __m128 zero = _mm_setzero_ps();
+	__m128 columns[4] = { _mm_loadu_ps(matrix1.m[0]), _mm_loadu_ps(matrix1.m[1]), _mm_loadu_ps(matrix1.m[2]), zero };
+	_MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+	for (int row = 0; row < 4; row++) {
+		__m128 r = row == 3 ? b3 : zero;
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(columns[row], columns[row], _MM_SHUFFLE(0, 0, 0, 0)), b0));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(columns[row], columns[row], _MM_SHUFFLE(1, 1, 1, 1)), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(columns[row], columns[row], _MM_SHUFFLE(2, 2, 2, 2)), b2));
+		_mm_storeu_ps(result.m[row], r);
+	}
+}
+#pragma endregion
+
+#pragma region AVX2実装
+SIMD_TARGET_AVX2 void AddAVX2(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	__m256 r01 = _mm256_add_ps(_mm256_loadu_ps(matrix1.m[0]), _mm256_loadu_ps(matrix2.m[0]));
+	__m256 r23 = _mm256_add_ps(_mm256_loadu_ps(matrix1.m[2]), _mm256_loadu_ps(matrix2.m[2]));
+	_mm256_storeu_ps(result.m[0], r01);
+	_mm256_storeu_ps(result.m[2], r23);
+}
+
+SIMD_TARGET_AVX2 void SubtractAVX2(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	__m256 r01 = _mm256_sub_ps(_mm256_loadu_ps(matrix1.m[0]), _mm256_loadu_ps(matrix2.m[0]));
+	__m256 r23 = _mm256_sub_ps(_mm256_loadu_ps(matrix1.m[2]), _mm256_loadu_ps(matrix2.m[2]));
+	_mm256_storeu_ps(result.m[0], r01);
+	_mm256_storeu_ps(result.m[2], r23);
+}
+
+SIMD_TARGET_AVX2 void MultiplyAVX2(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	//matrix2の各行を上下両方のレーンに複製しておき、2行ずつ計算する
+	__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[0]));
+	__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[1]));
+	__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[2]));
+	__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[3]));
+
+	__m256 a01 = _mm256_loadu_ps(matrix1.m[0]);
+	__m256 a23 = _mm256_loadu_ps(matrix1.m[2]);
+
+	__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+	__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(1, 1, 1, 1)), b1, r01);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(1, 1, 1, 1)), b1, r23);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(2, 2, 2, 2)), b2, r01);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(2, 2, 2, 2)), b2, r23);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(3, 3, 3, 3)), b3, r01);
+	r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(3, 3, 3, 3)), b3, r23);
+
+	_mm256_storeu_ps(result.m[0], r01);
+	_mm256_storeu_ps(result.m[2], r23);
+}
+
+SIMD_TARGET_AVX2 Vector3 TransformAVX2(const Vector3& vector, const Matrix4x4& matrix) {
+	__m128 r = _mm_fmadd_ps(_mm_set1_ps(vector.x), _mm_loadu_ps(matrix.m[0]), _mm_loadu_ps(matrix.m[3]));
+	r = _mm_fmadd_ps(_mm_set1_ps(vector.y), _mm_loadu_ps(matrix.m[1]), r);
+	r = _mm_fmadd_ps(_mm_set1_ps(vector.z), _mm_loadu_ps(matrix.m[2]), r);
+	__m128 w = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3));
+	assert(_mm_cvtss_f32(w) != 0.0f);
+	r = _mm_div_ps(r, w);
+
+	alignas(16) float result[4];
+	_mm_store_ps(result, r);
+	return { result[0], result[1], result[2] };
+}
+
+/// <summary>
+/// 8レーン分の(a, b, c, d)を転置して、8つの行列の指定した行に書き込む
+/// </summary>
+SIMD_TARGET_AVX2 void StoreRowsAVX2(__m256 a, __m256 b, __m256 c, __m256 d, Matrix4x4* result, int row) {
+	__m256 t0 = _mm256_unpacklo_ps(a, b);
+	__m256 t1 = _mm256_unpackhi_ps(a, b);
+	__m256 t2 = _mm256_unpacklo_ps(c, d);
+	__m256 t3 = _mm256_unpackhi_ps(c, d);
+	__m256 r[4] = {
+		_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+		_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)) };
+	for (int lane = 0; lane < 4; lane++) {
+		_mm_storeu_ps(result[lane].m[row], _mm256_castps256_ps128(r[lane]));
+		_mm_storeu_ps(result[lane + 4].m[row], _mm256_extractf128_ps(r[lane], 1));
+	}
+}
+
+SIMD_TARGET_AVX2 void ComposeAffineAVX2(const AffineComposeInput& input, size_t count, Matrix4x4* result) {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 sinX = _mm256_loadu_ps(input.sin[0] + i), sinY = _mm256_loadu_ps(input.sin[1] + i), sinZ = _mm256_loadu_ps(input.sin[2] + i);
+		__m256 cosX = _mm256_loadu_ps(input.cos[0] + i), cosY = _mm256_loadu_ps(input.cos[1] + i), cosZ = _mm256_loadu_ps(input.cos[2] + i);
+		__m256 scaleX = _mm256_loadu_ps(input.scale[0] + i), scaleY = _mm256_loadu_ps(input.scale[1] + i), scaleZ = _mm256_loadu_ps(input.scale[2] + i);
+		__m256 sinXsinY = _mm256_mul_ps(sinX, sinY);
+		__m256 cosXsinY = _mm256_mul_ps(cosX, sinY);
+
+		StoreRowsAVX2(
+			_mm256_mul_ps(scaleX, _mm256_mul_ps(cosY, cosZ)),
+			_mm256_mul_ps(scaleX, _mm256_mul_ps(cosY, sinZ)),
+			_mm256_mul_ps(scaleX, _mm256_sub_ps(zero, sinY)),
+			zero, result + i, 0);
+		StoreRowsAVX2(
+			_mm256_mul_ps(scaleY, _mm256_fmsub_ps(sinXsinY, cosZ, _mm256_mul_ps(cosX, sinZ))),
+			_mm256_mul_ps(scaleY, _mm256_fmadd_ps(sinXsinY, sinZ, _mm256_mul_ps(cosX, cosZ))),
+			_mm256_mul_ps(scaleY, _mm256_mul_ps(sinX, cosY)),
+			zero, result + i, 1);
+		StoreRowsAVX2(
+			_mm256_mul_ps(scaleZ, _mm256_fmadd_ps(cosXsinY, cosZ, _mm256_mul_ps(sinX, sinZ))),
+			_mm256_mul_ps(scaleZ, _mm256_fmsub_ps(cosXsinY, sinZ, _mm256_mul_ps(sinX, cosZ))),
+			_mm256_mul_ps(scaleZ, _mm256_mul_ps(cosX, cosY)),
+			zero, result + i, 2);
+		StoreRowsAVX2(
+			_mm256_loadu_ps(input.translate[0] + i),
+			_mm256_loadu_ps(input.translate[1] + i),
+			_mm256_loadu_ps(input.translate[2] + i),
+			one, result + i, 3);
+	}
+
+	//YMMの上位を汚したままSSE命令を実行すると大きなペナルティがかかるので、SSE4の処理に移る前にクリアする
+	_mm256_zeroupper();
+
+	//8つに満たない残りはSSE4でまとめる
+	AffineComposeInput rest = input;
+	for (int axis = 0; axis < 3; axis++) {
+		rest.scale[axis] += i;
+		rest.sin[axis] += i;
+		rest.cos[axis] += i;
+		rest.translate[axis] += i;
+	}
+	ComposeAffineSSE4(rest, count - i, result + i);
+}
+
+SIMD_TARGET_AVX2 void Multiply3x4AVX2(const Matrix3x4& matrix1, const Matrix3x4& matrix2, Matrix3x4& result) {
+	//matrix1の各行を上下両方のレーンに複製し、結果の0,1行目を256bitで、2行目を128bitで計算する
+	__m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix1.m[0]));
+	__m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix1.m[1]));
+	__m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix1.m[2]));
+	__m256 b01 = _mm256_loadu_ps(matrix2.m[0]);
+	__m128 b2 = _mm_loadu_ps(matrix2.m[2]);
+
+	__m256 r01 = _mm256_blend_ps(_mm256_setzero_ps(), b01, 0b10001000);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(0, 0, 0, 0)), a0, r01);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(1, 1, 1, 1)), a1, r01);
+	r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 2, 2, 2)), a2, r01);
+
+	__m128 r2 = _mm_blend_ps(_mm_setzero_ps(), b2, 0b1000);
+	r2 = _mm_fmadd_ps(_mm_shuffle_ps(b2, b2, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_castps256_ps128(a0), r2);
+	r2 = _mm_fmadd_ps(_mm_shuffle_ps(b2, b2, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_castps256_ps128(a1), r2);
+	r2 = _mm_fmadd_ps(_mm_shuffle_ps(b2, b2, _MM_SHUFFLE(2, 2, 2, 2)), _mm256_castps256_ps128(a2), r2);
+
+	_mm256_storeu_ps(result.m[0], r01);
+	_mm_storeu_ps(result.m[2], r2);
+}
+
+SIMD_TARGET_AVX2 void Multiply3x4By4x4AVX2(const Matrix3x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[0]));
+	__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[1]));
+	__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[2]));
+	__m128 b3 = _mm_loadu_ps(matrix2.m[3]);
+
+	//結果のrow行目の係数はmatrix1のrow列目なので、下位レーンにrow列目、上位レーンにrow+1列目の要素を並べる
+	const __m256i index01 = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+	const __m256i index23 = _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3);
+	__m256 a0 = _mm256_castps128_ps256(_mm_loadu_ps(matrix1.m[0]));
+	__m256 a1 = _mm256_castps128_ps256(_mm_loadu_ps(matrix1.m[1]));
+	__m256 a2 = _mm256_castps128_ps256(_mm_loadu_ps(matrix1.m[2]));
+
+	__m256 r01 = _mm256_mul_ps(_mm256_permutevar8x32_ps(a0, index01), b0);
+	__m256 r23 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(a0, index23), b0, _mm256_insertf128_ps(_mm256_setzero_ps(), b3, 1));
+	r01 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(a1, index01), b1, r01);
+	r23 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(a1, index23), b1, r23);
+	r01 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(a2, index01), b2, r01);
+	r23 = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(a2, index23), b2, r23);
+
+	_mm256_storeu_ps(result.m[0], r01);
+	_mm256_storeu_ps(result.m[2], r23);
+}
+#pragma endregion
+
+const MatrixKernel kScalarKernel = {
+	AddScalar, SubtractScalar, MultiplyScalar, TransposeScalar, TransformScalar, ComposeAffineScalar,
+	Multiply3x4Scalar, Multiply3x4By4x4Scalar
+};
+
+const MatrixKernel kSSE4Kernel = {
+	AddSSE4, SubtractSSE4, MultiplySSE4, TransposeSSE4, TransformSSE4, ComposeAffineSSE4,
+	Multiply3x4SSE4, Multiply3x4By4x4SSE4
+};
+
+//転置は256bitにしても速くならないのでSSE4のものを使う
+const MatrixKernel kAVX2Kernel = {
+	AddAVX2, SubtractAVX2, MultiplyAVX2, TransposeSSE4, TransformAVX2, ComposeAffineAVX2,
+	Multiply3x4AVX2, Multiply3x4By4x4AVX2
+};
+
+}
+
+void ComposeAffineScalar(const AffineComposeInput& input, size_t count, Matrix4x4* result) {
+	for (size_t i = 0; i < count; i++) {
+		float sinX = input.sin[0][i], sinY = input.sin[1][i], sinZ = input.sin[2][i];
+		float cosX = input.cos[0][i], cosY = input.cos[1][i], cosZ = input.cos[2][i];
+		float scaleX = input.scale[0][i], scaleY = input.scale[1][i], scaleZ = input.scale[2][i];
+		Matrix4x4& matrix = result[i];
+
+		matrix.m[0][0] = scaleX * (cosY * cosZ);
+		matrix.m[0][1] = scaleX * (cosY * sinZ);
+		matrix.m[0][2] = scaleX * -sinY;
+		matrix.m[0][3] = 0.0f;
+
+		matrix.m[1][0] = scaleY * (sinX * sinY * cosZ - cosX * sinZ);
+		matrix.m[1][1] = scaleY * (sinX * sinY * sinZ + cosX * cosZ);
+		matrix.m[1][2] = scaleY * (sinX * cosY);
+		matrix.m[1][3] = 0.0f;
+
+		matrix.m[2][0] = scaleZ * (cosX * sinY * cosZ + sinX * sinZ);
+		matrix.m[2][1] = scaleZ * (cosX * sinY * sinZ - sinX * cosZ);
+		matrix.m[2][2] = scaleZ * (cosX * cosY);
+		matrix.m[2][3] = 0.0f;
+
+		matrix.m[3][0] = input.translate[0][i];
+		matrix.m[3][1] = input.translate[1][i];
+		matrix.m[3][2] = input.translate[2][i];
+		matrix.m[3][3] = 1.0f;
+	}
+}
+
+const MatrixKernel& GetMatrixKernel() {
+	static const MatrixKernel& kernel = GetMatrixKernel(GetSimdLevel());
+	return kernel;
+}
+
+const MatrixKernel& GetMatrixKernel(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::AVX2:
+		return kAVX2Kernel;
+	case SimdLevel::SSE4:
+		return kSSE4Kernel;
+	default:
+		return kScalarKernel;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "CpuFeature.h"
+#include <cstddef>
+
+//Matrix4x4.hのconstexpr関数から実行時にこのテーブルを呼ぶので、ここではMatrix4x4.hをインクルードしない
+struct Vector3;
+template<int Row, int Colmun>
+struct Matrix;
+using Matrix3x4 = Matrix<3, 4>;
+using Matrix4x4 = Matrix<4, 4>;
+
+//4x4行列演算のSIMD実装
+//起動時にCPUIDで選んだ実装をMatrix4x4.hのAdd/Subtract/Multiply/Transpose/Transformと、Matrix.hの3x4行列のMultiplyから呼ぶ
+//(定数式のときはスカラーで計算する)
+//
+//スカラー実装との誤差(Benchmarkの--accuracyで確認できる)
+// Add/Subtract/Transpose : 全段階でスカラー実装とビット一致
+// Multiply/Transform     : SSE4はスカラー実装と同じ順番で乗算・加算するのでビット一致(3x4行列のMultiplyも同じ)
+//                          AVX2はFMAで丸めが1回減るため、各要素の誤差は Σ|a*b| の 4ulp 以内
+
+/// <summary>
+/// アフィン変換行列をまとめて作るための入力。sin/cosは呼び出し側で計算しておく
+/// </summary>
+struct AffineComposeInput {
+	const float* scale[3];
+	const float* sin[3];
+	const float* cos[3];
+	const float* translate[3];
+};
+
+/// <summary>
+/// 行列演算の実装をまとめたテーブル
+/// </summary>
+struct MatrixKernel {
+	void (*add)(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result);
+	void (*subtract)(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result);
+	void (*multiply)(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result);
+	void (*transpose)(const Matrix4x4& matrix, Matrix4x4& result);
+	Vector3 (*transform)(const Vector3& vector, const Matrix4x4& matrix);
+	void (*composeAffine)(const AffineComposeInput& input, size_t count, Matrix4x4* result);
+	void (*multiply3x4)(const Matrix3x4& matrix1, const Matrix3x4& matrix2, Matrix3x4& result);
+	void (*multiply3x4By4x4)(const Matrix3x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result);
+};
+
+/// <summary>
+/// 起動時に選ばれた行列演算の実装を取得
+/// </summary>
+/// <returns></returns>
+const MatrixKernel& GetMatrixKernel();
+
+/// <summary>
+/// 命令セットを指定して行列演算の実装を取得(ベンチマークや比較用)
+/// </summary>
+/// <param name="level">命令セットの段階。CPUが対応していない段階を指定してはいけない</param>
+/// <returns></returns>
+const MatrixKernel& GetMatrixKernel(SimdLevel level);
+
+/// <summary>
+/// スカラー実装でアフィン変換行列を作る。1つだけ作るときに関数ポインタを通さずに呼ぶためのもの
+/// </summary>
+/// <param name="input">スケール・sin/cos・平行移動</param>
+/// <param name="count">作る数</param>
+/// <param name="result">書き込み先</param>
+void ComposeAffineScalar(const AffineComposeInput& input, size_t count, Matrix4x4* result);
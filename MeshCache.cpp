@@ -0,0 +1,390 @@
+#include "MeshCache.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader> && std::is_trivially_copyable_v<VertexData> && std::is_trivially_copyable_v<Meshlet> &&
+	std::is_trivially_copyable_v<NormalCone> && std::is_trivially_copyable_v<MeshCacheLevel>, "キャッシュの構造体はそのままファイルに書く");
+
+namespace {
+
+constexpr size_t kSectionCount = static_cast<size_t>(MeshCacheSection::Count);
+
+//xxHash64と同じ定数と混ぜ方
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+uint64_t Round(uint64_t accumulator, uint64_t word) {
+	accumulator += word * kPrime2;
+	accumulator = std::rotl(accumulator, 31);
+	return accumulator * kPrime1;
+}
+
+uint64_t ReadWord(const std::byte* data) {
+	uint64_t word;
+	std::memcpy(&word, data, sizeof(word));
+	return word;
+}
+
+size_t AlignUp(size_t offset) {
+	return (offset + kMeshCacheAlignment - 1) & ~(kMeshCacheAlignment - 1);
+}
+
+/// <summary>
+/// セクションの数から、ヘッダーに書くべき大きさを求める
+/// </summary>
+void GetSectionSizes(size_t vertexCount, size_t indexCount, size_t indexSize, size_t meshletCount, size_t levelCount,
+	uint64_t (&sizes)[kSectionCount]) {
+	sizes[static_cast<size_t>(MeshCacheSection::Vertices)] = sizeof(VertexData) * vertexCount;
+	sizes[static_cast<size_t>(MeshCacheSection::Indices)] = indexSize * indexCount;
+	sizes[static_cast<size_t>(MeshCacheSection::Meshlets)] = sizeof(Meshlet) * meshletCount;
+	sizes[static_cast<size_t>(MeshCacheSection::MeshletSpheres)] = sizeof(float) * 4 * meshletCount;
+	sizes[static_cast<size_t>(MeshCacheSection::MeshletCones)] = sizeof(NormalCone) * meshletCount;
+	sizes[static_cast<size_t>(MeshCacheSection::Levels)] = sizeof(MeshCacheLevel) * levelCount;
+}
+
+const MeshCacheRange& GetSection(const MeshCacheHeader& header, MeshCacheSection section) {
+	return header.sections[static_cast<size_t>(section)];
+}
+
+/// <summary>
+/// インデックスがすべて頂点数より小さいか。最大値を求めるだけの1回の走査なので、ハッシュを確かめるより軽い
+/// </summary>
+template<class Index>
+bool AreIndicesInRange(const std::byte* data, size_t indexCount, uint32_t vertexCount) {
+	const Index* indices = reinterpret_cast<const Index*>(data);
+	Index maxIndex = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		maxIndex = std::max(maxIndex, indices[i]);
+	}
+	return indexCount == 0 || maxIndex < vertexCount;
+}
+
+}
+
+uint64_t HashBytes(std::span<const std::byte> bytes, uint64_t seed) {
+	const std::byte* data = bytes.data();
+	const std::byte* end = data + bytes.size();
+	uint64_t hash;
+	if (bytes.size() >= 32) {
+		//4列は互いに依存しないので、掛け算の待ち時間が重なる
+		uint64_t lanes[4] = { seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1 };
+		for (; end - data >= 32; data += 32) {
+			lanes[0] = Round(lanes[0], ReadWord(data));
+			lanes[1] = Round(lanes[1], ReadWord(data + 8));
+			lanes[2] = Round(lanes[2], ReadWord(data + 16));
+			lanes[3] = Round(lanes[3], ReadWord(data + 24));
+		}
+		hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+	} else {
+		hash = seed + kPrime5;
+	}
+	hash += bytes.size();
+	for (; end - data >= 8; data += 8) {
+		hash ^= Round(0, ReadWord(data));
+		hash = std::rotl(hash, 27) * kPrime1 + kPrime4;
+	}
+	for (; data < end; data++) {
+		hash ^= static_cast<uint64_t>(*data) * kPrime5;
+		hash = std::rotl(hash, 11) * kPrime1;
+	}
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64_t MakeFileStamp(const std::filesystem::path& path) {
+	std::error_code error;
+	const uintmax_t size = std::filesystem::file_size(path, error);
+	if (error) {
+		return 0;
+	}
+	const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+	if (error) {
+		return 0;
+	}
+	const uint64_t values[2] = { static_cast<uint64_t>(size), static_cast<uint64_t>(writeTime.time_since_epoch().count()) };
+	const uint64_t stamp = HashBytes(std::as_bytes(std::span(values)));
+	//0は「ファイルがない」に使うので避ける
+	return stamp != 0 ? stamp : 1;
+}
+
+std::vector<std::byte> SerializeMeshCache(uint64_t sourceKey, std::span<const VertexData> vertices, const MeshletData& meshlets,
+	std::span<const MeshCacheLevel> levels) {
+	assert(vertices.size() <= UINT32_MAX && meshlets.indices.size() <= UINT32_MAX && !levels.empty());
+	const size_t meshletCount = meshlets.meshlets.size();
+	const bool isIndex16 = CanUse16BitIndices(vertices.size());
+
+	MeshCacheHeader header{};
+	header.magic = kMeshCacheMagic;
+	header.version = kMeshCacheVersion;
+	header.sourceKey = sourceKey;
+	header.vertexCount = static_cast<uint32_t>(vertices.size());
+	header.indexCount = static_cast<uint32_t>(meshlets.indices.size());
+	header.indexSize = isIndex16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	header.meshletCount = static_cast<uint32_t>(meshletCount);
+	header.levelCount = static_cast<uint32_t>(levels.size());
+	header.bounds = ComputeAABB(vertices);
+	header.boundingSphere = ComputeBoundingSphere(vertices);
+	uint64_t sizes[kSectionCount];
+	GetSectionSizes(vertices.size(), meshlets.indices.size(), header.indexSize, meshletCount, levels.size(), sizes);
+	size_t offset = AlignUp(sizeof(MeshCacheHeader));
+	for (size_t section = 0; section < kSectionCount; section++) {
+		header.sections[section] = { offset, sizes[section] };
+		header.fileSize = offset + sizes[section];
+		offset = AlignUp(static_cast<size_t>(header.fileSize));
+	}
+
+	//隙間を0で埋めておくと、同じメッシュからは同じファイルになる
+	std::vector<std::byte> image(static_cast<size_t>(header.fileSize));
+	auto sectionData = [&](MeshCacheSection section) { return image.data() + GetSection(header, section).offset; };
+	std::memcpy(sectionData(MeshCacheSection::Vertices), vertices.data(), vertices.size_bytes());
+	if (isIndex16) {
+		uint16_t* indices16 = reinterpret_cast<uint16_t*>(sectionData(MeshCacheSection::Indices));
+		for (size_t i = 0; i < meshlets.indices.size(); i++) {
+			indices16[i] = static_cast<uint16_t>(meshlets.indices[i]);
+		}
+	} else {
+		std::memcpy(sectionData(MeshCacheSection::Indices), meshlets.indices.data(), sizeof(uint32_t) * meshlets.indices.size());
+	}
+	std::memcpy(sectionData(MeshCacheSection::Meshlets), meshlets.meshlets.data(), sizeof(Meshlet) * meshletCount);
+	std::byte* spheres = sectionData(MeshCacheSection::MeshletSpheres);
+	std::memcpy(spheres, meshlets.centerX.data(), sizeof(float) * meshletCount);
+	std::memcpy(spheres + sizeof(float) * meshletCount, meshlets.centerY.data(), sizeof(float) * meshletCount);
+	std::memcpy(spheres + sizeof(float) * meshletCount * 2, meshlets.centerZ.data(), sizeof(float) * meshletCount);
+	std::memcpy(spheres + sizeof(float) * meshletCount * 3, meshlets.radius.data(), sizeof(float) * meshletCount);
+	std::memcpy(sectionData(MeshCacheSection::MeshletCones), meshlets.cones.data(), sizeof(NormalCone) * meshletCount);
+	std::memcpy(sectionData(MeshCacheSection::Levels), levels.data(), levels.size_bytes());
+
+	header.contentHash = HashBytes(std::span<const std::byte>(image).subspan(sizeof(MeshCacheHeader)));
+	std::memcpy(image.data(), &header, sizeof(header));
+	return image;
+}
+
+bool WriteMeshCache(const std::filesystem::path& path, std::span<const std::byte> image) {
+	std::filesystem::path temporaryPath = path;
+	temporaryPath += ".tmp";
+	std::error_code error;
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (file) {
+			file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+			file.close();
+		}
+		if (!file) {
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+	}
+	//置き換えは1回の操作なので、読む側は古いキャッシュか新しいキャッシュのどちらかしか見ない
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+MeshCache::MeshCache(MeshCache&& other) noexcept
+	: file_(std::move(other.file_)), image_(std::move(other.image_)), bytes_(std::exchange(other.bytes_, {})),
+	header_(std::exchange(other.header_, nullptr)), vertices_(std::exchange(other.vertices_, nullptr)),
+	meshlets_(std::exchange(other.meshlets_, {})), levels_(std::exchange(other.levels_, {})) {}
+
+MeshCache& MeshCache::operator=(MeshCache&& other) noexcept {
+	//マップした領域もvectorの中身も移動で場所が変わらないので、指しているポインタはそのまま使える
+	if (this != &other) {
+		file_ = std::move(other.file_);
+		image_ = std::move(other.image_);
+		bytes_ = std::exchange(other.bytes_, {});
+		header_ = std::exchange(other.header_, nullptr);
+		vertices_ = std::exchange(other.vertices_, nullptr);
+		meshlets_ = std::exchange(other.meshlets_, {});
+		levels_ = std::exchange(other.levels_, {});
+	}
+	return *this;
+}
+
+bool MeshCache::Open(const std::filesystem::path& path, uint64_t sourceKey, bool verifyContent) {
+	Close();
+	if (!file_.Open(path) || !Attach(file_.GetBytes(), sourceKey, verifyContent)) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::Open(std::vector<std::byte>&& image) {
+	Close();
+	image_ = std::move(image);
+	if (!Attach(image_, 0, true)) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MeshCache::Close() {
+	file_.Close();
+	image_ = {};
+	bytes_ = {};
+	header_ = nullptr;
+	vertices_ = nullptr;
+	meshlets_ = {};
+	levels_ = {};
+}
+
+std::span<const std::byte> MeshCache::GetGpuData() const {
+	const MeshCacheRange& vertices = GetSection(*header_, MeshCacheSection::Vertices);
+	const MeshCacheRange& indices = GetSection(*header_, MeshCacheSection::Indices);
+	return bytes_.subspan(static_cast<size_t>(vertices.offset), static_cast<size_t>(indices.offset + indices.size - vertices.offset));
+}
+
+MeshletView MeshCache::GetMeshlets(uint32_t level) const {
+	const MeshCacheLevel& range = levels_[level];
+	const BoundingSphereSoA& spheres = meshlets_.spheres;
+	return { meshlets_.meshlets.subspan(range.meshletStart, range.meshletCount),
+		{ spheres.centerX + range.meshletStart, spheres.centerY + range.meshletStart, spheres.centerZ + range.meshletStart, spheres.radius + range.meshletStart },
+		meshlets_.cones.subspan(range.meshletStart, range.meshletCount) };
+}
+
+size_t MeshCache::GetIndexDataOffset() const {
+	return static_cast<size_t>(GetSection(*header_, MeshCacheSection::Indices).offset - GetSection(*header_, MeshCacheSection::Vertices).offset);
+}
+
+bool MeshCache::Attach(std::span<const std::byte> bytes, uint64_t sourceKey, bool verifyContent) {
+	//ヘッダーの値はすべて疑い、範囲を確かめてからポインタにする
+	if (bytes.size() < sizeof(MeshCacheHeader)) {
+		return false;
+	}
+	const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(bytes.data());
+	if (header->magic != kMeshCacheMagic || header->version != kMeshCacheVersion || header->fileSize != bytes.size() ||
+		(sourceKey != 0 && header->sourceKey != sourceKey) || (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t)) ||
+		header->indexCount % 3 != 0 || header->levelCount == 0) {
+		return false;
+	}
+	uint64_t sizes[kSectionCount];
+	GetSectionSizes(header->vertexCount, header->indexCount, header->indexSize, header->meshletCount, header->levelCount, sizes);
+	for (size_t section = 0; section < kSectionCount; section++) {
+		const MeshCacheRange& range = header->sections[section];
+		if (range.size != sizes[section] || range.offset % kMeshCacheAlignment != 0 || range.offset < sizeof(MeshCacheHeader) ||
+			range.offset > bytes.size() || range.size > bytes.size() - range.offset) {
+			return false;
+		}
+	}
+	//GetGpuDataで頂点からインデックスまでを1つの範囲として返すので、この順に並んでいる必要がある
+	const MeshCacheRange& vertexRange = GetSection(*header, MeshCacheSection::Vertices);
+	if (GetSection(*header, MeshCacheSection::Indices).offset < vertexRange.offset + vertexRange.size) {
+		return false;
+	}
+	if (verifyContent && HashBytes(bytes.subspan(sizeof(MeshCacheHeader))) != header->contentHash) {
+		return false;
+	}
+
+	//古いキャッシュや壊れたキャッシュでも、頂点の範囲外を指すインデックスは渡さない(CPUのBVH構築がそのまま頂点を読む)
+	const std::byte* indexData = bytes.data() + GetSection(*header, MeshCacheSection::Indices).offset;
+	if (header->indexSize == sizeof(uint16_t) ? !AreIndicesInRange<uint16_t>(indexData, header->indexCount, header->vertexCount)
+		: !AreIndicesInRange<uint32_t>(indexData, header->indexCount, header->vertexCount)) {
+		return false;
+	}
+
+	const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(bytes.data() + GetSection(*header, MeshCacheSection::Meshlets).offset);
+	for (uint32_t i = 0; i < header->meshletCount; i++) {
+		if (meshlets[i].startIndex > header->indexCount || meshlets[i].triangleCount > (header->indexCount - meshlets[i].startIndex) / 3) {
+			return false;
+		}
+	}
+	const MeshCacheLevel* levels = reinterpret_cast<const MeshCacheLevel*>(bytes.data() + GetSection(*header, MeshCacheSection::Levels).offset);
+	for (uint32_t i = 0; i < header->levelCount; i++) {
+		if (levels[i].startIndex > header->indexCount || levels[i].indexCount > header->indexCount - levels[i].startIndex ||
+			levels[i].meshletStart > header->meshletCount || levels[i].meshletCount > header->meshletCount - levels[i].meshletStart) {
+			return false;
+		}
+	}
+	const float* spheres = reinterpret_cast<const float*>(bytes.data() + GetSection(*header, MeshCacheSection::MeshletSpheres).offset);
+	const size_t meshletCount = header->meshletCount;
+	bytes_ = bytes;
+	header_ = header;
+	vertices_ = reinterpret_cast<const VertexData*>(bytes.data() + vertexRange.offset);
+	meshlets_.meshlets = { meshlets, meshletCount };
+	meshlets_.spheres = { spheres, spheres + meshletCount, spheres + meshletCount * 2, spheres + meshletCount * 3 };
+	meshlets_.cones = { reinterpret_cast<const NormalCone*>(bytes.data() + GetSection(*header, MeshCacheSection::MeshletCones).offset), meshletCount };
+	levels_ = { levels, header->levelCount };
+	return true;
+}
+
+bool OpenOrBuildMeshCache(const std::filesystem::path& cachePath, uint64_t sourceKey, const std::function<bool(MeshData& mesh)>& build,
+	MeshCache& cache, bool* isRebuilt) {
+	assert(sourceKey != 0);
+	if (isRebuilt) {
+		*isRebuilt = false;
+	}
+	if (cache.Open(cachePath, sourceKey)) {
+		return true;
+	}
+	MeshData mesh;
+	if (!build(mesh) || mesh.indices.empty()) {
+		return false;
+	}
+	if (isRebuilt) {
+		*isRebuilt = true;
+	}
+	MeshLODChain chain = BuildLODChain(mesh);
+	mesh = {};
+	//段階ごとにメッシュレットに分け、インデックスとメッシュレットを段階の順に続けて置く
+	MeshletData meshlets;
+	std::vector<MeshCacheLevel> levels;
+	for (size_t level = 0; level < chain.levels.size(); level++) {
+		const MeshLevel& range = chain.levels[level];
+		MeshletData levelMeshlets = BuildMeshlets(chain.mesh.vertices, std::span(chain.mesh.indices).subspan(range.startIndex, range.indexCount));
+		levels.push_back({ range.indexCount, static_cast<uint32_t>(meshlets.indices.size()), static_cast<uint32_t>(meshlets.meshlets.size()),
+			static_cast<uint32_t>(levelMeshlets.meshlets.size()), chain.errors[level] });
+		for (Meshlet& meshlet : levelMeshlets.meshlets) {
+			meshlet.startIndex += levels.back().startIndex;
+		}
+		meshlets.meshlets.insert(meshlets.meshlets.end(), levelMeshlets.meshlets.begin(), levelMeshlets.meshlets.end());
+		meshlets.indices.insert(meshlets.indices.end(), levelMeshlets.indices.begin(), levelMeshlets.indices.end());
+		meshlets.centerX.insert(meshlets.centerX.end(), levelMeshlets.centerX.begin(), levelMeshlets.centerX.end());
+		meshlets.centerY.insert(meshlets.centerY.end(), levelMeshlets.centerY.begin(), levelMeshlets.centerY.end());
+		meshlets.centerZ.insert(meshlets.centerZ.end(), levelMeshlets.centerZ.begin(), levelMeshlets.centerZ.end());
+		meshlets.radius.insert(meshlets.radius.end(), levelMeshlets.radius.begin(), levelMeshlets.radius.end());
+		meshlets.cones.insert(meshlets.cones.end(), levelMeshlets.cones.begin(), levelMeshlets.cones.end());
+	}
+	//メッシュレットの順に頂点を並べ直すと、1つのメッシュレットの頂点が近くにまとまる(球と円錐は位置から求めたので変わらない)
+	//どのLODからも使われていない頂点は後ろに詰められるので、キャッシュに書く前に切り捨てる
+	chain.mesh.vertices.resize(OptimizeVertexFetch(chain.mesh.vertices, meshlets.indices));
+	std::vector<std::byte> image = SerializeMeshCache(sourceKey, chain.mesh.vertices, meshlets, levels);
+	chain = {};
+	meshlets = {};
+	//書けたらマップし直して、メモリ上の結果は捨てる
+	if (WriteMeshCache(cachePath, image) && cache.Open(cachePath, sourceKey)) {
+		return true;
+	}
+	return cache.Open(std::move(image));
+}
+
+bool OpenMeshCache(const std::filesystem::path& sourcePath, MeshCache& cache, bool* isRebuilt) {
+	std::filesystem::path cachePath = sourcePath;
+	cachePath += ".meshcache";
+	const uint64_t stamp = MakeFileStamp(sourcePath);
+	if (stamp == 0) {
+		//元のファイルがなければ、残っているキャッシュをそのまま使う
+		if (isRebuilt) {
+			*isRebuilt = false;
+		}
+		return cache.Open(cachePath, 0);
+	}
+	return OpenOrBuildMeshCache(cachePath, stamp, [&sourcePath](MeshData& mesh) { return LoadMesh(sourcePath, mesh); }, cache, isRebuilt);
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include "Bounds.h"
+#include "MappedFile.h"
+#include "MeshData.h"
+#include "Meshlet.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+//生成・読み込みしたメッシュを、次の起動で解析し直さずに使うためのバイナリのキャッシュ
+//
+//  [ヘッダー][頂点][インデックス][メッシュレット][メッシュレットの球(X, Y, Z, 半径の順)][法線の円錐][LODの段階]
+//
+//各セクションはkMeshCacheAlignmentにそろえて置くので、ファイルをマップしたらオフセットを足すだけで配列として読める
+//頂点とインデックスは続けて置くので、CreateBufferResourceで作った1つのバッファへ1回のmemcpyで写せる
+//インデックスはLODの段階を細かい順に続けたもので、段階の中はメッシュレットの順に並べてある。頂点数が65536以下なら16bitにする
+//数値はリトルエンディアンで、このプロジェクトの構造体をそのまま書いている。形式を変えたらkMeshCacheVersionを上げる
+
+constexpr uint32_t kMeshCacheMagic = 0x4843534D; //"MSCH"
+constexpr uint32_t kMeshCacheVersion = 2;
+//セクションの先頭のそろえ方(キャッシュラインの大きさ)
+constexpr size_t kMeshCacheAlignment = 64;
+
+/// <summary>
+/// キャッシュのセクションの種類
+/// </summary>
+enum class MeshCacheSection {
+	Vertices,
+	Indices,
+	Meshlets,
+	MeshletSpheres,
+	MeshletCones,
+	Levels,
+	Count,
+};
+
+/// <summary>
+/// ファイルの中での位置と大きさ(バイト)
+/// </summary>
+struct MeshCacheRange {
+	uint64_t offset;
+	uint64_t size;
+};
+
+/// <summary>
+/// LODの1つの段階。頂点はすべての段階で共有する
+/// </summary>
+struct MeshCacheLevel {
+	//インデックスの範囲
+	uint32_t indexCount;
+	uint32_t startIndex;
+	//メッシュレットの範囲
+	uint32_t meshletStart;
+	uint32_t meshletCount;
+	//段階0からの誤差(オブジェクト空間の距離)。SelectLODByErrorに使う
+	float error;
+};
+
+/// <summary>
+/// ファイルの先頭に置くヘッダー
+/// </summary>
+struct MeshCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	//元データを表す値(MakeFileStampなど)。変わっていたら作り直す
+	uint64_t sourceKey;
+	//ヘッダーより後ろ全体のHashBytes
+	uint64_t contentHash;
+	uint64_t fileSize;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	//2か4
+	uint32_t indexSize;
+	uint32_t meshletCount;
+	uint32_t levelCount;
+	//メッシュ全体を囲む範囲(ローカル空間)
+	AABB bounds;
+	BoundingSphere boundingSphere;
+	MeshCacheRange sections[static_cast<size_t>(MeshCacheSection::Count)];
+};
+
+/// <summary>
+/// バイト列の64bitハッシュ。8バイトずつ4列を並行に混ぜるので、メモリの読み込みとほぼ同じ速さで進む
+/// </summary>
+/// <param name="bytes">ハッシュするバイト列</param>
+/// <param name="seed">初期値。前のハッシュを渡すと続けてつなげられる</param>
+/// <returns></returns>
+uint64_t HashBytes(std::span<const std::byte> bytes, uint64_t seed = 0);
+
+/// <summary>
+/// ファイルの大きさと更新日時から、変わったかどうかを見分ける値を作る
+/// </summary>
+/// <param name="path">ファイルのパス</param>
+/// <returns>ファイルがなければ0</returns>
+uint64_t MakeFileStamp(const std::filesystem::path& path);
+
+/// <summary>
+/// 頂点とメッシュレットからキャッシュのファイルの中身を作る
+/// </summary>
+/// <param name="sourceKey">元データを表す値</param>
+/// <param name="vertices">頂点</param>
+/// <param name="meshlets">すべての段階のメッシュレット。インデックスはmeshlets.indicesを書く</param>
+/// <param name="levels">LODの段階(1つ以上)。範囲はmeshletsの中を指す</param>
+/// <returns>ファイルにそのまま書けるバイト列</returns>
+std::vector<std::byte> SerializeMeshCache(uint64_t sourceKey, std::span<const VertexData> vertices, const MeshletData& meshlets,
+	std::span<const MeshCacheLevel> levels);
+
+/// <summary>
+/// キャッシュのファイルを書く。途中で失敗しても壊れたキャッシュが残らないように、一時ファイルに書いてから置き換える
+/// </summary>
+/// <param name="path">書き込み先</param>
+/// <param name="image">SerializeMeshCacheの結果</param>
+/// <returns>書けなければfalse</returns>
+bool WriteMeshCache(const std::filesystem::path& path, std::span<const std::byte> image);
+
+/// <summary>
+/// 読み込んだメッシュキャッシュ。ファイルをマップしたまま、中身を直接指す
+/// </summary>
+class MeshCache {
+public:
+	MeshCache() = default;
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+	MeshCache(MeshCache&& other) noexcept;
+	MeshCache& operator=(MeshCache&& other) noexcept;
+
+	/// <summary>
+	/// キャッシュのファイルをマップして開く
+	/// </summary>
+	/// <param name="path">キャッシュのパス</param>
+	/// <param name="sourceKey">期待する元データの値。0ならどの値でも開く</param>
+	/// <param name="verifyContent">contentHashも確かめるか。全体を読むので遅くなる</param>
+	/// <returns>ない、壊れている、バージョンか元データが違うならfalse</returns>
+	bool Open(const std::filesystem::path& path, uint64_t sourceKey, bool verifyContent = false);
+
+	/// <summary>
+	/// メモリ上のキャッシュ(SerializeMeshCacheの結果)を開く。ファイルに書けなかったときに使う
+	/// </summary>
+	/// <param name="image">キャッシュの中身</param>
+	/// <returns>壊れていればfalse</returns>
+	bool Open(std::vector<std::byte>&& image);
+
+	void Close();
+
+	bool IsOpen() const { return header_ != nullptr; }
+	const MeshCacheHeader& GetHeader() const { return *header_; }
+	std::span<const VertexData> GetVertices() const { return { vertices_, header_->vertexCount }; }
+	//インデックスの大きさ(2か4)
+	uint32_t GetIndexSize() const { return header_->indexSize; }
+	uint32_t GetIndexCount() const { return header_->indexCount; }
+	const AABB& GetBounds() const { return header_->bounds; }
+	const BoundingSphere& GetBoundingSphere() const { return header_->boundingSphere; }
+	std::span<const MeshCacheLevel> GetLevels() const { return levels_; }
+	//すべての段階のメッシュレット
+	MeshletView GetMeshlets() const { return meshlets_; }
+
+	/// <summary>
+	/// 1つの段階のメッシュレット。IndexRangeの位置はインデックス全体の先頭から数える
+	/// </summary>
+	/// <param name="level">段階</param>
+	/// <returns></returns>
+	MeshletView GetMeshlets(uint32_t level) const;
+
+	/// <summary>
+	/// 頂点からインデックスの終わりまで。頂点バッファとインデックスバッファを兼ねる1つのバッファへそのまま写す
+	/// </summary>
+	/// <returns></returns>
+	std::span<const std::byte> GetGpuData() const;
+
+	/// <summary>
+	/// GetGpuDataの先頭からインデックスまでのバイト数(インデックスバッファビューの位置)
+	/// </summary>
+	/// <returns></returns>
+	size_t GetIndexDataOffset() const;
+
+private:
+	bool Attach(std::span<const std::byte> bytes, uint64_t sourceKey, bool verifyContent);
+
+	MappedFile file_;
+	std::vector<std::byte> image_;
+	//file_かimage_の中身
+	std::span<const std::byte> bytes_;
+	const MeshCacheHeader* header_ = nullptr;
+	const VertexData* vertices_ = nullptr;
+	MeshletView meshlets_{};
+	std::span<const MeshCacheLevel> levels_;
+};
+
+/// <summary>
+/// キャッシュが元データと合っていればそのまま開き、合わなければbuildで作り直して書いてから開く
+/// 作り直すときはBuildLODChainでLODの段階を作り、段階ごとにBuildMeshletsで分けてから、メッシュレットの順でOptimizeVertexFetchを行う
+/// </summary>
+/// <param name="cachePath">キャッシュのパス</param>
+/// <param name="sourceKey">元データを表す値(0以外)。生成したメッシュならパラメーターのHashBytesなど</param>
+/// <param name="build">元のメッシュを作る関数。失敗したらfalseを返す</param>
+/// <param name="cache">結果</param>
+/// <param name="isRebuilt">作り直したかの書き込み先。不要ならnullptr</param>
+/// <returns>作り直しにも失敗したらfalse。キャッシュを書けなかったときはメモリ上の結果を開いてtrueを返す</returns>
+bool OpenOrBuildMeshCache(const std::filesystem::path& cachePath, uint64_t sourceKey, const std::function<bool(MeshData& mesh)>& build,
+	MeshCache& cache, bool* isRebuilt = nullptr);
+
+/// <summary>
+/// メッシュファイル(.obj / .gltf / .glb)をキャッシュを通して読み込む。キャッシュは元のファイルの横に".meshcache"を付けて置く
+/// </summary>
+/// <param name="sourcePath">元のファイルのパス</param>
+/// <param name="cache">結果</param>
+/// <param name="isRebuilt">元のファイルを読み直したかの書き込み先。不要ならnullptr</param>
+/// <returns>キャッシュも元のファイルも読めなければfalse</returns>
+bool OpenMeshCache(const std::filesystem::path& sourcePath, MeshCache& cache, bool* isRebuilt = nullptr);
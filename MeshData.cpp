@@ -0,0 +1,29 @@
+#include "MeshData.h"
+#include <cassert>
+
+std::vector<uint16_t> ToIndices16(std::span<const uint32_t> indices) {
+	std::vector<uint16_t> result(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		assert(indices[i] <= 0xFFFF);
+		result[i] = static_cast<uint16_t>(indices[i]);
+	}
+	return result;
+}
+
+VertexAdjacency BuildVertexAdjacency(std::span<const uint32_t> indices, size_t vertexCount) {
+	VertexAdjacency adjacency;
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	for (uint32_t index : indices) {
+		assert(index < vertexCount);
+		adjacency.offsets[index + 1]++;
+	}
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		adjacency.offsets[vertex + 1] += adjacency.offsets[vertex];
+	}
+	adjacency.triangles.resize(indices.size());
+	std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++) {
+		adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+	return adjacency;
+}
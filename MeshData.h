@@ -0,0 +1,47 @@
+#pragma once
+#include "VertexData.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// <summary>
+/// インデックス付きのメッシュ。三角形リストとして3つずつインデックスを並べる
+/// </summary>
+struct MeshData {
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+};
+
+/// <summary>
+/// 16bitのインデックスで表せる頂点数か
+/// </summary>
+/// <param name="vertexCount">頂点数</param>
+/// <returns></returns>
+constexpr bool CanUse16BitIndices(size_t vertexCount) {
+	return vertexCount <= 0x10000;
+}
+
+/// <summary>
+/// インデックスを16bitに詰める。頂点数が65536以下のときだけ使える(インデックスバッファが半分になる)
+/// </summary>
+/// <param name="indices">32bitのインデックス</param>
+/// <returns></returns>
+std::vector<uint16_t> ToIndices16(std::span<const uint32_t> indices);
+
+/// <summary>
+/// 頂点ごとに、その頂点を使う三角形の一覧
+/// </summary>
+struct VertexAdjacency {
+	//頂点vの三角形は triangles[offsets[v]] ～ triangles[offsets[v + 1] - 1]
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+};
+
+/// <summary>
+/// 三角形リストから頂点ごとの三角形の一覧を作る
+/// </summary>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="vertexCount">頂点数</param>
+/// <returns></returns>
+VertexAdjacency BuildVertexAdjacency(std::span<const uint32_t> indices, size_t vertexCount);
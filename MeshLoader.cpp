@@ -0,0 +1,1220 @@
+#include "MeshLoader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "Quaternion.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void FinishStatistics(MeshLoadStatistics* statistics, Clock::time_point start) {
+	if (statistics) {
+		statistics->totalSeconds = SecondsSince(start);
+		statistics->megabytesPerSecond = statistics->totalSeconds > 0.0 ? static_cast<double>(statistics->fileSize) / statistics->totalSeconds / 1.0e6 : 0.0;
+	}
+}
+
+Vector3 GetPosition(const VertexData& vertex) {
+	return { vertex.position.x, vertex.position.y, vertex.position.z };
+}
+
+/// <summary>
+/// 法線が0ベクトルの頂点に、その頂点を使う三角形の法線(面積の重み付き)の平均を入れる
+/// </summary>
+/// <param name="vertexBegin">対象の頂点の範囲の先頭</param>
+/// <param name="vertexEnd">対象の頂点の範囲の終わり</param>
+/// <param name="indexBegin">範囲の頂点を使うインデックスの先頭</param>
+/// <param name="indexEnd">範囲の頂点を使うインデックスの終わり</param>
+void ComputeMissingNormals(MeshData& mesh, size_t vertexBegin, size_t vertexEnd, size_t indexBegin, size_t indexEnd) {
+	std::vector<Vector3> sums(vertexEnd - vertexBegin, Vector3{ 0.0f, 0.0f, 0.0f });
+	std::vector<bool> isMissing(vertexEnd - vertexBegin);
+	bool hasMissing = false;
+	for (size_t vertex = vertexBegin; vertex < vertexEnd; vertex++) {
+		const Vector3& normal = mesh.vertices[vertex].normal;
+		isMissing[vertex - vertexBegin] = normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f;
+		hasMissing = hasMissing || isMissing[vertex - vertexBegin];
+	}
+	if (!hasMissing) {
+		return;
+	}
+	for (size_t i = indexBegin; i + 3 <= indexEnd; i += 3) {
+		const uint32_t* triangle = &mesh.indices[i];
+		//時計回りが表なので、Cross(b - a, c - a)が外向き。長さが面積の2倍なのでそのまま足せば面積の重みになる
+		Vector3 a = GetPosition(mesh.vertices[triangle[0]]);
+		Vector3 normal = Cross(GetPosition(mesh.vertices[triangle[1]]) - a, GetPosition(mesh.vertices[triangle[2]]) - a);
+		for (int corner = 0; corner < 3; corner++) {
+			if (vertexBegin <= triangle[corner] && triangle[corner] < vertexEnd && isMissing[triangle[corner] - vertexBegin]) {
+				sums[triangle[corner] - vertexBegin] += normal;
+			}
+		}
+	}
+	for (size_t vertex = vertexBegin; vertex < vertexEnd; vertex++) {
+		if (isMissing[vertex - vertexBegin]) {
+			mesh.vertices[vertex].normal = Normalize(sums[vertex - vertexBegin]);
+		}
+	}
+}
+
+#pragma region OBJ
+//OBJを区切る大きさ。小さすぎると区切りの処理が増え、大きすぎるとスレッドに偏りが出る
+constexpr size_t kObjChunkSize = 1 << 20;
+//UVや法線が指定されていない角
+constexpr int32_t kNoIndex = std::numeric_limits<int32_t>::min();
+
+/// <summary>
+/// 面の角。(位置, UV, 法線)の番号(0始まり)
+/// </summary>
+struct ObjCorner {
+	int32_t attributes[3];
+
+	bool operator==(const ObjCorner& other) const {
+		return attributes[0] == other.attributes[0] && attributes[1] == other.attributes[1] && attributes[2] == other.attributes[2];
+	}
+};
+
+/// <summary>
+/// 1つの区切りを解析した結果
+/// </summary>
+struct ObjChunk {
+	std::vector<Vector3> positions;
+	std::vector<Vector2> texcoords;
+	std::vector<Vector3> normals;
+	//3つずつで三角形。時計回りに並べ直してある
+	std::vector<ObjCorner> corners;
+	//負の(相対)インデックスを使った要素の番号(角の番号 * 3 + 要素)。区切りの中での番号になっているので後で先頭をずらす
+	std::vector<uint32_t> relativeAttributes;
+	bool isValid = true;
+};
+
+bool IsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* SkipSpaces(const char* p, const char* end) {
+	while (p < end && IsSpace(*p)) {
+		++p;
+	}
+	return p;
+}
+
+bool IsDigit(char c) {
+	return '0' <= c && c <= '9';
+}
+
+bool ParseFloat(const char*& p, const char* end, float& value) {
+	p = SkipSpaces(p, end);
+	//from_charsは先頭の+を受け付けない
+	if (p < end && *p == '+') {
+		++p;
+	}
+	//OBJに多い"-0.123456"のような短い小数は、仮数が2^24以下で10の累乗もfloatで正確に表せるので、1回の割り算で正しく丸めた値になる
+	//(結果はfrom_charsと同じ)。指数表記や桁の多い数はfrom_charsに任せる
+	constexpr float kPowersOf10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	const char* q = p;
+	bool isNegative = q < end && *q == '-';
+	q += isNegative ? 1 : 0;
+	//10桁は32bitに収まらないので64bitで数える
+	uint64_t mantissa = 0;
+	int digitCount = 0;
+	int fractionCount = 0;
+	for (; q < end && IsDigit(*q) && digitCount < 10; ++q, ++digitCount) {
+		mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+	}
+	if (q < end && *q == '.') {
+		for (++q; q < end && IsDigit(*q) && digitCount < 10; ++q, ++digitCount, ++fractionCount) {
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+		}
+	}
+	//11桁目があれば下の条件(次が数字でない)で弾かれるので、読んだ桁は10桁まで、小数部も10桁まで
+	if (digitCount > 0 && mantissa <= (1u << 24) && (q == end || !(IsDigit(*q) || *q == 'e' || *q == 'E' || *q == '.'))) {
+		value = static_cast<float>(mantissa) / kPowersOf10[fractionCount];
+		value = isNegative ? -value : value;
+		p = q;
+		return true;
+	}
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec == std::errc::result_out_of_range) {
+		//非正規化数やfloatに収まらない値。0にしておく
+		value = 0.0f;
+	} else if (result.ec != std::errc()) {
+		return false;
+	}
+	p = result.ptr;
+	return true;
+}
+
+bool ParseInt(const char*& p, const char* end, int32_t& value) {
+	if (p < end && *p == '+') {
+		++p;
+	}
+	//9桁まではオーバーフローしないので自分で読む
+	const char* q = p;
+	bool isNegative = q < end && *q == '-';
+	q += isNegative ? 1 : 0;
+	int32_t number = 0;
+	int digitCount = 0;
+	for (; q < end && IsDigit(*q) && digitCount < 9; ++q, ++digitCount) {
+		number = number * 10 + (*q - '0');
+	}
+	//10桁以上は範囲の確認をfrom_charsに任せる
+	if (digitCount > 0 && (q == end || !IsDigit(*q))) {
+		value = isNegative ? -number : number;
+		p = q;
+		return true;
+	}
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) {
+		return false;
+	}
+	p = result.ptr;
+	return true;
+}
+
+/// <summary>
+/// 面の角を1つ読む(v, v/t, v//n, v/t/n)
+/// </summary>
+/// <param name="counts">ここまでに区切りの中で出てきた位置・UV・法線の数。負のインデックスに使う</param>
+/// <param name="relativeMask">負のインデックスだった要素のビット</param>
+bool ParseCorner(const char*& p, const char* end, const int32_t counts[3], ObjCorner& corner, uint32_t& relativeMask) {
+	corner = { { kNoIndex, kNoIndex, kNoIndex } };
+	relativeMask = 0;
+	for (int attribute = 0; attribute < 3; attribute++) {
+		if (attribute > 0) {
+			if (p >= end || *p != '/') {
+				break;
+			}
+			++p;
+		}
+		int32_t value = 0;
+		if (!ParseInt(p, end, value)) {
+			//v//nのUVのように省略されている。位置は省略できない
+			if (attribute == 0) {
+				return false;
+			}
+			continue;
+		}
+		if (value > 0) {
+			corner.attributes[attribute] = value - 1;
+		} else if (value < 0) {
+			corner.attributes[attribute] = counts[attribute] + value;
+			relativeMask |= 1u << attribute;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// [begin, end)の行を解析する。beginは行の先頭であること
+/// </summary>
+void ParseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+	struct PolygonCorner {
+		ObjCorner corner;
+		uint32_t relativeMask;
+	};
+	std::vector<PolygonCorner> polygon;
+	const char* p = begin;
+	while (p < end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (!lineEnd) {
+			lineEnd = end;
+		}
+		const char* q = SkipSpaces(p, lineEnd);
+		p = lineEnd + 1;
+		if (lineEnd - q < 2 || !(q[0] == 'v' || q[0] == 'f')) {
+			//コメント、グループ、マテリアルなどは読み飛ばす
+			continue;
+		}
+		if (q[0] == 'v' && IsSpace(q[1])) {
+			float x, y, z;
+			q += 1;
+			if (!ParseFloat(q, lineEnd, x) || !ParseFloat(q, lineEnd, y) || !ParseFloat(q, lineEnd, z)) {
+				chunk.isValid = false;
+				return;
+			}
+			chunk.positions.push_back({ -x, y, z });
+		} else if (q[0] == 'v' && q[1] == 't' && (q + 2 == lineEnd || IsSpace(q[2]))) {
+			float u = 0.0f, v = 0.0f;
+			q += 2;
+			if (!ParseFloat(q, lineEnd, u)) {
+				chunk.isValid = false;
+				return;
+			}
+			//Vは省略できる
+			ParseFloat(q, lineEnd, v);
+			chunk.texcoords.push_back({ u, 1.0f - v });
+		} else if (q[0] == 'v' && q[1] == 'n' && (q + 2 == lineEnd || IsSpace(q[2]))) {
+			float x, y, z;
+			q += 2;
+			if (!ParseFloat(q, lineEnd, x) || !ParseFloat(q, lineEnd, y) || !ParseFloat(q, lineEnd, z)) {
+				chunk.isValid = false;
+				return;
+			}
+			chunk.normals.push_back({ -x, y, z });
+		} else if (q[0] == 'f' && IsSpace(q[1])) {
+			const int32_t counts[3] = {
+				static_cast<int32_t>(chunk.positions.size()), static_cast<int32_t>(chunk.texcoords.size()), static_cast<int32_t>(chunk.normals.size()) };
+			polygon.clear();
+			q = SkipSpaces(q + 1, lineEnd);
+			while (q < lineEnd && *q != '#') {
+				PolygonCorner corner;
+				if (!ParseCorner(q, lineEnd, counts, corner.corner, corner.relativeMask)) {
+					chunk.isValid = false;
+					return;
+				}
+				polygon.push_back(corner);
+				q = SkipSpaces(q, lineEnd);
+			}
+			//扇形に分ける。Xを反転したので(0, i + 1, i)の順にして時計回りにする
+			for (size_t i = 1; i + 1 < polygon.size(); i++) {
+				for (const PolygonCorner* corner : { &polygon[0], &polygon[i + 1], &polygon[i] }) {
+					for (uint32_t attribute = 0; attribute < 3; attribute++) {
+						if (corner->relativeMask & (1u << attribute)) {
+							chunk.relativeAttributes.push_back(static_cast<uint32_t>(chunk.corners.size() * 3 + attribute));
+						}
+					}
+					chunk.corners.push_back(corner->corner);
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// 同じ角を1つの頂点にまとめる(線形探索のオープンアドレス法)
+/// 位置の番号ごとに連続したスロットを割り当てて、そこから探し始める。OBJの面は近い番号の位置を続けて使うので、
+/// テーブルへのアクセスがほぼ先頭から順になり、キャッシュミスがほとんど起きない。キーはスロットに直接入れて頂点の配列を見に行かない
+/// </summary>
+/// <param name="corners">すべての角</param>
+/// <param name="positionCount">位置の数</param>
+/// <param name="uniqueCorners">まとめた後の頂点ごとの角</param>
+/// <param name="indices">角ごとの頂点番号</param>
+void WeldCorners(const std::vector<ObjCorner>& corners, size_t positionCount, std::vector<ObjCorner>& uniqueCorners, std::vector<uint32_t>& indices) {
+	struct Slot {
+		ObjCorner key;
+		uint32_t vertex;
+	};
+	//位置の番号は0以上なので、負の値を空きの印にする
+	constexpr Slot kEmpty = { { { -1, -1, -1 } }, 0 };
+	positionCount = std::max<size_t>(positionCount, 1);
+	size_t capacity = 16;
+	while (capacity < positionCount * 2) {
+		capacity *= 2;
+	}
+	std::vector<Slot> table;
+	size_t mask = 0;
+	size_t slotsPerPosition = 0;
+	auto resize = [&](size_t newCapacity) {
+		capacity = newCapacity;
+		mask = capacity - 1;
+		slotsPerPosition = capacity / positionCount;
+		table.assign(capacity, kEmpty);
+	};
+	resize(capacity);
+	uniqueCorners.clear();
+	uniqueCorners.reserve(positionCount);
+	indices.resize(corners.size());
+
+	for (size_t i = 0; i < corners.size(); i++) {
+		const ObjCorner& corner = corners[i];
+		size_t slot = static_cast<size_t>(corner.attributes[0]) * slotsPerPosition & mask;
+		while (table[slot].key.attributes[0] >= 0 && !(table[slot].key == corner)) {
+			slot = (slot + 1) & mask;
+		}
+		if (table[slot].key.attributes[0] >= 0) {
+			indices[i] = table[slot].vertex;
+			continue;
+		}
+		uint32_t vertex = static_cast<uint32_t>(uniqueCorners.size());
+		uniqueCorners.push_back(corner);
+		table[slot] = { corner, vertex };
+		indices[i] = vertex;
+		//使用率が半分を超えたら(1つの位置をUVや法線の違う角が多く使っているとき)倍の大きさで作り直す
+		if (uniqueCorners.size() * 2 > capacity) {
+			resize(capacity * 2);
+			for (uint32_t existing = 0; existing < uniqueCorners.size(); existing++) {
+				size_t newSlot = static_cast<size_t>(uniqueCorners[existing].attributes[0]) * slotsPerPosition & mask;
+				while (table[newSlot].key.attributes[0] >= 0) {
+					newSlot = (newSlot + 1) & mask;
+				}
+				table[newSlot] = { uniqueCorners[existing], existing };
+			}
+		}
+	}
+}
+#pragma endregion
+
+#pragma region glTF
+/// <summary>
+/// glTFを読むのに足りるだけのJSONの値
+/// </summary>
+struct JsonValue {
+	enum class Type { Null, Boolean, Number, String, Array, Object };
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	/// <summary>
+	/// オブジェクトのメンバーを探す。なければnullptr
+	/// </summary>
+	const JsonValue* Find(std::string_view key) const {
+		for (const std::pair<std::string, JsonValue>& member : object) {
+			if (member.first == key) {
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+
+	/// <summary>
+	/// 数値のメンバー。なければ、または数値でなければdefaultValue
+	/// </summary>
+	double GetNumber(std::string_view key, double defaultValue) const {
+		const JsonValue* value = Find(key);
+		return value && value->type == Type::Number ? value->number : defaultValue;
+	}
+
+	/// <summary>
+	/// 大きさや位置を表す0以上の整数のメンバー。なければ、または数値でなければdefaultValue
+	/// </summary>
+	/// <returns>有限でない、負、小数、size_tに収まらない値ならfalse</returns>
+	bool GetSize(std::string_view key, size_t defaultValue, size_t& result) const {
+		const JsonValue* value = Find(key);
+		if (!value || value->type != Type::Number) {
+			result = defaultValue;
+			return true;
+		}
+		//doubleからの変換は範囲外だと未定義動作なので先に確かめる(NaNは比較がfalseになるのでここで弾かれる)
+		const double kSizeLimit = std::ldexp(1.0, std::numeric_limits<size_t>::digits);
+		if (!(value->number >= 0.0 && value->number < kSizeLimit) || std::floor(value->number) != value->number) {
+			return false;
+		}
+		result = static_cast<size_t>(value->number);
+		return true;
+	}
+
+	/// <summary>
+	/// 配列の番号を指すメンバー。なければ、または番号として不正な値なら-1
+	/// </summary>
+	int64_t GetIndex(std::string_view key) const {
+		//なければSIZE_MAXにして、int64_tに収まらない値と一緒に-1にする
+		size_t index = 0;
+		if (!GetSize(key, SIZE_MAX, index) || index > static_cast<size_t>(std::numeric_limits<int64_t>::max())) {
+			return -1;
+		}
+		return static_cast<int64_t>(index);
+	}
+
+	/// <summary>
+	/// 配列のメンバーのindex番目。範囲外ならnullptr
+	/// </summary>
+	const JsonValue* FindElement(std::string_view key, int64_t index) const {
+		const JsonValue* value = Find(key);
+		if (!value || value->type != Type::Array || index < 0 || static_cast<size_t>(index) >= value->array.size()) {
+			return nullptr;
+		}
+		return &value->array[static_cast<size_t>(index)];
+	}
+};
+
+/// <summary>
+/// 再帰下降のJSONパーサー
+/// </summary>
+class JsonParser {
+public:
+	JsonParser(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+	bool Parse(JsonValue& value) {
+		if (!ParseValue(value, 0)) {
+			return false;
+		}
+		SkipWhitespace();
+		return p_ == end_;
+	}
+
+private:
+	//入れ子の深さの上限。壊れたファイルでスタックを使い切らないようにする
+	static constexpr int kMaxDepth = 64;
+
+	void SkipWhitespace() {
+		while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+			++p_;
+		}
+	}
+
+	bool Consume(char c) {
+		SkipWhitespace();
+		if (p_ < end_ && *p_ == c) {
+			++p_;
+			return true;
+		}
+		return false;
+	}
+
+	bool ConsumeWord(std::string_view word) {
+		if (static_cast<size_t>(end_ - p_) < word.size() || std::string_view(p_, word.size()) != word) {
+			return false;
+		}
+		p_ += word.size();
+		return true;
+	}
+
+	bool ParseString(std::string& result) {
+		if (!Consume('"')) {
+			return false;
+		}
+		result.clear();
+		while (p_ < end_ && *p_ != '"') {
+			if (*p_ != '\\') {
+				result.push_back(*p_++);
+				continue;
+			}
+			if (++p_ >= end_) {
+				return false;
+			}
+			switch (*p_++) {
+			case '"': result.push_back('"'); break;
+			case '\\': result.push_back('\\'); break;
+			case '/': result.push_back('/'); break;
+			case 'b': result.push_back('\b'); break;
+			case 'f': result.push_back('\f'); break;
+			case 'n': result.push_back('\n'); break;
+			case 'r': result.push_back('\r'); break;
+			case 't': result.push_back('\t'); break;
+			case 'u': {
+				//glTFで使う名前やURIには出てこないので、ASCIIの範囲だけ戻す
+				uint32_t code = 0;
+				if (end_ - p_ < 4 || std::from_chars(p_, p_ + 4, code, 16).ptr != p_ + 4) {
+					return false;
+				}
+				p_ += 4;
+				result.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		return Consume('"');
+	}
+
+	bool ParseValue(JsonValue& value, int depth) {
+		if (depth > kMaxDepth) {
+			return false;
+		}
+		SkipWhitespace();
+		if (p_ >= end_) {
+			return false;
+		}
+		switch (*p_) {
+		case '{':
+			++p_;
+			value.type = JsonValue::Type::Object;
+			if (Consume('}')) {
+				return true;
+			}
+			do {
+				std::pair<std::string, JsonValue> member;
+				if (!ParseString(member.first) || !Consume(':') || !ParseValue(member.second, depth + 1)) {
+					return false;
+				}
+				value.object.push_back(std::move(member));
+			} while (Consume(','));
+			return Consume('}');
+		case '[':
+			++p_;
+			value.type = JsonValue::Type::Array;
+			if (Consume(']')) {
+				return true;
+			}
+			do {
+				value.array.emplace_back();
+				if (!ParseValue(value.array.back(), depth + 1)) {
+					return false;
+				}
+			} while (Consume(','));
+			return Consume(']');
+		case '"':
+			value.type = JsonValue::Type::String;
+			return ParseString(value.string);
+		case 't':
+			value.type = JsonValue::Type::Boolean;
+			value.boolean = true;
+			return ConsumeWord("true");
+		case 'f':
+			value.type = JsonValue::Type::Boolean;
+			return ConsumeWord("false");
+		case 'n':
+			return ConsumeWord("null");
+		default: {
+			value.type = JsonValue::Type::Number;
+			std::from_chars_result result = std::from_chars(p_, end_, value.number);
+			if (result.ec != std::errc()) {
+				return false;
+			}
+			p_ = result.ptr;
+			return true;
+		}
+		}
+	}
+
+	const char* p_;
+	const char* end_;
+};
+
+//glTFの定数
+constexpr uint32_t kGlbMagic = 0x46546C67;     //"glTF"
+constexpr uint32_t kGlbChunkJson = 0x4E4F534A; //"JSON"
+constexpr uint32_t kGlbChunkBin = 0x004E4942;  //"BIN\0"
+constexpr int kComponentByte = 5120;
+constexpr int kComponentUnsignedByte = 5121;
+constexpr int kComponentShort = 5122;
+constexpr int kComponentUnsignedShort = 5123;
+constexpr int kComponentUnsignedInt = 5125;
+constexpr int kComponentFloat = 5126;
+constexpr int kModeTriangles = 4;
+
+uint32_t ReadUint32(const std::byte* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+/// <summary>
+/// base64を戻す。data URIのバッファに使う
+/// </summary>
+bool DecodeBase64(std::string_view text, std::vector<std::byte>& result) {
+	auto decodeChar = [](char c) -> int {
+		if ('A' <= c && c <= 'Z') return c - 'A';
+		if ('a' <= c && c <= 'z') return c - 'a' + 26;
+		if ('0' <= c && c <= '9') return c - '0' + 52;
+		if (c == '+') return 62;
+		if (c == '/') return 63;
+		return -1;
+	};
+	result.clear();
+	result.reserve(text.size() / 4 * 3);
+	uint32_t bits = 0;
+	int bitCount = 0;
+	for (char c : text) {
+		if (c == '=') {
+			break;
+		}
+		int value = decodeChar(c);
+		if (value < 0) {
+			return false;
+		}
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		bitCount += 6;
+		if (bitCount >= 8) {
+			bitCount -= 8;
+			result.push_back(static_cast<std::byte>((bits >> bitCount) & 0xFF));
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// URIの%XXを戻す
+/// </summary>
+std::string DecodeUri(std::string_view uri) {
+	std::string result;
+	for (size_t i = 0; i < uri.size(); i++) {
+		uint32_t code = 0;
+		if (uri[i] == '%' && i + 2 < uri.size() && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3) {
+			result.push_back(static_cast<char>(code));
+			i += 2;
+		} else {
+			result.push_back(uri[i]);
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// 読み込んだglTFのJSONとバッファ
+/// </summary>
+struct GltfDocument {
+	JsonValue root;
+	std::vector<std::span<const std::byte>> buffers;
+	//.binやdata URIを戻したものを持っておく場所
+	std::vector<MappedFile> externalFiles;
+	std::vector<std::vector<std::byte>> decodedBuffers;
+};
+
+/// <summary>
+/// アクセサーが指す要素の並び
+/// </summary>
+struct AccessorView {
+	const std::byte* data;
+	size_t count;
+	size_t stride;
+	int componentType;
+	size_t componentCount;
+	bool normalized;
+};
+
+size_t GetComponentSize(int componentType) {
+	switch (componentType) {
+	case kComponentByte:
+	case kComponentUnsignedByte:
+		return 1;
+	case kComponentShort:
+	case kComponentUnsignedShort:
+		return 2;
+	case kComponentUnsignedInt:
+	case kComponentFloat:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+size_t GetComponentCount(const std::string& type) {
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+	return 0;
+}
+
+/// <summary>
+/// アクセサーを調べ、範囲がバッファに収まっていれば要素の並びを返す。疎(sparse)なアクセサーには対応しない
+/// </summary>
+bool GetAccessorView(const GltfDocument& document, int64_t accessorIndex, AccessorView& view) {
+	const JsonValue* accessor = document.root.FindElement("accessors", accessorIndex);
+	if (!accessor || accessor->Find("sparse")) {
+		return false;
+	}
+	const JsonValue* bufferView = document.root.FindElement("bufferViews", accessor->GetIndex("bufferView"));
+	const JsonValue* type = accessor->Find("type");
+	if (!bufferView || !type || type->type != JsonValue::Type::String) {
+		return false;
+	}
+	int64_t bufferIndex = bufferView->GetIndex("buffer");
+	if (bufferIndex < 0 || static_cast<size_t>(bufferIndex) >= document.buffers.size()) {
+		return false;
+	}
+	size_t componentType = 0;
+	if (!accessor->GetSize("componentType", 0, componentType) || componentType > static_cast<size_t>(std::numeric_limits<int>::max())) {
+		return false;
+	}
+	view.componentType = static_cast<int>(componentType);
+	view.componentCount = GetComponentCount(type->string);
+	const JsonValue* normalized = accessor->Find("normalized");
+	view.normalized = normalized && normalized->boolean;
+	size_t elementSize = GetComponentSize(view.componentType) * view.componentCount;
+	if (elementSize == 0) {
+		return false;
+	}
+	size_t viewOffset = 0, viewLength = 0, offset = 0;
+	if (!accessor->GetSize("count", 0, view.count) || !bufferView->GetSize("byteStride", elementSize, view.stride)
+		|| !bufferView->GetSize("byteOffset", 0, viewOffset) || !bufferView->GetSize("byteLength", 0, viewLength)
+		|| !accessor->GetSize("byteOffset", 0, offset)) {
+		return false;
+	}
+	//ファイルの値は信用できないので、足し算や掛け算があふれない形(a > size - b)で範囲を確かめる
+	std::span<const std::byte> buffer = document.buffers[static_cast<size_t>(bufferIndex)];
+	if (view.stride < elementSize || viewOffset > buffer.size() || viewLength > buffer.size() - viewOffset) {
+		return false;
+	}
+	if (view.count > 0 && (offset > viewLength || elementSize > viewLength - offset
+		|| view.count - 1 > (viewLength - offset - elementSize) / view.stride)) {
+		return false;
+	}
+	view.data = buffer.data() + viewOffset + offset;
+	return true;
+}
+
+/// <summary>
+/// 要素の成分を1つfloatで読む。normalizedなら[0, 1]か[-1, 1]にする
+/// </summary>
+float ReadComponent(const AccessorView& view, size_t element, size_t component) {
+	const std::byte* p = view.data + element * view.stride + component * GetComponentSize(view.componentType);
+	switch (view.componentType) {
+	case kComponentFloat: {
+		float value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+	case kComponentUnsignedByte: {
+		uint8_t value = static_cast<uint8_t>(*p);
+		return view.normalized ? static_cast<float>(value) / 255.0f : static_cast<float>(value);
+	}
+	case kComponentByte: {
+		int8_t value = static_cast<int8_t>(*p);
+		return view.normalized ? std::max(static_cast<float>(value) / 127.0f, -1.0f) : static_cast<float>(value);
+	}
+	case kComponentUnsignedShort: {
+		uint16_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return view.normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+	}
+	case kComponentShort: {
+		int16_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return view.normalized ? std::max(static_cast<float>(value) / 32767.0f, -1.0f) : static_cast<float>(value);
+	}
+	default: {
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return static_cast<float>(value);
+	}
+	}
+}
+
+uint32_t ReadIndex(const AccessorView& view, size_t element) {
+	const std::byte* p = view.data + element * view.stride;
+	switch (view.componentType) {
+	case kComponentUnsignedByte:
+		return static_cast<uint8_t>(*p);
+	case kComponentUnsignedShort: {
+		uint16_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+	default:
+		return ReadUint32(p);
+	}
+}
+
+/// <summary>
+/// .glbのヘッダーとチャンクを読み、JSONのテキストとBINチャンクを取り出す
+/// </summary>
+bool ParseGlb(std::span<const std::byte> file, std::string_view& json, std::span<const std::byte>& bin) {
+	if (file.size() < 20 || ReadUint32(file.data()) != kGlbMagic || ReadUint32(file.data() + 4) != 2) {
+		return false;
+	}
+	size_t length = std::min<size_t>(ReadUint32(file.data() + 8), file.size());
+	size_t offset = 12;
+	while (offset + 8 <= length) {
+		size_t chunkLength = ReadUint32(file.data() + offset);
+		uint32_t chunkType = ReadUint32(file.data() + offset + 4);
+		offset += 8;
+		if (chunkLength > length - offset) {
+			return false;
+		}
+		if (chunkType == kGlbChunkJson && json.empty()) {
+			json = std::string_view(reinterpret_cast<const char*>(file.data() + offset), chunkLength);
+		} else if (chunkType == kGlbChunkBin && bin.empty()) {
+			bin = file.subspan(offset, chunkLength);
+		}
+		//チャンクは4byte境界に並んでいる
+		offset += (chunkLength + 3) & ~size_t(3);
+	}
+	return !json.empty();
+}
+
+/// <summary>
+/// ノードの変換行列。matrixがあればそれを、なければTRSから作る
+/// glTFは列優先で列ベクトルに掛ける行列なので、並びのまま読めば行ベクトル(v * M)の行列になる
+/// </summary>
+Matrix4x4 GetNodeMatrix(const JsonValue& node) {
+	const JsonValue* matrix = node.Find("matrix");
+	if (matrix && matrix->type == JsonValue::Type::Array && matrix->array.size() == 16) {
+		Matrix4x4 result;
+		for (int i = 0; i < 16; i++) {
+			result.m[i / 4][i % 4] = static_cast<float>(matrix->array[i].number);
+		}
+		return result;
+	}
+	auto readArray = [&node](const char* key, float* values, size_t count) {
+		const JsonValue* array = node.Find(key);
+		if (array && array->type == JsonValue::Type::Array && array->array.size() == count) {
+			for (size_t i = 0; i < count; i++) {
+				values[i] = static_cast<float>(array->array[i].number);
+			}
+		}
+	};
+	Vector3 scale = { 1.0f, 1.0f, 1.0f };
+	Quaternion rotate = IdentityQuaternion();
+	Vector3 translate = { 0.0f, 0.0f, 0.0f };
+	readArray("scale", &scale.x, 3);
+	readArray("rotation", &rotate.x, 4);
+	readArray("translation", &translate.x, 3);
+	return MakeAffineMatrix(scale, Normalize(rotate), translate);
+}
+
+/// <summary>
+/// ノードを子までたどり、メッシュとワールド行列の組を集める
+/// </summary>
+void CollectMeshInstances(const JsonValue& root, int64_t nodeIndex, const Matrix4x4& parentMatrix, int depth,
+	std::vector<std::pair<int64_t, Matrix4x4>>& instances) {
+	const JsonValue* node = root.FindElement("nodes", nodeIndex);
+	//壊れたファイルでノードが循環していても止まるように深さを制限する
+	if (!node || depth > 64) {
+		return;
+	}
+	Matrix4x4 worldMatrix = Multiply(GetNodeMatrix(*node), parentMatrix);
+	if (node->GetIndex("mesh") >= 0) {
+		instances.push_back({ node->GetIndex("mesh"), worldMatrix });
+	}
+	if (const JsonValue* children = node->Find("children"); children && children->type == JsonValue::Type::Array) {
+		for (const JsonValue& child : children->array) {
+			CollectMeshInstances(root, static_cast<int64_t>(child.number), worldMatrix, depth + 1, instances);
+		}
+	}
+}
+
+/// <summary>
+/// 1つのプリミティブを読み出して変換する処理
+/// </summary>
+struct GltfPrimitiveJob {
+	AccessorView positions;
+	AccessorView normals;
+	AccessorView texcoords;
+	AccessorView indices;
+	bool hasNormals;
+	bool hasTexcoords;
+	bool hasIndices;
+	Matrix4x4 worldMatrix;
+	size_t vertexOffset;
+	size_t indexOffset;
+	size_t indexCount;
+};
+
+/// <summary>
+/// ワールド行列を掛け、Xを反転して左手座標系にしながら頂点とインデックスを書き込む
+/// </summary>
+bool WriteGltfPrimitive(const GltfPrimitiveJob& job, MeshData& mesh) {
+	//スケール0のノードも正しいglTFなので、逆行列がないときは法線をそのまま使う(位置はどのみち1点か面に潰れる)
+	const float det = Det(job.worldMatrix);
+	const Matrix4x4 normalMatrix = det != 0.0f ? Transpose(Inverse(job.worldMatrix)) : MakeIdentity4x4();
+	ThreadPool::GetInstance().ParallelFor(job.positions.count, 16384, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			Vector3 position = Transform({ ReadComponent(job.positions, i, 0), ReadComponent(job.positions, i, 1), ReadComponent(job.positions, i, 2) }, job.worldMatrix);
+			VertexData& vertex = mesh.vertices[job.vertexOffset + i];
+			vertex.position = { -position.x, position.y, position.z, 1.0f };
+			vertex.texcoode = { 0.0f, 0.0f };
+			if (job.hasTexcoords) {
+				vertex.texcoode = { ReadComponent(job.texcoords, i, 0), ReadComponent(job.texcoords, i, 1) };
+			}
+			vertex.normal = { 0.0f, 0.0f, 0.0f };
+			if (job.hasNormals) {
+				Vector3 normal = Normalize(TransformNormal({ ReadComponent(job.normals, i, 0), ReadComponent(job.normals, i, 1), ReadComponent(job.normals, i, 2) }, normalMatrix));
+				vertex.normal = { -normal.x, normal.y, normal.z };
+			}
+		}
+	});
+
+	//Xの反転で表裏が入れ替わるので並びを逆にする。ワールド行列が裏返すときはもう一度入れ替わるのでそのまま
+	const bool isFlipped = det < 0.0f;
+	const uint32_t order[3] = { 0, isFlipped ? 1u : 2u, isFlipped ? 2u : 1u };
+	std::atomic<bool> isValid = true;
+	ThreadPool::GetInstance().ParallelFor(job.indexCount / 3, 16384, [&](size_t begin, size_t end) {
+		for (size_t triangle = begin; triangle < end; triangle++) {
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t index = job.hasIndices ? ReadIndex(job.indices, triangle * 3 + order[corner]) : static_cast<uint32_t>(triangle * 3 + order[corner]);
+				if (index >= job.positions.count) {
+					isValid = false;
+					index = 0;
+				}
+				mesh.indices[job.indexOffset + triangle * 3 + corner] = static_cast<uint32_t>(job.vertexOffset + index);
+			}
+		}
+	});
+	return isValid;
+}
+#pragma endregion
+
+}
+
+bool ParseObjMesh(std::string_view text, MeshData& mesh, MeshLoadStatistics* statistics) {
+	Clock::time_point start = Clock::now();
+	mesh = {};
+
+	//改行の直後で区切り、区切りごとに並列に解析する
+	std::vector<const char*> boundaries = { text.data() };
+	const char* end = text.data() + text.size();
+	while (boundaries.back() < end) {
+		const char* boundary = boundaries.back() + std::min<size_t>(kObjChunkSize, end - boundaries.back());
+		if (boundary < end) {
+			const char* newline = static_cast<const char*>(std::memchr(boundary, '\n', end - boundary));
+			boundary = newline ? newline + 1 : end;
+		}
+		boundaries.push_back(boundary);
+	}
+	const size_t chunkCount = boundaries.size() - 1;
+	std::vector<ObjChunk> chunks(chunkCount);
+	ThreadPool::GetInstance().ParallelFor(chunkCount, 1, [&](size_t begin, size_t chunkEnd) {
+		for (size_t chunk = begin; chunk < chunkEnd; chunk++) {
+			ParseObjChunk(boundaries[chunk], boundaries[chunk + 1], chunks[chunk]);
+		}
+	});
+
+	//区切りごとの結果を並べる位置を決め、並列にコピーしながら相対インデックスを全体の番号に直す
+	struct ChunkOffset {
+		size_t attributes[3];
+		size_t corners;
+	};
+	std::vector<ChunkOffset> offsets(chunkCount + 1, ChunkOffset{});
+	for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+		if (!chunks[chunk].isValid) {
+			return false;
+		}
+		offsets[chunk + 1].attributes[0] = offsets[chunk].attributes[0] + chunks[chunk].positions.size();
+		offsets[chunk + 1].attributes[1] = offsets[chunk].attributes[1] + chunks[chunk].texcoords.size();
+		offsets[chunk + 1].attributes[2] = offsets[chunk].attributes[2] + chunks[chunk].normals.size();
+		offsets[chunk + 1].corners = offsets[chunk].corners + chunks[chunk].corners.size();
+	}
+	const ChunkOffset& totals = offsets[chunkCount];
+	if (totals.attributes[0] > static_cast<size_t>(std::numeric_limits<int32_t>::max()) || totals.corners > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+	std::vector<Vector3> positions(totals.attributes[0]);
+	std::vector<Vector2> texcoords(totals.attributes[1]);
+	std::vector<Vector3> normals(totals.attributes[2]);
+	std::vector<ObjCorner> corners(totals.corners);
+	std::atomic<bool> isValid = true;
+	ThreadPool::GetInstance().ParallelFor(chunkCount, 1, [&](size_t begin, size_t chunkEnd) {
+		for (size_t chunk = begin; chunk < chunkEnd; chunk++) {
+			const ObjChunk& source = chunks[chunk];
+			const ChunkOffset& offset = offsets[chunk];
+			std::copy(source.positions.begin(), source.positions.end(), positions.begin() + offset.attributes[0]);
+			std::copy(source.texcoords.begin(), source.texcoords.end(), texcoords.begin() + offset.attributes[1]);
+			std::copy(source.normals.begin(), source.normals.end(), normals.begin() + offset.attributes[2]);
+			ObjCorner* destination = corners.data() + offset.corners;
+			std::copy(source.corners.begin(), source.corners.end(), destination);
+			for (uint32_t relative : source.relativeAttributes) {
+				destination[relative / 3].attributes[relative % 3] += static_cast<int32_t>(offset.attributes[relative % 3]);
+			}
+			for (size_t i = 0; i < source.corners.size(); i++) {
+				for (int attribute = 0; attribute < 3; attribute++) {
+					int32_t index = destination[i].attributes[attribute];
+					if ((index < 0 && (index != kNoIndex || attribute == 0)) || (index >= 0 && static_cast<size_t>(index) >= totals.attributes[attribute])) {
+						isValid = false;
+					}
+				}
+			}
+		}
+	});
+	chunks.clear();
+	if (!isValid) {
+		return false;
+	}
+	double parseSeconds = SecondsSince(start);
+
+	//同じ(位置, UV, 法線)を1つの頂点にまとめる
+	Clock::time_point weldStart = Clock::now();
+	std::vector<ObjCorner> uniqueCorners;
+	WeldCorners(corners, positions.size(), uniqueCorners, mesh.indices);
+	mesh.vertices.resize(uniqueCorners.size());
+	ThreadPool::GetInstance().ParallelFor(uniqueCorners.size(), 16384, [&](size_t begin, size_t vertexEnd) {
+		for (size_t vertex = begin; vertex < vertexEnd; vertex++) {
+			const ObjCorner& corner = uniqueCorners[vertex];
+			const Vector3& position = positions[corner.attributes[0]];
+			mesh.vertices[vertex].position = { position.x, position.y, position.z, 1.0f };
+			mesh.vertices[vertex].texcoode = corner.attributes[1] != kNoIndex ? texcoords[corner.attributes[1]] : Vector2{ 0.0f, 0.0f };
+			mesh.vertices[vertex].normal = corner.attributes[2] != kNoIndex ? normals[corner.attributes[2]] : Vector3{ 0.0f, 0.0f, 0.0f };
+		}
+	});
+	ComputeMissingNormals(mesh, 0, mesh.vertices.size(), 0, mesh.indices.size());
+
+	if (statistics) {
+		statistics->fileSize = text.size();
+		statistics->parseSeconds = parseSeconds;
+		statistics->weldSeconds = SecondsSince(weldStart);
+		statistics->sourceVertexCount = corners.size();
+	}
+	FinishStatistics(statistics, start);
+	return true;
+}
+
+bool LoadObjMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics) {
+	Clock::time_point start = Clock::now();
+	mesh = {};
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	if (!ParseObjMesh(std::string_view(reinterpret_cast<const char*>(file.GetData()), file.GetSize()), mesh, statistics)) {
+		return false;
+	}
+	//マップにかかった時間も含める
+	FinishStatistics(statistics, start);
+	return true;
+}
+
+bool LoadGltfMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics) {
+	Clock::time_point start = Clock::now();
+	mesh = {};
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	size_t fileSize = file.GetSize();
+
+	//.glbならJSONとBINチャンクを取り出し、.gltfならファイル全体がJSON
+	GltfDocument document;
+	std::string_view json(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+	std::span<const std::byte> bin;
+	if (file.GetSize() >= 4 && ReadUint32(file.GetData()) == kGlbMagic) {
+		json = {};
+		if (!ParseGlb(file.GetBytes(), json, bin)) {
+			return false;
+		}
+	}
+	if (!JsonParser(json).Parse(document.root)) {
+		return false;
+	}
+
+	//バッファを集める。uriがなければGLBのBINチャンク、data URIならbase64を戻し、それ以外は同じフォルダのファイルを開く
+	if (const JsonValue* buffers = document.root.Find("buffers"); buffers && buffers->type == JsonValue::Type::Array) {
+		document.externalFiles.reserve(buffers->array.size());
+		document.decodedBuffers.reserve(buffers->array.size());
+		for (const JsonValue& buffer : buffers->array) {
+			size_t byteLength = 0;
+			if (!buffer.GetSize("byteLength", 0, byteLength)) {
+				return false;
+			}
+			const JsonValue* uri = buffer.Find("uri");
+			std::span<const std::byte> data;
+			if (!uri) {
+				data = bin;
+			} else if (uri->string.starts_with("data:")) {
+				size_t comma = uri->string.find(";base64,");
+				document.decodedBuffers.emplace_back();
+				if (comma == std::string::npos || !DecodeBase64(std::string_view(uri->string).substr(comma + 8), document.decodedBuffers.back())) {
+					return false;
+				}
+				data = document.decodedBuffers.back();
+			} else {
+				document.externalFiles.emplace_back();
+				//URIはUTF-8なので、そのままパスにするとWindowsで日本語の名前が化ける
+				std::string relativePath = DecodeUri(uri->string);
+				if (!document.externalFiles.back().Open(path.parent_path() / std::filesystem::path(std::u8string(relativePath.begin(), relativePath.end())))) {
+					return false;
+				}
+				data = document.externalFiles.back().GetBytes();
+				fileSize += data.size();
+			}
+			if (data.size() < byteLength) {
+				return false;
+			}
+			document.buffers.push_back(data.first(byteLength));
+		}
+	}
+
+	//既定のシーンのノードをたどる。シーンがなければすべてのメッシュをそのまま使う
+	std::vector<std::pair<int64_t, Matrix4x4>> instances;
+	size_t sceneIndex = 0;
+	if (!document.root.GetSize("scene", 0, sceneIndex)) {
+		return false;
+	}
+	const JsonValue* scene = sceneIndex <= static_cast<size_t>(std::numeric_limits<int64_t>::max())
+		? document.root.FindElement("scenes", static_cast<int64_t>(sceneIndex)) : nullptr;
+	if (scene) {
+		if (const JsonValue* nodes = scene->Find("nodes"); nodes && nodes->type == JsonValue::Type::Array) {
+			for (const JsonValue& node : nodes->array) {
+				CollectMeshInstances(document.root, static_cast<int64_t>(node.number), MakeIdentity4x4(), 0, instances);
+			}
+		}
+	} else if (const JsonValue* meshes = document.root.Find("meshes"); meshes && meshes->type == JsonValue::Type::Array) {
+		for (size_t i = 0; i < meshes->array.size(); i++) {
+			instances.push_back({ static_cast<int64_t>(i), MakeIdentity4x4() });
+		}
+	}
+
+	//三角形リストのプリミティブを調べて書き込む位置を決める
+	std::vector<GltfPrimitiveJob> jobs;
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (const std::pair<int64_t, Matrix4x4>& instance : instances) {
+		const JsonValue* gltfMesh = document.root.FindElement("meshes", instance.first);
+		const JsonValue* primitives = gltfMesh ? gltfMesh->Find("primitives") : nullptr;
+		if (!primitives || primitives->type != JsonValue::Type::Array) {
+			return false;
+		}
+		for (const JsonValue& primitive : primitives->array) {
+			const JsonValue* attributes = primitive.Find("attributes");
+			if (primitive.GetNumber("mode", kModeTriangles) != kModeTriangles || !attributes) {
+				continue;
+			}
+			GltfPrimitiveJob job{};
+			job.worldMatrix = instance.second;
+			if (!GetAccessorView(document, attributes->GetIndex("POSITION"), job.positions)
+				|| job.positions.componentType != kComponentFloat || job.positions.componentCount != 3) {
+				return false;
+			}
+			job.hasNormals = attributes->GetIndex("NORMAL") >= 0;
+			if (job.hasNormals && (!GetAccessorView(document, attributes->GetIndex("NORMAL"), job.normals)
+				|| job.normals.count != job.positions.count || job.normals.componentCount != 3)) {
+				return false;
+			}
+			job.hasTexcoords = attributes->GetIndex("TEXCOORD_0") >= 0;
+			if (job.hasTexcoords && (!GetAccessorView(document, attributes->GetIndex("TEXCOORD_0"), job.texcoords)
+				|| job.texcoords.count != job.positions.count || job.texcoords.componentCount != 2)) {
+				return false;
+			}
+			job.hasIndices = primitive.GetIndex("indices") >= 0;
+			if (job.hasIndices && (!GetAccessorView(document, primitive.GetIndex("indices"), job.indices) || job.indices.componentCount != 1
+				|| job.indices.componentType == kComponentFloat || job.indices.componentType == kComponentByte || job.indices.componentType == kComponentShort)) {
+				return false;
+			}
+			job.indexCount = (job.hasIndices ? job.indices.count : job.positions.count) / 3 * 3;
+			job.vertexOffset = vertexCount;
+			job.indexOffset = indexCount;
+			vertexCount += job.positions.count;
+			indexCount += job.indexCount;
+			jobs.push_back(job);
+		}
+	}
+	if (vertexCount > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+
+	mesh.vertices.resize(vertexCount);
+	mesh.indices.resize(indexCount);
+	for (const GltfPrimitiveJob& job : jobs) {
+		if (!WriteGltfPrimitive(job, mesh)) {
+			mesh = {};
+			return false;
+		}
+		if (!job.hasNormals) {
+			ComputeMissingNormals(mesh, job.vertexOffset, job.vertexOffset + job.positions.count, job.indexOffset, job.indexOffset + job.indexCount);
+		}
+	}
+
+	if (statistics) {
+		statistics->fileSize = fileSize;
+		statistics->parseSeconds = SecondsSince(start);
+		statistics->weldSeconds = 0.0;
+		statistics->sourceVertexCount = vertexCount;
+	}
+	FinishStatistics(statistics, start);
+	return true;
+}
+
+bool LoadMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics) {
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+	if (extension == ".obj") {
+		return LoadObjMesh(path, mesh, statistics);
+	}
+	if (extension == ".gltf" || extension == ".glb") {
+		return LoadGltfMesh(path, mesh, statistics);
+	}
+	mesh = {};
+	return false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "MeshData.h"
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+//OBJ・glTFのメッシュの読み込み
+//ファイルはMappedFileでマップして読み、コピーせずにそのまま解析する
+//
+//  OBJ  : テキストを改行の位置で区切ってスレッドプールで並列に解析し(数値はstd::from_chars)、
+//         同じ(位置, UV, 法線)の組をオープンアドレス法のハッシュで1つの頂点にまとめる。多角形は扇形に三角形に分ける
+//  glTF : .glb(バイナリ)と、.bin(またはdata URI)を参照する.gltf。既定のシーンのノードをたどり、
+//         三角形リストのプリミティブをノードの変換を掛けて1つのメッシュにまとめる。マテリアルとスキンは読まない
+//
+//どちらも右手座標系・反時計回りが表なので、Xを反転して左手座標系・時計回りが表(このプロジェクトの形式)に直す
+//OBJのUVは左下が原点なのでVを反転する。法線がない頂点は、その頂点を使う三角形の法線の平均にする
+
+/// <summary>
+/// 読み込みにかかった時間など
+/// </summary>
+struct MeshLoadStatistics {
+	//読んだファイルの大きさ(glTFは参照している.binも含む)
+	size_t fileSize;
+	//テキストの解析(glTFはバッファからの取り出し)にかかった時間
+	double parseSeconds;
+	//OBJの頂点をまとめるのにかかった時間
+	double weldSeconds;
+	//ファイルを開いてから終わるまでの時間
+	double totalSeconds;
+	//fileSize / totalSeconds (MB/s)
+	double megabytesPerSecond;
+	//まとめる前の頂点数(三角形の角の数)
+	size_t sourceVertexCount;
+};
+
+/// <summary>
+/// OBJのテキストを解析する
+/// </summary>
+/// <param name="text">OBJファイルの中身</param>
+/// <param name="mesh">結果。失敗したときは空にする</param>
+/// <param name="statistics">時間の書き込み先(fileSizeはtextの大きさ)。不要ならnullptr</param>
+/// <returns>インデックスが範囲外など、壊れていればfalse</returns>
+bool ParseObjMesh(std::string_view text, MeshData& mesh, MeshLoadStatistics* statistics = nullptr);
+
+/// <summary>
+/// OBJファイルを読み込む
+/// </summary>
+/// <param name="path">ファイルのパス</param>
+/// <param name="mesh">結果。失敗したときは空にする</param>
+/// <param name="statistics">時間の書き込み先。不要ならnullptr</param>
+/// <returns>開けない、または壊れていればfalse</returns>
+bool LoadObjMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics = nullptr);
+
+/// <summary>
+/// glTF(.gltf / .glb)ファイルを読み込む
+/// </summary>
+/// <param name="path">ファイルのパス。.gltfが参照する.binは同じフォルダからの相対パスで探す</param>
+/// <param name="mesh">結果。失敗したときは空にする</param>
+/// <param name="statistics">時間の書き込み先。不要ならnullptr</param>
+/// <returns>開けない、壊れている、または対応していない形式ならfalse</returns>
+bool LoadGltfMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics = nullptr);
+
+/// <summary>
+/// 拡張子(.obj / .gltf / .glb)で形式を選んで読み込む
+/// </summary>
+/// <param name="path">ファイルのパス</param>
+/// <param name="mesh">結果。失敗したときは空にする</param>
+/// <param name="statistics">時間の書き込み先。不要ならnullptr</param>
+/// <returns>失敗、または知らない拡張子ならfalse</returns>
+bool LoadMesh(const std::filesystem::path& path, MeshData& mesh, MeshLoadStatistics* statistics = nullptr);
@@ -0,0 +1,358 @@
+#include "MeshOptimizer.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kUnused = std::numeric_limits<uint32_t>::max();
+
+Vector3 GetPosition(const VertexData& vertex) {
+	return { vertex.position.x, vertex.position.y, vertex.position.z };
+}
+
+/// <summary>
+/// FIFOの頂点キャッシュ。時刻の差でキャッシュに残っているかを判定する
+/// </summary>
+class FifoCache {
+public:
+	FifoCache(size_t vertexCount, uint32_t cacheSize) : timeStamps_(vertexCount, 0), cacheSize_(cacheSize), time_(cacheSize + 1) {}
+
+	/// <summary>
+	/// 頂点を使う。キャッシュになければ追加してtrueを返す
+	/// </summary>
+	bool Access(uint32_t vertex) {
+		if (time_ - timeStamps_[vertex] > cacheSize_) {
+			timeStamps_[vertex] = time_++;
+			return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// キャッシュを空にする
+	/// </summary>
+	void Flush() {
+		time_ += cacheSize_ + 1;
+	}
+
+private:
+	std::vector<uint32_t> timeStamps_;
+	uint32_t cacheSize_;
+	uint32_t time_;
+};
+
+/// <summary>
+/// 1方向から平行投影でラスタライズし、深度テストを通ったピクセル数を数える
+/// </summary>
+/// <param name="axis">視線の軸(0:X 1:Y 2:Z)</param>
+/// <param name="sign">視線の向き(+1で軸の正の向きを見る)</param>
+void RasterizeView(std::span<const uint32_t> indices, std::span<const VertexData> vertices, const Vector3& min, float scale,
+	int axis, float sign, uint32_t resolution, std::vector<float>& depthBuffer, OverdrawStatistics& statistics) {
+	const int axisU = (axis + 1) % 3;
+	const int axisV = (axis + 2) % 3;
+	std::fill(depthBuffer.begin(), depthBuffer.end(), std::numeric_limits<float>::infinity());
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		Vector3 p[3] = { GetPosition(vertices[indices[i]]), GetPosition(vertices[indices[i + 1]]), GetPosition(vertices[indices[i + 2]]) };
+		//外側から見て時計回りなので、面の法線と視線が向き合っているものだけ描く
+		Vector3 normal = Cross(p[1] - p[0], p[2] - p[0]);
+		if ((&normal.x)[axis] * sign >= 0.0f) {
+			continue;
+		}
+		float x[3], y[3], z[3];
+		for (int k = 0; k < 3; k++) {
+			Vector3 local = p[k] - min;
+			x[k] = (&local.x)[axisU] * scale;
+			y[k] = (&local.x)[axisV] * scale;
+			z[k] = (&p[k].x)[axis] * sign;
+		}
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0.0f) {
+			continue;
+		}
+		float invArea = 1.0f / area;
+		const float maxPixel = static_cast<float>(resolution - 1);
+		int minX = static_cast<int>(std::max(0.0f, std::floor(std::min({ x[0], x[1], x[2] }))));
+		int maxX = static_cast<int>(std::min(maxPixel, std::ceil(std::max({ x[0], x[1], x[2] }))));
+		int minY = static_cast<int>(std::max(0.0f, std::floor(std::min({ y[0], y[1], y[2] }))));
+		int maxY = static_cast<int>(std::min(maxPixel, std::ceil(std::max({ y[0], y[1], y[2] }))));
+		for (int py = minY; py <= maxY; py++) {
+			float sy = static_cast<float>(py) + 0.5f;
+			for (int px = minX; px <= maxX; px++) {
+				float sx = static_cast<float>(px) + 0.5f;
+				//重心座標。面積で割って符号をそろえる
+				float w0 = ((x[1] - sx) * (y[2] - sy) - (x[2] - sx) * (y[1] - sy)) * invArea;
+				float w1 = ((x[2] - sx) * (y[0] - sy) - (x[0] - sx) * (y[2] - sy)) * invArea;
+				float w2 = 1.0f - w0 - w1;
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+					continue;
+				}
+				float depth = w0 * z[0] + w1 * z[1] + w2 * z[2];
+				float& stored = depthBuffer[static_cast<size_t>(py) * resolution + px];
+				if (depth < stored) {
+					stored = depth;
+					statistics.shadedPixels++;
+				}
+			}
+		}
+	}
+	for (float depth : depthBuffer) {
+		if (depth != std::numeric_limits<float>::infinity()) {
+			statistics.coveredPixels++;
+		}
+	}
+}
+
+}
+
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStatistics statistics = {};
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> isUsed(vertexCount, false);
+	uint32_t usedVertices = 0;
+	for (uint32_t index : indices) {
+		assert(index < vertexCount);
+		if (cache.Access(index)) {
+			statistics.transformedVertices++;
+		}
+		if (!isUsed[index]) {
+			isUsed[index] = true;
+			usedVertices++;
+		}
+	}
+	size_t triangleCount = indices.size() / 3;
+	statistics.acmr = triangleCount != 0 ? static_cast<float>(statistics.transformedVertices) / static_cast<float>(triangleCount) : 0.0f;
+	statistics.atvr = usedVertices != 0 ? static_cast<float>(statistics.transformedVertices) / static_cast<float>(usedVertices) : 0.0f;
+	return statistics;
+}
+
+OverdrawStatistics AnalyzeOverdraw(std::span<const uint32_t> indices, std::span<const VertexData> vertices, uint32_t resolution) {
+	OverdrawStatistics statistics = {};
+	if (indices.empty() || resolution == 0) {
+		return statistics;
+	}
+	//使われている頂点の範囲が解像度いっぱいに収まるように拡大する
+	constexpr float kInfinity = std::numeric_limits<float>::infinity();
+	Vector3 min = { kInfinity, kInfinity, kInfinity };
+	Vector3 max = { -kInfinity, -kInfinity, -kInfinity };
+	for (uint32_t index : indices) {
+		Vector3 position = GetPosition(vertices[index]);
+		min = { std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z) };
+		max = { std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z) };
+	}
+	float extent = std::max({ max.x - min.x, max.y - min.y, max.z - min.z });
+	float scale = extent > 0.0f ? static_cast<float>(resolution) / extent : 0.0f;
+
+	std::vector<float> depthBuffer(static_cast<size_t>(resolution) * resolution);
+	for (int axis = 0; axis < 3; axis++) {
+		RasterizeView(indices, vertices, min, scale, axis, 1.0f, resolution, depthBuffer, statistics);
+		RasterizeView(indices, vertices, min, scale, axis, -1.0f, resolution, depthBuffer, statistics);
+	}
+	statistics.overdraw = statistics.coveredPixels != 0 ? static_cast<float>(statistics.shadedPixels) / static_cast<float>(statistics.coveredPixels) : 0.0f;
+	return statistics;
+}
+
+std::vector<uint32_t> OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	assert(indices.size() % 3 == 0);
+	std::vector<uint32_t> clusters;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return clusters;
+	}
+	const VertexAdjacency adjacency = BuildVertexAdjacency(indices, vertexCount);
+	//まだ出力していない三角形の数
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+	}
+	std::vector<uint32_t> timeStamps(vertexCount, 0);
+	std::vector<bool> isEmitted(triangleCount, false);
+	//行き止まりになったときに戻る候補(最近使った頂点)
+	std::vector<uint32_t> deadEndStack;
+	deadEndStack.reserve(indices.size());
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+		cursor++;
+	}
+	uint32_t fanning = cursor < vertexCount ? cursor : kUnused;
+	bool isNewCluster = true;
+	while (fanning != kUnused) {
+		if (isNewCluster) {
+			clusters.push_back(static_cast<uint32_t>(result.size() / 3));
+		}
+		//扇の中心の頂点を使う三角形をすべて出力する
+		candidates.clear();
+		for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+			uint32_t triangle = adjacency.triangles[i];
+			if (isEmitted[triangle]) {
+				continue;
+			}
+			isEmitted[triangle] = true;
+			for (int k = 0; k < 3; k++) {
+				uint32_t vertex = indices[triangle * 3 + k];
+				result.push_back(vertex);
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - timeStamps[vertex] > cacheSize) {
+					timeStamps[vertex] = time++;
+				}
+			}
+		}
+
+		//次の扇の中心は、残りの三角形を出してもキャッシュから追い出されない頂点のうち一番古いもの
+		uint32_t best = kUnused;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (liveTriangles[vertex] == 0) {
+				continue;
+			}
+			int64_t priority = 0;
+			if (time - timeStamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+				priority = time - timeStamps[vertex];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+		isNewCluster = best == kUnused;
+		if (best == kUnused) {
+			//行き止まり。最近使った頂点から戻り、なければ頂点番号順に探す
+			while (!deadEndStack.empty()) {
+				uint32_t vertex = deadEndStack.back();
+				deadEndStack.pop_back();
+				if (liveTriangles[vertex] > 0) {
+					best = vertex;
+					break;
+				}
+			}
+			if (best == kUnused) {
+				while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+					cursor++;
+				}
+				best = cursor < vertexCount ? cursor : kUnused;
+			}
+		}
+		fanning = best;
+	}
+	std::copy(result.begin(), result.end(), indices.begin());
+	return clusters;
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const VertexData> vertices, std::span<const uint32_t> clusters,
+	float threshold, uint32_t cacheSize) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || clusters.empty()) {
+		return;
+	}
+	const float meshAcmr = AnalyzeVertexCache(indices, vertices.size(), cacheSize).acmr;
+
+	//キャッシュの効率が全体のthreshold倍以内に収まったところでクラスタを細かく分ける
+	//並べ替えた後は前のクラスタの頂点がキャッシュに残っていないので、クラスタごとに空のキャッシュから数える
+	std::vector<uint32_t> starts;
+	FifoCache cache(vertices.size(), cacheSize);
+	for (size_t c = 0; c < clusters.size(); c++) {
+		uint32_t begin = clusters[c];
+		uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+		uint32_t softBegin = begin;
+		uint32_t misses = 0;
+		starts.push_back(begin);
+		cache.Flush();
+		for (uint32_t triangle = begin; triangle < end; triangle++) {
+			for (int k = 0; k < 3; k++) {
+				misses += cache.Access(indices[triangle * 3 + k]) ? 1 : 0;
+			}
+			float acmr = static_cast<float>(misses) / static_cast<float>(triangle - softBegin + 1);
+			if (triangle + 1 < end && acmr <= meshAcmr * threshold) {
+				softBegin = triangle + 1;
+				misses = 0;
+				starts.push_back(softBegin);
+				cache.Flush();
+			}
+		}
+	}
+
+	//クラスタの面積で重みをつけた中心と法線。メッシュの中心から外を向いているものほど先に描く
+	struct Cluster {
+		uint32_t begin;
+		uint32_t end;
+		Vector3 centroid;
+		Vector3 normal;
+		float sortKey;
+	};
+	std::vector<Cluster> sorted(starts.size());
+	Vector3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < starts.size(); c++) {
+		Cluster& cluster = sorted[c];
+		cluster.begin = starts[c];
+		cluster.end = c + 1 < starts.size() ? starts[c + 1] : static_cast<uint32_t>(triangleCount);
+		cluster.centroid = { 0.0f, 0.0f, 0.0f };
+		cluster.normal = { 0.0f, 0.0f, 0.0f };
+		float clusterArea = 0.0f;
+		for (uint32_t triangle = cluster.begin; triangle < cluster.end; triangle++) {
+			Vector3 p0 = GetPosition(vertices[indices[triangle * 3]]);
+			Vector3 p1 = GetPosition(vertices[indices[triangle * 3 + 1]]);
+			Vector3 p2 = GetPosition(vertices[indices[triangle * 3 + 2]]);
+			Vector3 normal = Cross(p1 - p0, p2 - p0);
+			float area = std::sqrt(Dot(normal, normal));
+			cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+			cluster.normal += normal;
+			clusterArea += area;
+		}
+		meshCentroid += cluster.centroid;
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f) {
+			cluster.centroid /= clusterArea;
+		}
+	}
+	if (meshArea > 0.0f) {
+		meshCentroid /= meshArea;
+	}
+	for (Cluster& cluster : sorted) {
+		float length = std::sqrt(Dot(cluster.normal, cluster.normal));
+		cluster.sortKey = length > 0.0f ? Dot(cluster.centroid - meshCentroid, cluster.normal) / length : 0.0f;
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const Cluster& cluster : sorted) {
+		result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+	}
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+size_t OptimizeVertexFetch(std::span<VertexData> vertices, std::span<uint32_t> indices) {
+	std::vector<uint32_t> remap(vertices.size(), kUnused);
+	uint32_t usedCount = 0;
+	for (uint32_t& index : indices) {
+		assert(index < vertices.size());
+		if (remap[index] == kUnused) {
+			remap[index] = usedCount++;
+		}
+		index = remap[index];
+	}
+	std::vector<VertexData> sorted(usedCount);
+	for (size_t vertex = 0; vertex < vertices.size(); vertex++) {
+		if (remap[vertex] != kUnused) {
+			sorted[remap[vertex]] = vertices[vertex];
+		}
+	}
+	std::copy(sorted.begin(), sorted.end(), vertices.begin());
+	return usedCount;
+}
+
+void OptimizeMesh(MeshData& mesh, float overdrawThreshold) {
+	std::vector<uint32_t> clusters = OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+	OptimizeOverdraw(mesh.indices, mesh.vertices, clusters, overdrawThreshold);
+	mesh.vertices.resize(OptimizeVertexFetch(mesh.vertices, mesh.indices));
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "MeshData.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//インデックスバッファの並べ替えと、その効果をGPUなしで確かめる統計
+//どの関数も三角形リスト(3つずつのインデックス)を受け取り、メッシュ生成・読み込みのどの結果にも使える
+//おすすめの順番は OptimizeVertexCache -> OptimizeOverdraw -> OptimizeVertexFetch (OptimizeMeshでまとめて行う)
+
+/// <summary>
+/// 頂点キャッシュの統計
+/// </summary>
+struct VertexCacheStatistics {
+	//頂点シェーダーを実行した回数(キャッシュミス)
+	uint32_t transformedVertices;
+	//三角形あたりの頂点シェーダーの実行回数(ACMR)。理想は0.5付近、最悪は3
+	float acmr;
+	//使われている頂点あたりの実行回数(ATVR)。理想は1
+	float atvr;
+};
+
+/// <summary>
+/// オーバードローの統計
+/// </summary>
+struct OverdrawStatistics {
+	//最終的に映ったピクセル数
+	uint32_t coveredPixels;
+	//深度テストを通ってピクセルシェーダーを実行したピクセル数
+	uint32_t shadedPixels;
+	//shadedPixels / coveredPixels。1が理想
+	float overdraw;
+};
+
+/// <summary>
+/// FIFOの頂点キャッシュを真似して統計を取る
+/// </summary>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="cacheSize">キャッシュの大きさ(頂点数)</param>
+/// <returns></returns>
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+/// <summary>
+/// 6方向(±X, ±Y, ±Z)から平行投影でソフトウェアラスタライズし、描画順によるオーバードローを測る
+/// 外側から見て時計回りの面を表として、裏面は描かない
+/// </summary>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="vertices">頂点</param>
+/// <param name="resolution">1方向あたりの解像度(ピクセル)</param>
+/// <returns>6方向の合計</returns>
+OverdrawStatistics AnalyzeOverdraw(std::span<const uint32_t> indices, std::span<const VertexData> vertices, uint32_t resolution = 256);
+
+/// <summary>
+/// 頂点キャッシュに合わせて三角形を並べ替える(Tipsify法。キャッシュの大きさに対して線形時間)
+/// </summary>
+/// <param name="indices">三角形リストのインデックス。並べ替えた結果で上書きする</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="cacheSize">想定する頂点キャッシュの大きさ</param>
+/// <returns>扇状に出力したまとまり(クラスタ)の先頭の三角形番号。OptimizeOverdrawに渡す</returns>
+std::vector<uint32_t> OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+/// <summary>
+/// クラスタの中の順番は保ったまま、外を向いたクラスタが先に描かれるようにクラスタを並べ替える
+/// 頂点キャッシュの効率をthreshold倍まで悪くしてよい範囲でクラスタを細かく分けてから並べる
+/// </summary>
+/// <param name="indices">OptimizeVertexCacheを通したインデックス。並べ替えた結果で上書きする</param>
+/// <param name="vertices">頂点</param>
+/// <param name="clusters">OptimizeVertexCacheが返したクラスタの先頭</param>
+/// <param name="threshold">ACMRを何倍まで悪くしてよいか(1.05なら5%)</param>
+/// <param name="cacheSize">想定する頂点キャッシュの大きさ</param>
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const VertexData> vertices, std::span<const uint32_t> clusters,
+	float threshold = 1.05f, uint32_t cacheSize = 16);
+
+/// <summary>
+/// インデックスで最初に使われる順に頂点を並べ替え、使われていない頂点を詰める(頂点の読み込みを連続にする)
+/// </summary>
+/// <param name="vertices">頂点。並べ替えた結果で上書きする</param>
+/// <param name="indices">インデックス。新しい頂点番号に書き換える</param>
+/// <returns>使われている頂点数。verticesの先頭からこの数だけが有効</returns>
+size_t OptimizeVertexFetch(std::span<VertexData> vertices, std::span<uint32_t> indices);
+
+/// <summary>
+/// 頂点キャッシュ、オーバードロー、頂点の読み込みの順にまとめて最適化し、使われていない頂点を取り除く
+/// </summary>
+/// <param name="mesh">メッシュ</param>
+/// <param name="overdrawThreshold">OptimizeOverdrawのthreshold</param>
+void OptimizeMesh(MeshData& mesh, float overdrawThreshold = 1.05f);
@@ -0,0 +1,504 @@
+#include "MeshSimplifier.h"
+#include "Bounds.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+//開いた辺が2本以上ある
+constexpr uint32_t kMultiple = kNone - 1;
+//縁と継ぎ目を保つ平面の重み(三角形の平面に対する倍率)
+constexpr float kEdgeWeight = 10.0f;
+//1回に並列で調べる三角形の数
+constexpr size_t kTriangleGrainSize = 16384;
+
+enum class VertexKind : uint8_t {
+	//周りが閉じている。どの隣の頂点へも寄せられる
+	Manifold,
+	//開いた縁の上。縁に沿ってだけ寄せられる
+	Border,
+	//UVや法線の継ぎ目の上(同じ位置に頂点が2つ)。継ぎ目に沿って両側をそろえてだけ寄せられる
+	Seam,
+	//縁の分岐など。動かさない
+	Locked,
+};
+
+/// <summary>
+/// 平面までの距離の二乗の和を表す二次形式 p^T A p + 2 b・p + c
+/// </summary>
+struct Quadric {
+	float a00, a01, a02, a11, a12, a22;
+	float b0, b1, b2;
+	float c;
+	//足した平面の重みの合計。誤差を重みで割って、面積に依らない距離の二乗にする
+	float weight;
+};
+
+/// <summary>
+/// 縮約の候補。fromをtoへ寄せる
+/// </summary>
+struct Collapse {
+	uint32_t from;
+	uint32_t to;
+	float cost;
+};
+
+/// <summary>
+/// Dot(normal, p) + distance = 0 の平面の二次形式
+/// </summary>
+Quadric MakePlaneQuadric(const Vector3& normal, float distance, float weight) {
+	return {
+		weight * normal.x * normal.x, weight * normal.x * normal.y, weight * normal.x * normal.z,
+		weight * normal.y * normal.y, weight * normal.y * normal.z, weight * normal.z * normal.z,
+		weight * normal.x * distance, weight * normal.y * distance, weight * normal.z * distance,
+		weight * distance * distance, weight,
+	};
+}
+
+void AddQuadric(Quadric& quadric, const Quadric& other) {
+	quadric.a00 += other.a00;
+	quadric.a01 += other.a01;
+	quadric.a02 += other.a02;
+	quadric.a11 += other.a11;
+	quadric.a12 += other.a12;
+	quadric.a22 += other.a22;
+	quadric.b0 += other.b0;
+	quadric.b1 += other.b1;
+	quadric.b2 += other.b2;
+	quadric.c += other.c;
+	quadric.weight += other.weight;
+}
+
+float EvaluateQuadric(const Quadric& quadric, const Vector3& p) {
+	float rx = quadric.a00 * p.x + quadric.a01 * p.y + quadric.a02 * p.z;
+	float ry = quadric.a01 * p.x + quadric.a11 * p.y + quadric.a12 * p.z;
+	float rz = quadric.a02 * p.x + quadric.a12 * p.y + quadric.a22 * p.z;
+	float r = rx * p.x + ry * p.y + rz * p.z + 2.0f * (quadric.b0 * p.x + quadric.b1 * p.y + quadric.b2 * p.z) + quadric.c;
+	return quadric.weight > 0.0f ? std::fabs(r) / quadric.weight : 0.0f;
+}
+
+/// <summary>
+/// メッシュの大きさ(AABBの一番長い辺)
+/// </summary>
+float ComputeMeshScale(std::span<const VertexData> vertices) {
+	AABB aabb = ComputeAABB(vertices);
+	return std::max({ aabb.max.x - aabb.min.x, aabb.max.y - aabb.min.y, aabb.max.z - aabb.min.z });
+}
+
+bool IsUnique(uint32_t vertex) {
+	return vertex != kNone && vertex != kMultiple;
+}
+
+/// <summary>
+/// 簡略化の途中の状態。頂点番号は元のverticesのまま使う
+/// </summary>
+class Simplifier {
+public:
+	Simplifier(std::span<const VertexData> vertices, std::span<const uint32_t> indices, const SimplifyOptions& options, float scale);
+
+	/// <summary>
+	/// 全体を調べて、重ならない縮約をまとめて1回行う
+	/// </summary>
+	/// <param name="targetTriangleCount">目標の三角形数</param>
+	/// <param name="errorLimit">許す誤差(大きさ1に直した距離の二乗)</param>
+	/// <returns>縮約できなければfalse</returns>
+	bool RunPass(size_t targetTriangleCount, float errorLimit);
+
+	inline size_t GetTriangleCount() const { return indices_.size() / 3; }
+	inline float GetMaxError() const { return maxError_; }
+	inline std::vector<uint32_t>& GetIndices() { return indices_; }
+
+private:
+	void Classify();
+	bool CanCollapse(uint32_t from, uint32_t to) const;
+	//継ぎ目の頂点fromをtoへ寄せるとき、反対側の頂点を寄せる先
+	uint32_t GetSeamTarget(uint32_t from, uint32_t to) const;
+	float GetAttributeError(uint32_t from, uint32_t to) const;
+	float GetCollapseCost(uint32_t from, uint32_t to) const;
+	bool HasEdge(uint32_t a, uint32_t b) const;
+	bool HasTriangleFlip(uint32_t from, uint32_t to) const;
+
+	std::span<const VertexData> vertices_;
+	std::vector<uint32_t> indices_;
+	float normalWeightSq_;
+	float uvWeightSq_;
+	//大きさ1に直した位置
+	std::vector<Vector3> positions_;
+	//同じ位置の頂点の代表。二次形式と「動かしたか」は代表ごとに持つ
+	std::vector<uint32_t> remap_;
+	//同じ位置の次の頂点(循環リスト)
+	std::vector<uint32_t> wedge_;
+	std::vector<Quadric> quadrics_;
+	float maxError_ = 0.0f;
+
+	//以下はパスごとに作り直す
+	VertexAdjacency adjacency_;
+	std::vector<uint32_t> openOut_;
+	std::vector<uint32_t> openIn_;
+	std::vector<VertexKind> kinds_;
+	//継ぎ目の頂点の、同じ位置にあるもう1つの頂点
+	std::vector<uint32_t> seamPartner_;
+	std::vector<uint32_t> collapseRemap_;
+	std::vector<bool> isLocked_;
+};
+
+Simplifier::Simplifier(std::span<const VertexData> vertices, std::span<const uint32_t> indices, const SimplifyOptions& options, float scale)
+	: vertices_(vertices), indices_(indices.begin(), indices.end()),
+	normalWeightSq_(options.normalWeight * options.normalWeight), uvWeightSq_(options.uvWeight * options.uvWeight) {
+	const size_t vertexCount = vertices.size();
+	AABB aabb = ComputeAABB(vertices);
+	const float invScale = scale > 0.0f ? 1.0f / scale : 0.0f;
+	positions_.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		positions_[i] = { (vertices[i].position.x - aabb.min.x) * invScale, (vertices[i].position.y - aabb.min.y) * invScale,
+			(vertices[i].position.z - aabb.min.z) * invScale };
+	}
+
+	//位置で並べ替えて、同じ位置の頂点をまとめる
+	std::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	auto key = [&vertices](uint32_t v) { return std::tie(vertices[v].position.x, vertices[v].position.y, vertices[v].position.z); };
+	std::sort(order.begin(), order.end(), [&key](uint32_t a, uint32_t b) { return key(a) < key(b); });
+	remap_.resize(vertexCount);
+	wedge_.resize(vertexCount);
+	for (size_t begin = 0, end = 0; begin < vertexCount; begin = end) {
+		end = begin + 1;
+		while (end < vertexCount && key(order[end]) == key(order[begin])) {
+			end++;
+		}
+		for (size_t i = begin; i < end; i++) {
+			remap_[order[i]] = order[begin];
+			wedge_[order[i]] = order[i + 1 < end ? i + 1 : begin];
+		}
+	}
+
+	//三角形の平面を面積で重み付けして足す
+	quadrics_.assign(vertexCount, Quadric{});
+	const size_t triangleCount = indices_.size() / 3;
+	std::vector<Vector3> normals(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		const uint32_t* corners = &indices_[triangle * 3];
+		const Vector3& p0 = positions_[corners[0]];
+		Vector3 normal = Cross(positions_[corners[1]] - p0, positions_[corners[2]] - p0);
+		float area = Length(normal);
+		if (area == 0.0f) {
+			continue;
+		}
+		normal = normal * (1.0f / area);
+		normals[triangle] = normal;
+		Quadric quadric = MakePlaneQuadric(normal, -Dot(normal, p0), area);
+		for (int corner = 0; corner < 3; corner++) {
+			AddQuadric(quadrics_[remap_[corners[corner]]], quadric);
+		}
+	}
+
+	//開いた辺(縁と継ぎ目)には、辺を含み三角形に垂直な平面を足して、辺が内側に縮まないようにする
+	adjacency_ = BuildVertexAdjacency(indices_, vertexCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t a = indices_[triangle * 3 + corner];
+			uint32_t b = indices_[triangle * 3 + (corner + 1) % 3];
+			if (HasEdge(b, a)) {
+				continue;
+			}
+			Vector3 edge = positions_[b] - positions_[a];
+			Vector3 normal = Normalize(Cross(edge, normals[triangle]));
+			Quadric quadric = MakePlaneQuadric(normal, -Dot(normal, positions_[a]), Dot(edge, edge) * kEdgeWeight);
+			AddQuadric(quadrics_[remap_[a]], quadric);
+			AddQuadric(quadrics_[remap_[b]], quadric);
+		}
+	}
+
+	collapseRemap_.resize(vertexCount);
+	std::iota(collapseRemap_.begin(), collapseRemap_.end(), 0u);
+	isLocked_.assign(vertexCount, false);
+}
+
+bool Simplifier::HasEdge(uint32_t a, uint32_t b) const {
+	for (uint32_t i = adjacency_.offsets[a]; i < adjacency_.offsets[a + 1]; i++) {
+		const uint32_t* corners = &indices_[adjacency_.triangles[i] * 3];
+		if ((corners[0] == a && corners[1] == b) || (corners[1] == a && corners[2] == b) || (corners[2] == a && corners[0] == b)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Simplifier::Classify() {
+	const size_t vertexCount = vertices_.size();
+	const size_t triangleCount = indices_.size() / 3;
+	openOut_.assign(vertexCount, kNone);
+	openIn_.assign(vertexCount, kNone);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t a = indices_[triangle * 3 + corner];
+			uint32_t b = indices_[triangle * 3 + (corner + 1) % 3];
+			if (!HasEdge(b, a)) {
+				openOut_[a] = openOut_[a] == kNone ? b : kMultiple;
+				openIn_[b] = openIn_[b] == kNone ? a : kMultiple;
+			}
+		}
+	}
+
+	kinds_.assign(vertexCount, VertexKind::Locked);
+	seamPartner_.assign(vertexCount, kNone);
+	auto isLive = [this](uint32_t v) { return adjacency_.offsets[v + 1] != adjacency_.offsets[v]; };
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		if (!isLive(v)) {
+			continue;
+		}
+		uint32_t liveWedgeCount = 1;
+		uint32_t other = kNone;
+		for (uint32_t w = wedge_[v]; w != v; w = wedge_[w]) {
+			if (isLive(w)) {
+				liveWedgeCount++;
+				other = w;
+			}
+		}
+		if (liveWedgeCount == 1) {
+			if (openIn_[v] == kNone && openOut_[v] == kNone) {
+				kinds_[v] = VertexKind::Manifold;
+			} else if (IsUnique(openIn_[v]) && IsUnique(openOut_[v])) {
+				kinds_[v] = VertexKind::Border;
+			}
+		} else if (liveWedgeCount == 2 && IsUnique(openIn_[v]) && IsUnique(openOut_[v]) && IsUnique(openIn_[other]) && IsUnique(openOut_[other]) &&
+			remap_[openIn_[v]] == remap_[openOut_[other]] && remap_[openOut_[v]] == remap_[openIn_[other]]) {
+			//継ぎ目は両側で向きが逆になる
+			kinds_[v] = VertexKind::Seam;
+			seamPartner_[v] = other;
+		}
+	}
+}
+
+bool Simplifier::CanCollapse(uint32_t from, uint32_t to) const {
+	const VertexKind toKind = kinds_[to];
+	switch (kinds_[from]) {
+	case VertexKind::Manifold:
+		return true;
+	case VertexKind::Border:
+		return (toKind == VertexKind::Border || toKind == VertexKind::Locked) && (openOut_[from] == to || openIn_[from] == to);
+	case VertexKind::Seam:
+		return (toKind == VertexKind::Seam || toKind == VertexKind::Locked) && (openOut_[from] == to || openIn_[from] == to);
+	default:
+		return false;
+	}
+}
+
+uint32_t Simplifier::GetSeamTarget(uint32_t from, uint32_t to) const {
+	const uint32_t partner = seamPartner_[from];
+	return openOut_[from] == to ? openIn_[partner] : openOut_[partner];
+}
+
+float Simplifier::GetAttributeError(uint32_t from, uint32_t to) const {
+	const VertexData& a = vertices_[from];
+	const VertexData& b = vertices_[to];
+	float nx = a.normal.x - b.normal.x;
+	float ny = a.normal.y - b.normal.y;
+	float nz = a.normal.z - b.normal.z;
+	float u = a.texcoode.x - b.texcoode.x;
+	float v = a.texcoode.y - b.texcoode.y;
+	return normalWeightSq_ * (nx * nx + ny * ny + nz * nz) + uvWeightSq_ * (u * u + v * v);
+}
+
+float Simplifier::GetCollapseCost(uint32_t from, uint32_t to) const {
+	float attributeError = GetAttributeError(from, to);
+	if (kinds_[from] == VertexKind::Seam) {
+		attributeError = std::max(attributeError, GetAttributeError(seamPartner_[from], GetSeamTarget(from, to)));
+	}
+	return EvaluateQuadric(quadrics_[remap_[from]], positions_[to]) + attributeError;
+}
+
+bool Simplifier::HasTriangleFlip(uint32_t from, uint32_t to) const {
+	const Vector3& fromPosition = positions_[from];
+	const Vector3& toPosition = positions_[to];
+	const uint32_t toRemap = remap_[to];
+	for (uint32_t i = adjacency_.offsets[from]; i < adjacency_.offsets[from + 1]; i++) {
+		const uint32_t* corners = &indices_[adjacency_.triangles[i] * 3];
+		//このパスで先に寄せた頂点があるので、今の頂点に直してから調べる
+		uint32_t current[3] = { collapseRemap_[corners[0]], collapseRemap_[corners[1]], collapseRemap_[corners[2]] };
+		int k = current[0] == from ? 0 : (current[1] == from ? 1 : 2);
+		uint32_t a = current[(k + 1) % 3];
+		uint32_t b = current[(k + 2) % 3];
+		//縮約する辺を含む三角形と、もう潰れている三角形は消えるので調べない
+		if (remap_[a] == toRemap || remap_[b] == toRemap || remap_[a] == remap_[b]) {
+			continue;
+		}
+		Vector3 before = Cross(positions_[a] - fromPosition, positions_[b] - fromPosition);
+		Vector3 after = Cross(positions_[a] - toPosition, positions_[b] - toPosition);
+		if (Dot(before, after) <= 0.0f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Simplifier::RunPass(size_t targetTriangleCount, float errorLimit) {
+	const size_t triangleCount = indices_.size() / 3;
+	if (triangleCount <= targetTriangleCount) {
+		return false;
+	}
+	adjacency_ = BuildVertexAdjacency(indices_, vertices_.size());
+	Classify();
+
+	//辺ごとに、寄せられる向きのうち安いほうを候補にする。両側に三角形がある辺は番号の小さい側からだけ調べる
+	std::vector<Collapse> collapses(triangleCount * 3);
+	ThreadPool::GetInstance().ParallelFor(triangleCount, kTriangleGrainSize, [this, &collapses](size_t begin, size_t end) {
+		for (size_t triangle = begin; triangle < end; triangle++) {
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t a = indices_[triangle * 3 + corner];
+				uint32_t b = indices_[triangle * 3 + (corner + 1) % 3];
+				Collapse& collapse = collapses[triangle * 3 + corner];
+				collapse = { a, b, std::numeric_limits<float>::infinity() };
+				if (a > b && HasEdge(b, a)) {
+					continue;
+				}
+				if (CanCollapse(a, b)) {
+					collapse.cost = GetCollapseCost(a, b);
+				}
+				if (CanCollapse(b, a)) {
+					float cost = GetCollapseCost(b, a);
+					if (cost < collapse.cost) {
+						collapse = { b, a, cost };
+					}
+				}
+			}
+		}
+	});
+	collapses.erase(std::remove_if(collapses.begin(), collapses.end(), [errorLimit](const Collapse& collapse) { return !(collapse.cost <= errorLimit); }),
+		collapses.end());
+	if (collapses.empty()) {
+		return false;
+	}
+	std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+	//安い順に、まだこのパスで触っていない位置どうしの縮約を行う
+	const size_t removeGoal = triangleCount - targetTriangleCount;
+	size_t removedEstimate = 0;
+	std::vector<uint32_t> collapsed;
+	for (const Collapse& collapse : collapses) {
+		if (removedEstimate >= removeGoal) {
+			break;
+		}
+		const uint32_t fromRemap = remap_[collapse.from];
+		const uint32_t toRemap = remap_[collapse.to];
+		if (isLocked_[fromRemap] || isLocked_[toRemap] || HasTriangleFlip(collapse.from, collapse.to)) {
+			continue;
+		}
+		if (kinds_[collapse.from] == VertexKind::Seam) {
+			const uint32_t partner = seamPartner_[collapse.from];
+			const uint32_t partnerTarget = GetSeamTarget(collapse.from, collapse.to);
+			if (HasTriangleFlip(partner, partnerTarget)) {
+				continue;
+			}
+			collapseRemap_[partner] = partnerTarget;
+			collapsed.push_back(partner);
+		}
+		collapseRemap_[collapse.from] = collapse.to;
+		collapsed.push_back(collapse.from);
+		AddQuadric(quadrics_[toRemap], quadrics_[fromRemap]);
+		isLocked_[fromRemap] = true;
+		isLocked_[toRemap] = true;
+		maxError_ = std::max(maxError_, collapse.cost);
+		//内側の辺を縮約すると三角形が2つ、縁では1つ消える
+		removedEstimate += kinds_[collapse.from] == VertexKind::Border ? 1 : 2;
+	}
+	if (collapsed.empty()) {
+		return false;
+	}
+
+	//寄せた頂点を書き換え、潰れた三角形を取り除く
+	size_t writeIndex = 0;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		uint32_t a = collapseRemap_[indices_[triangle * 3 + 0]];
+		uint32_t b = collapseRemap_[indices_[triangle * 3 + 1]];
+		uint32_t c = collapseRemap_[indices_[triangle * 3 + 2]];
+		if (remap_[a] != remap_[b] && remap_[b] != remap_[c] && remap_[c] != remap_[a]) {
+			indices_[writeIndex++] = a;
+			indices_[writeIndex++] = b;
+			indices_[writeIndex++] = c;
+		}
+	}
+	indices_.resize(writeIndex);
+	for (uint32_t vertex : collapsed) {
+		collapseRemap_[vertex] = vertex;
+	}
+	std::fill(isLocked_.begin(), isLocked_.end(), false);
+	return true;
+}
+
+}
+
+float SimplifyMesh(std::span<const VertexData> vertices, std::span<const uint32_t> indices, const SimplifyOptions& options,
+	std::vector<uint32_t>& result) {
+	assert(indices.size() % 3 == 0);
+	const float scale = ComputeMeshScale(vertices);
+	Simplifier simplifier(vertices, indices, options, scale);
+	const float errorLimit = options.targetError * options.targetError;
+	while (simplifier.GetTriangleCount() > options.targetTriangleCount) {
+		if (!simplifier.RunPass(options.targetTriangleCount, errorLimit)) {
+			break;
+		}
+	}
+	result = std::move(simplifier.GetIndices());
+	return std::sqrt(simplifier.GetMaxError()) * scale;
+}
+
+MeshLODChain BuildLODChain(const MeshData& mesh, const LODChainOptions& options) {
+	assert(options.maxLevelCount >= 1 && options.reduction > 0.0f && options.reduction < 1.0f);
+	const float scale = ComputeMeshScale(mesh.vertices);
+	std::vector<std::vector<uint32_t>> levelIndices;
+	levelIndices.push_back(mesh.indices);
+	MeshLODChain chain;
+	chain.errors.push_back(0.0f);
+	while (levelIndices.size() < options.maxLevelCount) {
+		const std::vector<uint32_t>& current = levelIndices.back();
+		const size_t triangleCount = current.size() / 3;
+		//誤差は段階ごとに足していくので、残りの分だけを許す
+		const float remainingError = options.maxError - (scale > 0.0f ? chain.errors.back() / scale : 0.0f);
+		if (triangleCount <= options.minTriangleCount || remainingError <= 0.0f) {
+			break;
+		}
+		SimplifyOptions simplifyOptions;
+		simplifyOptions.targetTriangleCount = std::max(options.minTriangleCount, static_cast<size_t>(static_cast<float>(triangleCount) * options.reduction));
+		simplifyOptions.targetError = remainingError;
+		simplifyOptions.normalWeight = options.normalWeight;
+		simplifyOptions.uvWeight = options.uvWeight;
+		std::vector<uint32_t> next;
+		float error = SimplifyMesh(mesh.vertices, current, simplifyOptions, next);
+		//ほとんど減らないなら、縁や継ぎ目、誤差の上限で止まっているのでそれ以上は作らない
+		if (next.empty() || next.size() > current.size() - current.size() / 10) {
+			break;
+		}
+		chain.errors.push_back(chain.errors.back() + error);
+		levelIndices.push_back(std::move(next));
+	}
+
+	//段階ごとに頂点キャッシュ向けに並べ替えてから1つのインデックスバッファに続けて置く
+	chain.mesh.vertices = mesh.vertices;
+	for (std::vector<uint32_t>& indices : levelIndices) {
+		OptimizeVertexCache(indices, mesh.vertices.size());
+		chain.levels.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(chain.mesh.indices.size()), 0 });
+		chain.mesh.indices.insert(chain.mesh.indices.end(), indices.begin(), indices.end());
+	}
+	//段階0がすべての頂点を使っていれば、段階0で使う順に並ぶ
+	chain.mesh.vertices.resize(OptimizeVertexFetch(chain.mesh.vertices, chain.mesh.indices));
+	return chain;
+}
+
+std::vector<MeshLODChain> BuildLODChains(std::span<const MeshData> meshes, const LODChainOptions& options) {
+	std::vector<MeshLODChain> chains(meshes.size());
+	ThreadPool::GetInstance().ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			chains[i] = BuildLODChain(meshes[i], options);
+		}
+	});
+	return chains;
+}
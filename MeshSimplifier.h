@@ -0,0 +1,84 @@
+#pragma once
+#include "LOD.h"
+#include "MeshData.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//二次誤差(QEM)による辺の縮約でメッシュの三角形を減らし、LODの段階を作る
+//頂点は動かさずに辺の片方の頂点へ寄せるので、どの段階も元の頂点バッファをそのまま使える(インデックスだけが変わる)
+//
+//  ・誤差は元の三角形の平面までの距離の二乗を面積で重み付けしたもの。開いた縁とUV・法線の継ぎ目には辺に垂直な平面も足して形を保つ
+//  ・縁の頂点は縁に沿ってだけ、継ぎ目の頂点は継ぎ目に沿って両側の頂点をそろえてだけ寄せる。分岐などの複雑な頂点は動かさない
+//  ・寄せる先との法線・UVの差も誤差に足し、三角形が裏返る縮約はしない
+//  ・縮約は1回に全部を調べて安いものから重ならないようにまとめて行い、それを目標に届くまで繰り返す
+
+/// <summary>
+/// SimplifyMeshの設定
+/// </summary>
+struct SimplifyOptions {
+	//三角形数がこれ以下になったら止める
+	size_t targetTriangleCount = 0;
+	//誤差(メッシュのAABBの一番長い辺に対する割合)がこれを超える縮約はしない
+	float targetError = 0.01f;
+	//法線の差(単位ベクトルの差の長さ)を、メッシュの大きさに対する距離の割合に換算する係数
+	float normalWeight = 0.01f;
+	//UVの差を、メッシュの大きさに対する距離の割合に換算する係数
+	float uvWeight = 0.01f;
+};
+
+/// <summary>
+/// BuildLODChainの設定
+/// </summary>
+struct LODChainOptions {
+	//作る段階の数の上限(元のメッシュの段階0を含む)
+	uint32_t maxLevelCount = 6;
+	//1つ粗い段階の三角形数の目標(前の段階に対する割合)
+	float reduction = 0.5f;
+	//段階0からの誤差の合計(メッシュの大きさに対する割合)の上限。これを超える段階は作らない
+	float maxError = 0.05f;
+	//三角形数がこれ以下の段階ができたら止める
+	size_t minTriangleCount = 64;
+	float normalWeight = 0.01f;
+	float uvWeight = 0.01f;
+};
+
+/// <summary>
+/// 1つの頂点バッファを共有するLODの段階
+/// </summary>
+struct MeshLODChain {
+	//頂点と、すべての段階のインデックスを細かい順に続けたもの
+	MeshData mesh;
+	//段階ごとの描画範囲(baseVertexは0)
+	std::vector<MeshLevel> levels;
+	//段階ごとの誤差(オブジェクト空間の距離)。段階0は0で、粗くなるほど大きい。SelectLODByErrorに渡す
+	std::vector<float> errors;
+};
+
+/// <summary>
+/// 辺を縮約して三角形を減らす
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="options">目標の三角形数と誤差</param>
+/// <param name="result">減らした三角形リストの書き込み先(頂点番号はverticesのまま)</param>
+/// <returns>行った縮約の誤差の最大(オブジェクト空間の距離)</returns>
+float SimplifyMesh(std::span<const VertexData> vertices, std::span<const uint32_t> indices, const SimplifyOptions& options,
+	std::vector<uint32_t>& result);
+
+/// <summary>
+/// 前の段階を簡略化することを繰り返してLODの段階を作る。段階ごとに頂点キャッシュ向けに並べ替え、最後に頂点を使う順に並べ替える
+/// </summary>
+/// <param name="mesh">元のメッシュ(段階0)</param>
+/// <param name="options">設定</param>
+/// <returns></returns>
+MeshLODChain BuildLODChain(const MeshData& mesh, const LODChainOptions& options = {});
+
+/// <summary>
+/// 複数のメッシュのLODをスレッドプールで並列に作る(1つのメッシュを1つのスレッドが受け持つ)
+/// </summary>
+/// <param name="meshes">元のメッシュ</param>
+/// <param name="options">設定</param>
+/// <returns>meshesと同じ順の結果</returns>
+std::vector<MeshLODChain> BuildLODChains(std::span<const MeshData> meshes, const LODChainOptions& options = {});
@@ -0,0 +1,80 @@
+#pragma once
+#include "VertexData.h"
+#include "ThreadPool.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//格子状のメッシュを書き込み先(Mapしたアップロードバッファなど)に直接書き込む関数
+//行の範囲ごとにスレッドプールで分担し、各スレッドは自分の行の頂点・インデックスを先頭から順に構造体ごと書き込む
+//アップロードヒープは書き込み結合のメモリなので、読み返したり飛び飛びに書いたりしないこと
+
+/// <summary>
+/// 行数rows、列数colmunsの格子の頂点数
+/// </summary>
+constexpr size_t GetGridVertexCount(uint32_t rows, uint32_t colmuns) {
+	return static_cast<size_t>(rows + 1) * (colmuns + 1);
+}
+
+/// <summary>
+/// 行数rows、列数colmunsの格子のインデックス数
+/// </summary>
+/// <param name="hasPoles">一番下と一番上の行が1点に縮退しているか(球の極)。その行は四角形ごとに三角形1枚になる</param>
+constexpr size_t GetGridIndexCount(uint32_t rows, uint32_t colmuns, bool hasPoles = false) {
+	return (static_cast<size_t>(rows) * 2 - (hasPoles ? 2 : 0)) * colmuns * 3;
+}
+
+/// <summary>
+/// 格子状のメッシュを並列に書き込む。四角形は外側から見て(左下, 左上, 右下), (右下, 左上, 右上)の三角形2枚にする
+/// </summary>
+/// <param name="rows">行数(下から上)</param>
+/// <param name="colmuns">列数(左から右)</param>
+/// <param name="vertices">頂点の書き込み先。GetGridVertexCount個以上</param>
+/// <param name="indices">インデックスの書き込み先。GetGridIndexCount(rows, colmuns, hasPoles)個以上。uint16_tなら頂点数は65536以下にすること</param>
+/// <param name="makeVertex">makeVertex(row, colmun)で格子点の頂点を返す。別々のスレッドから同時に呼ばれる</param>
+/// <param name="hasPoles">一番下と一番上の行の頂点が1点に重なっているか(球の極)。trueならその行の面積0の三角形を書かない(rowsは2以上)</param>
+template<class Index, class VertexFunction>
+void WriteGridMesh(uint32_t rows, uint32_t colmuns, std::span<VertexData> vertices, std::span<Index> indices, const VertexFunction& makeVertex, bool hasPoles = false) {
+	const uint32_t stride = colmuns + 1;
+	assert(!hasPoles || rows >= 2);
+	assert(vertices.size() >= GetGridVertexCount(rows, colmuns) && indices.size() >= GetGridIndexCount(rows, colmuns, hasPoles));
+	assert(sizeof(Index) >= sizeof(uint32_t) || GetGridVertexCount(rows, colmuns) <= 0x10000);
+
+	auto writeRows = [=, &makeVertex](size_t begin, size_t end) {
+		//頂点の行は rows + 1 個、インデックスの行は rows 個なので、最後の範囲だけインデックスが1行少ない
+		for (size_t row = begin; row < end; ++row) {
+			VertexData* vertex = vertices.data() + row * stride;
+			for (uint32_t colmun = 0; colmun < stride; ++colmun) {
+				vertex[colmun] = makeVertex(static_cast<uint32_t>(row), colmun);
+			}
+			if (row == rows) {
+				continue;
+			}
+			//極の行は(左下, 右下)または(左上, 右上)が同じ点になるので、その三角形を飛ばす
+			bool isBottomPole = hasPoles && row == 0;
+			bool isTopPole = hasPoles && row + 1 == rows;
+			Index* index = indices.data() + (row * 2 - (hasPoles && row != 0 ? 1 : 0)) * colmuns * 3;
+			for (uint32_t colmun = 0; colmun < colmuns; ++colmun) {
+				Index leftBottom = static_cast<Index>(row * stride + colmun);
+				Index leftTop = static_cast<Index>(leftBottom + stride);
+				if (!isBottomPole) {
+					index[0] = leftBottom;
+					index[1] = leftTop;
+					index[2] = static_cast<Index>(leftBottom + 1);
+					index += 3;
+				}
+				if (!isTopPole) {
+					index[0] = static_cast<Index>(leftBottom + 1);
+					index[1] = leftTop;
+					index[2] = static_cast<Index>(leftTop + 1);
+					index += 3;
+				}
+			}
+		}
+	};
+	//1回の処理で16384頂点程度になるように行をまとめる
+	constexpr size_t kGrainVertexCount = 16384;
+	size_t grainRows = kGrainVertexCount / stride + 1;
+	ThreadPool::GetInstance().ParallelFor(static_cast<size_t>(rows) + 1, grainRows, writeRows);
+}
@@ -0,0 +1,224 @@
+#include "Meshlet.h"
+#include "MeshData.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kUnused = std::numeric_limits<uint32_t>::max();
+//法線の広がりがこれより大きい(軸との内積の最小値がこれ以下)メッシュレットは裏向きにならないものとして扱う
+constexpr float kMinConeDot = 0.1f;
+
+Vector3 GetPosition(const VertexData& vertex) {
+	return { vertex.position.x, vertex.position.y, vertex.position.z };
+}
+
+/// <summary>
+/// 作ったメッシュレットの球と円錐を求めて追加する
+/// </summary>
+/// <param name="triangles">メッシュレットの三角形の番号</param>
+/// <param name="meshletVertices">メッシュレットの頂点の番号</param>
+void AddBounds(MeshletData& result, std::span<const VertexData> vertices, std::span<const uint32_t> indices,
+	std::span<const Vector3> normals, std::span<const uint32_t> triangles, std::span<const uint32_t> meshletVertices) {
+	//球はAABBの中心から一番遠い頂点までの距離にする
+	Vector3 min = GetPosition(vertices[meshletVertices[0]]);
+	Vector3 max = min;
+	for (uint32_t vertex : meshletVertices) {
+		Vector3 position = GetPosition(vertices[vertex]);
+		min = { std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z) };
+		max = { std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z) };
+	}
+	Vector3 center = (min + max) * 0.5f;
+	float radiusSq = 0.0f;
+	for (uint32_t vertex : meshletVertices) {
+		Vector3 offset = GetPosition(vertices[vertex]) - center;
+		radiusSq = std::max(radiusSq, Dot(offset, offset));
+	}
+	result.centerX.push_back(center.x);
+	result.centerY.push_back(center.y);
+	result.centerZ.push_back(center.z);
+	result.radius.push_back(std::sqrt(radiusSq));
+
+	//円錐の軸は法線の平均。面積0の三角形はどこからも見えないので数えない
+	NormalCone cone = { center, { 0.0f, 0.0f, 1.0f }, 2.0f };
+	Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t triangle : triangles) {
+		normalSum += normals[triangle];
+	}
+	Vector3 axis = Normalize(normalSum);
+	float minDot = 1.0f;
+	for (uint32_t triangle : triangles) {
+		if (Dot(normals[triangle], normals[triangle]) != 0.0f) {
+			minDot = std::min(minDot, Dot(axis, normals[triangle]));
+		}
+	}
+	if (Dot(axis, axis) == 0.0f || minDot <= kMinConeDot) {
+		result.cones.push_back(cone);
+		return;
+	}
+	//頂点を円錐の中に収めるため、どの三角形の平面よりも裏側になるまで中心から軸の逆向きに下げた点を頂点にする
+	float maxT = 0.0f;
+	for (uint32_t triangle : triangles) {
+		const Vector3& normal = normals[triangle];
+		if (Dot(normal, normal) == 0.0f) {
+			continue;
+		}
+		Vector3 p0 = GetPosition(vertices[indices[triangle * 3]]);
+		maxT = std::max(maxT, Dot(center - p0, normal) / Dot(axis, normal));
+	}
+	cone.apex = center - axis * maxT;
+	cone.axis = axis;
+	cone.cutoff = std::sqrt(1.0f - minDot * minDot);
+	result.cones.push_back(cone);
+}
+
+}
+
+MeshletData BuildMeshlets(std::span<const VertexData> vertices, std::span<const uint32_t> indices, uint32_t maxVertices, uint32_t maxTriangles) {
+	assert(indices.size() % 3 == 0 && maxVertices >= 3 && maxTriangles >= 1);
+	const size_t triangleCount = indices.size() / 3;
+	const VertexAdjacency adjacency = BuildVertexAdjacency(indices, vertices.size());
+
+	//外側から見て時計回りが表なので、Cross(b - a, c - a)が表の向き
+	std::vector<Vector3> normals(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		Vector3 a = GetPosition(vertices[indices[triangle * 3 + 0]]);
+		Vector3 b = GetPosition(vertices[indices[triangle * 3 + 1]]);
+		Vector3 c = GetPosition(vertices[indices[triangle * 3 + 2]]);
+		normals[triangle] = Normalize(Cross(b - a, c - a));
+	}
+
+	MeshletData result;
+	result.indices.reserve(indices.size());
+	std::vector<bool> isEmitted(triangleCount, false);
+	//まだメッシュレットに入っていない三角形の数。0になった頂点は候補探しで飛ばす
+	std::vector<uint32_t> liveTriangles(vertices.size());
+	for (size_t vertex = 0; vertex < vertices.size(); vertex++) {
+		liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+	}
+	//頂点が今のメッシュレットに入っているか。メッシュレットの番号を入れておけば作り直すたびに消さなくてよい
+	std::vector<uint32_t> vertexMeshlet(vertices.size(), kUnused);
+	std::vector<uint32_t> meshletTriangles;
+	std::vector<uint32_t> meshletVertices;
+	meshletTriangles.reserve(maxTriangles);
+	meshletVertices.reserve(maxVertices);
+	size_t emittedCount = 0;
+	size_t seedCursor = 0;
+
+	while (emittedCount < triangleCount) {
+		const uint32_t meshletIndex = static_cast<uint32_t>(result.meshlets.size());
+		//前のメッシュレットの縁に残っている三角形から始めると、メッシュレット同士がまとまる
+		uint32_t seed = kUnused;
+		for (uint32_t vertex : meshletVertices) {
+			if (liveTriangles[vertex] == 0) {
+				continue;
+			}
+			for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; i++) {
+				if (!isEmitted[adjacency.triangles[i]]) {
+					seed = adjacency.triangles[i];
+					break;
+				}
+			}
+			if (seed != kUnused) {
+				break;
+			}
+		}
+		if (seed == kUnused) {
+			while (isEmitted[seedCursor]) {
+				seedCursor++;
+			}
+			seed = static_cast<uint32_t>(seedCursor);
+		}
+		meshletTriangles.clear();
+		meshletVertices.clear();
+		Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+
+		uint32_t next = seed;
+		while (next != kUnused) {
+			isEmitted[next] = true;
+			emittedCount++;
+			meshletTriangles.push_back(next);
+			normalSum += normals[next];
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[next * 3 + corner];
+				liveTriangles[vertex]--;
+				if (vertexMeshlet[vertex] != meshletIndex) {
+					vertexMeshlet[vertex] = meshletIndex;
+					meshletVertices.push_back(vertex);
+				}
+			}
+			if (meshletTriangles.size() >= maxTriangles) {
+				break;
+			}
+
+			//今のメッシュレットの頂点を使う三角形から、増える頂点が一番少なく、法線が平均に近いものを選ぶ
+			next = kUnused;
+			uint32_t bestNewVertices = 4;
+			float bestDot = -std::numeric_limits<float>::infinity();
+			for (uint32_t vertex : meshletVertices) {
+				if (liveTriangles[vertex] == 0) {
+					continue;
+				}
+				for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; i++) {
+					uint32_t triangle = adjacency.triangles[i];
+					if (isEmitted[triangle]) {
+						continue;
+					}
+					uint32_t newVertices = 0;
+					for (int corner = 0; corner < 3; corner++) {
+						newVertices += vertexMeshlet[indices[triangle * 3 + corner]] != meshletIndex ? 1 : 0;
+					}
+					if (meshletVertices.size() + newVertices > maxVertices || newVertices > bestNewVertices) {
+						continue;
+					}
+					float dot = Dot(normals[triangle], normalSum);
+					if (newVertices < bestNewVertices || dot > bestDot) {
+						next = triangle;
+						bestNewVertices = newVertices;
+						bestDot = dot;
+					}
+				}
+			}
+		}
+
+		result.meshlets.push_back({ static_cast<uint32_t>(result.indices.size()), static_cast<uint32_t>(meshletTriangles.size()),
+			static_cast<uint32_t>(meshletVertices.size()) });
+		for (uint32_t triangle : meshletTriangles) {
+			result.indices.insert(result.indices.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3);
+		}
+		AddBounds(result, vertices, indices, normals, meshletTriangles, meshletVertices);
+	}
+	return result;
+}
+
+bool IsBackfacing(const NormalCone& cone, const Vector3& cameraPosition) {
+	//IsFrontは三角形1枚の法線と視線で判定する。円錐の中に視線が入れば、円錐に収まるすべての法線と視線のなす角が90度以上になる
+	return Dot(Normalize(cone.apex - cameraPosition), cone.axis) >= cone.cutoff;
+}
+
+MeshletCullResult CullMeshlets(const MeshletView& meshlets, const Frustum& frustum, const Vector3& cameraPosition, bool cullBackfaces,
+	std::span<uint32_t> visibleMeshlets, std::span<IndexRange> ranges) {
+	assert(visibleMeshlets.size() >= meshlets.meshlets.size());
+	MeshletCullResult result = {};
+	size_t visibleCount = CullSpheres(frustum, meshlets.spheres, meshlets.meshlets.size(), visibleMeshlets.data());
+	//CullSpheresは番号の小さい順に書くので、インデックスが続いているメッシュレットは1つの範囲にまとめられる
+	for (size_t i = 0; i < visibleCount; i++) {
+		uint32_t index = visibleMeshlets[i];
+		if (cullBackfaces && IsBackfacing(meshlets.cones[index], cameraPosition)) {
+			continue;
+		}
+		const Meshlet& meshlet = meshlets.meshlets[index];
+		result.meshletCount++;
+		result.triangleCount += meshlet.triangleCount;
+		if (result.rangeCount > 0 && ranges[result.rangeCount - 1].startIndex + ranges[result.rangeCount - 1].indexCount == meshlet.startIndex) {
+			ranges[result.rangeCount - 1].indexCount += meshlet.triangleCount * 3;
+		} else {
+			assert(result.rangeCount < ranges.size());
+			ranges[result.rangeCount++] = { meshlet.startIndex, meshlet.triangleCount * 3 };
+		}
+	}
+	return result;
+}
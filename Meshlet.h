@@ -0,0 +1,138 @@
+#pragma once
+#include "VertexData.h"
+#include "Vector3.h"
+#include "Frustum.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//インデックス付きメッシュを小さなまとまり(メッシュレット)に分け、まとまりごとにカリングする
+//各メッシュレットは視錐台カリング用の球と、裏向きカリング用の法線の円錐(IsFrontを三角形の集まりに広げたもの)を持つ
+//分けた後のインデックスはメッシュレットごとに連続しているので、見えるメッシュレットの範囲だけを描画すればよい
+
+//1つのメッシュレットの頂点数と三角形数の上限(メッシュシェーダーでよく使われる値)
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+/// <summary>
+/// メッシュレット1つ分の範囲
+/// </summary>
+struct Meshlet {
+	//MeshletData::indicesでの先頭のインデックス番号
+	uint32_t startIndex;
+	uint32_t triangleCount;
+	//使っている頂点の種類の数
+	uint32_t vertexCount;
+};
+
+/// <summary>
+/// 法線の円錐。Dot(Normalize(apex - camera), axis) >= cutoff のとき、どの三角形も裏を向いている
+/// </summary>
+struct NormalCone {
+	Vector3 apex;
+	Vector3 axis;
+	//円錐の半角のsin。法線がばらばらで裏向きにならないときは1より大きい
+	float cutoff;
+};
+
+/// <summary>
+/// メッシュレットに分けたメッシュ
+/// </summary>
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	//メッシュレットの順に並べ直した三角形リスト(頂点番号は元のまま)
+	std::vector<uint32_t> indices;
+	//メッシュレットを囲む球(CullSpheresにそのまま渡せるように要素ごとに並べる)
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+	std::vector<NormalCone> cones;
+};
+
+/// <summary>
+/// カリングで使うメッシュレットの情報への参照。MeshletDataのほか、メッシュキャッシュのマップした中身も指せる
+/// </summary>
+struct MeshletView {
+	std::span<const Meshlet> meshlets;
+	BoundingSphereSoA spheres;
+	std::span<const NormalCone> cones;
+};
+
+/// <summary>
+/// 描画するインデックスの範囲
+/// </summary>
+struct IndexRange {
+	uint32_t startIndex;
+	uint32_t indexCount;
+};
+
+/// <summary>
+/// CullMeshletsの結果
+/// </summary>
+struct MeshletCullResult {
+	//見えたメッシュレットの数
+	uint32_t meshletCount;
+	//書き込んだ範囲の数。隣り合うメッシュレットは1つの範囲にまとめる
+	uint32_t rangeCount;
+	//見えたメッシュレットの三角形の合計
+	uint32_t triangleCount;
+};
+
+/// <summary>
+/// 三角形をつながりに沿って集め、メッシュレットに分ける
+/// 今のメッシュレットに追加したときに増える頂点が一番少ない三角形を選び、同じなら法線が近いものを選ぶ
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="maxVertices">1つのメッシュレットの頂点数の上限(3以上)</param>
+/// <param name="maxTriangles">1つのメッシュレットの三角形数の上限(1以上)</param>
+/// <returns></returns>
+MeshletData BuildMeshlets(std::span<const VertexData> vertices, std::span<const uint32_t> indices,
+	uint32_t maxVertices = kMeshletMaxVertices, uint32_t maxTriangles = kMeshletMaxTriangles);
+
+/// <summary>
+/// メッシュレットを囲む球をCullSpheresに渡す形にする
+/// </summary>
+/// <param name="meshlets">メッシュレット</param>
+/// <returns></returns>
+inline BoundingSphereSoA GetBoundingSpheres(const MeshletData& meshlets) {
+	return { meshlets.centerX.data(), meshlets.centerY.data(), meshlets.centerZ.data(), meshlets.radius.data() };
+}
+
+/// <summary>
+/// MeshletDataをカリング用の参照にする
+/// </summary>
+/// <param name="meshlets">メッシュレット</param>
+/// <returns></returns>
+inline MeshletView GetMeshletView(const MeshletData& meshlets) {
+	return { meshlets.meshlets, GetBoundingSpheres(meshlets), meshlets.cones };
+}
+
+/// <summary>
+/// カメラから見てメッシュレットのすべての三角形が裏を向いているか
+/// </summary>
+/// <param name="cone">法線の円錐</param>
+/// <param name="cameraPosition">カメラの位置(メッシュレットと同じ空間)</param>
+/// <returns>裏を向いていて描かなくてよいならtrue</returns>
+bool IsBackfacing(const NormalCone& cone, const Vector3& cameraPosition);
+
+/// <summary>
+/// 視錐台の外にあるメッシュレットと裏を向いたメッシュレットを除き、描画するインデックスの範囲を書き込む
+/// ローカル空間で判定するので、視錐台はMakeFrustum(Multiply(world, viewProjection))、カメラ位置はワールド行列の逆行列で戻したものを渡す
+/// </summary>
+/// <param name="meshlets">メッシュレット</param>
+/// <param name="frustum">ローカル空間の視錐台</param>
+/// <param name="cameraPosition">ローカル空間のカメラの位置</param>
+/// <param name="cullBackfaces">裏向きも除くか。ワールド行列が裏返す(行列式が負の)ときはfalseにする</param>
+/// <param name="visibleMeshlets">作業用。メッシュレットの数だけ必要</param>
+/// <param name="ranges">描画する範囲の書き込み先。メッシュレットの数だけあれば足りる</param>
+/// <returns></returns>
+MeshletCullResult CullMeshlets(const MeshletView& meshlets, const Frustum& frustum, const Vector3& cameraPosition, bool cullBackfaces,
+	std::span<uint32_t> visibleMeshlets, std::span<IndexRange> ranges);
+
+inline MeshletCullResult CullMeshlets(const MeshletData& meshlets, const Frustum& frustum, const Vector3& cameraPosition, bool cullBackfaces,
+	std::span<uint32_t> visibleMeshlets, std::span<IndexRange> ranges) {
+	return CullMeshlets(GetMeshletView(meshlets), frustum, cameraPosition, cullBackfaces, visibleMeshlets, ranges);
+}
@@ -2,7 +2,7 @@
 
 struct TransformationMatrix {
 	float32_t4x4 WVP;
-	float32_t4x4 World;
+	float32_t3x4 World; //アフィン変換を転置して4列目を省いたもの
 };
 
 ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
@@ -17,6 +17,6 @@ VertexShaderOutput main(VertexShaderInput input) {
 	VertexShaderOutput output;
 	output.position = mul(input.position, gTransformationMatrix.WVP);
 	output.texcoord = input.texcoord;
-	output.normal = normalize(mul(input.normal, (float32_t3x3)gTransformationMatrix.World));
+	output.normal = normalize(mul((float32_t3x3)gTransformationMatrix.World, input.normal));
 	return output;
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "object3d.hlsli"
+
+//VertexFormat.hのCompact/Quantized形式を受け取る頂点シェーダー
+//Quantizedの位置は[0, 1]で届くので、WVPには量子化を戻す行列を掛けたものを渡す
+
+struct TransformationMatrix {
+	float32_t4x4 WVP;
+	float32_t3x4 World; //アフィン変換を転置して4列目を省いたもの
+};
+
+ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
+
+struct VertexShaderInput {
+	float32_t4 position : POSITION0; //Compactはfloat3(wは1で埋まる)、Quantizedはunorm16x4
+	float32_t2 texcoord : TEXCOORD0; //half2
+	float32_t2 normal : NORMAL0;     //八面体に展開した法線(snorm16x2)
+};
+
+//八面体に展開した法線を元に戻す。VertexFormat.cppのDecodeOctahedralと同じ計算
+float32_t3 DecodeOctahedral(float32_t2 encoded) {
+	float32_t3 normal = float32_t3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float32_t t = saturate(-normal.z);
+	//xかyが0のときはtも0になるので、signが0を返しても同じ結果になる
+	normal.xy -= (float32_t2)sign(normal.xy) * t;
+	return normalize(normal);
+}
+
+VertexShaderOutput main(VertexShaderInput input) {
+	VertexShaderOutput output;
+	output.position = mul(input.position, gTransformationMatrix.WVP);
+	output.texcoord = input.texcoord;
+	output.normal = normalize(mul((float32_t3x3)gTransformationMatrix.World, DecodeOctahedral(input.normal)));
+	return output;
+}
@@ -0,0 +1,262 @@
+#include "Primitive.h"
+#include "SphereMesh.h"
+#include "MathConstexpr.h"
+#include "MathFunction.h"
+#include "Vector3_Math.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr float kPi = static_cast<float>(MathConstexpr::kPi);
+
+/// <summary>
+/// 回転体の断面の点。radiusはY軸からの距離
+/// </summary>
+struct ProfilePoint {
+	float radius;
+	float y;
+	//断面上での法線(Y軸から離れる向き, Y)
+	float normalRadius;
+	float normalY;
+	//テクスチャのV座標
+	float v;
+};
+
+/// <summary>
+/// [begin, end]をcount等分した角度のsin, cosをまとめて求める(count + 1個)
+/// </summary>
+void MakeRing(uint32_t count, float begin, float end, std::vector<float>& sines, std::vector<float>& cosines) {
+	std::vector<float> angles(count + 1);
+	float every = (end - begin) / static_cast<float>(count);
+	for (uint32_t index = 0; index <= count; ++index) {
+		angles[index] = begin + every * static_cast<float>(index);
+	}
+	sines.resize(count + 1);
+	cosines.resize(count + 1);
+	SinCos(angles, sines, cosines);
+}
+
+/// <summary>
+/// 四角形を三角形2枚で追加する。外側から見て a:左下 b:左上 c:右下 d:右上
+/// </summary>
+void AddQuad(std::vector<uint32_t>& indices, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	indices.insert(indices.end(), { a, b, c, c, b, d });
+}
+
+/// <summary>
+/// 断面をY軸の周りに回した面を追加する。断面は下から上へ(外側を右に見る向きで)並べる
+/// 半径0の点(極・頂点)では面積のない三角形を作らない
+/// </summary>
+void AddLathe(MeshData& mesh, std::span<const ProfilePoint> profile, const std::vector<float>& ringSin, const std::vector<float>& ringCos) {
+	const uint32_t stride = static_cast<uint32_t>(ringSin.size());
+	const uint32_t segment = stride - 1;
+	const uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+	for (const ProfilePoint& point : profile) {
+		for (uint32_t lonIndex = 0; lonIndex < stride; ++lonIndex) {
+			VertexData vertex;
+			vertex.position = { point.radius * ringCos[lonIndex], point.y, point.radius * ringSin[lonIndex], 1.0f };
+			vertex.texcoode = { static_cast<float>(lonIndex) / static_cast<float>(segment), point.v };
+			vertex.normal = { point.normalRadius * ringCos[lonIndex], point.normalY, point.normalRadius * ringSin[lonIndex] };
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	for (uint32_t row = 0; row + 1 < profile.size(); ++row) {
+		bool isBottomPole = profile[row].radius == 0.0f;
+		bool isTopPole = profile[row + 1].radius == 0.0f;
+		for (uint32_t lonIndex = 0; lonIndex < segment; ++lonIndex) {
+			uint32_t leftBottom = base + row * stride + lonIndex;
+			uint32_t leftTop = leftBottom + stride;
+			if (!isBottomPole) {
+				mesh.indices.insert(mesh.indices.end(), { leftBottom, leftTop, leftBottom + 1 });
+			}
+			if (!isTopPole) {
+				mesh.indices.insert(mesh.indices.end(), { leftBottom + 1, leftTop, leftTop + 1 });
+			}
+		}
+	}
+}
+
+/// <summary>
+/// 2点を結ぶ直線の断面。法線は線分に垂直な外向き
+/// </summary>
+void AddSegmentProfile(std::vector<ProfilePoint>& profile, float radius0, float y0, float radius1, float y1, uint32_t count, float v0, float v1) {
+	float normalRadius = y1 - y0;
+	float normalY = radius0 - radius1;
+	float length = std::sqrt(normalRadius * normalRadius + normalY * normalY);
+	normalRadius /= length;
+	normalY /= length;
+	for (uint32_t index = 0; index <= count; ++index) {
+		float t = static_cast<float>(index) / static_cast<float>(count);
+		profile.push_back({ radius0 + (radius1 - radius0) * t, y0 + (y1 - y0) * t, normalRadius, normalY, v0 + (v1 - v0) * t });
+	}
+}
+
+/// <summary>
+/// 断面が線分の回転体(円柱の側面、ふた、円錐)を追加する
+/// </summary>
+void AddSegmentLathe(MeshData& mesh, float radius0, float y0, float radius1, float y1, uint32_t count, float v0, float v1,
+	const std::vector<float>& ringSin, const std::vector<float>& ringCos) {
+	std::vector<ProfilePoint> profile;
+	AddSegmentProfile(profile, radius0, y0, radius1, y1, count, v0, v1);
+	AddLathe(mesh, profile, ringSin, ringCos);
+}
+
+/// <summary>
+/// 格子状に分割した四角形の面を追加する
+/// </summary>
+/// <param name="center">面の中心</param>
+/// <param name="normal">面の法線</param>
+/// <param name="up">面の上方向(長さが面の大きさの半分)。右方向は normal × up</param>
+void AddGrid(MeshData& mesh, const Vector3& center, const Vector3& normal, const Vector3& up, uint32_t subdivision) {
+	const Vector3 right = Cross(normal, up);
+	const uint32_t stride = subdivision + 1;
+	const uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+	for (uint32_t row = 0; row < stride; ++row) {
+		float t = static_cast<float>(row) / static_cast<float>(subdivision);
+		for (uint32_t colmun = 0; colmun < stride; ++colmun) {
+			float s = static_cast<float>(colmun) / static_cast<float>(subdivision);
+			Vector3 position = center + right * (s * 2.0f - 1.0f) + up * (t * 2.0f - 1.0f);
+			mesh.vertices.push_back({ { position.x, position.y, position.z, 1.0f }, { s, 1.0f - t }, normal });
+		}
+	}
+	for (uint32_t row = 0; row < subdivision; ++row) {
+		for (uint32_t colmun = 0; colmun < subdivision; ++colmun) {
+			uint32_t leftBottom = base + row * stride + colmun;
+			AddQuad(mesh.indices, leftBottom, leftBottom + stride, leftBottom + 1, leftBottom + stride + 1);
+		}
+	}
+}
+
+}
+
+MeshData MakeBoxMesh(uint32_t subdivision) {
+	assert(subdivision >= 1);
+	//面の法線と上方向
+	const Vector3 faces[6][2] = {
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f } },
+	};
+	MeshData mesh;
+	size_t faceVertexCount = static_cast<size_t>(subdivision + 1) * (subdivision + 1);
+	mesh.vertices.reserve(faceVertexCount * 6);
+	mesh.indices.reserve(static_cast<size_t>(subdivision) * subdivision * 6 * 6);
+	for (const Vector3(&face)[2] : faces) {
+		AddGrid(mesh, face[0], face[0], face[1], subdivision);
+	}
+	return mesh;
+}
+
+MeshData MakePlaneMesh(uint32_t subdivision) {
+	assert(subdivision >= 1);
+	MeshData mesh;
+	AddGrid(mesh, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, subdivision);
+	return mesh;
+}
+
+MeshData MakeCylinderMesh(uint32_t subdivision) {
+	assert(subdivision >= 3);
+	std::vector<float> ringSin, ringCos;
+	MakeRing(subdivision, 0.0f, 2.0f * kPi, ringSin, ringCos);
+	const uint32_t heightSegment = std::max(1u, subdivision / 4);
+	MeshData mesh;
+	//底面、側面、上面の順。法線が不連続になるところは頂点を分ける
+	AddSegmentLathe(mesh, 0.0f, -1.0f, 1.0f, -1.0f, 1, 1.0f, 1.0f, ringSin, ringCos);
+	AddSegmentLathe(mesh, 1.0f, -1.0f, 1.0f, 1.0f, heightSegment, 1.0f, 0.0f, ringSin, ringCos);
+	AddSegmentLathe(mesh, 1.0f, 1.0f, 0.0f, 1.0f, 1, 0.0f, 0.0f, ringSin, ringCos);
+	return mesh;
+}
+
+MeshData MakeConeMesh(uint32_t subdivision) {
+	assert(subdivision >= 3);
+	std::vector<float> ringSin, ringCos;
+	MakeRing(subdivision, 0.0f, 2.0f * kPi, ringSin, ringCos);
+	const uint32_t heightSegment = std::max(1u, subdivision / 4);
+	MeshData mesh;
+	AddSegmentLathe(mesh, 0.0f, -1.0f, 1.0f, -1.0f, 1, 1.0f, 1.0f, ringSin, ringCos);
+	AddSegmentLathe(mesh, 1.0f, -1.0f, 0.0f, 1.0f, heightSegment, 1.0f, 0.0f, ringSin, ringCos);
+	return mesh;
+}
+
+MeshData MakeTorusMesh(uint32_t subdivision, float minorRadius) {
+	assert(subdivision >= 3 && 0.0f < minorRadius && minorRadius < 1.0f);
+	std::vector<float> ringSin, ringCos, tubeSin, tubeCos;
+	MakeRing(subdivision, 0.0f, 2.0f * kPi, ringSin, ringCos);
+	//外側が上に向かうように断面は-πからπまで回す
+	const uint32_t tubeSegment = std::max(3u, subdivision / 2);
+	MakeRing(tubeSegment, -kPi, kPi, tubeSin, tubeCos);
+	std::vector<ProfilePoint> profile(tubeSegment + 1);
+	for (uint32_t index = 0; index <= tubeSegment; ++index) {
+		profile[index] = { 1.0f + minorRadius * tubeCos[index], minorRadius * tubeSin[index], tubeCos[index], tubeSin[index],
+			1.0f - static_cast<float>(index) / static_cast<float>(tubeSegment) };
+	}
+	MeshData mesh;
+	AddLathe(mesh, profile, ringSin, ringCos);
+	return mesh;
+}
+
+MeshData MakeCapsuleMesh(uint32_t subdivision, float halfHeight) {
+	assert(subdivision >= 4 && halfHeight >= 0.0f);
+	std::vector<float> ringSin, ringCos, latSin, latCos;
+	MakeRing(subdivision, 0.0f, 2.0f * kPi, ringSin, ringCos);
+	//半球の緯度。-π/2から0までを下の半球、上の半球はその反転で使う
+	const uint32_t latSegment = std::max(2u, subdivision / 4);
+	MakeRing(latSegment, -kPi / 2.0f, 0.0f, latSin, latCos);
+
+	//断面の長さに合わせてVを割り振る
+	const float hemisphereLength = kPi / 2.0f;
+	const float totalLength = hemisphereLength * 2.0f + halfHeight * 2.0f;
+	std::vector<ProfilePoint> profile;
+	profile.reserve((latSegment + 1) * 2);
+	for (uint32_t index = 0; index <= latSegment; ++index) {
+		float arc = hemisphereLength * static_cast<float>(index) / static_cast<float>(latSegment);
+		//極は半径をちょうど0にして面積のない三角形を作らないようにする
+		float radius = index == 0 ? 0.0f : latCos[index];
+		profile.push_back({ radius, latSin[index] - halfHeight, latCos[index], latSin[index], 1.0f - arc / totalLength });
+	}
+	//上の半球。赤道の点から下の半球と対称に並べる。赤道同士の間が円柱部分になる
+	for (uint32_t index = latSegment + 1; index-- > 0;) {
+		float arc = hemisphereLength * static_cast<float>(latSegment - index) / static_cast<float>(latSegment);
+		float radius = index == 0 ? 0.0f : latCos[index];
+		profile.push_back({ radius, -latSin[index] + halfHeight, latCos[index], -latSin[index],
+			(hemisphereLength - arc) / totalLength });
+	}
+	MeshData mesh;
+	AddLathe(mesh, profile, ringSin, ringCos);
+	return mesh;
+}
+
+MeshData MakePrimitiveMesh(PrimitiveType type, uint32_t subdivision) {
+	switch (type) {
+	case PrimitiveType::Sphere:
+		return MakeSphereMesh(subdivision);
+	case PrimitiveType::Box:
+		return MakeBoxMesh(subdivision);
+	case PrimitiveType::Plane:
+		return MakePlaneMesh(subdivision);
+	case PrimitiveType::Cylinder:
+		return MakeCylinderMesh(subdivision);
+	case PrimitiveType::Cone:
+		return MakeConeMesh(subdivision);
+	case PrimitiveType::Torus:
+		return MakeTorusMesh(subdivision);
+	case PrimitiveType::Capsule:
+		return MakeCapsuleMesh(subdivision);
+	}
+	assert(false);
+	return {};
+}
+
+std::vector<MeshData> MakePrimitiveLODs(PrimitiveType type, std::span<const uint32_t> subdivisions) {
+	std::vector<MeshData> levels;
+	levels.reserve(subdivisions.size());
+	for (uint32_t subdivision : subdivisions) {
+		levels.push_back(MakePrimitiveMesh(type, subdivision));
+	}
+	return levels;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "MeshData.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//基本形状のメッシュを作る関数
+//どの形状も原点中心で、大きさはワールド行列のスケールで決める。面の向きは球(SphereMesh.h)と同じく外側から見て時計回り
+//subdivisionは曲面の周方向・高さ方向の分割数(箱と平面は1辺の分割数)で、LODごとに変えて使う
+
+/// <summary>
+/// 基本形状の種類
+/// </summary>
+enum class PrimitiveType {
+	Sphere,
+	Box,
+	Plane,
+	Cylinder,
+	Cone,
+	Torus,
+	Capsule,
+};
+
+/// <summary>
+/// 1辺が2の立方体(-1～1)。面ごとに頂点を分けて法線を面に垂直にする
+/// </summary>
+/// <param name="subdivision">1辺の分割数(1以上)</param>
+/// <returns></returns>
+MeshData MakeBoxMesh(uint32_t subdivision);
+
+/// <summary>
+/// XZ平面上の1辺が2の正方形(-1～1)。法線は+Y
+/// </summary>
+/// <param name="subdivision">1辺の分割数(1以上)</param>
+/// <returns></returns>
+MeshData MakePlaneMesh(uint32_t subdivision);
+
+/// <summary>
+/// 半径1、高さ2(Y方向に-1～1)の円柱。上下のふた付き
+/// </summary>
+/// <param name="subdivision">周方向の分割数(3以上)。側面の高さ方向はsubdivision / 4に分ける</param>
+/// <returns></returns>
+MeshData MakeCylinderMesh(uint32_t subdivision);
+
+/// <summary>
+/// 底面の半径1、高さ2(Y方向に-1～1)の円錐。底面のふた付き
+/// </summary>
+/// <param name="subdivision">周方向の分割数(3以上)</param>
+/// <returns></returns>
+MeshData MakeConeMesh(uint32_t subdivision);
+
+/// <summary>
+/// Y軸の周りを回るトーラス。中心から管の中心までの半径は1
+/// </summary>
+/// <param name="subdivision">周方向の分割数(3以上)。管の周りはsubdivision / 2に分ける</param>
+/// <param name="minorRadius">管の半径</param>
+/// <returns></returns>
+MeshData MakeTorusMesh(uint32_t subdivision, float minorRadius = 0.25f);
+
+/// <summary>
+/// 半径1の半球2つを円柱でつないだカプセル。Y方向に -1 - halfHeight ～ 1 + halfHeight
+/// </summary>
+/// <param name="subdivision">周方向の分割数(4以上)。半球の緯度方向はsubdivision / 4に分ける</param>
+/// <param name="halfHeight">円柱部分の高さの半分</param>
+/// <returns></returns>
+MeshData MakeCapsuleMesh(uint32_t subdivision, float halfHeight = 0.5f);
+
+/// <summary>
+/// 種類を指定して基本形状を作る。トーラスとカプセルの形は既定値を使う
+/// </summary>
+/// <param name="type">形状の種類</param>
+/// <param name="subdivision">分割数</param>
+/// <returns></returns>
+MeshData MakePrimitiveMesh(PrimitiveType type, uint32_t subdivision);
+
+/// <summary>
+/// 分割数を変えた基本形状をLODの段階ごとにまとめて作る
+/// </summary>
+/// <param name="type">形状の種類</param>
+/// <param name="subdivisions">段階ごとの分割数。先頭が一番細かい段階(LOD0)</param>
+/// <returns>subdivisionsと同じ順のメッシュ</returns>
+std::vector<MeshData> MakePrimitiveLODs(PrimitiveType type, std::span<const uint32_t> subdivisions);
@@ -0,0 +1,403 @@
+#include "Quaternion.h"
+#include "CpuFeature.h"
+#include <immintrin.h>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+//Slerpの係数を多項式で求めるための定数 (D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP")
+//u[i] = 1 / (i(2i + 1)), v[i] = i / (2i + 1)。最後の項だけ打ち切り誤差を補正する係数を掛けている
+constexpr int kSlerpTerms = 8;
+constexpr float kSlerpCorrection = 1.85298109240830f;
+constexpr float kSlerpU[kSlerpTerms] = {
+	1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+	1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), kSlerpCorrection / (8 * 17)
+};
+constexpr float kSlerpV[kSlerpTerms] = {
+	1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+	5.0f / 11, 6.0f / 13, 7.0f / 15, kSlerpCorrection * 8 / 17
+};
+
+/// <summary>
+/// sin(tθ)/sin(θ)を多項式で近似する。cosθ(= x)は0以上であること
+/// </summary>
+float SlerpCoefficient(float t, float xm1) {
+	float sqrT = t * t;
+	float c = 1.0f;
+	for (int i = kSlerpTerms - 1; i >= 0; i--) {
+		c = 1.0f + (kSlerpU[i] * sqrT - kSlerpV[i]) * xm1 * c;
+	}
+	return t * c;
+}
+
+#pragma region SSE4実装
+//4つのクォータニオンを転置してSoA(x, y, z, w)にする
+SIMD_TARGET_SSE4 void LoadQuaternionsSSE4(const Quaternion* quaternions, __m128 soa[4]) {
+	for (int i = 0; i < 4; i++) {
+		soa[i] = _mm_loadu_ps(&quaternions[i].x);
+	}
+	_MM_TRANSPOSE4_PS(soa[0], soa[1], soa[2], soa[3]);
+}
+
+SIMD_TARGET_SSE4 void StoreQuaternionsSSE4(__m128 soa[4], Quaternion* quaternions) {
+	_MM_TRANSPOSE4_PS(soa[0], soa[1], soa[2], soa[3]);
+	for (int i = 0; i < 4; i++) {
+		_mm_storeu_ps(&quaternions[i].x, soa[i]);
+	}
+}
+
+SIMD_TARGET_SSE4 __m128 DotSSE4(const __m128 a[4], const __m128 b[4]) {
+	__m128 dot = _mm_mul_ps(a[0], b[0]);
+	for (int i = 1; i < 4; i++) {
+		dot = _mm_add_ps(dot, _mm_mul_ps(a[i], b[i]));
+	}
+	return dot;
+}
+
+SIMD_TARGET_SSE4 __m128 SlerpCoefficientSSE4(__m128 t, __m128 xm1) {
+	const __m128 one = _mm_set1_ps(1.0f);
+	__m128 sqrT = _mm_mul_ps(t, t);
+	__m128 c = one;
+	for (int i = kSlerpTerms - 1; i >= 0; i--) {
+		__m128 b = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(kSlerpU[i]), sqrT), _mm_set1_ps(kSlerpV[i])), xm1);
+		c = _mm_add_ps(one, _mm_mul_ps(b, c));
+	}
+	return _mm_mul_ps(t, c);
+}
+
+/// <summary>
+/// 4つずつ補間する。isSlerpがfalseならNlerp
+/// </summary>
+SIMD_TARGET_SSE4 void InterpolateSSE4(const Quaternion* q1, const Quaternion* q2, const float* t, Quaternion* result, bool isSlerp) {
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 a[4], b[4];
+	LoadQuaternionsSSE4(q1, a);
+	LoadQuaternionsSSE4(q2, b);
+	__m128 t4 = _mm_loadu_ps(t);
+
+	//内積が負なら反対側を回らないようにq2の符号を反転する
+	__m128 dot = DotSSE4(a, b);
+	__m128 sign = _mm_and_ps(dot, signMask);
+	dot = _mm_xor_ps(dot, sign);
+
+	__m128 coefficient1, coefficient2;
+	if (isSlerp) {
+		__m128 xm1 = _mm_sub_ps(dot, one);
+		coefficient1 = SlerpCoefficientSSE4(_mm_sub_ps(one, t4), xm1);
+		coefficient2 = SlerpCoefficientSSE4(t4, xm1);
+	} else {
+		coefficient1 = _mm_sub_ps(one, t4);
+		coefficient2 = t4;
+	}
+	coefficient2 = _mm_xor_ps(coefficient2, sign);
+
+	__m128 r[4];
+	for (int i = 0; i < 4; i++) {
+		r[i] = _mm_add_ps(_mm_mul_ps(a[i], coefficient1), _mm_mul_ps(b[i], coefficient2));
+	}
+	if (!isSlerp) {
+		//長さ0のレーンはスカラー版のNormalizeと同じく単位クォータニオンにする
+		__m128 lengthSq = DotSSE4(r, r);
+		__m128 isZero = _mm_cmpeq_ps(lengthSq, _mm_setzero_ps());
+		__m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+		for (int i = 0; i < 4; i++) {
+			r[i] = _mm_blendv_ps(_mm_mul_ps(r[i], invLength), i == 3 ? one : _mm_setzero_ps(), isZero);
+		}
+	}
+	StoreQuaternionsSSE4(r, result);
+}
+#pragma endregion
+
+#pragma region AVX2実装
+//8つのクォータニオンを転置してSoA(x, y, z, w)にする。上位レーンが後半の4つ
+SIMD_TARGET_AVX2 void LoadQuaternionsAVX2(const Quaternion* quaternions, __m256 soa[4]) {
+	for (int i = 0; i < 4; i++) {
+		soa[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&quaternions[i].x)), _mm_loadu_ps(&quaternions[i + 4].x), 1);
+	}
+	__m256 t0 = _mm256_unpacklo_ps(soa[0], soa[1]);
+	__m256 t1 = _mm256_unpackhi_ps(soa[0], soa[1]);
+	__m256 t2 = _mm256_unpacklo_ps(soa[2], soa[3]);
+	__m256 t3 = _mm256_unpackhi_ps(soa[2], soa[3]);
+	soa[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	soa[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	soa[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	soa[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+SIMD_TARGET_AVX2 void StoreQuaternionsAVX2(const __m256 soa[4], Quaternion* quaternions) {
+	__m256 t0 = _mm256_unpacklo_ps(soa[0], soa[1]);
+	__m256 t1 = _mm256_unpackhi_ps(soa[0], soa[1]);
+	__m256 t2 = _mm256_unpacklo_ps(soa[2], soa[3]);
+	__m256 t3 = _mm256_unpackhi_ps(soa[2], soa[3]);
+	__m256 aos[4] = {
+		_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+		_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)) };
+	for (int i = 0; i < 4; i++) {
+		_mm_storeu_ps(&quaternions[i].x, _mm256_castps256_ps128(aos[i]));
+		_mm_storeu_ps(&quaternions[i + 4].x, _mm256_extractf128_ps(aos[i], 1));
+	}
+}
+
+SIMD_TARGET_AVX2 __m256 DotAVX2(const __m256 a[4], const __m256 b[4]) {
+	__m256 dot = _mm256_mul_ps(a[0], b[0]);
+	for (int i = 1; i < 4; i++) {
+		dot = _mm256_fmadd_ps(a[i], b[i], dot);
+	}
+	return dot;
+}
+
+SIMD_TARGET_AVX2 __m256 SlerpCoefficientAVX2(__m256 t, __m256 xm1) {
+	const __m256 one = _mm256_set1_ps(1.0f);
+	__m256 sqrT = _mm256_mul_ps(t, t);
+	__m256 c = one;
+	for (int i = kSlerpTerms - 1; i >= 0; i--) {
+		__m256 b = _mm256_mul_ps(_mm256_fmsub_ps(_mm256_set1_ps(kSlerpU[i]), sqrT, _mm256_set1_ps(kSlerpV[i])), xm1);
+		c = _mm256_fmadd_ps(b, c, one);
+	}
+	return _mm256_mul_ps(t, c);
+}
+
+SIMD_TARGET_AVX2 void InterpolateAVX2(const Quaternion* q1, const Quaternion* q2, const float* t, Quaternion* result, bool isSlerp) {
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	__m256 a[4], b[4];
+	LoadQuaternionsAVX2(q1, a);
+	LoadQuaternionsAVX2(q2, b);
+	//転置後も下位レーンが0～3番目、上位レーンが4～7番目なのでtはそのまま読み込める
+	__m256 t8 = _mm256_loadu_ps(t);
+
+	__m256 dot = DotAVX2(a, b);
+	__m256 sign = _mm256_and_ps(dot, signMask);
+	dot = _mm256_xor_ps(dot, sign);
+
+	__m256 coefficient1, coefficient2;
+	if (isSlerp) {
+		__m256 xm1 = _mm256_sub_ps(dot, one);
+		coefficient1 = SlerpCoefficientAVX2(_mm256_sub_ps(one, t8), xm1);
+		coefficient2 = SlerpCoefficientAVX2(t8, xm1);
+	} else {
+		coefficient1 = _mm256_sub_ps(one, t8);
+		coefficient2 = t8;
+	}
+	coefficient2 = _mm256_xor_ps(coefficient2, sign);
+
+	__m256 r[4];
+	for (int i = 0; i < 4; i++) {
+		r[i] = _mm256_fmadd_ps(a[i], coefficient1, _mm256_mul_ps(b[i], coefficient2));
+	}
+	if (!isSlerp) {
+		//長さ0のレーンはスカラー版のNormalizeと同じく単位クォータニオンにする
+		__m256 lengthSq = DotAVX2(r, r);
+		__m256 isZero = _mm256_cmp_ps(lengthSq, _mm256_setzero_ps(), _CMP_EQ_OQ);
+		__m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSq));
+		for (int i = 0; i < 4; i++) {
+			r[i] = _mm256_blendv_ps(_mm256_mul_ps(r[i], invLength), i == 3 ? one : _mm256_setzero_ps(), isZero);
+		}
+	}
+	StoreQuaternionsAVX2(r, result);
+}
+#pragma endregion
+
+void InterpolateBatch(std::span<const Quaternion> q1, std::span<const Quaternion> q2, std::span<const float> t, std::span<Quaternion> result, bool isSlerp) {
+	assert(q2.size() >= q1.size() && t.size() >= q1.size() && result.size() >= q1.size());
+	size_t count = q1.size();
+	size_t i = 0;
+	SimdLevel level = GetSimdLevel();
+	if (level == SimdLevel::AVX2) {
+		for (; i + 8 <= count; i += 8) {
+			InterpolateAVX2(&q1[i], &q2[i], &t[i], &result[i], isSlerp);
+		}
+	}
+	if (level != SimdLevel::Scalar) {
+		for (; i + 4 <= count; i += 4) {
+			InterpolateSSE4(&q1[i], &q2[i], &t[i], &result[i], isSlerp);
+		}
+	}
+	for (; i < count; i++) {
+		result[i] = isSlerp ? Slerp(q1[i], q2[i], t[i]) : Nlerp(q1[i], q2[i], t[i]);
+	}
+}
+
+}
+
+Quaternion IdentityQuaternion() {
+	return { 0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+Quaternion Multiply(const Quaternion& q1, const Quaternion& q2) {
+	Quaternion result;
+	result.x = q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y;
+	result.y = q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x;
+	result.z = q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w;
+	result.w = q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z;
+	return result;
+}
+
+Quaternion Conjugate(const Quaternion& quaternion) {
+	return { -quaternion.x, -quaternion.y, -quaternion.z, quaternion.w };
+}
+
+float Dot(const Quaternion& q1, const Quaternion& q2) {
+	return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+
+float Norm(const Quaternion& quaternion) {
+	return std::sqrt(Dot(quaternion, quaternion));
+}
+
+Quaternion Normalize(const Quaternion& quaternion) {
+	float norm = Norm(quaternion);
+	if (norm == 0.0f) {
+		return IdentityQuaternion();
+	}
+	float invNorm = 1.0f / norm;
+	return { quaternion.x * invNorm, quaternion.y * invNorm, quaternion.z * invNorm, quaternion.w * invNorm };
+}
+
+Quaternion Inverse(const Quaternion& quaternion) {
+	float normSq = Dot(quaternion, quaternion);
+	assert(normSq != 0.0f);
+	float invNormSq = 1.0f / normSq;
+	Quaternion conjugate = Conjugate(quaternion);
+	return { conjugate.x * invNormSq, conjugate.y * invNormSq, conjugate.z * invNormSq, conjugate.w * invNormSq };
+}
+
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle) {
+	float halfSin = std::sin(angle * 0.5f);
+	float halfCos = std::cos(angle * 0.5f);
+	return { axis.x * halfSin, axis.y * halfSin, axis.z * halfSin, halfCos };
+}
+
+Quaternion MakeRotateQuaternion(const Vector3& rotate) {
+	float sinX = std::sin(rotate.x * 0.5f), cosX = std::cos(rotate.x * 0.5f);
+	float sinY = std::sin(rotate.y * 0.5f), cosY = std::cos(rotate.y * 0.5f);
+	float sinZ = std::sin(rotate.z * 0.5f), cosZ = std::cos(rotate.z * 0.5f);
+
+	//X→Y→Zの順に回すので qZ * qY * qX を展開したもの
+	Quaternion result;
+	result.x = sinX * cosY * cosZ - cosX * sinY * sinZ;
+	result.y = cosX * sinY * cosZ + sinX * cosY * sinZ;
+	result.z = cosX * cosY * sinZ - sinX * sinY * cosZ;
+	result.w = cosX * cosY * cosZ + sinX * sinY * sinZ;
+	return result;
+}
+
+void ToAxisAngle(const Quaternion& quaternion, Vector3& axis, float& angle) {
+	float w = std::fmin(std::fmax(quaternion.w, -1.0f), 1.0f);
+	angle = 2.0f * std::acos(w);
+	float sinHalf = std::sqrt(1.0f - w * w);
+	if (sinHalf < 1.0e-6f) {
+		//回転がないので軸はどれでもよい
+		axis = { 1.0f, 0.0f, 0.0f };
+		return;
+	}
+	float invSinHalf = 1.0f / sinHalf;
+	axis = { quaternion.x * invSinHalf, quaternion.y * invSinHalf, quaternion.z * invSinHalf };
+}
+
+Vector3 ToEulerAngles(const Quaternion& quaternion) {
+	//回転行列の要素から求める
+	Matrix4x4 matrix = MakeRotateMatrix(quaternion);
+	const float(&m)[4][4] = matrix.m;
+	float sinY = std::fmin(std::fmax(-m[0][2], -1.0f), 1.0f);
+
+	Vector3 rotate;
+	rotate.y = std::asin(sinY);
+	if (std::fabs(sinY) < 0.999999f) {
+		rotate.x = std::atan2(m[1][2], m[2][2]);
+		rotate.z = std::atan2(m[0][1], m[0][0]);
+	} else {
+		//ジンバルロック。XとZが同じ軸になるのでZを0にする
+		rotate.x = std::atan2(sinY * m[1][0], m[1][1]);
+		rotate.z = 0.0f;
+	}
+	return rotate;
+}
+
+Vector3 RotateVector(const Vector3& vector, const Quaternion& quaternion) {
+	//v' = v + 2w(q×v) + 2q×(q×v)
+	Vector3 q = { quaternion.x, quaternion.y, quaternion.z };
+	Vector3 t = {
+		2.0f * (q.y * vector.z - q.z * vector.y),
+		2.0f * (q.z * vector.x - q.x * vector.z),
+		2.0f * (q.x * vector.y - q.y * vector.x) };
+	return {
+		vector.x + quaternion.w * t.x + (q.y * t.z - q.z * t.y),
+		vector.y + quaternion.w * t.y + (q.z * t.x - q.x * t.z),
+		vector.z + quaternion.w * t.z + (q.x * t.y - q.y * t.x) };
+}
+
+Matrix4x4 MakeRotateMatrix(const Quaternion& quaternion) {
+	return MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, quaternion, { 0.0f, 0.0f, 0.0f });
+}
+
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	float xx = rotate.x * rotate.x, yy = rotate.y * rotate.y, zz = rotate.z * rotate.z;
+	float xy = rotate.x * rotate.y, xz = rotate.x * rotate.z, yz = rotate.y * rotate.z;
+	float wx = rotate.w * rotate.x, wy = rotate.w * rotate.y, wz = rotate.w * rotate.z;
+
+	Matrix4x4 matrix;
+
+	matrix.m[0][0] = scale.x * (1.0f - 2.0f * (yy + zz));
+	matrix.m[0][1] = scale.x * (2.0f * (xy + wz));
+	matrix.m[0][2] = scale.x * (2.0f * (xz - wy));
+	matrix.m[0][3] = 0.0f;
+
+	matrix.m[1][0] = scale.y * (2.0f * (xy - wz));
+	matrix.m[1][1] = scale.y * (1.0f - 2.0f * (xx + zz));
+	matrix.m[1][2] = scale.y * (2.0f * (yz + wx));
+	matrix.m[1][3] = 0.0f;
+
+	matrix.m[2][0] = scale.z * (2.0f * (xz + wy));
+	matrix.m[2][1] = scale.z * (2.0f * (yz - wx));
+	matrix.m[2][2] = scale.z * (1.0f - 2.0f * (xx + yy));
+	matrix.m[2][3] = 0.0f;
+
+	matrix.m[3][0] = translate.x;
+	matrix.m[3][1] = translate.y;
+	matrix.m[3][2] = translate.z;
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
+
+Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float t) {
+	float sign = Dot(q1, q2) < 0.0f ? -1.0f : 1.0f;
+	float t1 = 1.0f - t;
+	float t2 = t * sign;
+	Quaternion result = {
+		q1.x * t1 + q2.x * t2,
+		q1.y * t1 + q2.y * t2,
+		q1.z * t1 + q2.z * t2,
+		q1.w * t1 + q2.w * t2 };
+	return Normalize(result);
+}
+
+Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t) {
+	float dot = Dot(q1, q2);
+	float sign = 1.0f;
+	if (dot < 0.0f) {
+		dot = -dot;
+		sign = -1.0f;
+	}
+	float xm1 = dot - 1.0f;
+	float coefficient1 = SlerpCoefficient(1.0f - t, xm1);
+	float coefficient2 = SlerpCoefficient(t, xm1) * sign;
+	return {
+		q1.x * coefficient1 + q2.x * coefficient2,
+		q1.y * coefficient1 + q2.y * coefficient2,
+		q1.z * coefficient1 + q2.z * coefficient2,
+		q1.w * coefficient1 + q2.w * coefficient2 };
+}
+
+void Nlerp(std::span<const Quaternion> q1, std::span<const Quaternion> q2, std::span<const float> t, std::span<Quaternion> result) {
+	InterpolateBatch(q1, q2, t, result, false);
+}
+
+void Slerp(std::span<const Quaternion> q1, std::span<const Quaternion> q2, std::span<const float> t, std::span<Quaternion> result) {
+	InterpolateBatch(q1, q2, t, result, true);
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include <span>
+
+/// <summary>
+/// 回転を表すクォータニオン。(x, y, z)が虚部、wが実部
+/// </summary>
+struct Quaternion {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+/// <summary>
+/// 単位クォータニオン(回転なし)
+/// </summary>
+/// <returns></returns>
+Quaternion IdentityQuaternion();
+
+/// <summary>
+/// クォータニオンの積。q2で回転した後にq1で回転する回転になる
+/// </summary>
+/// <param name="q1">後に適用する回転</param>
+/// <param name="q2">先に適用する回転</param>
+/// <returns></returns>
+Quaternion Multiply(const Quaternion& q1, const Quaternion& q2);
+
+/// <summary>
+/// 共役クォータニオン
+/// </summary>
+/// <param name="quaternion">クォータニオン</param>
+/// <returns></returns>
+Quaternion Conjugate(const Quaternion& quaternion);
+
+/// <summary>
+/// クォータニオンの内積
+/// </summary>
+/// <param name="q1">クォータニオン1</param>
+/// <param name="q2">クォータニオン2</param>
+/// <returns></returns>
+float Dot(const Quaternion& q1, const Quaternion& q2);
+
+/// <summary>
+/// クォータニオンの長さ
+/// </summary>
+/// <param name="quaternion">クォータニオン</param>
+/// <returns></returns>
+float Norm(const Quaternion& quaternion);
+
+/// <summary>
+/// クォータニオンの正規化
+/// </summary>
+/// <param name="quaternion">正規化したいクォータニオン。長さ0の場合は単位クォータニオンを返す</param>
+/// <returns></returns>
+Quaternion Normalize(const Quaternion& quaternion);
+
+/// <summary>
+/// 逆クォータニオン
+/// </summary>
+/// <param name="quaternion">逆にしたいクォータニオン</param>
+/// <returns></returns>
+Quaternion Inverse(const Quaternion& quaternion);
+
+/// <summary>
+/// 任意軸回転を表すクォータニオンの作成
+/// </summary>
+/// <param name="axis">回転軸(正規化済み)</param>
+/// <param name="angle">回転角(ラジアン)</param>
+/// <returns></returns>
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle);
+
+/// <summary>
+/// オイラー角からクォータニオンを作成。MakeRotateMatrix(rotate)と同じX→Y→Zの順に回す
+/// </summary>
+/// <param name="rotate">オイラー角(ラジアン)</param>
+/// <returns></returns>
+Quaternion MakeRotateQuaternion(const Vector3& rotate);
+
+/// <summary>
+/// クォータニオンを回転軸と回転角に変換
+/// </summary>
+/// <param name="quaternion">正規化済みのクォータニオン</param>
+/// <param name="axis">回転軸の書き込み先。回転がない場合は(1, 0, 0)</param>
+/// <param name="angle">回転角の書き込み先(0～2π)</param>
+void ToAxisAngle(const Quaternion& quaternion, Vector3& axis, float& angle);
+
+/// <summary>
+/// クォータニオンをオイラー角に変換。MakeRotateQuaternionの逆変換
+/// </summary>
+/// <param name="quaternion">正規化済みのクォータニオン</param>
+/// <returns></returns>
+Vector3 ToEulerAngles(const Quaternion& quaternion);
+
+/// <summary>
+/// ベクトルをクォータニオンで回転させる
+/// </summary>
+/// <param name="vector">回転させるベクトル</param>
+/// <param name="quaternion">正規化済みのクォータニオン</param>
+/// <returns></returns>
+Vector3 RotateVector(const Vector3& vector, const Quaternion& quaternion);
+
+/// <summary>
+/// クォータニオンから回転行列を作成
+/// </summary>
+/// <param name="quaternion">正規化済みのクォータニオン</param>
+/// <returns></returns>
+Matrix4x4 MakeRotateMatrix(const Quaternion& quaternion);
+
+/// <summary>
+/// スケール、クォータニオン、平行移動からアフィン変換行列を作成
+/// </summary>
+/// <param name="scale">スケール</param>
+/// <param name="rotate">正規化済みのクォータニオン</param>
+/// <param name="translate">平行移動</param>
+/// <returns></returns>
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+
+/// <summary>
+/// 正規化線形補間。近い方の回りで補間する
+/// </summary>
+/// <param name="q1">t = 0のときの回転</param>
+/// <param name="q2">t = 1のときの回転</param>
+/// <param name="t">補間係数(0～1)</param>
+/// <returns></returns>
+Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+/// <summary>
+/// 球面線形補間。近い方の回りで補間する
+/// 三角関数を使わずに多項式(積和のみ)で係数を求める。各成分の誤差は3e-5以下
+/// </summary>
+/// <param name="q1">t = 0のときの回転</param>
+/// <param name="q2">t = 1のときの回転</param>
+/// <param name="t">補間係数(0～1)</param>
+/// <returns></returns>
+Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+/// <summary>
+/// 正規化線形補間をまとめて行う。SIMDで4つか8つずつ計算する
+/// 補間した結果の長さが0になったものは、1つずつのNlerpと同じく単位クォータニオンにする
+/// </summary>
+/// <param name="q1">t = 0のときの回転</param>
+/// <param name="q2">t = 1のときの回転。q1と同じ数が必要</param>
+/// <param name="t">補間係数。q1と同じ数が必要</param>
+/// <param name="result">結果の書き込み先。q1と同じ数が必要</param>
+void Nlerp(std::span<const Quaternion> q1, std::span<const Quaternion> q2, std::span<const float> t, std::span<Quaternion> result);
+
+/// <summary>
+/// 球面線形補間をまとめて行う。SIMDで4つか8つずつ計算する
+/// </summary>
+/// <param name="q1">t = 0のときの回転</param>
+/// <param name="q2">t = 1のときの回転。q1と同じ数が必要</param>
+/// <param name="t">補間係数。q1と同じ数が必要</param>
+/// <param name="result">結果の書き込み先。q1と同じ数が必要</param>
+void Slerp(std::span<const Quaternion> q1, std::span<const Quaternion> q2, std::span<const float> t, std::span<Quaternion> result);
@@ -0,0 +1,57 @@
+#include "SphereMesh.h"
+#include "MeshWriter.h"
+#include "MathFunction.h"
+#include <cassert>
+
+namespace {
+
+constexpr float kPi = static_cast<float>(MathConstexpr::kPi);
+
+template<class Index>
+void WriteSphere(uint32_t subdivision, std::span<VertexData> vertices, std::span<Index> indices) {
+	assert(subdivision >= 3);
+	const uint32_t stride = subdivision + 1;
+	const float kLonEvery = 2.0f * kPi / static_cast<float>(subdivision);
+	const float kLatEvery = kPi / static_cast<float>(subdivision);
+
+	//緯度・経度の分割点ごとのsin, cosをまとめて求めておく
+	std::vector<float> lats(stride), lons(stride);
+	std::vector<float> latSin(stride), latCos(stride), lonSin(stride), lonCos(stride);
+	for (uint32_t index = 0; index < stride; ++index) {
+		lats[index] = -kPi / 2.0f + kLatEvery * static_cast<float>(index);
+		lons[index] = kLonEvery * static_cast<float>(index);
+	}
+	SinCos(lats, latSin, latCos);
+	SinCos(lons, lonSin, lonCos);
+
+	const float invSubdivision = 1.0f / static_cast<float>(subdivision);
+	//一番下と一番上の行は極の1点に縮退するので、面積0の三角形は書かない
+	WriteGridMesh(subdivision, subdivision, vertices, indices, [&](uint32_t latIndex, uint32_t lonIndex) {
+		float x = latCos[latIndex] * lonCos[lonIndex];
+		float y = latSin[latIndex];
+		float z = latCos[latIndex] * lonSin[lonIndex];
+		//単位球なので位置がそのまま法線になる
+		return VertexData{
+			{ x, y, z, 1.0f },
+			{ static_cast<float>(lonIndex) * invSubdivision, 1.0f - static_cast<float>(latIndex) * invSubdivision },
+			{ x, y, z } };
+	}, true);
+}
+
+}
+
+MeshData MakeSphereMesh(uint32_t subdivision) {
+	MeshData mesh;
+	mesh.vertices.resize(GetGridVertexCount(subdivision, subdivision));
+	mesh.indices.resize(GetGridIndexCount(subdivision, subdivision, true));
+	WriteSphere<uint32_t>(subdivision, mesh.vertices, mesh.indices);
+	return mesh;
+}
+
+void WriteSphereMesh(uint32_t subdivision, std::span<VertexData> vertices, std::span<uint32_t> indices) {
+	WriteSphere<uint32_t>(subdivision, vertices, indices);
+}
+
+void WriteSphereMesh(uint32_t subdivision, std::span<VertexData> vertices, std::span<uint16_t> indices) {
+	WriteSphere<uint16_t>(subdivision, vertices, indices);
+}
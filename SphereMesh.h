@@ -0,0 +1,195 @@
+#pragma once
+#include "VertexData.h"
+#include "MeshData.h"
+#include "MathConstexpr.h"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/// <summary>
+/// 緯度・経度で分割した球(半径1、原点中心)を頂点を共有したインデックス付きのメッシュで作る
+/// 緯度・経度ごとのsin, cosは最初にまとめて求めるので、頂点ごとには三角関数を呼ばない
+/// </summary>
+/// <param name="subdivision">緯度・経度方向の分割数(3以上)</param>
+/// <returns>頂点は(subdivision + 1)^2個。テクスチャ座標のために経度0と2πの列、極の行は重ねて持つ</returns>
+MeshData MakeSphereMesh(uint32_t subdivision);
+
+/// <summary>
+/// MakeSphereMeshと同じ球を書き込み先に直接書き込む。緯度の行ごとにスレッドプールで分担する
+/// Mapしたアップロードバッファに書けば、一時的な配列もコピーもいらない
+/// </summary>
+/// <param name="subdivision">緯度・経度方向の分割数(3以上)</param>
+/// <param name="vertices">頂点の書き込み先。(subdivision + 1)^2個以上</param>
+/// <param name="indices">インデックスの書き込み先。subdivision * (subdivision - 1) * 6個以上(極の行は四角形ごとに三角形1枚)</param>
+void WriteSphereMesh(uint32_t subdivision, std::span<VertexData> vertices, std::span<uint32_t> indices);
+
+/// <summary>
+/// 16bitのインデックスで球を書き込む。subdivisionは255以下(頂点数65536以下)
+/// </summary>
+void WriteSphereMesh(uint32_t subdivision, std::span<VertexData> vertices, std::span<uint16_t> indices);
+
+#pragma region コンパイル時に作る球
+/// <summary>
+/// 分割数Subdivisionの球(半径1、原点中心)の頂点数。インデックスを使わず三角形リストで並べる
+/// </summary>
+template<uint32_t Subdivision>
+constexpr uint32_t kSphereVertexCount = Subdivision * (Subdivision - 1) * 6;
+
+/// <summary>
+/// 緯度・経度で分割した球の頂点をコンパイル時に作る
+/// </summary>
+/// <returns>経度方向に並んだ四角形ごとに三角形2枚(6頂点)。極の行は面積0になる方を除いて1枚(3頂点)</returns>
+template<uint32_t Subdivision>
+constexpr std::array<VertexData, kSphereVertexCount<Subdivision>> MakeSphereVertices() {
+	static_assert(Subdivision >= 3, "分割数が少なすぎます");
+	constexpr double kLonEvery = 2.0 * MathConstexpr::kPi / Subdivision;
+	constexpr double kLatEvery = MathConstexpr::kPi / Subdivision;
+	constexpr float kSubdivision = static_cast<float>(Subdivision);
+
+	//分割点ごとの緯度・経度のsin, cosを先に求めておく
+	float latSin[Subdivision + 1] = {}, latCos[Subdivision + 1] = {};
+	float lonSin[Subdivision + 1] = {}, lonCos[Subdivision + 1] = {};
+	for (uint32_t index = 0; index <= Subdivision; ++index) {
+		double lat = -MathConstexpr::kPi / 2.0 + kLatEvery * index;
+		double lon = kLonEvery * index;
+		latSin[index] = static_cast<float>(MathConstexpr::Sin(lat));
+		latCos[index] = static_cast<float>(MathConstexpr::Cos(lat));
+		lonSin[index] = static_cast<float>(MathConstexpr::Sin(lon));
+		lonCos[index] = static_cast<float>(MathConstexpr::Cos(lon));
+	}
+
+	std::array<VertexData, kSphereVertexCount<Subdivision>> vertices{};
+	auto makeVertex = [&](uint32_t latIndex, uint32_t lonIndex) {
+		float x = latCos[latIndex] * lonCos[lonIndex];
+		float y = latSin[latIndex];
+		float z = latCos[latIndex] * lonSin[lonIndex];
+		VertexData vertex{};
+		vertex.position = { x, y, z, 1.0f };
+		vertex.texcoode = { static_cast<float>(lonIndex) / kSubdivision, 1.0f - static_cast<float>(latIndex) / kSubdivision };
+		//単位球なので位置がそのまま法線になる
+		vertex.normal = { x, y, z };
+		return vertex;
+	};
+	uint32_t start = 0;
+	//緯度の方向に分割 -π/2 ～ π/2
+	for (uint32_t latIndex = 0; latIndex < Subdivision; ++latIndex) {
+		//経度の方向に分割 0～2π
+		for (uint32_t lonIndex = 0; lonIndex < Subdivision; ++lonIndex) {
+			//1枚目(南極の行では底辺が1点に縮退する)
+			if (latIndex != 0) {
+				vertices[start] = makeVertex(latIndex, lonIndex);
+				vertices[start + 1] = makeVertex(latIndex + 1, lonIndex);
+				vertices[start + 2] = makeVertex(latIndex, lonIndex + 1);
+				start += 3;
+			}
+			//2枚目(北極の行では上辺が1点に縮退する)
+			if (latIndex != Subdivision - 1) {
+				vertices[start] = makeVertex(latIndex, lonIndex + 1);
+				vertices[start + 1] = makeVertex(latIndex + 1, lonIndex);
+				vertices[start + 2] = makeVertex(latIndex + 1, lonIndex + 1);
+				start += 3;
+			}
+		}
+	}
+	return vertices;
+}
+
+/// <summary>
+/// コンパイル時に作った球の頂点。アップロード用のバッファにそのままmemcpyできる
+/// </summary>
+template<uint32_t Subdivision>
+inline constexpr std::array<VertexData, kSphereVertexCount<Subdivision>> kSphereVertices = MakeSphereVertices<Subdivision>();
+
+/// <summary>
+/// 頂点を共有した球の頂点数
+/// </summary>
+template<uint32_t Subdivision>
+constexpr uint32_t kSphereIndexedVertexCount = (Subdivision + 1) * (Subdivision + 1);
+
+/// <summary>
+/// 頂点を共有した球のインデックス数。極の行は四角形ごとに三角形1枚
+/// </summary>
+template<uint32_t Subdivision>
+constexpr uint32_t kSphereIndexCount = Subdivision * (Subdivision - 1) * 6;
+
+/// <summary>
+/// 頂点を共有した球のインデックスの型。頂点数が収まるなら16bitにする
+/// </summary>
+template<uint32_t Subdivision>
+using SphereIndex = std::conditional_t<CanUse16BitIndices(kSphereIndexedVertexCount<Subdivision>), uint16_t, uint32_t>;
+
+/// <summary>
+/// MakeSphereMeshと同じ並びの頂点をコンパイル時に作る
+/// </summary>
+template<uint32_t Subdivision>
+constexpr std::array<VertexData, kSphereIndexedVertexCount<Subdivision>> MakeSphereIndexedVertices() {
+	static_assert(Subdivision >= 3, "分割数が少なすぎます");
+	constexpr float kSubdivision = static_cast<float>(Subdivision);
+	float lonSin[Subdivision + 1] = {}, lonCos[Subdivision + 1] = {};
+	for (uint32_t index = 0; index <= Subdivision; ++index) {
+		double lon = 2.0 * MathConstexpr::kPi / Subdivision * index;
+		lonSin[index] = static_cast<float>(MathConstexpr::Sin(lon));
+		lonCos[index] = static_cast<float>(MathConstexpr::Cos(lon));
+	}
+
+	std::array<VertexData, kSphereIndexedVertexCount<Subdivision>> vertices{};
+	for (uint32_t latIndex = 0; latIndex <= Subdivision; ++latIndex) {
+		double lat = -MathConstexpr::kPi / 2.0 + MathConstexpr::kPi / Subdivision * latIndex;
+		float latSin = static_cast<float>(MathConstexpr::Sin(lat));
+		float latCos = static_cast<float>(MathConstexpr::Cos(lat));
+		for (uint32_t lonIndex = 0; lonIndex <= Subdivision; ++lonIndex) {
+			float x = latCos * lonCos[lonIndex];
+			float z = latCos * lonSin[lonIndex];
+			VertexData& vertex = vertices[latIndex * (Subdivision + 1) + lonIndex];
+			vertex.position = { x, latSin, z, 1.0f };
+			vertex.texcoode = { static_cast<float>(lonIndex) / kSubdivision, 1.0f - static_cast<float>(latIndex) / kSubdivision };
+			vertex.normal = { x, latSin, z };
+		}
+	}
+	return vertices;
+}
+
+/// <summary>
+/// MakeSphereMeshと同じ並びのインデックスをコンパイル時に作る
+/// </summary>
+template<uint32_t Subdivision>
+constexpr std::array<SphereIndex<Subdivision>, kSphereIndexCount<Subdivision>> MakeSphereIndices() {
+	using Index = SphereIndex<Subdivision>;
+	std::array<Index, kSphereIndexCount<Subdivision>> indices{};
+	constexpr uint32_t kStride = Subdivision + 1;
+	uint32_t start = 0;
+	for (uint32_t latIndex = 0; latIndex < Subdivision; ++latIndex) {
+		for (uint32_t lonIndex = 0; lonIndex < Subdivision; ++lonIndex) {
+			uint32_t leftBottom = latIndex * kStride + lonIndex;
+			uint32_t leftTop = leftBottom + kStride;
+			//1枚目(南極の行では底辺が1点に縮退する)
+			if (latIndex != 0) {
+				indices[start] = static_cast<Index>(leftBottom);
+				indices[start + 1] = static_cast<Index>(leftTop);
+				indices[start + 2] = static_cast<Index>(leftBottom + 1);
+				start += 3;
+			}
+			//2枚目(北極の行では上辺が1点に縮退する)
+			if (latIndex != Subdivision - 1) {
+				indices[start] = static_cast<Index>(leftBottom + 1);
+				indices[start + 1] = static_cast<Index>(leftTop);
+				indices[start + 2] = static_cast<Index>(leftTop + 1);
+				start += 3;
+			}
+		}
+	}
+	return indices;
+}
+
+/// <summary>
+/// コンパイル時に作った頂点を共有した球の頂点
+/// </summary>
+template<uint32_t Subdivision>
+inline constexpr std::array<VertexData, kSphereIndexedVertexCount<Subdivision>> kSphereIndexedVertices = MakeSphereIndexedVertices<Subdivision>();
+
+/// <summary>
+/// コンパイル時に作った頂点を共有した球のインデックス
+/// </summary>
+template<uint32_t Subdivision>
+inline constexpr std::array<SphereIndex<Subdivision>, kSphereIndexCount<Subdivision>> kSphereIndices = MakeSphereIndices<Subdivision>();
+#pragma endregion
@@ -0,0 +1,79 @@
+#include "TextureLoader.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <objbase.h>
+#include <thread>
+
+namespace {
+
+/// <summary>
+/// ワーカースレッドごとにCOMを初期化しておく(WICを使うため)
+/// </summary>
+struct ComScope {
+	ComScope() : isInitialized(SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED))) {}
+	~ComScope() {
+		if (isInitialized) {
+			CoUninitialize();
+		}
+	}
+	bool isInitialized;
+};
+
+size_t GetDefaultThreadCount() {
+	//描画スレッドと、メッシュの処理に使う共有のスレッドプールの分を残す
+	return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+
+}
+
+bool DecodeTexture(const std::filesystem::path& filePath, DirectX::ScratchImage& mipImages) {
+	//テクスチャファイルを読んでプログラムで扱えるようにする
+	DirectX::ScratchImage image{};
+	HRESULT hr = DirectX::LoadFromWICFile(filePath.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	//ミップマップの作成。1x1の画像はそれ以上小さくできないのでそのまま使う
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	if (metadata.width == 1 && metadata.height == 1) {
+		mipImages = std::move(image);
+		return true;
+	}
+	hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), metadata, DirectX::TEX_FILTER_SRGB, 0, mipImages);
+	return SUCCEEDED(hr);
+}
+
+TextureLoader::TextureLoader(size_t threadCount)
+	: workers_(threadCount != 0 ? threadCount : GetDefaultThreadCount()) {
+}
+
+TextureLoader::~TextureLoader() {
+	//キューに残っている読み込みは飛ばし、workers_を壊すときに実行中のものを待つ
+	isStopping_.store(true, std::memory_order_relaxed);
+}
+
+TextureHandle TextureLoader::Load(const std::filesystem::path& filePath) {
+	std::filesystem::path normalPath = filePath.lexically_normal();
+	auto found = handles_.find(normalPath.native());
+	if (found != handles_.end()) {
+		return found->second;
+	}
+
+	TextureHandle handle = static_cast<TextureHandle>(filePaths_.size());
+	filePaths_.push_back(normalPath);
+	handles_.emplace(normalPath.native(), handle);
+	pendingCount_.fetch_add(1, std::memory_order_relaxed);
+	workers_.Enqueue([this, handle, normalPath]() {
+		thread_local ComScope comScope;
+		DecodedTexture texture = { handle, {}, false, 0.0 };
+		if (!isStopping_.load(std::memory_order_relaxed)) {
+			const auto start = std::chrono::steady_clock::now();
+			texture.isSucceeded = DecodeTexture(normalPath, texture.mipImages);
+			texture.decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		completed_.Push(std::move(texture));
+	});
+	return handle;
+}
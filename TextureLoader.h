@@ -0,0 +1,95 @@
+#pragma once
+#include "CompletionQueue.h"
+#include "ThreadPool.h"
+#include "externals/DirectXTex/DirectXTex.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//テクスチャを別のスレッドで読み込む
+//Loadはすぐにハンドルを返し、WICでの読み込みとミップマップの作成はワーカースレッドで行う
+//読み終わった画像はCompletionQueueに入り、描画スレッドがProcessCompletedで受け取ってGPUへ転送する
+//転送が済むまでは、そのハンドルのテクスチャとしてプレースホルダー(1x1)を使うこと
+
+/// <summary>
+/// テクスチャのハンドル。Loadを呼んだ順に0から振る
+/// </summary>
+using TextureHandle = uint32_t;
+
+constexpr TextureHandle kInvalidTexture = 0xFFFFFFFF;
+
+/// <summary>
+/// ワーカースレッドで読み終わったテクスチャ
+/// </summary>
+struct DecodedTexture {
+	TextureHandle handle;
+	//ミップマップ付きの画像。読めなかったときは空
+	DirectX::ScratchImage mipImages;
+	bool isSucceeded;
+	//読み込みとミップマップの作成にかかった時間(秒)
+	double decodeSeconds;
+};
+
+/// <summary>
+/// ファイルを読んでミップマップ付きの画像にする。sRGBとして読む
+/// </summary>
+/// <param name="filePath">画像ファイルのパス(WICで読める形式)</param>
+/// <param name="mipImages">結果</param>
+/// <returns>読めなければfalse</returns>
+bool DecodeTexture(const std::filesystem::path& filePath, DirectX::ScratchImage& mipImages);
+
+class TextureLoader {
+public:
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="threadCount">読み込みに使うワーカースレッドの数。0ならコア数の半分(1以上)</param>
+	explicit TextureLoader(size_t threadCount = 0);
+
+	/// <summary>
+	/// まだ始まっていない読み込みは行わず、読み込み中のものが終わるのを待つ
+	/// </summary>
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	/// <summary>
+	/// 読み込みを始めて、すぐにハンドルを返す。描画スレッドから呼ぶ
+	/// </summary>
+	/// <param name="filePath">画像ファイルのパス</param>
+	/// <returns>ハンドル。同じパスを2回渡したときは同じハンドル</returns>
+	TextureHandle Load(const std::filesystem::path& filePath);
+
+	/// <summary>
+	/// 読み終わったテクスチャをすべて受け取る。描画スレッドから毎フレーム呼ぶ
+	/// </summary>
+	/// <param name="function">function(DecodedTexture&& texture)。読み終わった順に呼ばれる</param>
+	/// <returns>受け取った数</returns>
+	template<class Function>
+	size_t ProcessCompleted(Function&& function) {
+		return completed_.Drain([&](DecodedTexture&& texture) {
+			pendingCount_.fetch_sub(1, std::memory_order_relaxed);
+			function(std::move(texture));
+		});
+	}
+
+	//Loadで作ったハンドルの数
+	size_t GetTextureCount() const { return filePaths_.size(); }
+	const std::filesystem::path& GetFilePath(TextureHandle handle) const { return filePaths_[handle]; }
+	//読み込み中かProcessCompletedでまだ受け取っていない数
+	size_t GetPendingCount() const { return pendingCount_.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<std::filesystem::path> filePaths_;
+	std::unordered_map<std::filesystem::path::string_type, TextureHandle> handles_;
+	std::atomic<size_t> pendingCount_ = 0;
+	std::atomic<bool> isStopping_ = false;
+	CompletionQueue<DecodedTexture> completed_;
+	//ほかのメンバーより先に壊してスレッドを止めるので、最後に置く
+	ThreadPool workers_;
+};
@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+	workers_.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++) {
+		workers_.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+	}
+	condition_.notify_all();
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+}
+
+ThreadPool& ThreadPool::GetInstance() {
+	static ThreadPool instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return instance;
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push(std::move(task));
+	}
+	condition_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+	for (;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return isStopping_ || !tasks_.empty(); });
+			if (isStopping_ && tasks_.empty()) {
+				return;
+			}
+			task = std::move(tasks_.front());
+			tasks_.pop();
+		}
+		task();
+	}
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = std::max<size_t>(grainSize, 1);
+	size_t chunkCount = (count + grainSize - 1) / grainSize;
+	if (chunkCount == 1 || workers_.empty()) {
+		function(0, count);
+		return;
+	}
+
+	//チャンクを取り合う形にして、先に空いたスレッドが次のチャンクを処理する
+	//ワーカーが処理を始める前に全部終わることもあるので、共有する状態はshared_ptrで持たせる
+	struct SharedState {
+		std::atomic<size_t> nextChunk = 0;
+		std::atomic<size_t> remainingChunks = 0;
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+	std::shared_ptr<SharedState> state = std::make_shared<SharedState>();
+	state->remainingChunks = chunkCount;
+
+	auto runChunks = [state, count, grainSize, chunkCount, &function]() {
+		for (;;) {
+			size_t chunk = state->nextChunk.fetch_add(1);
+			if (chunk >= chunkCount) {
+				return;
+			}
+			size_t begin = chunk * grainSize;
+			function(begin, std::min(begin + grainSize, count));
+			if (state->remainingChunks.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->condition.notify_all();
+			}
+		}
+	};
+
+	//呼び出し元も処理するので、ワーカーに頼むのはチャンク数-1まで
+	size_t helperCount = std::min(workers_.size(), chunkCount - 1);
+	for (size_t i = 0; i < helperCount; i++) {
+		Enqueue(runChunks);
+	}
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&state]() { return state->remainingChunks.load() == 0; });
+}
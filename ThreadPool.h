@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// 起動時に作ったワーカースレッドで処理を分担するスレッドプール
+/// </summary>
+class ThreadPool
+{
+public:
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="threadCount">ワーカースレッドの数。呼び出し元のスレッドも処理を手伝うので、コア数-1程度でよい</param>
+	explicit ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// <summary>
+	/// アプリ全体で共有するスレッドプール。最初の呼び出しでコア数-1個のスレッドを作る
+	/// </summary>
+	/// <returns></returns>
+	static ThreadPool& GetInstance();
+
+	/// <summary>
+	/// [0, count)をgrainSize個ずつに分けて並列に処理する。すべて終わるまで戻らない
+	/// </summary>
+	/// <param name="count">要素数</param>
+	/// <param name="grainSize">1回の呼び出しで処理する要素数の目安。これ以下の要素数なら呼び出し元のスレッドだけで処理する</param>
+	/// <param name="function">function(begin, end)で[begin, end)を処理する。別々のスレッドから同時に呼ばれる</param>
+	void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+
+	/// <summary>
+	/// 処理を投げて、すぐに戻る。終了を待つ仕組みは呼び出し側で用意すること
+	/// </summary>
+	/// <param name="task">ワーカースレッドで実行する処理</param>
+	void Enqueue(std::function<void()> task);
+
+	inline size_t GetThreadCount() const { return workers_.size(); }
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> workers_;
+	std::queue<std::function<void()>> tasks_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	bool isStopping_ = false;
+};
@@ -0,0 +1,250 @@
+#include "TransformBatch.h"
+#include "CpuFeature.h"
+#include <immintrin.h>
+#include <cassert>
+#include <cstddef>
+
+namespace {
+
+enum class TransformMode {
+	Affine,     //平行移動まで。wの除算はしない
+	Projective, //wで割る
+	Normal,     //3x3部分だけ
+};
+
+//AoSもSoAも同じように扱えるように、要素の間隔(float単位)を持たせた読み書き先
+struct StridedInput {
+	const float* x;
+	const float* y;
+	const float* z;
+	size_t stride;
+};
+
+struct StridedOutput {
+	float* x;
+	float* y;
+	float* z;
+	size_t stride;
+};
+
+StridedInput MakeInput(std::span<const Vector3> vectors) {
+	const float* base = reinterpret_cast<const float*>(vectors.data());
+	return { base, base + 1, base + 2, 3 };
+}
+
+StridedInput MakeInput(const ConstVector3SoA& vectors) {
+	return { vectors.x, vectors.y, vectors.z, 1 };
+}
+
+StridedInput MakePositionInput(std::span<const VertexData> vertices) {
+	const float* base = reinterpret_cast<const float*>(vertices.data()) + offsetof(VertexData, position) / sizeof(float);
+	return { base, base + 1, base + 2, sizeof(VertexData) / sizeof(float) };
+}
+
+StridedInput MakeNormalInput(std::span<const VertexData> vertices) {
+	const float* base = reinterpret_cast<const float*>(vertices.data()) + offsetof(VertexData, normal) / sizeof(float);
+	return { base, base + 1, base + 2, sizeof(VertexData) / sizeof(float) };
+}
+
+StridedOutput MakeOutput(std::span<Vector3> vectors) {
+	float* base = reinterpret_cast<float*>(vectors.data());
+	return { base, base + 1, base + 2, 3 };
+}
+
+StridedOutput MakeOutput(const Vector3SoA& vectors) {
+	return { vectors.x, vectors.y, vectors.z, 1 };
+}
+
+StridedInput Advance(StridedInput input, size_t count) {
+	size_t offset = count * input.stride;
+	return { input.x + offset, input.y + offset, input.z + offset, input.stride };
+}
+
+StridedOutput Advance(StridedOutput output, size_t count) {
+	size_t offset = count * output.stride;
+	return { output.x + offset, output.y + offset, output.z + offset, output.stride };
+}
+
+#pragma region スカラー実装
+void TransformScalar(const StridedInput& input, const StridedOutput& output, size_t count, const Matrix4x4& matrix, TransformMode mode) {
+	const float(&m)[4][4] = matrix.m;
+	for (size_t i = 0; i < count; i++) {
+		float x = input.x[i * input.stride];
+		float y = input.y[i * input.stride];
+		float z = input.z[i * input.stride];
+
+		float resultX = x * m[0][0] + y * m[1][0] + z * m[2][0];
+		float resultY = x * m[0][1] + y * m[1][1] + z * m[2][1];
+		float resultZ = x * m[0][2] + y * m[1][2] + z * m[2][2];
+		if (mode != TransformMode::Normal) {
+			resultX += m[3][0];
+			resultY += m[3][1];
+			resultZ += m[3][2];
+		}
+		if (mode == TransformMode::Projective) {
+			float w = x * m[0][3] + y * m[1][3] + z * m[2][3] + m[3][3];
+			assert(w != 0.0f);
+			float invW = 1.0f / w;
+			resultX *= invW;
+			resultY *= invW;
+			resultZ *= invW;
+		}
+
+		output.x[i * output.stride] = resultX;
+		output.y[i * output.stride] = resultY;
+		output.z[i * output.stride] = resultZ;
+	}
+}
+#pragma endregion
+
+#pragma region SSE4実装
+//1要素ずつ、行列の各行に成分をブロードキャストして掛ける
+SIMD_TARGET_SSE4 void TransformSSE4(const StridedInput& input, const StridedOutput& output, size_t count, const Matrix4x4& matrix, TransformMode mode) {
+	__m128 row0 = _mm_loadu_ps(matrix.m[0]);
+	__m128 row1 = _mm_loadu_ps(matrix.m[1]);
+	__m128 row2 = _mm_loadu_ps(matrix.m[2]);
+	__m128 row3 = mode == TransformMode::Normal ? _mm_setzero_ps() : _mm_loadu_ps(matrix.m[3]);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	alignas(16) float result[4];
+	for (size_t i = 0; i < count; i++) {
+		__m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(input.x[i * input.stride]), row0), row3);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(input.y[i * input.stride]), row1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(input.z[i * input.stride]), row2));
+		if (mode == TransformMode::Projective) {
+			__m128 w = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3));
+			assert(_mm_cvtss_f32(w) != 0.0f);
+			r = _mm_mul_ps(r, _mm_div_ps(one, w));
+		}
+		_mm_store_ps(result, r);
+		output.x[i * output.stride] = result[0];
+		output.y[i * output.stride] = result[1];
+		output.z[i * output.stride] = result[2];
+	}
+}
+#pragma endregion
+
+#pragma region AVX2実装
+SIMD_TARGET_AVX2 __m256 LoadStrided(const float* base, size_t stride, __m256i index) {
+	if (stride == 1) {
+		return _mm256_loadu_ps(base);
+	}
+	return _mm256_i32gather_ps(base, index, sizeof(float));
+}
+
+SIMD_TARGET_AVX2 void StoreStrided(float* base, size_t stride, __m256 value) {
+	if (stride == 1) {
+		_mm256_storeu_ps(base, value);
+		return;
+	}
+	alignas(32) float lanes[8];
+	_mm256_store_ps(lanes, value);
+	for (size_t lane = 0; lane < 8; lane++) {
+		base[lane * stride] = lanes[lane];
+	}
+}
+
+//8要素ずつSoAとして読み込み(AoSはgatherで集める)、FMAで計算する
+SIMD_TARGET_AVX2 void TransformAVX2(const StridedInput& input, const StridedOutput& output, size_t count, const Matrix4x4& matrix, TransformMode mode) {
+	const float(&m)[4][4] = matrix.m;
+	const int stride = int(input.stride);
+	const __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	const bool translate = mode != TransformMode::Normal;
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		size_t inOffset = i * input.stride;
+		__m256 x = LoadStrided(input.x + inOffset, input.stride, index);
+		__m256 y = LoadStrided(input.y + inOffset, input.stride, index);
+		__m256 z = LoadStrided(input.z + inOffset, input.stride, index);
+
+		__m256 r[3];
+		for (int colmun = 0; colmun < 3; colmun++) {
+			__m256 c = translate ? _mm256_set1_ps(m[3][colmun]) : _mm256_setzero_ps();
+			c = _mm256_fmadd_ps(x, _mm256_set1_ps(m[0][colmun]), c);
+			c = _mm256_fmadd_ps(y, _mm256_set1_ps(m[1][colmun]), c);
+			r[colmun] = _mm256_fmadd_ps(z, _mm256_set1_ps(m[2][colmun]), c);
+		}
+		if (mode == TransformMode::Projective) {
+			__m256 w = _mm256_set1_ps(m[3][3]);
+			w = _mm256_fmadd_ps(x, _mm256_set1_ps(m[0][3]), w);
+			w = _mm256_fmadd_ps(y, _mm256_set1_ps(m[1][3]), w);
+			w = _mm256_fmadd_ps(z, _mm256_set1_ps(m[2][3]), w);
+			__m256 invW = _mm256_div_ps(_mm256_set1_ps(1.0f), w);
+			for (int colmun = 0; colmun < 3; colmun++) {
+				r[colmun] = _mm256_mul_ps(r[colmun], invW);
+			}
+		}
+
+		size_t outOffset = i * output.stride;
+		StoreStrided(output.x + outOffset, output.stride, r[0]);
+		StoreStrided(output.y + outOffset, output.stride, r[1]);
+		StoreStrided(output.z + outOffset, output.stride, r[2]);
+	}
+
+	//8つに満たない残り。SSE4の処理に移る前にYMMの上位をクリアしておく
+	_mm256_zeroupper();
+	TransformSSE4(Advance(input, i), Advance(output, i), count - i, matrix, mode);
+}
+#pragma endregion
+
+void TransformStream(const StridedInput& input, const StridedOutput& output, size_t count, const Matrix4x4& matrix, TransformMode mode) {
+	if (count == 0) {
+		return;
+	}
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		TransformAVX2(input, output, count, matrix, mode);
+		break;
+	case SimdLevel::SSE4:
+		TransformSSE4(input, output, count, matrix, mode);
+		break;
+	default:
+		TransformScalar(input, output, count, matrix, mode);
+		break;
+	}
+}
+
+}
+
+void TransformPoints(std::span<const Vector3> points, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= points.size());
+	TransformStream(MakeInput(points), MakeOutput(result), points.size(), matrix, TransformMode::Affine);
+}
+
+void TransformPoints(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= vertices.size());
+	TransformStream(MakePositionInput(vertices), MakeOutput(result), vertices.size(), matrix, TransformMode::Affine);
+}
+
+void TransformPoints(const ConstVector3SoA& points, size_t count, const Matrix4x4& matrix, const Vector3SoA& result) {
+	TransformStream(MakeInput(points), MakeOutput(result), count, matrix, TransformMode::Affine);
+}
+
+void TransformPointsProjective(std::span<const Vector3> points, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= points.size());
+	TransformStream(MakeInput(points), MakeOutput(result), points.size(), matrix, TransformMode::Projective);
+}
+
+void TransformPointsProjective(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= vertices.size());
+	TransformStream(MakePositionInput(vertices), MakeOutput(result), vertices.size(), matrix, TransformMode::Projective);
+}
+
+void TransformPointsProjective(const ConstVector3SoA& points, size_t count, const Matrix4x4& matrix, const Vector3SoA& result) {
+	TransformStream(MakeInput(points), MakeOutput(result), count, matrix, TransformMode::Projective);
+}
+
+void TransformNormals(std::span<const Vector3> normals, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= normals.size());
+	TransformStream(MakeInput(normals), MakeOutput(result), normals.size(), matrix, TransformMode::Normal);
+}
+
+void TransformNormals(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result) {
+	assert(result.size() >= vertices.size());
+	TransformStream(MakeNormalInput(vertices), MakeOutput(result), vertices.size(), matrix, TransformMode::Normal);
+}
+
+void TransformNormals(const ConstVector3SoA& normals, size_t count, const Matrix4x4& matrix, const Vector3SoA& result) {
+	TransformStream(MakeInput(normals), MakeOutput(result), count, matrix, TransformMode::Normal);
+}
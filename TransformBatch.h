@@ -0,0 +1,102 @@
+#pragma once
+#include "Vector3.h"
+#include "VertexData.h"
+#include "Matrix4x4.h"
+#include <span>
+#include <cstddef>
+
+//頂点や法線をまとめて行列で変換する関数
+//AVX2が使えるCPUでは8つずつ、それ以外では1つずつSSE4で計算する
+
+/// <summary>
+/// 要素ごとの配列で並べた3次元ベクトル(SoA)
+/// </summary>
+struct Vector3SoA {
+	float* x;
+	float* y;
+	float* z;
+};
+
+/// <summary>
+/// 読み取り専用のVector3SoA
+/// </summary>
+struct ConstVector3SoA {
+	const float* x;
+	const float* y;
+	const float* z;
+};
+
+/// <summary>
+/// 点をまとめてアフィン変換する。行列の4列目は(0, 0, 0, 1)とみなしてwの除算はしない
+/// </summary>
+/// <param name="points">変換する点</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <param name="result">結果の書き込み先。pointsと同じ数が必要。pointsと同じ配列でもよい</param>
+void TransformPoints(std::span<const Vector3> points, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// 頂点の位置をまとめてアフィン変換する
+/// </summary>
+/// <param name="vertices">変換する頂点。positionのxyzだけを使う</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <param name="result">結果の書き込み先。verticesと同じ数が必要</param>
+void TransformPoints(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// SoAで並べた点をまとめてアフィン変換する
+/// </summary>
+/// <param name="points">変換する点</param>
+/// <param name="count">点の数</param>
+/// <param name="matrix">アフィン変換行列</param>
+/// <param name="result">結果の書き込み先。pointsと同じ配列でもよい</param>
+void TransformPoints(const ConstVector3SoA& points, size_t count, const Matrix4x4& matrix, const Vector3SoA& result);
+
+/// <summary>
+/// 点をまとめて射影変換する。wの逆数を1回だけ求めて掛ける
+/// </summary>
+/// <param name="points">変換する点</param>
+/// <param name="matrix">変換行列。WVPなど</param>
+/// <param name="result">結果の書き込み先。pointsと同じ数が必要。pointsと同じ配列でもよい</param>
+void TransformPointsProjective(std::span<const Vector3> points, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// 頂点の位置をまとめて射影変換する
+/// </summary>
+/// <param name="vertices">変換する頂点。positionのxyzだけを使う</param>
+/// <param name="matrix">変換行列。WVPなど</param>
+/// <param name="result">結果の書き込み先。verticesと同じ数が必要</param>
+void TransformPointsProjective(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// SoAで並べた点をまとめて射影変換する
+/// </summary>
+/// <param name="points">変換する点</param>
+/// <param name="count">点の数</param>
+/// <param name="matrix">変換行列。WVPなど</param>
+/// <param name="result">結果の書き込み先。pointsと同じ配列でもよい</param>
+void TransformPointsProjective(const ConstVector3SoA& points, size_t count, const Matrix4x4& matrix, const Vector3SoA& result);
+
+/// <summary>
+/// 法線をまとめて変換する。行列の3x3部分だけを使い、正規化はしない
+/// </summary>
+/// <param name="normals">変換する法線</param>
+/// <param name="matrix">変換行列</param>
+/// <param name="result">結果の書き込み先。normalsと同じ数が必要。normalsと同じ配列でもよい</param>
+void TransformNormals(std::span<const Vector3> normals, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// 頂点の法線をまとめて変換する
+/// </summary>
+/// <param name="vertices">変換する頂点。normalだけを使う</param>
+/// <param name="matrix">変換行列</param>
+/// <param name="result">結果の書き込み先。verticesと同じ数が必要</param>
+void TransformNormals(std::span<const VertexData> vertices, const Matrix4x4& matrix, std::span<Vector3> result);
+
+/// <summary>
+/// SoAで並べた法線をまとめて変換する
+/// </summary>
+/// <param name="normals">変換する法線</param>
+/// <param name="count">法線の数</param>
+/// <param name="matrix">変換行列</param>
+/// <param name="result">結果の書き込み先。normalsと同じ配列でもよい</param>
+void TransformNormals(const ConstVector3SoA& normals, size_t count, const Matrix4x4& matrix, const Vector3SoA& result);
@@ -0,0 +1,22 @@
+#pragma once
+#include "Vector3.h"
+#include <cstddef>
+
+/// <summary>
+/// オブジェクトのSRT
+/// </summary>
+struct TransformStructure {
+	Vector3 scale;
+	Vector3 rotate;
+	Vector3 translate;
+};
+
+/// <summary>
+/// SRTを要素ごとの配列で持ったもの(SoA)。各ポインタはcount個の要素を指す
+/// </summary>
+struct TransformStructureSoA {
+	const float* scale[3];
+	const float* rotate[3];
+	const float* translate[3];
+	size_t count;
+};
@@ -7,11 +7,51 @@ struct Vector3 {
 };
 
 //算術演算子のオーバーロード
-Vector3 operator+(Vector3 num1, Vector3 num2);
-Vector3 operator-(Vector3 num1, Vector3 num2);
-Vector3 operator*(Vector3 num1, float num2);
-Vector3 operator/(Vector3 num1, float num2);
-Vector3 operator+=(Vector3& num1, Vector3 num2);
-Vector3 operator-=(Vector3& num1, Vector3 num2);
-Vector3 operator*=(Vector3& num1, float num2);
-Vector3 operator/=(Vector3& num1, float num2);
\ No newline at end of file
+//呼び出しのコストがかからないようにヘッダーで定義し、定数式でも使えるようにconstexprにしている
+constexpr Vector3 operator+(Vector3 num1, Vector3 num2) {
+	return { num1.x + num2.x, num1.y + num2.y, num1.z + num2.z };
+}
+
+constexpr Vector3 operator-(Vector3 num1, Vector3 num2) {
+	return { num1.x - num2.x, num1.y - num2.y, num1.z - num2.z };
+}
+
+constexpr Vector3 operator*(Vector3 num1, float num2) {
+	return { num1.x * num2, num1.y * num2, num1.z * num2 };
+}
+
+constexpr Vector3 operator/(Vector3 num1, float num2) {
+	return { num1.x / num2, num1.y / num2, num1.z / num2 };
+}
+
+constexpr Vector3 operator+=(Vector3& num1, Vector3 num2) {
+	num1.x += num2.x;
+	num1.y += num2.y;
+	num1.z += num2.z;
+
+	return num1;
+}
+
+constexpr Vector3 operator-=(Vector3& num1, Vector3 num2) {
+	num1.x -= num2.x;
+	num1.y -= num2.y;
+	num1.z -= num2.z;
+
+	return num1;
+}
+
+constexpr Vector3 operator*=(Vector3& num1, float num2) {
+	num1.x *= num2;
+	num1.y *= num2;
+	num1.z *= num2;
+
+	return num1;
+}
+
+constexpr Vector3 operator/=(Vector3& num1, float num2) {
+	num1.x /= num2;
+	num1.y /= num2;
+	num1.z /= num2;
+
+	return num1;
+}
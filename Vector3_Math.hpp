@@ -1,26 +1,111 @@
 #pragma once
 #include "Vector3.h"
 #include <math.h>
+#include <xmmintrin.h>
+#include <type_traits>
 #include "Matrix4x4.h"
 
 static const int kColumnWidth = 60;
 static const int kRowHeight = 20;
 
+//ベクトル演算はすべてヘッダーで定義している
+//sqrtを使うLength/Normalize以外はconstexprなので定数式でも使える
 
-Vector3 Add(const Vector3& v1, const Vector3& v2);
+constexpr Vector3 Add(const Vector3& v1, const Vector3& v2) {
+	return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z };
+}
 
-Vector3 Subtract(const Vector3& v1, const Vector3& v2);
+constexpr Vector3 Subtract(const Vector3& v1, const Vector3& v2) {
+	return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z };
+}
 
-Vector3 Multiply(float scalar, const Vector3& v);
+constexpr Vector3 Multiply(float scalar, const Vector3& v) {
+	return { scalar * v.x, scalar * v.y, scalar * v.z };
+}
 
-float Dot(const Vector3& v1, const Vector3& v2);
+/// <summary>
+/// Length/Normalizeの計算精度。テンプレート引数で呼び出し側が選ぶ
+/// Lengthの誤差とNormalizeの各成分の誤差(長さ1～1000のベクトル200万個を倍精度の結果と比較。Benchmarkの--accuracyで確認できる)
+/// Exact  : Lengthは最大2ulp、Normalizeは最大3ulp。sqrtと除算を使う。これまでのNormalizeと同じ計算
+/// Fast   : どちらも最大5ulp。rsqrtにニュートン法を1回かける
+/// Approx : どちらも最大6200ulp(rsqrtの相対誤差の上限 1.5 * 2^-12 = 3.7e-4 から決まる値)。rsqrtをそのまま使う
+/// Dot/Crossは積和だけで段階による違いがないので、精度の引数を持たない
+/// </summary>
+namespace Precision {
 
-float Length(const Vector3& v);
+struct Exact {
+	static float Sqrt(float x) { return sqrtf(x); }
+	static float InverseSqrt(float x) { return 1.0f / sqrtf(x); }
+};
 
-Vector3 Normalize(const Vector3& v1);
+struct Fast {
+	static float Sqrt(float x) { return x * InverseSqrt(x); }
+	static float InverseSqrt(float x) {
+		float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+		//ニュートン法で精度を約2倍の桁数にする
+		return y * (1.5f - 0.5f * x * y * y);
+	}
+};
 
-Vector3 Cross(const Vector3& v1, const Vector3& v2);
+struct Approx {
+	static float Sqrt(float x) { return x * InverseSqrt(x); }
+	static float InverseSqrt(float x) { return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x))); }
+};
 
-bool IsFront(const Vector3& v1, const Vector3 obj[3]);
+}
 
-Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m);
+constexpr float Dot(const Vector3& v1, const Vector3& v2) {
+	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+template<class Policy = Precision::Exact>
+inline float Length(const Vector3& v) {
+	float lengthSq = Dot(v, v);
+	if (lengthSq == 0.0f) {
+		return 0.0f;
+	}
+	return Policy::Sqrt(lengthSq);
+}
+
+/// <summary>
+/// 正規化。長さ0のベクトルはそのまま(0, 0, 0)を返す
+/// </summary>
+template<class Policy = Precision::Exact>
+inline Vector3 Normalize(const Vector3& v1) {
+	float lengthSq = Dot(v1, v1);
+	if (lengthSq == 0.0f) {
+		return { 0.0f, 0.0f, 0.0f };
+	}
+	if constexpr (std::is_same_v<Policy, Precision::Exact>) {
+		float length = sqrtf(lengthSq);
+		return { v1.x / length, v1.y / length, v1.z / length };
+	} else {
+		float invLength = Policy::InverseSqrt(lengthSq);
+		return { v1.x * invLength, v1.y * invLength, v1.z * invLength };
+	}
+}
+
+constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) {
+	return {
+		v1.y * v2.z - v1.z * v2.y,
+		v1.z * v2.x - v1.x * v2.z,
+		v1.x * v2.y - v1.y * v2.x
+	};
+}
+
+constexpr bool IsFront(const Vector3& v1, const Vector3 obj[3]) {
+	Vector3 vecA = obj[1] - obj[0];
+	Vector3 vecB = obj[2] - obj[1];
+
+	Vector3 v2 = Cross(vecA, vecB);
+
+	return Dot(v1, v2) <= 0;
+}
+
+constexpr Vector3 TransformNormal(const Vector3& v, const Matrix4x4& m) {
+	return {
+		v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+		v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+		v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2]
+	};
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#if defined(__FMA__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//__m128をそのまま持つ16バイト境界のベクトル型
+//計算中はレジスタに置いたまま扱い、メモリに書くときだけVector3/Vector4に戻す
+//Vector3/Vector4や定数バッファ・頂点の構造体はHLSLと同じ並びのまま変えない(Vector4の境界を16にするとVertexDataが48バイトになる)
+//
+//x64で必ず使えるSSE2の命令だけで書いているので、CPUの判定なしでどこからでも呼べる
+//FMAはコンパイラの設定(/arch:AVX2など)で有効なときだけ使う
+
+/// <summary>
+/// SIMDレジスタで扱う4次元ベクトル
+/// </summary>
+struct alignas(16) Vector4A {
+	__m128 v;
+};
+
+/// <summary>
+/// SIMDレジスタで扱う3次元ベクトル。wは常に0にしておく
+/// </summary>
+struct alignas(16) Vector3A {
+	__m128 v;
+};
+
+static_assert(sizeof(Vector4A) == 16 && alignof(Vector4A) == 16);
+static_assert(sizeof(Vector3A) == 16 && alignof(Vector3A) == 16);
+
+#pragma region 読み込みと書き込み
+/// <summary>
+/// Vector3を読み込む。12バイトだけ読むので配列の末尾でもよい
+/// </summary>
+inline Vector3A Load(const Vector3& vector) {
+	__m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&vector.x)));
+	__m128 z = _mm_load_ss(&vector.z);
+	return { _mm_movelh_ps(xy, z) };
+}
+
+inline Vector4A Load(const Vector4& vector) {
+	return { _mm_loadu_ps(&vector.x) };
+}
+
+/// <summary>
+/// Vector3に書き込む。12バイトだけ書くので隣のメンバーを壊さない
+/// </summary>
+inline void Store(Vector3& destination, Vector3A vector) {
+	_mm_store_sd(reinterpret_cast<double*>(&destination.x), _mm_castps_pd(vector.v));
+	_mm_store_ss(&destination.z, _mm_movehl_ps(vector.v, vector.v));
+}
+
+inline void Store(Vector4& destination, Vector4A vector) {
+	_mm_storeu_ps(&destination.x, vector.v);
+}
+
+inline Vector3 ToVector3(Vector3A vector) {
+	Vector3 result;
+	Store(result, vector);
+	return result;
+}
+
+inline Vector4 ToVector4(Vector4A vector) {
+	Vector4 result;
+	Store(result, vector);
+	return result;
+}
+
+inline Vector3A MakeVector3A(float x, float y, float z) {
+	return { _mm_setr_ps(x, y, z, 0.0f) };
+}
+
+inline Vector4A MakeVector4A(float x, float y, float z, float w) {
+	return { _mm_setr_ps(x, y, z, w) };
+}
+
+/// <summary>
+/// 位置として(x, y, z, 1)に拡張する
+/// </summary>
+inline Vector4A ToPoint(Vector3A vector) {
+	return { _mm_or_ps(vector.v, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f)) };
+}
+
+/// <summary>
+/// wを捨てて3次元ベクトルにする
+/// </summary>
+inline Vector3A ToVector3A(Vector4A vector) {
+	const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	return { _mm_and_ps(vector.v, mask) };
+}
+#pragma endregion
+
+#pragma region 算術演算子
+inline Vector3A operator+(Vector3A v1, Vector3A v2) { return { _mm_add_ps(v1.v, v2.v) }; }
+inline Vector3A operator-(Vector3A v1, Vector3A v2) { return { _mm_sub_ps(v1.v, v2.v) }; }
+inline Vector3A operator*(Vector3A v1, Vector3A v2) { return { _mm_mul_ps(v1.v, v2.v) }; }
+inline Vector3A operator*(Vector3A v1, float scalar) { return { _mm_mul_ps(v1.v, _mm_set1_ps(scalar)) }; }
+inline Vector3A operator-(Vector3A v1) { return { _mm_xor_ps(v1.v, _mm_set1_ps(-0.0f)) }; }
+inline Vector3A& operator+=(Vector3A& v1, Vector3A v2) { v1 = v1 + v2; return v1; }
+inline Vector3A& operator-=(Vector3A& v1, Vector3A v2) { v1 = v1 - v2; return v1; }
+inline Vector3A& operator*=(Vector3A& v1, float scalar) { v1 = v1 * scalar; return v1; }
+
+inline Vector4A operator+(Vector4A v1, Vector4A v2) { return { _mm_add_ps(v1.v, v2.v) }; }
+inline Vector4A operator-(Vector4A v1, Vector4A v2) { return { _mm_sub_ps(v1.v, v2.v) }; }
+inline Vector4A operator*(Vector4A v1, Vector4A v2) { return { _mm_mul_ps(v1.v, v2.v) }; }
+inline Vector4A operator*(Vector4A v1, float scalar) { return { _mm_mul_ps(v1.v, _mm_set1_ps(scalar)) }; }
+inline Vector4A operator-(Vector4A v1) { return { _mm_xor_ps(v1.v, _mm_set1_ps(-0.0f)) }; }
+inline Vector4A& operator+=(Vector4A& v1, Vector4A v2) { v1 = v1 + v2; return v1; }
+inline Vector4A& operator-=(Vector4A& v1, Vector4A v2) { v1 = v1 - v2; return v1; }
+inline Vector4A& operator*=(Vector4A& v1, float scalar) { v1 = v1 * scalar; return v1; }
+#pragma endregion
+
+#pragma region ベクトル演算
+namespace VectorSIMD {
+
+//4要素の和を全要素に入れる
+inline __m128 HorizontalSum(__m128 v) {
+	__m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sum = _mm_add_ps(v, shuffled);
+	shuffled = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2));
+	return _mm_add_ps(sum, shuffled);
+}
+
+inline __m128 MultiplyAdd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__) || defined(__AVX2__)
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+}
+
+/// <summary>
+/// v1 * v2 + v3。FMAが有効なビルドでは1命令になる
+/// </summary>
+inline Vector3A MultiplyAdd(Vector3A v1, Vector3A v2, Vector3A v3) { return { VectorSIMD::MultiplyAdd(v1.v, v2.v, v3.v) }; }
+inline Vector4A MultiplyAdd(Vector4A v1, Vector4A v2, Vector4A v3) { return { VectorSIMD::MultiplyAdd(v1.v, v2.v, v3.v) }; }
+
+inline Vector3A Min(Vector3A v1, Vector3A v2) { return { _mm_min_ps(v1.v, v2.v) }; }
+inline Vector3A Max(Vector3A v1, Vector3A v2) { return { _mm_max_ps(v1.v, v2.v) }; }
+inline Vector4A Min(Vector4A v1, Vector4A v2) { return { _mm_min_ps(v1.v, v2.v) }; }
+inline Vector4A Max(Vector4A v1, Vector4A v2) { return { _mm_max_ps(v1.v, v2.v) }; }
+
+/// <summary>
+/// 内積を全要素に入れたまま返す。続けてベクトルと掛けるときはこちらを使うとレジスタから出さずに済む
+/// </summary>
+inline __m128 DotSplat(Vector3A v1, Vector3A v2) { return VectorSIMD::HorizontalSum(_mm_mul_ps(v1.v, v2.v)); }
+inline __m128 DotSplat(Vector4A v1, Vector4A v2) { return VectorSIMD::HorizontalSum(_mm_mul_ps(v1.v, v2.v)); }
+
+inline float Dot(Vector3A v1, Vector3A v2) { return _mm_cvtss_f32(DotSplat(v1, v2)); }
+inline float Dot(Vector4A v1, Vector4A v2) { return _mm_cvtss_f32(DotSplat(v1, v2)); }
+
+inline Vector3A Cross(Vector3A v1, Vector3A v2) {
+	//(y, z, x)の並びを作って v1 * v2.yzx - v1.yzx * v2 を計算し、最後にyzxに戻す
+	__m128 v1yzx = _mm_shuffle_ps(v1.v, v1.v, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 v2yzx = _mm_shuffle_ps(v2.v, v2.v, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 cross = _mm_sub_ps(_mm_mul_ps(v1.v, v2yzx), _mm_mul_ps(v1yzx, v2.v));
+	return { _mm_shuffle_ps(cross, cross, _MM_SHUFFLE(3, 0, 2, 1)) };
+}
+
+inline float Length(Vector3A vector) {
+	return _mm_cvtss_f32(_mm_sqrt_ss(DotSplat(vector, vector)));
+}
+
+/// <summary>
+/// 正規化。長さ0のベクトルはそのまま(0, 0, 0)を返す
+/// </summary>
+inline Vector3A Normalize(Vector3A vector) {
+	__m128 lengthSq = DotSplat(vector, vector);
+	__m128 normalized = _mm_div_ps(vector.v, _mm_sqrt_ps(lengthSq));
+	//長さ0のときは0/0でNaNになるので0に置き換える
+	__m128 isNonZero = _mm_cmpneq_ps(lengthSq, _mm_setzero_ps());
+	return { _mm_and_ps(normalized, isNonZero) };
+}
+
+/// <summary>
+/// 点を行列でアフィン変換する(wの除算はしない)
+/// </summary>
+inline Vector3A TransformPoint(Vector3A vector, const Matrix4x4& matrix) {
+	__m128 x = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 result = VectorSIMD::MultiplyAdd(x, _mm_loadu_ps(matrix.m[0]), _mm_loadu_ps(matrix.m[3]));
+	result = VectorSIMD::MultiplyAdd(y, _mm_loadu_ps(matrix.m[1]), result);
+	result = VectorSIMD::MultiplyAdd(z, _mm_loadu_ps(matrix.m[2]), result);
+	return ToVector3A({ result });
+}
+
+/// <summary>
+/// 方向ベクトルを行列の3x3部分で変換する
+/// </summary>
+inline Vector3A TransformNormal(Vector3A vector, const Matrix4x4& matrix) {
+	__m128 x = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 result = _mm_mul_ps(x, _mm_loadu_ps(matrix.m[0]));
+	result = VectorSIMD::MultiplyAdd(y, _mm_loadu_ps(matrix.m[1]), result);
+	result = VectorSIMD::MultiplyAdd(z, _mm_loadu_ps(matrix.m[2]), result);
+	return ToVector3A({ result });
+}
+
+/// <summary>
+/// 4次元ベクトルを行列で変換する(v * M)
+/// </summary>
+inline Vector4A Transform(Vector4A vector, const Matrix4x4& matrix) {
+	__m128 x = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 y = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 z = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 w = _mm_shuffle_ps(vector.v, vector.v, _MM_SHUFFLE(3, 3, 3, 3));
+	__m128 result = _mm_mul_ps(x, _mm_loadu_ps(matrix.m[0]));
+	result = VectorSIMD::MultiplyAdd(y, _mm_loadu_ps(matrix.m[1]), result);
+	result = VectorSIMD::MultiplyAdd(z, _mm_loadu_ps(matrix.m[2]), result);
+	result = VectorSIMD::MultiplyAdd(w, _mm_loadu_ps(matrix.m[3]), result);
+	return { result };
+}
+#pragma endregion
@@ -0,0 +1,19 @@
+#pragma once
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include <cstddef>
+
+/// <summary>
+/// 頂点データ。InputLayoutとVertexShaderInputの並びと合わせること
+/// </summary>
+struct VertexData {
+	Vector4 position;
+	Vector2 texcoode;
+	Vector3 normal;
+};
+
+//InputLayoutのオフセットと合わせるため、Vector4A/Vector3Aではなく詰めた構造体のままにしておく
+static_assert(sizeof(VertexData) == 36);
+static_assert(offsetof(VertexData, texcoode) == 16);
+static_assert(offsetof(VertexData, normal) == 24);
@@ -0,0 +1,853 @@
+#include "VertexFormat.h"
+#include "CpuFeature.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+//unorm16, snorm16の最大値と逆数
+constexpr float kUnorm16Max = 65535.0f;
+constexpr float kSnorm16Max = 32767.0f;
+constexpr float kInverseUnorm16Max = 1.0f / 65535.0f;
+constexpr float kInverseSnorm16Max = 1.0f / 32767.0f;
+
+//halfとの変換に使うfloatのビット列
+constexpr uint32_t kHalfOverflow = (127 + 16) << 23;                         //これ以上はhalfで∞になる
+constexpr uint32_t kHalfMinNormal = (127 - 14) << 23;                        //これ未満はhalfでデノーマルになる
+constexpr uint32_t kHalfDenormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;  //足すと仮数部の下位にデノーマルの値が丸めて入る
+constexpr uint32_t kHalfNormalBias = 0xFFFu - ((127u - 15u) << 23);          //指数の差と、丸め用の0.5未満の値
+constexpr uint32_t kHalfToFloatMagic = (254 - 15) << 23;                     //2^112。halfの指数をfloatの指数に直す
+
+//VertexDataのfloat単位の大きさと各要素の位置
+constexpr size_t kVertexFloatCount = sizeof(VertexData) / sizeof(float);
+constexpr size_t kTexcoordOffset = offsetof(VertexData, texcoode) / sizeof(float);
+constexpr size_t kNormalOffset = offsetof(VertexData, normal) / sizeof(float);
+
+float BitsToFloat(uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+uint32_t FloatToBits(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+/// <summary>
+/// 量子化する側の値。割り算をしないように逆数にしておく
+/// </summary>
+struct Quantizer {
+	float offset[3];
+	float inverseScale[3];
+};
+
+Quantizer MakeQuantizer(const PositionQuantization& quantization) {
+	const float* offset = &quantization.offset.x;
+	const float* scale = &quantization.scale.x;
+	Quantizer quantizer{};
+	for (int axis = 0; axis < 3; axis++) {
+		quantizer.offset[axis] = offset[axis];
+		quantizer.inverseScale[axis] = scale[axis] > 0.0f ? kUnorm16Max / scale[axis] : 0.0f;
+	}
+	return quantizer;
+}
+
+#pragma region スカラー実装
+//SIMD版と同じ結果になるように、max/minは_mm_max_ps/_mm_min_psと同じ比較の向きで書く
+
+uint16_t QuantizeUnorm16(float value, float offset, float inverseScale) {
+	float t = (value - offset) * inverseScale;
+	t = t > 0.0f ? t : 0.0f;
+	t = t < kUnorm16Max ? t : kUnorm16Max;
+	return static_cast<uint16_t>(static_cast<int32_t>(t + 0.5f));
+}
+
+float DequantizeUnorm16(uint16_t value, float offset, float scale) {
+	return offset + scale * (static_cast<float>(value) * kInverseUnorm16Max);
+}
+
+//八面体上の点(u, v)を方向に戻す。正規化はしない
+void UnfoldOctahedral(float u, float v, float& x, float& y, float& z) {
+	z = 1.0f - std::fabs(u) - std::fabs(v);
+	float t = -z > 0.0f ? -z : 0.0f;
+	x = u + (u < 0.0f ? t : -t);
+	y = v + (v < 0.0f ? t : -t);
+}
+
+void EncodeVertexScalar(const VertexData& vertex, VertexDataCompact& result) {
+	result.position = { vertex.position.x, vertex.position.y, vertex.position.z };
+	result.texcoord[0] = FloatToHalf(vertex.texcoode.x);
+	result.texcoord[1] = FloatToHalf(vertex.texcoode.y);
+	EncodeOctahedral(vertex.normal, result.normal);
+}
+
+void EncodeVertexScalar(const VertexData& vertex, const Quantizer& quantizer, VertexDataQuantized& result) {
+	const float* position = &vertex.position.x;
+	for (int axis = 0; axis < 3; axis++) {
+		result.position[axis] = QuantizeUnorm16(position[axis], quantizer.offset[axis], quantizer.inverseScale[axis]);
+	}
+	result.position[3] = 0xFFFF;
+	result.texcoord[0] = FloatToHalf(vertex.texcoode.x);
+	result.texcoord[1] = FloatToHalf(vertex.texcoode.y);
+	EncodeOctahedral(vertex.normal, result.normal);
+}
+
+void DecodeVertexScalar(const VertexDataCompact& vertex, VertexData& result) {
+	result.position = { vertex.position.x, vertex.position.y, vertex.position.z, 1.0f };
+	result.texcoode = { HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]) };
+	result.normal = DecodeOctahedral(vertex.normal);
+}
+
+void DecodeVertexScalar(const VertexDataQuantized& vertex, const PositionQuantization& quantization, VertexData& result) {
+	result.position = {
+		DequantizeUnorm16(vertex.position[0], quantization.offset.x, quantization.scale.x),
+		DequantizeUnorm16(vertex.position[1], quantization.offset.y, quantization.scale.y),
+		DequantizeUnorm16(vertex.position[2], quantization.offset.z, quantization.scale.z),
+		1.0f };
+	result.texcoode = { HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]) };
+	result.normal = DecodeOctahedral(vertex.normal);
+}
+#pragma endregion
+
+#pragma region 16bitの並べ替え
+//SSE4版とAVX2版の両方から呼ぶ。呼び出し元の命令セットで展開されるように(AVX2版で古いSSEの命令が混ざらないように)inlineにしておく
+//8本のレジスタを16bitの8x8の行列とみなして転置する
+//頂点ごと(1頂点16byte)と要素ごと(8頂点分の同じ要素)の並びを入れ替える。SSE2だけで書ける
+inline void Transpose8x16(__m128i (&rows)[8]) {
+	__m128i a[8], b[8];
+	for (int i = 0; i < 4; i++) {
+		a[i] = _mm_unpacklo_epi16(rows[i * 2], rows[i * 2 + 1]);
+		a[i + 4] = _mm_unpackhi_epi16(rows[i * 2], rows[i * 2 + 1]);
+	}
+	for (int i = 0; i < 2; i++) {
+		b[i] = _mm_unpacklo_epi32(a[i * 2], a[i * 2 + 1]);
+		b[i + 2] = _mm_unpackhi_epi32(a[i * 2], a[i * 2 + 1]);
+		b[i + 4] = _mm_unpacklo_epi32(a[i * 2 + 4], a[i * 2 + 5]);
+		b[i + 6] = _mm_unpackhi_epi32(a[i * 2 + 4], a[i * 2 + 5]);
+	}
+	for (int i = 0; i < 4; i++) {
+		rows[i * 2] = _mm_unpacklo_epi64(b[i * 2], b[i * 2 + 1]);
+		rows[i * 2 + 1] = _mm_unpackhi_epi64(b[i * 2], b[i * 2 + 1]);
+	}
+}
+
+/// <summary>
+/// 8頂点分の要素ごとの16bit値
+/// </summary>
+struct EncodedLanes {
+	__m128i position[4];
+	__m128i texcoord[2];
+	__m128i normal[2];
+};
+
+inline void StoreVertices(const EncodedLanes& lanes, VertexDataQuantized* result) {
+	__m128i rows[8] = {
+		lanes.position[0], lanes.position[1], lanes.position[2], lanes.position[3],
+		lanes.texcoord[0], lanes.texcoord[1], lanes.normal[0], lanes.normal[1] };
+	Transpose8x16(rows);
+	for (int i = 0; i < 8; i++) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), rows[i]);
+	}
+}
+
+inline void StoreVertices(const EncodedLanes& lanes, const VertexData* vertices, VertexDataCompact* result) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i rows[8] = { lanes.texcoord[0], lanes.texcoord[1], lanes.normal[0], lanes.normal[1], zero, zero, zero, zero };
+	Transpose8x16(rows);
+	//位置はそのまま写し、UVと法線の8byteを続けて書く
+	for (int i = 0; i < 8; i++) {
+		std::memcpy(&result[i].position, &vertices[i].position, sizeof(Vector3));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(result[i].texcoord), rows[i]);
+	}
+}
+
+inline EncodedLanes LoadVertices(const VertexDataQuantized* vertices) {
+	__m128i rows[8];
+	for (int i = 0; i < 8; i++) {
+		rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vertices + i));
+	}
+	Transpose8x16(rows);
+	return { { rows[0], rows[1], rows[2], rows[3] }, { rows[4], rows[5] }, { rows[6], rows[7] } };
+}
+
+inline EncodedLanes LoadVertices(const VertexDataCompact* vertices) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i rows[8];
+	for (int i = 0; i < 8; i++) {
+		rows[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vertices[i].texcoord));
+	}
+	Transpose8x16(rows);
+	return { { zero, zero, zero, zero }, { rows[0], rows[1] }, { rows[2], rows[3] } };
+}
+
+//4頂点分のUV・法線(と位置)をVertexDataに書く
+inline void StoreVertices4(const __m128* texcoord, const __m128* normal, VertexData* result) {
+	__m128 row0 = texcoord[0], row1 = texcoord[1], row2 = normal[0], row3 = normal[1];
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	__m128 rows[4] = { row0, row1, row2, row3 };
+	alignas(16) float normalZ[4];
+	_mm_store_ps(normalZ, normal[2]);
+	for (int i = 0; i < 4; i++) {
+		float* base = reinterpret_cast<float*>(result + i);
+		_mm_storeu_ps(base + kTexcoordOffset, rows[i]);
+		base[kNormalOffset + 2] = normalZ[i];
+	}
+}
+
+inline void StorePositions4(const __m128* position, VertexData* result) {
+	__m128 row0 = position[0], row1 = position[1], row2 = position[2], row3 = _mm_set1_ps(1.0f);
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	_mm_storeu_ps(&result[0].position.x, row0);
+	_mm_storeu_ps(&result[1].position.x, row1);
+	_mm_storeu_ps(&result[2].position.x, row2);
+	_mm_storeu_ps(&result[3].position.x, row3);
+}
+#pragma endregion
+
+#pragma region SSE4実装
+/// <summary>
+/// 4頂点分の要素ごとのfloat
+/// </summary>
+struct VertexLanesSSE4 {
+	__m128 position[3];
+	__m128 texcoord[2];
+	__m128 normal[3];
+};
+
+SIMD_TARGET_SSE4 inline VertexLanesSSE4 LoadVerticesSSE4(const VertexData* vertices) {
+	const float* base = reinterpret_cast<const float*>(vertices);
+	//位置(xyzw)とUV + 法線xy(4つ)をそれぞれ4x4で転置する
+	__m128 p0 = _mm_loadu_ps(base);
+	__m128 p1 = _mm_loadu_ps(base + kVertexFloatCount);
+	__m128 p2 = _mm_loadu_ps(base + kVertexFloatCount * 2);
+	__m128 p3 = _mm_loadu_ps(base + kVertexFloatCount * 3);
+	_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+	__m128 a0 = _mm_loadu_ps(base + kTexcoordOffset);
+	__m128 a1 = _mm_loadu_ps(base + kVertexFloatCount + kTexcoordOffset);
+	__m128 a2 = _mm_loadu_ps(base + kVertexFloatCount * 2 + kTexcoordOffset);
+	__m128 a3 = _mm_loadu_ps(base + kVertexFloatCount * 3 + kTexcoordOffset);
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+	__m128 normalZ = _mm_setr_ps(vertices[0].normal.z, vertices[1].normal.z, vertices[2].normal.z, vertices[3].normal.z);
+	return { { p0, p1, p2 }, { a0, a1 }, { a2, a3, normalZ } };
+}
+
+SIMD_TARGET_SSE4 __m128i QuantizeUnorm16SSE4(__m128 value, float offset, float inverseScale) {
+	__m128 t = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(offset)), _mm_set1_ps(inverseScale));
+	t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(kUnorm16Max));
+	return _mm_cvttps_epi32(_mm_add_ps(t, _mm_set1_ps(0.5f)));
+}
+
+SIMD_TARGET_SSE4 __m128 DequantizeUnorm16SSE4(__m128i value, float offset, float scale) {
+	__m128 t = _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(kInverseUnorm16Max));
+	return _mm_add_ps(_mm_set1_ps(offset), _mm_mul_ps(_mm_set1_ps(scale), t));
+}
+
+//FloatToHalfと同じ計算を4つずつ行う。結果は32bitごとに入る
+SIMD_TARGET_SSE4 __m128i FloatToHalfSSE4(__m128 value) {
+	__m128i bits = _mm_castps_si128(value);
+	__m128i sign = _mm_and_si128(bits, _mm_set1_epi32(int(0x80000000u)));
+	bits = _mm_xor_si128(bits, sign);
+
+	__m128 absolute = _mm_castsi128_ps(bits);
+	__m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+	__m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32(int(kHalfOverflow)), bits);
+	__m128i isDenormal = _mm_cmpgt_epi32(_mm_set1_epi32(int(kHalfMinNormal)), bits);
+	__m128i infinity = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+	__m128 magic = _mm_castsi128_ps(_mm_set1_epi32(int(kHalfDenormalMagic)));
+	__m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, magic)), _mm_castps_si128(magic));
+
+	__m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+	__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(int(kHalfNormalBias))), odd), 13);
+
+	__m128i finite = _mm_blendv_epi8(normal, denormal, isDenormal);
+	__m128i half = _mm_blendv_epi8(infinity, finite, isRegular);
+	return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+}
+
+//HalfToFloatと同じ計算を4つずつ行う。halfは32bitごとに入れておく
+SIMD_TARGET_SSE4 __m128 HalfToFloatSSE4(__m128i half) {
+	__m128i exponentMantissa = _mm_and_si128(half, _mm_set1_epi32(0x7FFF));
+	__m128i sign = _mm_slli_epi32(_mm_xor_si128(half, exponentMantissa), 16);
+	__m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponentMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32(int(kHalfToFloatMagic))));
+	__m128i isInfinity = _mm_cmpgt_epi32(exponentMantissa, _mm_set1_epi32(0x7BFF));
+	__m128i exponent = _mm_and_si128(isInfinity, _mm_set1_epi32(255 << 23));
+	return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, exponent)));
+}
+
+SIMD_TARGET_SSE4 void UnfoldOctahedralSSE4(__m128 u, __m128 v, __m128& x, __m128& y, __m128& z) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_andnot_ps(signMask, u)), _mm_andnot_ps(signMask, v));
+	__m128 t = _mm_max_ps(_mm_xor_ps(z, signMask), zero);
+	__m128 negative = _mm_xor_ps(t, signMask);
+	x = _mm_add_ps(u, _mm_blendv_ps(negative, t, _mm_cmplt_ps(u, zero)));
+	y = _mm_add_ps(v, _mm_blendv_ps(negative, t, _mm_cmplt_ps(v, zero)));
+}
+
+//EncodeOctahedralと同じ計算を4つずつ行う
+SIMD_TARGET_SSE4 void EncodeOctahedralSSE4(const __m128* normal, __m128i& encodedU, __m128i& encodedV) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minimum = _mm_set1_ps(FLT_MIN);
+	__m128 length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normal[0], normal[0]), _mm_mul_ps(normal[1], normal[1])), _mm_mul_ps(normal[2], normal[2]));
+	length = _mm_max_ps(_mm_sqrt_ps(length), minimum);
+	__m128 unit[3] = { _mm_div_ps(normal[0], length), _mm_div_ps(normal[1], length), _mm_div_ps(normal[2], length) };
+
+	__m128 absoluteX = _mm_andnot_ps(signMask, unit[0]);
+	__m128 absoluteY = _mm_andnot_ps(signMask, unit[1]);
+	__m128 absoluteZ = _mm_andnot_ps(signMask, unit[2]);
+	__m128 sum = _mm_max_ps(_mm_add_ps(_mm_add_ps(absoluteX, absoluteY), absoluteZ), minimum);
+	__m128 u = _mm_div_ps(unit[0], sum);
+	__m128 v = _mm_div_ps(unit[1], sum);
+
+	//下半分は外側に折り返す
+	__m128 signU = _mm_blendv_ps(one, _mm_set1_ps(-1.0f), _mm_cmplt_ps(u, zero));
+	__m128 signV = _mm_blendv_ps(one, _mm_set1_ps(-1.0f), _mm_cmplt_ps(v, zero));
+	__m128 foldU = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, v)), signU);
+	__m128 foldV = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, u)), signV);
+	__m128 isLower = _mm_cmplt_ps(unit[2], zero);
+	u = _mm_blendv_ps(u, foldU, isLower);
+	v = _mm_blendv_ps(v, foldV, isLower);
+
+	const __m128 lowest = _mm_set1_ps(-kSnorm16Max);
+	const __m128 highest = _mm_set1_ps(kSnorm16Max - 1.0f);
+	__m128 baseU = _mm_min_ps(_mm_max_ps(_mm_floor_ps(_mm_mul_ps(u, _mm_set1_ps(kSnorm16Max))), lowest), highest);
+	__m128 baseV = _mm_min_ps(_mm_max_ps(_mm_floor_ps(_mm_mul_ps(v, _mm_set1_ps(kSnorm16Max))), lowest), highest);
+
+	__m128 bestU = baseU, bestV = baseV, bestError = zero;
+	for (int candidate = 0; candidate < 4; candidate++) {
+		__m128 codeU = _mm_add_ps(baseU, _mm_set1_ps(float(candidate & 1)));
+		__m128 codeV = _mm_add_ps(baseV, _mm_set1_ps(float(candidate >> 1)));
+		__m128 x, y, z;
+		UnfoldOctahedralSSE4(_mm_mul_ps(codeU, _mm_set1_ps(kInverseSnorm16Max)), _mm_mul_ps(codeV, _mm_set1_ps(kInverseSnorm16Max)), x, y, z);
+		__m128 decodedLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+		__m128 dx = _mm_sub_ps(_mm_div_ps(x, decodedLength), unit[0]);
+		__m128 dy = _mm_sub_ps(_mm_div_ps(y, decodedLength), unit[1]);
+		__m128 dz = _mm_sub_ps(_mm_div_ps(z, decodedLength), unit[2]);
+		__m128 error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 isBetter = candidate == 0 ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_cmplt_ps(error, bestError);
+		bestU = _mm_blendv_ps(bestU, codeU, isBetter);
+		bestV = _mm_blendv_ps(bestV, codeV, isBetter);
+		bestError = _mm_blendv_ps(bestError, error, isBetter);
+	}
+	encodedU = _mm_cvttps_epi32(bestU);
+	encodedV = _mm_cvttps_epi32(bestV);
+}
+
+//DecodeOctahedralと同じ計算を4つずつ行う。符号付きの値を32bitごとに入れておく
+SIMD_TARGET_SSE4 void DecodeOctahedralSSE4(__m128i encodedU, __m128i encodedV, __m128* normal) {
+	const __m128 lowest = _mm_set1_ps(-1.0f);
+	__m128 u = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(encodedU), _mm_set1_ps(kInverseSnorm16Max)), lowest);
+	__m128 v = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(encodedV), _mm_set1_ps(kInverseSnorm16Max)), lowest);
+	__m128 x, y, z;
+	UnfoldOctahedralSSE4(u, v, x, y, z);
+	__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	normal[0] = _mm_div_ps(x, length);
+	normal[1] = _mm_div_ps(y, length);
+	normal[2] = _mm_div_ps(z, length);
+}
+
+//8頂点を4頂点ずつ計算し、16bitに詰めて要素ごとに並べる
+SIMD_TARGET_SSE4 EncodedLanes EncodeLanesSSE4(const VertexData* vertices, const Quantizer* quantizer) {
+	__m128i position[3][2] = {}, texcoord[2][2], normal[2][2];
+	for (int half = 0; half < 2; half++) {
+		VertexLanesSSE4 lanes = LoadVerticesSSE4(vertices + half * 4);
+		if (quantizer != nullptr) {
+			for (int axis = 0; axis < 3; axis++) {
+				position[axis][half] = QuantizeUnorm16SSE4(lanes.position[axis], quantizer->offset[axis], quantizer->inverseScale[axis]);
+			}
+		}
+		texcoord[0][half] = FloatToHalfSSE4(lanes.texcoord[0]);
+		texcoord[1][half] = FloatToHalfSSE4(lanes.texcoord[1]);
+		EncodeOctahedralSSE4(lanes.normal, normal[0][half], normal[1][half]);
+	}
+	EncodedLanes result;
+	for (int axis = 0; axis < 3; axis++) {
+		result.position[axis] = _mm_packus_epi32(position[axis][0], position[axis][1]);
+	}
+	result.position[3] = _mm_set1_epi16(-1);
+	for (int i = 0; i < 2; i++) {
+		result.texcoord[i] = _mm_packus_epi32(texcoord[i][0], texcoord[i][1]);
+		result.normal[i] = _mm_packs_epi32(normal[i][0], normal[i][1]);
+	}
+	return result;
+}
+
+SIMD_TARGET_SSE4 void EncodeSSE4(const VertexData* vertices, VertexDataCompact* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		StoreVertices(EncodeLanesSSE4(vertices + i, nullptr), vertices + i, result + i);
+	}
+	for (; i < count; i++) {
+		EncodeVertexScalar(vertices[i], result[i]);
+	}
+}
+
+SIMD_TARGET_SSE4 void EncodeSSE4(const VertexData* vertices, const Quantizer& quantizer, VertexDataQuantized* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		StoreVertices(EncodeLanesSSE4(vertices + i, &quantizer), result + i);
+	}
+	for (; i < count; i++) {
+		EncodeVertexScalar(vertices[i], quantizer, result[i]);
+	}
+}
+
+//4頂点分の16bit値(下位64bit)を戻す。quantizationがnullptrなら位置は書かない
+SIMD_TARGET_SSE4 void DecodeLanesSSE4(__m128i const (&values)[8], const PositionQuantization* quantization, VertexData* result) {
+	if (quantization != nullptr) {
+		const float* offset = &quantization->offset.x;
+		const float* scale = &quantization->scale.x;
+		__m128 position[3];
+		for (int axis = 0; axis < 3; axis++) {
+			position[axis] = DequantizeUnorm16SSE4(_mm_cvtepu16_epi32(values[axis]), offset[axis], scale[axis]);
+		}
+		StorePositions4(position, result);
+	}
+	__m128 texcoord[2] = { HalfToFloatSSE4(_mm_cvtepu16_epi32(values[4])), HalfToFloatSSE4(_mm_cvtepu16_epi32(values[5])) };
+	__m128 normal[3];
+	DecodeOctahedralSSE4(_mm_cvtepi16_epi32(values[6]), _mm_cvtepi16_epi32(values[7]), normal);
+	StoreVertices4(texcoord, normal, result);
+}
+
+//8頂点を前半と後半の4頂点ずつ戻す
+SIMD_TARGET_SSE4 void DecodeLanesSSE4(const EncodedLanes& lanes, const PositionQuantization* quantization, VertexData* result) {
+	__m128i lower[8] = {
+		lanes.position[0], lanes.position[1], lanes.position[2], lanes.position[3],
+		lanes.texcoord[0], lanes.texcoord[1], lanes.normal[0], lanes.normal[1] };
+	__m128i upper[8];
+	for (int i = 0; i < 8; i++) {
+		upper[i] = _mm_srli_si128(lower[i], 8);
+	}
+	DecodeLanesSSE4(lower, quantization, result);
+	DecodeLanesSSE4(upper, quantization, result + 4);
+}
+
+SIMD_TARGET_SSE4 void DecodeSSE4(const VertexDataCompact* vertices, VertexData* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		DecodeLanesSSE4(LoadVertices(vertices + i), nullptr, result + i);
+		for (size_t j = i; j < i + 8; j++) {
+			result[j].position = { vertices[j].position.x, vertices[j].position.y, vertices[j].position.z, 1.0f };
+		}
+	}
+	for (; i < count; i++) {
+		DecodeVertexScalar(vertices[i], result[i]);
+	}
+}
+
+SIMD_TARGET_SSE4 void DecodeSSE4(const VertexDataQuantized* vertices, const PositionQuantization& quantization, VertexData* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		DecodeLanesSSE4(LoadVertices(vertices + i), &quantization, result + i);
+	}
+	for (; i < count; i++) {
+		DecodeVertexScalar(vertices[i], quantization, result[i]);
+	}
+}
+#pragma endregion
+
+#pragma region AVX2実装
+//SSE4版と同じ計算を8つずつ行う。halfの変換はF16Cの命令を使う
+
+/// <summary>
+/// 8頂点分の要素ごとのfloat
+/// </summary>
+struct VertexLanesAVX2 {
+	__m256 position[3];
+	__m256 texcoord[2];
+	__m256 normal[3];
+};
+
+SIMD_TARGET_AVX2 VertexLanesAVX2 LoadVerticesAVX2(const VertexData* vertices) {
+	VertexLanesSSE4 lower = LoadVerticesSSE4(vertices);
+	VertexLanesSSE4 upper = LoadVerticesSSE4(vertices + 4);
+	VertexLanesAVX2 lanes;
+	for (int i = 0; i < 3; i++) {
+		lanes.position[i] = _mm256_set_m128(upper.position[i], lower.position[i]);
+		lanes.normal[i] = _mm256_set_m128(upper.normal[i], lower.normal[i]);
+	}
+	for (int i = 0; i < 2; i++) {
+		lanes.texcoord[i] = _mm256_set_m128(upper.texcoord[i], lower.texcoord[i]);
+	}
+	return lanes;
+}
+
+//32bitごとの8つの値を16bitに詰める
+SIMD_TARGET_AVX2 __m128i PackUnsigned16AVX2(__m256i value) {
+	return _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+}
+
+SIMD_TARGET_AVX2 __m128i PackSigned16AVX2(__m256i value) {
+	return _mm_packs_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+}
+
+SIMD_TARGET_AVX2 __m128i QuantizeUnorm16AVX2(__m256 value, float offset, float inverseScale) {
+	__m256 t = _mm256_mul_ps(_mm256_sub_ps(value, _mm256_set1_ps(offset)), _mm256_set1_ps(inverseScale));
+	t = _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(kUnorm16Max));
+	return PackUnsigned16AVX2(_mm256_cvttps_epi32(_mm256_add_ps(t, _mm256_set1_ps(0.5f))));
+}
+
+SIMD_TARGET_AVX2 __m256 DequantizeUnorm16AVX2(__m128i value, float offset, float scale) {
+	__m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(value)), _mm256_set1_ps(kInverseUnorm16Max));
+	return _mm256_add_ps(_mm256_set1_ps(offset), _mm256_mul_ps(_mm256_set1_ps(scale), t));
+}
+
+SIMD_TARGET_AVX2 void UnfoldOctahedralAVX2(__m256 u, __m256 v, __m256& x, __m256& y, __m256& z) {
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 zero = _mm256_setzero_ps();
+	z = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_andnot_ps(signMask, u)), _mm256_andnot_ps(signMask, v));
+	__m256 t = _mm256_max_ps(_mm256_xor_ps(z, signMask), zero);
+	__m256 negative = _mm256_xor_ps(t, signMask);
+	x = _mm256_add_ps(u, _mm256_blendv_ps(negative, t, _mm256_cmp_ps(u, zero, _CMP_LT_OQ)));
+	y = _mm256_add_ps(v, _mm256_blendv_ps(negative, t, _mm256_cmp_ps(v, zero, _CMP_LT_OQ)));
+}
+
+SIMD_TARGET_AVX2 void EncodeOctahedralAVX2(const __m256* normal, __m128i& encodedU, __m128i& encodedV) {
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minimum = _mm256_set1_ps(FLT_MIN);
+	__m256 length = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normal[0], normal[0]), _mm256_mul_ps(normal[1], normal[1])), _mm256_mul_ps(normal[2], normal[2]));
+	length = _mm256_max_ps(_mm256_sqrt_ps(length), minimum);
+	__m256 unit[3] = { _mm256_div_ps(normal[0], length), _mm256_div_ps(normal[1], length), _mm256_div_ps(normal[2], length) };
+
+	__m256 absoluteX = _mm256_andnot_ps(signMask, unit[0]);
+	__m256 absoluteY = _mm256_andnot_ps(signMask, unit[1]);
+	__m256 absoluteZ = _mm256_andnot_ps(signMask, unit[2]);
+	__m256 sum = _mm256_max_ps(_mm256_add_ps(_mm256_add_ps(absoluteX, absoluteY), absoluteZ), minimum);
+	__m256 u = _mm256_div_ps(unit[0], sum);
+	__m256 v = _mm256_div_ps(unit[1], sum);
+
+	//下半分は外側に折り返す
+	__m256 signU = _mm256_blendv_ps(one, _mm256_set1_ps(-1.0f), _mm256_cmp_ps(u, zero, _CMP_LT_OQ));
+	__m256 signV = _mm256_blendv_ps(one, _mm256_set1_ps(-1.0f), _mm256_cmp_ps(v, zero, _CMP_LT_OQ));
+	__m256 foldU = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, v)), signU);
+	__m256 foldV = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, u)), signV);
+	__m256 isLower = _mm256_cmp_ps(unit[2], zero, _CMP_LT_OQ);
+	u = _mm256_blendv_ps(u, foldU, isLower);
+	v = _mm256_blendv_ps(v, foldV, isLower);
+
+	const __m256 lowest = _mm256_set1_ps(-kSnorm16Max);
+	const __m256 highest = _mm256_set1_ps(kSnorm16Max - 1.0f);
+	__m256 baseU = _mm256_min_ps(_mm256_max_ps(_mm256_floor_ps(_mm256_mul_ps(u, _mm256_set1_ps(kSnorm16Max))), lowest), highest);
+	__m256 baseV = _mm256_min_ps(_mm256_max_ps(_mm256_floor_ps(_mm256_mul_ps(v, _mm256_set1_ps(kSnorm16Max))), lowest), highest);
+
+	__m256 bestU = baseU, bestV = baseV, bestError = zero;
+	for (int candidate = 0; candidate < 4; candidate++) {
+		__m256 codeU = _mm256_add_ps(baseU, _mm256_set1_ps(float(candidate & 1)));
+		__m256 codeV = _mm256_add_ps(baseV, _mm256_set1_ps(float(candidate >> 1)));
+		__m256 x, y, z;
+		UnfoldOctahedralAVX2(_mm256_mul_ps(codeU, _mm256_set1_ps(kInverseSnorm16Max)), _mm256_mul_ps(codeV, _mm256_set1_ps(kInverseSnorm16Max)), x, y, z);
+		__m256 decodedLength = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+		__m256 dx = _mm256_sub_ps(_mm256_div_ps(x, decodedLength), unit[0]);
+		__m256 dy = _mm256_sub_ps(_mm256_div_ps(y, decodedLength), unit[1]);
+		__m256 dz = _mm256_sub_ps(_mm256_div_ps(z, decodedLength), unit[2]);
+		__m256 error = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		__m256 isBetter = candidate == 0 ? _mm256_castsi256_ps(_mm256_set1_epi32(-1)) : _mm256_cmp_ps(error, bestError, _CMP_LT_OQ);
+		bestU = _mm256_blendv_ps(bestU, codeU, isBetter);
+		bestV = _mm256_blendv_ps(bestV, codeV, isBetter);
+		bestError = _mm256_blendv_ps(bestError, error, isBetter);
+	}
+	encodedU = PackSigned16AVX2(_mm256_cvttps_epi32(bestU));
+	encodedV = PackSigned16AVX2(_mm256_cvttps_epi32(bestV));
+}
+
+SIMD_TARGET_AVX2 void DecodeOctahedralAVX2(__m128i encodedU, __m128i encodedV, __m256* normal) {
+	const __m256 lowest = _mm256_set1_ps(-1.0f);
+	__m256 u = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(encodedU)), _mm256_set1_ps(kInverseSnorm16Max)), lowest);
+	__m256 v = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(encodedV)), _mm256_set1_ps(kInverseSnorm16Max)), lowest);
+	__m256 x, y, z;
+	UnfoldOctahedralAVX2(u, v, x, y, z);
+	__m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+	normal[0] = _mm256_div_ps(x, length);
+	normal[1] = _mm256_div_ps(y, length);
+	normal[2] = _mm256_div_ps(z, length);
+}
+
+SIMD_TARGET_AVX2 EncodedLanes EncodeLanesAVX2(const VertexData* vertices, const Quantizer* quantizer) {
+	VertexLanesAVX2 lanes = LoadVerticesAVX2(vertices);
+	EncodedLanes result{};
+	if (quantizer != nullptr) {
+		for (int axis = 0; axis < 3; axis++) {
+			result.position[axis] = QuantizeUnorm16AVX2(lanes.position[axis], quantizer->offset[axis], quantizer->inverseScale[axis]);
+		}
+	}
+	result.position[3] = _mm_set1_epi16(-1);
+	result.texcoord[0] = _mm256_cvtps_ph(lanes.texcoord[0], _MM_FROUND_TO_NEAREST_INT);
+	result.texcoord[1] = _mm256_cvtps_ph(lanes.texcoord[1], _MM_FROUND_TO_NEAREST_INT);
+	EncodeOctahedralAVX2(lanes.normal, result.normal[0], result.normal[1]);
+	return result;
+}
+
+SIMD_TARGET_AVX2 void EncodeAVX2(const VertexData* vertices, VertexDataCompact* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		StoreVertices(EncodeLanesAVX2(vertices + i, nullptr), vertices + i, result + i);
+	}
+	for (; i < count; i++) {
+		EncodeVertexScalar(vertices[i], result[i]);
+	}
+}
+
+SIMD_TARGET_AVX2 void EncodeAVX2(const VertexData* vertices, const Quantizer& quantizer, VertexDataQuantized* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		StoreVertices(EncodeLanesAVX2(vertices + i, &quantizer), result + i);
+	}
+	for (; i < count; i++) {
+		EncodeVertexScalar(vertices[i], quantizer, result[i]);
+	}
+}
+
+SIMD_TARGET_AVX2 void DecodeLanesAVX2(const EncodedLanes& lanes, const PositionQuantization* quantization, VertexData* result) {
+	__m256 position[3] = {};
+	if (quantization != nullptr) {
+		const float* offset = &quantization->offset.x;
+		const float* scale = &quantization->scale.x;
+		for (int axis = 0; axis < 3; axis++) {
+			position[axis] = DequantizeUnorm16AVX2(lanes.position[axis], offset[axis], scale[axis]);
+		}
+	}
+	__m256 texcoord[2] = { _mm256_cvtph_ps(lanes.texcoord[0]), _mm256_cvtph_ps(lanes.texcoord[1]) };
+	__m256 normal[3];
+	DecodeOctahedralAVX2(lanes.normal[0], lanes.normal[1], normal);
+
+	//書き込みは4頂点ずつ行う
+	for (int half = 0; half < 2; half++) {
+		__m128 halfTexcoord[2], halfNormal[3], halfPosition[3];
+		for (int i = 0; i < 3; i++) {
+			halfPosition[i] = half == 0 ? _mm256_castps256_ps128(position[i]) : _mm256_extractf128_ps(position[i], 1);
+			halfNormal[i] = half == 0 ? _mm256_castps256_ps128(normal[i]) : _mm256_extractf128_ps(normal[i], 1);
+		}
+		for (int i = 0; i < 2; i++) {
+			halfTexcoord[i] = half == 0 ? _mm256_castps256_ps128(texcoord[i]) : _mm256_extractf128_ps(texcoord[i], 1);
+		}
+		if (quantization != nullptr) {
+			StorePositions4(halfPosition, result + half * 4);
+		}
+		StoreVertices4(halfTexcoord, halfNormal, result + half * 4);
+	}
+}
+
+SIMD_TARGET_AVX2 void DecodeAVX2(const VertexDataCompact* vertices, VertexData* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		DecodeLanesAVX2(LoadVertices(vertices + i), nullptr, result + i);
+		for (size_t j = i; j < i + 8; j++) {
+			result[j].position = { vertices[j].position.x, vertices[j].position.y, vertices[j].position.z, 1.0f };
+		}
+	}
+	for (; i < count; i++) {
+		DecodeVertexScalar(vertices[i], result[i]);
+	}
+}
+
+SIMD_TARGET_AVX2 void DecodeAVX2(const VertexDataQuantized* vertices, const PositionQuantization& quantization, VertexData* result, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		DecodeLanesAVX2(LoadVertices(vertices + i), &quantization, result + i);
+	}
+	for (; i < count; i++) {
+		DecodeVertexScalar(vertices[i], quantization, result[i]);
+	}
+}
+#pragma endregion
+
+}
+
+size_t GetVertexStride(VertexFormat format) {
+	switch (format) {
+	case VertexFormat::Compact:
+		return sizeof(VertexDataCompact);
+	case VertexFormat::Quantized:
+		return sizeof(VertexDataQuantized);
+	default:
+		return sizeof(VertexData);
+	}
+}
+
+uint16_t FloatToHalf(float value) {
+	uint32_t bits = FloatToBits(value);
+	uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+	uint32_t half = 0;
+	if (bits >= kHalfOverflow) {
+		//∞とNaN。NaNは仮数の最上位ビットを立てる
+		half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	} else if (bits < kHalfMinNormal) {
+		//デノーマル。floatの足し算の丸めで最近接偶数に丸める
+		half = FloatToBits(BitsToFloat(bits) + BitsToFloat(kHalfDenormalMagic)) - kHalfDenormalMagic;
+	} else {
+		//切り捨てる13bitに0.5未満を足し、残す部分が奇数ならさらに1を足すと最近接偶数丸めになる
+		uint32_t odd = (bits >> 13) & 1;
+		half = (bits + kHalfNormalBias + odd) >> 13;
+	}
+	return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float HalfToFloat(uint16_t half) {
+	uint32_t exponentMantissa = half & 0x7FFFu;
+	uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+	//指数と仮数をfloatの位置にずらし、指数の差(2^112)を掛ける。デノーマルもそのまま正しい値になる
+	uint32_t bits = FloatToBits(BitsToFloat(exponentMantissa << 13) * BitsToFloat(kHalfToFloatMagic));
+	if (exponentMantissa > 0x7BFFu) {
+		bits |= 255u << 23;
+	}
+	return BitsToFloat(bits | sign);
+}
+
+void EncodeOctahedral(const Vector3& normal, int16_t encoded[2]) {
+	//候補を比べるために正規化しておく
+	float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	length = length > FLT_MIN ? length : FLT_MIN;
+	Vector3 unit = { normal.x / length, normal.y / length, normal.z / length };
+
+	float sum = std::fabs(unit.x) + std::fabs(unit.y) + std::fabs(unit.z);
+	sum = sum > FLT_MIN ? sum : FLT_MIN;
+	float u = unit.x / sum;
+	float v = unit.y / sum;
+	//下半分(z < 0)は外側に折り返す
+	if (unit.z < 0.0f) {
+		float foldU = (1.0f - std::fabs(v)) * (u < 0.0f ? -1.0f : 1.0f);
+		float foldV = (1.0f - std::fabs(u)) * (v < 0.0f ? -1.0f : 1.0f);
+		u = foldU;
+		v = foldV;
+	}
+
+	//切り捨てと切り上げの4通りから、戻したときに一番近くなるものを選ぶ
+	//内積は1に近いとfloatで差がつかないので、差の長さの2乗で比べる
+	auto clampCode = [](float code) {
+		code = code > -kSnorm16Max ? code : -kSnorm16Max;
+		return code < kSnorm16Max - 1.0f ? code : kSnorm16Max - 1.0f;
+	};
+	float baseU = clampCode(std::floor(u * kSnorm16Max));
+	float baseV = clampCode(std::floor(v * kSnorm16Max));
+	float bestU = baseU, bestV = baseV, bestError = 0.0f;
+	for (int candidate = 0; candidate < 4; candidate++) {
+		float codeU = baseU + float(candidate & 1);
+		float codeV = baseV + float(candidate >> 1);
+		float x, y, z;
+		UnfoldOctahedral(codeU * kInverseSnorm16Max, codeV * kInverseSnorm16Max, x, y, z);
+		float decodedLength = std::sqrt(x * x + y * y + z * z);
+		float dx = x / decodedLength - unit.x;
+		float dy = y / decodedLength - unit.y;
+		float dz = z / decodedLength - unit.z;
+		float error = dx * dx + dy * dy + dz * dz;
+		if (candidate == 0 || error < bestError) {
+			bestU = codeU;
+			bestV = codeV;
+			bestError = error;
+		}
+	}
+	encoded[0] = static_cast<int16_t>(bestU);
+	encoded[1] = static_cast<int16_t>(bestV);
+}
+
+Vector3 DecodeOctahedral(const int16_t encoded[2]) {
+	//snorm16の-32768は-32767と同じ-1になる
+	float u = static_cast<float>(encoded[0]) * kInverseSnorm16Max;
+	float v = static_cast<float>(encoded[1]) * kInverseSnorm16Max;
+	u = u > -1.0f ? u : -1.0f;
+	v = v > -1.0f ? v : -1.0f;
+	float x, y, z;
+	UnfoldOctahedral(u, v, x, y, z);
+	float length = std::sqrt(x * x + y * y + z * z);
+	return { x / length, y / length, z / length };
+}
+
+PositionQuantization MakePositionQuantization(const AABB& aabb) {
+	return { aabb.min, aabb.max - aabb.min };
+}
+
+PositionQuantization MakePositionQuantization(std::span<const VertexData> vertices) {
+	return MakePositionQuantization(ComputeAABB(vertices));
+}
+
+Matrix4x4 MakeDequantizationMatrix(const PositionQuantization& quantization) {
+	Matrix4x4 result = MakeIdentity4x4();
+	result.m[0][0] = quantization.scale.x;
+	result.m[1][1] = quantization.scale.y;
+	result.m[2][2] = quantization.scale.z;
+	result.m[3][0] = quantization.offset.x;
+	result.m[3][1] = quantization.offset.y;
+	result.m[3][2] = quantization.offset.z;
+	return result;
+}
+
+void EncodeVertices(std::span<const VertexData> vertices, std::span<VertexDataCompact> result) {
+	assert(result.size() >= vertices.size());
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		EncodeAVX2(vertices.data(), result.data(), vertices.size());
+		break;
+	case SimdLevel::SSE4:
+		EncodeSSE4(vertices.data(), result.data(), vertices.size());
+		break;
+	default:
+		for (size_t i = 0; i < vertices.size(); i++) {
+			EncodeVertexScalar(vertices[i], result[i]);
+		}
+		break;
+	}
+}
+
+void EncodeVertices(std::span<const VertexData> vertices, const PositionQuantization& quantization, std::span<VertexDataQuantized> result) {
+	assert(result.size() >= vertices.size());
+	Quantizer quantizer = MakeQuantizer(quantization);
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		EncodeAVX2(vertices.data(), quantizer, result.data(), vertices.size());
+		break;
+	case SimdLevel::SSE4:
+		EncodeSSE4(vertices.data(), quantizer, result.data(), vertices.size());
+		break;
+	default:
+		for (size_t i = 0; i < vertices.size(); i++) {
+			EncodeVertexScalar(vertices[i], quantizer, result[i]);
+		}
+		break;
+	}
+}
+
+void DecodeVertices(std::span<const VertexDataCompact> vertices, std::span<VertexData> result) {
+	assert(result.size() >= vertices.size());
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		DecodeAVX2(vertices.data(), result.data(), vertices.size());
+		break;
+	case SimdLevel::SSE4:
+		DecodeSSE4(vertices.data(), result.data(), vertices.size());
+		break;
+	default:
+		for (size_t i = 0; i < vertices.size(); i++) {
+			DecodeVertexScalar(vertices[i], result[i]);
+		}
+		break;
+	}
+}
+
+void DecodeVertices(std::span<const VertexDataQuantized> vertices, const PositionQuantization& quantization, std::span<VertexData> result) {
+	assert(result.size() >= vertices.size());
+	switch (GetSimdLevel()) {
+	case SimdLevel::AVX2:
+		DecodeAVX2(vertices.data(), quantization, result.data(), vertices.size());
+		break;
+	case SimdLevel::SSE4:
+		DecodeSSE4(vertices.data(), quantization, result.data(), vertices.size());
+		break;
+	default:
+		for (size_t i = 0; i < vertices.size(); i++) {
+			DecodeVertexScalar(vertices[i], quantization, result[i]);
+		}
+		break;
+	}
+}
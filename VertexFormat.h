@@ -0,0 +1,158 @@
+#pragma once
+#include "VertexData.h"
+#include "Bounds.h"
+#include "Matrix4x4.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//VertexDataを詰めた頂点形式と、その変換(エンコード・デコード)
+//どの形式も位置・UV・法線の並びはVertexDataと同じで、InputLayoutはVertexLayout.hのGetInputLayoutDescで作る
+//
+//  Standard  : VertexData。36byte
+//  Compact   : 位置float3 + UV half2 + 法線(八面体)snorm16x2。20byte
+//  Quantized : 位置unorm16x4 + UV half2 + 法線(八面体)snorm16x2。16byte
+//              位置はメッシュごとのPositionQuantizationで[0, 1]に詰め、戻す行列をWVPに掛けてGPUで戻す
+//
+//最大誤差(Benchmarkの--accuracyで確認できる)
+//  位置(Quantized) : 各軸 scale / 131070 (量子化の半分の幅) + floatの丸め
+//  UV              : 相対 2^-11 (halfの丸め)。[-65504, 65504]を超えると∞になる
+//  法線            : 0.003度。切り捨てと切り上げの4つの候補から最も近くなるものを選んでいる
+//
+//SSE4では4頂点ずつ、AVX2(F16C)では8頂点ずつ変換する
+//掛け算と足し算をFMAにまとめないコンパイラ設定(MSVCの既定)なら、どの命令セットでも結果はスカラー版と同じになる
+
+/// <summary>
+/// 頂点形式の種類
+/// </summary>
+enum class VertexFormat {
+	Standard,  //VertexData
+	Compact,   //VertexDataCompact
+	Quantized, //VertexDataQuantized
+};
+
+/// <summary>
+/// 位置だけfloatのまま、UVと法線を16bitにした頂点
+/// </summary>
+struct VertexDataCompact {
+	Vector3 position;
+	uint16_t texcoord[2]; //half
+	int16_t normal[2];    //八面体に展開した法線(snorm16)
+};
+
+/// <summary>
+/// 位置も16bitに量子化した頂点。位置のwは常に65535(GPUでは1.0)にする
+/// </summary>
+struct VertexDataQuantized {
+	uint16_t position[4]; //unorm16。PositionQuantizationで元に戻す
+	uint16_t texcoord[2]; //half
+	int16_t normal[2];    //八面体に展開した法線(snorm16)
+};
+
+static_assert(sizeof(VertexDataCompact) == 20);
+static_assert(offsetof(VertexDataCompact, texcoord) == 12);
+static_assert(offsetof(VertexDataCompact, normal) == 16);
+static_assert(sizeof(VertexDataQuantized) == 16);
+static_assert(offsetof(VertexDataQuantized, texcoord) == 8);
+static_assert(offsetof(VertexDataQuantized, normal) == 12);
+
+/// <summary>
+/// 量子化した位置を元に戻す値。position = offset + scale * (unorm16 / 65535)
+/// </summary>
+struct PositionQuantization {
+	Vector3 offset;
+	Vector3 scale;
+};
+
+/// <summary>
+/// 頂点形式の1頂点の大きさ(byte)
+/// </summary>
+/// <param name="format">頂点形式</param>
+/// <returns></returns>
+size_t GetVertexStride(VertexFormat format);
+
+#pragma region スカラー変換
+/// <summary>
+/// floatをhalfに変換する(最近接偶数丸め)。範囲外は∞、NaNはNaNになる
+/// </summary>
+/// <param name="value">値</param>
+/// <returns>halfのビット列</returns>
+uint16_t FloatToHalf(float value);
+
+/// <summary>
+/// halfをfloatに変換する
+/// </summary>
+/// <param name="half">halfのビット列</param>
+/// <returns></returns>
+float HalfToFloat(uint16_t half);
+
+/// <summary>
+/// 法線を八面体に展開して2つのsnorm16にする
+/// </summary>
+/// <param name="normal">法線。長さは1でなくてもよい。0ベクトルは(0, 0, 1)として扱う</param>
+/// <param name="encoded">書き込み先</param>
+void EncodeOctahedral(const Vector3& normal, int16_t encoded[2]);
+
+/// <summary>
+/// 八面体に展開した法線を元に戻す
+/// </summary>
+/// <param name="encoded">EncodeOctahedralの結果</param>
+/// <returns>正規化した法線</returns>
+Vector3 DecodeOctahedral(const int16_t encoded[2]);
+#pragma endregion
+
+#pragma region 位置の量子化
+/// <summary>
+/// AABBを[0, 1]に詰める量子化を作る。大きさが0の軸は全部offsetの位置になる
+/// </summary>
+/// <param name="aabb">量子化する範囲。LODなど複数の頂点配列で同じものを使うときはMergeAABBsでまとめる</param>
+/// <returns></returns>
+PositionQuantization MakePositionQuantization(const AABB& aabb);
+
+/// <summary>
+/// 頂点を囲むAABBから量子化を作る
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <returns></returns>
+PositionQuantization MakePositionQuantization(std::span<const VertexData> vertices);
+
+/// <summary>
+/// 量子化した位置(w = 1)を元の位置に戻す行列。ワールド行列の前に掛ける(Multiply(dequantization, WVP))
+/// 法線は位置と別に戻すので、法線用のワールド行列には掛けない
+/// </summary>
+/// <param name="quantization">量子化</param>
+/// <returns></returns>
+Matrix4x4 MakeDequantizationMatrix(const PositionQuantization& quantization);
+#pragma endregion
+
+#pragma region まとめて変換
+/// <summary>
+/// 頂点をCompact形式にまとめて変換する
+/// </summary>
+/// <param name="vertices">変換する頂点</param>
+/// <param name="result">書き込み先。verticesと同じ数が必要。前から順に1頂点ずつ書くのでMapしたバッファでもよい</param>
+void EncodeVertices(std::span<const VertexData> vertices, std::span<VertexDataCompact> result);
+
+/// <summary>
+/// 頂点をQuantized形式にまとめて変換する。範囲外の位置は範囲の端に丸める
+/// </summary>
+/// <param name="vertices">変換する頂点</param>
+/// <param name="quantization">位置の量子化</param>
+/// <param name="result">書き込み先。verticesと同じ数が必要。前から順に1頂点ずつ書くのでMapしたバッファでもよい</param>
+void EncodeVertices(std::span<const VertexData> vertices, const PositionQuantization& quantization, std::span<VertexDataQuantized> result);
+
+/// <summary>
+/// Compact形式の頂点をまとめて元に戻す
+/// </summary>
+/// <param name="vertices">変換する頂点</param>
+/// <param name="result">書き込み先。verticesと同じ数が必要</param>
+void DecodeVertices(std::span<const VertexDataCompact> vertices, std::span<VertexData> result);
+
+/// <summary>
+/// Quantized形式の頂点をまとめて元に戻す
+/// </summary>
+/// <param name="vertices">変換する頂点</param>
+/// <param name="quantization">エンコードに使った量子化</param>
+/// <param name="result">書き込み先。verticesと同じ数が必要</param>
+void DecodeVertices(std::span<const VertexDataQuantized> vertices, const PositionQuantization& quantization, std::span<VertexData> result);
+#pragma endregion
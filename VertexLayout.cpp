@@ -0,0 +1,47 @@
+#include "VertexLayout.h"
+#include <cstddef>
+
+namespace {
+
+constexpr D3D12_INPUT_ELEMENT_DESC MakeElement(const char* semanticName, DXGI_FORMAT format, size_t offset) {
+	return { semanticName, 0, format, 0, static_cast<UINT>(offset), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+}
+
+//VertexData。位置はwまでfloatで持つ
+constexpr D3D12_INPUT_ELEMENT_DESC kStandardElements[] = {
+	MakeElement("POSITION", DXGI_FORMAT_R32G32B32A32_FLOAT, offsetof(VertexData, position)),
+	MakeElement("TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, offsetof(VertexData, texcoode)),
+	MakeElement("NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, offsetof(VertexData, normal)),
+};
+
+//VertexDataCompact。足りない位置のwは入力アセンブラが1で埋める
+constexpr D3D12_INPUT_ELEMENT_DESC kCompactElements[] = {
+	MakeElement("POSITION", DXGI_FORMAT_R32G32B32_FLOAT, offsetof(VertexDataCompact, position)),
+	MakeElement("TEXCOORD", DXGI_FORMAT_R16G16_FLOAT, offsetof(VertexDataCompact, texcoord)),
+	MakeElement("NORMAL", DXGI_FORMAT_R16G16_SNORM, offsetof(VertexDataCompact, normal)),
+};
+
+//VertexDataQuantized。位置は[0, 1]で届くので、WVPに量子化を戻す行列を掛けておく
+constexpr D3D12_INPUT_ELEMENT_DESC kQuantizedElements[] = {
+	MakeElement("POSITION", DXGI_FORMAT_R16G16B16A16_UNORM, offsetof(VertexDataQuantized, position)),
+	MakeElement("TEXCOORD", DXGI_FORMAT_R16G16_FLOAT, offsetof(VertexDataQuantized, texcoord)),
+	MakeElement("NORMAL", DXGI_FORMAT_R16G16_SNORM, offsetof(VertexDataQuantized, normal)),
+};
+
+}
+
+std::span<const D3D12_INPUT_ELEMENT_DESC> GetInputElementDescs(VertexFormat format) {
+	switch (format) {
+	case VertexFormat::Compact:
+		return kCompactElements;
+	case VertexFormat::Quantized:
+		return kQuantizedElements;
+	default:
+		return kStandardElements;
+	}
+}
+
+D3D12_INPUT_LAYOUT_DESC GetInputLayoutDesc(VertexFormat format) {
+	std::span<const D3D12_INPUT_ELEMENT_DESC> elements = GetInputElementDescs(format);
+	return { elements.data(), static_cast<UINT>(elements.size()) };
+}
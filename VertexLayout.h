@@ -0,0 +1,21 @@
+#pragma once
+#include "VertexFormat.h"
+#include <d3d12.h>
+#include <span>
+
+//VertexFormat.hの頂点形式に合わせたInputLayout
+//セマンティクスはどの形式もPOSITION0, TEXCOORD0, NORMAL0で、Standard以外はObject3dQuantized.VS.hlslで受け取る
+
+/// <summary>
+/// 頂点形式に合わせたInputElementの並びを取得する。オフセットは構造体のメンバーの位置から求めてある
+/// </summary>
+/// <param name="format">頂点形式</param>
+/// <returns>静的な配列なので、PSOを作り終わるまで保持しなくてよい</returns>
+std::span<const D3D12_INPUT_ELEMENT_DESC> GetInputElementDescs(VertexFormat format);
+
+/// <summary>
+/// 頂点形式に合わせたInputLayoutを取得する。GraphicsPipelineStateDescにそのまま設定できる
+/// </summary>
+/// <param name="format">頂点形式</param>
+/// <returns></returns>
+D3D12_INPUT_LAYOUT_DESC GetInputLayoutDesc(VertexFormat format);
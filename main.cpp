@@ -5,6 +5,9 @@
 #include <cstdint>
 #include <vector>
 #include <list>
+#include <array>
+#include <cstring>
+#include <chrono>
 #pragma endregion
 #pragma region DirectX
 #include <d3d12.h>
@@ -27,8 +30,21 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 #include "Vector3.h"
 #include "Vector3_Math.hpp"
 #include "Vector2.h"
+#include "Vector4.h"
+#include "VertexData.h"
 #include "Matrix4x4.h"
+#include "TransformStructure.h"
 #include "Camera.h"
+#include "Frustum.h"
+#include "Bounds.h"
+#include "SphereMesh.h"
+#include "LOD.h"
+#include "VertexFormat.h"
+#include "VertexLayout.h"
+#include "Meshlet.h"
+#include "MeshCache.h"
+#include "BVH.h"
+#include "TextureLoader.h"
 #pragma endregion
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -36,25 +52,6 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 #pragma comment(lib, "dxcompiler.lib")
 
 #pragma region 構造体の宣言
-struct Vector4 {
-    float x;
-    float y;
-    float z;
-    float w;
-};
-
-struct TransformStructure {
-    Vector3 scale;
-    Vector3 rotate;
-    Vector3 translate;
-};
-
-struct VertexData {
-    Vector4 position;
-    Vector2 texcoode;
-    Vector3 normal;
-};
-
 struct Material {
     Vector4 color;
     int32_t enableLighting;
@@ -62,7 +59,7 @@ struct Material {
 
 struct TransformationMatrix {
     Matrix4x4 WVP;
-    Matrix4x4 World;
+    Matrix3x4 World; //シェーダーではfloat32_t3x4として受け取る
 };
 
 struct DirectionalLight {
@@ -71,6 +68,13 @@ struct DirectionalLight {
     float intensity;
 };
 
+//定数バッファはHLSLのパッキング規則(16バイト単位)と同じ並びにする
+static_assert(offsetof(Material, enableLighting) == 16);
+static_assert(sizeof(TransformationMatrix) == 112);
+static_assert(sizeof(DirectionalLight) == 32);
+static_assert(offsetof(DirectionalLight, direction) == 16);
+static_assert(offsetof(DirectionalLight, intensity) == 28);
+
 #pragma endregion
 
 #pragma region 関数のプロトタイプ宣言
@@ -118,10 +122,10 @@ ID3D12Resource* CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
 
 ID3D12DescriptorHeap* CreateDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE heapType, UINT numDescriptors, bool shaderVisible);
 
-DirectX::ScratchImage LoadTexture(const std::string& filePath);
-
 ID3D12Resource* CreateTextureResources(ID3D12Device* device, const DirectX::TexMetadata& metadata);
 
+void CreateTextureShaderResourceView(ID3D12Device* device, ID3D12Resource* texture, const DirectX::TexMetadata& metadata, D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
 void UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages);
 
 ID3D12Resource* UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages, ID3D12Device* device, ID3D12GraphicsCommandList* commandList);
@@ -144,6 +148,11 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
     CoInitializeEx(0, COINIT_MULTITHREADED);
 
+    //テクスチャは最初に読み込みを始めておき、ほかの初期化と並行してワーカースレッドで読む
+    TextureLoader textureLoader;
+    const TextureHandle uvCheckerTexture = textureLoader.Load("Resource/Images/uvChecker.png");
+    const TextureHandle monsterBallTexture = textureLoader.Load("Resource/Images/monsterBall.png");
+
     WNDCLASS wc{};
     //ウィンドウプロシージャ
     wc.lpfnWndProc = WindowProc;
@@ -157,8 +166,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     RegisterClass(&wc);
 
     //クライアント領域のサイズ
-    const int32_t kClientWidth = 1280;
-    const int32_t kClientHeigth = 720;
+    constexpr int32_t kClientWidth = 1280;
+    constexpr int32_t kClientHeigth = 720;
 
     //ウィンドウサイズを表す構造体にクライアント領域を入れる
     RECT wrc = {0, 0, kClientWidth, kClientHeigth};
@@ -310,7 +319,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     //RTV用のヒープでディスクリプタの数は2。RTVはShader内で触るものではないので、ShaderVisibleはfalse
     ID3D12DescriptorHeap* rtvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 2, false);
     //SRV用のヒープでディスクリプタの数は128。SRVはShader内で触るものなので、ShaderVisibleはtrue
-    ID3D12DescriptorHeap* srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 128, true);
+    const uint32_t kSrvDescriptorCount = 128;
+    ID3D12DescriptorHeap* srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, kSrvDescriptorCount, true);
 
     //SwapChainからResourceを引っ張ってくる
     ID3D12Resource* swapChainResource[2] = { nullptr };
@@ -419,23 +429,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     hr = device->CreateRootSignature(0, signatureBlob->GetBufferPointer(), signatureBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
     assert(SUCCEEDED(hr));  
 
-    //InputLayout
-    D3D12_INPUT_ELEMENT_DESC inputElementDescs[3] = {};
-    inputElementDescs[0].SemanticName = "POSITION";
-    inputElementDescs[0].SemanticIndex = 0;
-    inputElementDescs[0].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-    inputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-    inputElementDescs[1].SemanticName = "TEXCOORD";
-    inputElementDescs[1].SemanticIndex = 0;
-    inputElementDescs[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-    inputElementDescs[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-    inputElementDescs[2].SemanticName = "NORMAL";
-    inputElementDescs[2].SemanticIndex = 0;
-    inputElementDescs[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-    inputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-    D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
-    inputLayoutDesc.pInputElementDescs = inputElementDescs;
-    inputLayoutDesc.NumElements = _countof(inputElementDescs);
+    //InputLayout。VertexDataの並びから作る
+    D3D12_INPUT_LAYOUT_DESC inputLayoutDesc = GetInputLayoutDesc(VertexFormat::Standard);
 
     //BlendStateの設定
     D3D12_BLEND_DESC blendDesc{};
@@ -476,6 +471,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     IDxcBlob* pixelShaderBlob = CompileShader(L"Object3d.PS.hlsl", L"ps_6_0", dxcUtils, dxcCompiler, includeHandler);
     assert(pixelShaderBlob != nullptr);
 
+    //量子化した頂点(VertexDataQuantized)用の頂点シェーダー
+    IDxcBlob* quantizedVertexShaderBlob = CompileShader(L"Object3dQuantized.VS.hlsl", L"vs_6_0", dxcUtils, dxcCompiler, includeHandler);
+    assert(quantizedVertexShaderBlob != nullptr);
+
     D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
     graphicsPipelineStateDesc.pRootSignature = rootSignature;                                                   //RootSignature
     graphicsPipelineStateDesc.InputLayout = inputLayoutDesc;                                                    //InputLayout
@@ -498,80 +497,81 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&graphicsPipelineState));
     assert(SUCCEEDED(hr));
 
+    //量子化した頂点用のPSO。InputLayoutと頂点シェーダー以外は同じ
+    graphicsPipelineStateDesc.InputLayout = GetInputLayoutDesc(VertexFormat::Quantized);
+    graphicsPipelineStateDesc.VS = { quantizedVertexShaderBlob->GetBufferPointer(), quantizedVertexShaderBlob->GetBufferSize() };
+    ID3D12PipelineState* quantizedPipelineState = nullptr;
+    hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&quantizedPipelineState));
+    assert(SUCCEEDED(hr));
+
 #pragma region 三角形
-    int vertexNumber = 16 * 16 * 6;
-    ID3D12Resource* vertexResource = CreateBufferResource(device, sizeof(VertexData) * vertexNumber);
+    //球の頂点とインデックスはコンパイル時に作ってあるので、頂点は16byteに詰めながら、インデックスはメッシュレットの順に並べ替えてマップしたバッファに書く
+    //分割数の違うLODをまとめて1つの頂点バッファ・インデックスバッファに入れ、段階ごとの範囲を覚えておく
+    const std::span<const VertexData> sphereLODVertices[] = {
+        kSphereIndexedVertices<32>, kSphereIndexedVertices<16>, kSphereIndexedVertices<8>, kSphereIndexedVertices<4> };
+    const std::span<const uint16_t> sphereLODIndices[] = {
+        kSphereIndices<32>, kSphereIndices<16>, kSphereIndices<8>, kSphereIndices<4> };
+    //段階を切り替える画面上の半径(ピクセル)
+    const float kSphereLODThresholds[] = { 160.0f, 60.0f, 20.0f };
+    MeshLevel sphereLevels[std::size(sphereLODVertices)] = {};
+    size_t vertexNumber = 0;
+    size_t indexNumber = 0;
+    for (size_t level = 0; level < std::size(sphereLODVertices); ++level) {
+        sphereLevels[level] = { static_cast<uint32_t>(sphereLODIndices[level].size()), static_cast<uint32_t>(indexNumber), static_cast<int32_t>(vertexNumber) };
+        vertexNumber += sphereLODVertices[level].size();
+        indexNumber += sphereLODIndices[level].size();
+    }
+    ID3D12Resource* vertexResource = CreateBufferResource(device, sizeof(VertexDataQuantized) * vertexNumber);
 
     //頂点バッファビューを作成する
     D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
     //リソースの先頭のアドレスから使う
     vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
     //使用するリソースのサイズは頂点3つ分のサイズ
-    vertexBufferView.SizeInBytes = sizeof(VertexData) * vertexNumber;
+    vertexBufferView.SizeInBytes = static_cast<UINT>(sizeof(VertexDataQuantized) * vertexNumber);
     //1頂点当たりのサイズ
-    vertexBufferView.StrideInBytes = sizeof(VertexData);
+    vertexBufferView.StrideInBytes = sizeof(VertexDataQuantized);
 
     //頂点リソースにデータを書き込む
-    VertexData* vertexData = nullptr;
+    VertexDataQuantized* vertexData = nullptr;
     //書き込むためのアドレスを取得
     vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
 
-    const uint32_t kSubdivision = 16;
-    const float kLonEvery = (2 * M_PI) / kSubdivision;
-    const float kLatEvery = (M_PI) / kSubdivision;
-    //緯度の方向に分割 -π/1 ～ π/2
-    for (uint32_t latIndex = 0; latIndex < kSubdivision; ++latIndex) {
-        float lat = -M_PI / 2.0f + kLatEvery * latIndex; //現在の緯度
-        //経度の方向に分割 0～2π
-        for (uint32_t lonIndex = 0; lonIndex < kSubdivision; ++lonIndex) {
-            uint32_t start = (latIndex * kSubdivision + lonIndex) * 6;
-            float lon = lonIndex * kLonEvery;
-
-            //1枚目
-            vertexData[start].position = {std::cos(lat) * std::cos(lon),
-                std::sin(lat),
-                std::cos(lat) * std::sin(lon), 1.0f};
-            vertexData[start].texcoode = {float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision)};
-            vertexData[start].normal = { vertexData[start].position.x, vertexData[start].position.y, vertexData[start].position.z };
-            vertexData[start].normal = Normalize(vertexData[start].normal);
-
-            vertexData[start + 1].position = { std::cos(lat + kLatEvery) * std::cos(lon),
-                std::sin(lat + kLatEvery),
-                std::cos(lat + kLatEvery) * std::sin(lon), 1.0f};
-            vertexData[start + 1].texcoode = { float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex + 1) / float(kSubdivision) };
-            vertexData[start + 1].normal = { vertexData[start + 1].position.x, vertexData[start + 1].position.y, vertexData[start + 1].position.z };
-            vertexData[start + 1].normal = Normalize(vertexData[start + 1].normal);
-
-            vertexData[start + 2].position = { std::cos(lat) * std::cos(lon + kLonEvery),
-                std::sin(lat),
-                std::cos(lat) * std::sin(lon + kLonEvery), 1.0f};
-            vertexData[start + 2].texcoode = { float(lonIndex + 1) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision) };
-            vertexData[start + 2].normal = { vertexData[start + 2].position.x, vertexData[start + 2].position.y, vertexData[start + 2].position.z };
-            vertexData[start + 2].normal = Normalize(vertexData[start + 2].normal);
-
-            //2枚目
-            vertexData[start + 3].position = { std::cos(lat) * std::cos(lon + kLonEvery),
-                std::sin(lat),
-                std::cos(lat) * std::sin(lon + kLonEvery), 1.0f };
-            vertexData[start + 3].texcoode = { float(lonIndex + 1) / float(kSubdivision), 1.0f - float(latIndex) / float(kSubdivision) };
-            vertexData[start + 3].normal = { vertexData[start + 3].position.x, vertexData[start + 3].position.y, vertexData[start + 3].position.z };
-            vertexData[start + 3].normal = Normalize(vertexData[start + 3].normal);
-
-            vertexData[start + 4].position = { std::cos(lat + kLatEvery) * std::cos(lon),
-                std::sin(lat + kLatEvery),
-                std::cos(lat + kLatEvery) * std::sin(lon), 1.0f };
-            vertexData[start + 4].texcoode = { float(lonIndex) / float(kSubdivision), 1.0f - float(latIndex + 1) / float(kSubdivision) };
-            vertexData[start + 4].normal = { vertexData[start + 4].position.x, vertexData[start + 4].position.y, vertexData[start + 4].position.z };
-            vertexData[start + 4].normal = Normalize(vertexData[start + 4].normal);
-
-            vertexData[start + 5].position = { std::cos(lat + kLatEvery) * std::cos(lon + kLonEvery),
-                std::sin(lat + kLatEvery),
-                std::cos(lat + kLatEvery) * std::sin(lon + kLonEvery), 1.0f};
-            vertexData[start + 5].texcoode = { float(lonIndex + 1) / float(kSubdivision), 1.0f - float(latIndex + 1) / float(kSubdivision) };
-            vertexData[start + 5].normal = { vertexData[start + 5].position.x, vertexData[start + 5].position.y, vertexData[start + 5].position.z };
-            vertexData[start + 5].normal = Normalize(vertexData[start + 5].normal);
+    //インデックスバッファも同じように作る。どの段階も頂点数が65536以下なので16bitにする
+    ID3D12Resource* indexResource = CreateBufferResource(device, sizeof(uint16_t) * indexNumber);
+    D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+    indexBufferView.BufferLocation = indexResource->GetGPUVirtualAddress();
+    indexBufferView.SizeInBytes = static_cast<UINT>(sizeof(uint16_t) * indexNumber);
+    indexBufferView.Format = DXGI_FORMAT_R16_UINT;
+    uint16_t* indexData = nullptr;
+    indexResource->Map(0, nullptr, reinterpret_cast<void**>(&indexData));
+    //位置はすべての段階を囲む範囲で量子化する。段階ごとに変えると継ぎ目で位置がずれる
+    AABB sphereLODBounds[std::size(sphereLODVertices)] = {};
+    for (size_t level = 0; level < std::size(sphereLODVertices); ++level) {
+        sphereLODBounds[level] = ComputeAABB(sphereLODVertices[level]);
+    }
+    const PositionQuantization sphereQuantization = MakePositionQuantization(MergeAABBs(sphereLODBounds));
+    const Matrix4x4 sphereDequantizationMatrix = MakeDequantizationMatrix(sphereQuantization);
+    for (size_t level = 0; level < std::size(sphereLODVertices); ++level) {
+        EncodeVertices(sphereLODVertices[level], sphereQuantization, std::span<VertexDataQuantized>(vertexData + sphereLevels[level].baseVertex, sphereLODVertices[level].size()));
+    }
+    //段階ごとにメッシュレットに分け、メッシュレットの順に並べたインデックスを書く。描画はメッシュレット単位で範囲を絞る
+    MeshletData sphereLODMeshlets[std::size(sphereLODVertices)];
+    size_t maxSphereMeshletCount = 0;
+    for (size_t level = 0; level < std::size(sphereLODVertices); ++level) {
+        std::vector<uint32_t> indices(sphereLODIndices[level].begin(), sphereLODIndices[level].end());
+        sphereLODMeshlets[level] = BuildMeshlets(sphereLODVertices[level], indices);
+        std::vector<uint16_t> meshletIndices = ToIndices16(sphereLODMeshlets[level].indices);
+        std::memcpy(indexData + sphereLevels[level].startIndex, meshletIndices.data(), sizeof(uint16_t) * meshletIndices.size());
+        if (maxSphereMeshletCount < sphereLODMeshlets[level].meshlets.size()) {
+            maxSphereMeshletCount = sphereLODMeshlets[level].meshlets.size();
         }
     }
+    //カリングの結果を毎フレーム書き込む場所
+    std::vector<uint32_t> visibleSphereMeshlets(maxSphereMeshletCount);
+    std::vector<IndexRange> sphereDrawRanges(maxSphereMeshletCount);
+    //カリング用にローカル空間での球の範囲を求めておく
+    const BoundingSphere sphereLocalBounds = ComputeBoundingSphere(sphereLODVertices[0]);
 
     //WVP用のリソースを作る。Matrix4x4 1つ分のサイズを用意する
     ID3D12Resource* transformationMatrixResource = CreateBufferResource(device, sizeof(TransformationMatrix));
@@ -581,7 +581,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     transformationMatrixResource->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixData));
     //単位行列を書き込んでおく
     transformationMatrixData->WVP = MakeIdentity4x4();
-    transformationMatrixData->World = MakeIdentity4x4();
+    transformationMatrixData->World = MakeIdentity3x4();
 
 #pragma endregion
 
@@ -631,7 +631,93 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     transformationMatrixResourceSprite->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixDataSprite));
     //単位行列を書き込んでおく
     transformationMatrixDataSprite->WVP = MakeIdentity4x4();
-    transformationMatrixDataSprite->World = MakeIdentity4x4();
+    transformationMatrixDataSprite->World = MakeIdentity3x4();
+
+#pragma endregion
+
+#pragma region モデル
+    //コマンドライン引数で.obj / .gltf / .glbのパスを渡すと、そのモデルも描画する
+    //2回目からは横に書いた.meshcacheをマップするだけで、解析もメッシュレットへの分割もしない
+    MeshCache modelCache;
+    bool isModelRebuilt = false;
+    double modelLoadSeconds = 0.0;
+    if (__argc >= 2) {
+        const auto loadStart = std::chrono::steady_clock::now();
+        if (OpenMeshCache(__argv[1], modelCache, &isModelRebuilt)) {
+            modelLoadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+            Log(std::format("Load Mesh:{}, {} vertices, {} triangles, {} LODs, {:.3f}s ({})\n", __argv[1], modelCache.GetVertices().size(),
+                modelCache.GetLevels()[0].indexCount / 3, modelCache.GetLevels().size(), modelLoadSeconds, isModelRebuilt ? "rebuilt" : "cached"));
+        } else {
+            Log(std::format("Failed to load mesh:{}\n", __argv[1]));
+        }
+    }
+    const uint32_t modelIndexCount = modelCache.IsOpen() ? modelCache.GetIndexCount() : 0;
+    ID3D12Resource* bufferResourceModel = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferViewModel{};
+    D3D12_INDEX_BUFFER_VIEW indexBufferViewModel{};
+    //カリング用のローカル空間での範囲
+    BoundingSphere modelLocalBounds{};
+    if (modelIndexCount > 0) {
+        //キャッシュは頂点とインデックスが続いているので、1つのバッファに1回で写して両方のビューをそこから作る
+        std::span<const std::byte> gpuDataModel = modelCache.GetGpuData();
+        bufferResourceModel = CreateBufferResource(device, gpuDataModel.size());
+        void* bufferDataModel = nullptr;
+        bufferResourceModel->Map(0, nullptr, &bufferDataModel);
+        std::memcpy(bufferDataModel, gpuDataModel.data(), gpuDataModel.size());
+        const D3D12_GPU_VIRTUAL_ADDRESS bufferAddressModel = bufferResourceModel->GetGPUVirtualAddress();
+        vertexBufferViewModel.BufferLocation = bufferAddressModel;
+        vertexBufferViewModel.SizeInBytes = static_cast<UINT>(modelCache.GetVertices().size_bytes());
+        vertexBufferViewModel.StrideInBytes = sizeof(VertexData);
+        indexBufferViewModel.BufferLocation = bufferAddressModel + modelCache.GetIndexDataOffset();
+        indexBufferViewModel.SizeInBytes = modelCache.GetIndexSize() * modelIndexCount;
+        indexBufferViewModel.Format = modelCache.GetIndexSize() == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        modelLocalBounds = modelCache.GetBoundingSphere();
+    }
+    //LODの段階ごとの誤差。キャッシュを作るときに簡略化して求めてある
+    std::vector<float> modelLevelErrors;
+    if (modelIndexCount > 0) {
+        for (const MeshCacheLevel& level : modelCache.GetLevels()) {
+            modelLevelErrors.push_back(level.error);
+        }
+    }
+    //メッシュレットのカリングはマップしたキャッシュをそのまま読むので、modelCacheは最後まで開いておく
+    std::vector<uint32_t> visibleModelMeshlets(modelIndexCount > 0 ? modelCache.GetMeshlets().meshlets.size() : 0);
+    std::vector<IndexRange> modelDrawRanges(visibleModelMeshlets.size());
+
+    //WVP用のリソースを作る
+    ID3D12Resource* transformationMatrixResourceModel = CreateBufferResource(device, sizeof(TransformationMatrix));
+    TransformationMatrix* transformationMatrixDataModel = nullptr;
+    transformationMatrixResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixDataModel));
+    transformationMatrixDataModel->WVP = MakeIdentity4x4();
+    transformationMatrixDataModel->World = MakeIdentity3x4();
+
+#pragma endregion
+
+#pragma region レイキャスト
+    //クリックしたものを調べるためのBVH。三角形のBVHはメッシュごとに1回作り、インスタンスの位置は毎フレームRefitで直す
+    MeshBVH sphereBVH;
+    sphereBVH.Build(sphereLODVertices[0], sphereLODIndices[0]);
+    MeshBVH modelBVH;
+    if (modelIndexCount > 0) {
+        //一番細かい段階の三角形で作る。インデックスはキャッシュのものをそのまま読む
+        const auto bvhStart = std::chrono::steady_clock::now();
+        const MeshCacheLevel& modelLevel = modelCache.GetLevels()[0];
+        const std::byte* modelIndexData = modelCache.GetGpuData().data() + modelCache.GetIndexDataOffset();
+        if (modelCache.GetIndexSize() == sizeof(uint16_t)) {
+            modelBVH.Build(modelCache.GetVertices(), std::span<const uint16_t>(reinterpret_cast<const uint16_t*>(modelIndexData) + modelLevel.startIndex, modelLevel.indexCount));
+        } else {
+            modelBVH.Build(modelCache.GetVertices(), std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(modelIndexData) + modelLevel.startIndex, modelLevel.indexCount));
+        }
+        Log(std::format("Build BVH:{} nodes, {:.3f}s\n", modelBVH.GetNodeCount(),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - bvhStart).count()));
+    }
+    SceneBVH sceneBVH;
+    const uint32_t sphereInstance = sceneBVH.AddInstance(&sphereBVH, MakeIdentity4x4());
+    uint32_t modelInstance = kInvalidRayHit;
+    if (modelIndexCount > 0) {
+        modelInstance = sceneBVH.AddInstance(&modelBVH, MakeIdentity4x4());
+    }
+    sceneBVH.Build();
 
 #pragma endregion
 
@@ -666,36 +752,30 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     //Transform変数を作る
     TransformStructure transform{ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
     TransformStructure transformSprite{ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f} };
+    TransformStructure transformModel{ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f} };
 
-    //Textureを読んで転送する
-    DirectX::ScratchImage mipImage = LoadTexture("Resource/Images/uvChecker.png");
-    DirectX::ScratchImage mipImage2 = LoadTexture("Resource/Images/monsterBall.png");
-    const DirectX::TexMetadata& metadata = mipImage.GetMetadata();
-    const DirectX::TexMetadata& metadata2 = mipImage2.GetMetadata();
-    ID3D12Resource* textureResource = CreateTextureResources(device, metadata);
-    ID3D12Resource* textureResource2 = CreateTextureResources(device, metadata2);
-    ID3D12Resource* intermediateResource = UploadTextureData(textureResource, mipImage, device, commandList);
-    ID3D12Resource* intermediateResource2 = UploadTextureData(textureResource2, mipImage2, device, commandList);
+    //テクスチャの読み込みが終わるまで使う1x1の白いテクスチャ。読み込み中のハンドルはすべてこれを指す
+    DirectX::ScratchImage placeholderImage{};
+    hr = placeholderImage.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1, 1, 1, 1);
+    assert(SUCCEEDED(hr));
+    std::memset(placeholderImage.GetPixels(), 0xFF, placeholderImage.GetPixelsSize());
+    ID3D12Resource* placeholderTextureResource = CreateTextureResources(device, placeholderImage.GetMetadata());
+    ID3D12Resource* intermediateResource = UploadTextureData(placeholderTextureResource, placeholderImage, device, commandList);
     PushCommandList(commandList, commandAllocator, commandQueue, swapChain, fence, fenceValue, fenceEvent);
     //転送が終わったので、ここでReleseしてもよい
     intermediateResource->Release();
-    intermediateResource2->Release();
 
-    //SRV関係
-    //metaDataを基にSRVの設定
-    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-    srvDesc.Format = metadata.format;
-    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;//2Dテクスチャ
-    srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
-    //SRVを作成する
-    D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
-    D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
-    D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU2 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-    D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU2 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-    //SRVの生成
-    device->CreateShaderResourceView(textureResource, &srvDesc, textureSrvHandleCPU);
-    device->CreateShaderResourceView(textureResource2, &srvDesc, textureSrvHandleCPU2);
+    //SRVの番号。0はImGui、1はプレースホルダー、2からはTextureLoaderのハンドルの順に使う
+    const uint32_t kPlaceholderSrvIndex = 1;
+    const uint32_t kTextureSrvStart = 2;
+    CreateTextureShaderResourceView(device, placeholderTextureResource, placeholderImage.GetMetadata(),
+        GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, kPlaceholderSrvIndex));
+    const D3D12_GPU_DESCRIPTOR_HANDLE placeholderSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, kPlaceholderSrvIndex);
+    //ハンドルごとのテクスチャとSRV。転送するまではnullptrとプレースホルダーのSRV
+    std::vector<ID3D12Resource*> textureResources(textureLoader.GetTextureCount(), nullptr);
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> textureSrvHandlesGPU(textureLoader.GetTextureCount(), placeholderSrvHandleGPU);
+    //転送に使った中間リソース。フレームの終わりにGPUを待ってから解放する
+    std::vector<ID3D12Resource*> textureIntermediateResources;
 
     //ビューポート
     D3D12_VIEWPORT viewport{};
@@ -731,7 +811,18 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     camera->Initialize();
 
     bool useMonsterBall = true;
+    //球のLODの段階(0が一番細かい)と画角
+    uint32_t sphereLOD = 0;
+    MeshletCullResult sphereMeshletCull = {};
+    MeshletCullResult modelMeshletCull = {};
+    uint32_t modelLOD = 0;
+    const float kFovY = 0.45f;
+    //モデルのLODで許す画面上の誤差(ピクセル)
+    const float kModelMaxPixelError = 1.0f;
     bool isDrawSprite = true;
+    //最後にクリックした点のレイキャストの結果と、かかった時間
+    RayHit pickHit{};
+    double pickMicroseconds = 0.0;
 
     MSG msg{};
     //ウィンドウの×ボタンが押されるまでループ
@@ -761,25 +852,121 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
             ImGui::SliderFloat3("scale", *sphereScale, -10, 10);
             ImGui::SliderFloat3("rotate", *sphereRotate, -2 * M_PI, 2 * M_PI);
             ImGui::SliderFloat3("translate", *sphereTranslate, -100, 100);
+            ImGui::Text("LOD %u", sphereLOD);
+            ImGui::Text("Meshlets %u / %zu (%u draws, %u triangles)", sphereMeshletCull.meshletCount,
+                sphereLODMeshlets[sphereLOD].meshlets.size(), sphereMeshletCull.rangeCount, sphereMeshletCull.triangleCount);
             ImGui::End();
 
             camera->Update();
             
             //WVPMatrixに変換するだけで後の処理はDirectXが勝手にやってくれる
-            Matrix4x4 worldMatrix = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
-            Matrix4x4 viewMatrix = Inverse(camera->GetWorldTransform());
-            Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f, float(kClientWidth) / float(kClientHeigth), 0.1f, 100.0f);
-            Matrix4x4 worldViewProjectionMatrix = Multiply(worldMatrix, Multiply(viewMatrix, projectionMatrix));
+            Matrix3x4 worldMatrix = MakeAffineMatrix3x4(transform.scale, transform.rotate, transform.translate);
+            Matrix4x4 viewMatrix = InverseRigid(camera->GetWorldTransform());
+            Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(kFovY, float(kClientWidth) / float(kClientHeigth), 0.1f, 100.0f);
+            Matrix4x4 viewProjectionMatrix = Multiply(viewMatrix, projectionMatrix);
+            Matrix4x4 worldViewProjectionMatrix = Multiply(worldMatrix, viewProjectionMatrix);
+
+            //視錐台の外にある球は定数バッファの更新も描画もしない
+            Frustum frustum = MakeFrustum(viewProjectionMatrix);
+            BoundingSphere sphereWorldBounds = TransformSphere(sphereLocalBounds, ToMatrix4x4(worldMatrix));
+            sceneBVH.SetTransform(sphereInstance, ToMatrix4x4(worldMatrix));
+            bool isSphereVisible = IsVisible(frustum, sphereWorldBounds.center, sphereWorldBounds.radius);
+            //見えるときだけ、画面に映る大きさでLODを選び直す
+            if (isSphereVisible) {
+                float screenRadius = ComputeScreenRadius(sphereWorldBounds, camera->GetWorldTransform(), kFovY, float(kClientHeigth));
+                sphereLOD = SelectLOD(screenRadius, kSphereLODThresholds, sphereLOD);
+            }
 
-            transformationMatrixData->WVP = worldViewProjectionMatrix;
-            transformationMatrixData->World = worldMatrix;
+            if (isSphereVisible) {
+                //頂点の位置は量子化してあるので、先に元の範囲へ戻す行列を掛ける
+                transformationMatrixData->WVP = Multiply(sphereDequantizationMatrix, worldViewProjectionMatrix);
+                transformationMatrixData->World = worldMatrix;
+
+                //メッシュレットはローカル空間で判定する。ワールド行列まで掛けた視錐台と、逆行列で戻したカメラ位置を使う
+                Matrix4x4 worldMatrix4x4 = ToMatrix4x4(worldMatrix);
+                Frustum localFrustum = MakeFrustum(worldViewProjectionMatrix);
+                //裏返す(行列式が負の)ワールド行列では表裏が逆になり、潰れている(0の)ときは逆行列がないので、裏向きのカリングはしない
+                bool cullBackfaces = Det(worldMatrix4x4) > 0.0f;
+                Vector3 localCameraPosition = { 0.0f, 0.0f, 0.0f };
+                if (cullBackfaces) {
+                    Matrix4x4 cameraWorld = camera->GetWorldTransform();
+                    localCameraPosition = Transform(Vector3{ cameraWorld.m[3][0], cameraWorld.m[3][1], cameraWorld.m[3][2] }, InverseAffine(worldMatrix4x4));
+                }
+                sphereMeshletCull = CullMeshlets(sphereLODMeshlets[sphereLOD], localFrustum, localCameraPosition, cullBackfaces,
+                    visibleSphereMeshlets, sphereDrawRanges);
+            } else {
+                sphereMeshletCull = {};
+            }
+
+            //モデルも球と同じように、視錐台の外なら描画しない
+            bool isModelVisible = false;
+            if (modelIndexCount > 0) {
+                ImGui::Begin("Model");
+                ImGui::SliderFloat3("scale", &transformModel.scale.x, -10, 10);
+                ImGui::SliderFloat3("rotate", &transformModel.rotate.x, -2 * M_PI, 2 * M_PI);
+                ImGui::SliderFloat3("translate", &transformModel.translate.x, -100, 100);
+                ImGui::Text("%zu vertices, %u triangles", modelCache.GetVertices().size(), modelCache.GetLevels()[modelLOD].indexCount / 3);
+                ImGui::Text("Load %.3fs (%s)", modelLoadSeconds, isModelRebuilt ? "rebuilt" : "cached");
+                ImGui::Text("LOD %u / %zu (error %.5f)", modelLOD, modelLevelErrors.size(), modelLevelErrors[modelLOD]);
+                ImGui::Text("Meshlets %u / %u (%u draws, %u triangles)", modelMeshletCull.meshletCount,
+                    modelCache.GetLevels()[modelLOD].meshletCount, modelMeshletCull.rangeCount, modelMeshletCull.triangleCount);
+                ImGui::End();
+
+                Matrix3x4 worldMatrixModel = MakeAffineMatrix3x4(transformModel.scale, transformModel.rotate, transformModel.translate);
+                Matrix4x4 worldMatrixModel4x4 = ToMatrix4x4(worldMatrixModel);
+                BoundingSphere modelWorldBounds = TransformSphere(modelLocalBounds, worldMatrixModel4x4);
+                sceneBVH.SetTransform(modelInstance, worldMatrixModel4x4);
+                isModelVisible = IsVisible(frustum, modelWorldBounds.center, modelWorldBounds.radius);
+                if (isModelVisible) {
+                    //誤差を画面上のピクセルに直して、目立たない一番粗い段階を使う
+                    float modelScreenRadius = ComputeScreenRadius(modelWorldBounds, camera->GetWorldTransform(), kFovY, float(kClientHeigth));
+                    modelLOD = SelectLODByError(modelScreenRadius, modelLocalBounds.radius, modelLevelErrors, kModelMaxPixelError, modelLOD);
+
+                    Matrix4x4 worldViewProjectionMatrixModel = Multiply(worldMatrixModel, viewProjectionMatrix);
+                    transformationMatrixDataModel->WVP = worldViewProjectionMatrixModel;
+                    transformationMatrixDataModel->World = worldMatrixModel;
+
+                    //球と同じくローカル空間でメッシュレットを判定する
+                    bool cullBackfaces = Det(worldMatrixModel4x4) > 0.0f;
+                    Vector3 localCameraPosition = { 0.0f, 0.0f, 0.0f };
+                    if (cullBackfaces) {
+                        Matrix4x4 cameraWorld = camera->GetWorldTransform();
+                        localCameraPosition = Transform(Vector3{ cameraWorld.m[3][0], cameraWorld.m[3][1], cameraWorld.m[3][2] }, InverseAffine(worldMatrixModel4x4));
+                    }
+                    modelMeshletCull = CullMeshlets(modelCache.GetMeshlets(modelLOD), MakeFrustum(worldViewProjectionMatrixModel), localCameraPosition, cullBackfaces,
+                        visibleModelMeshlets, modelDrawRanges);
+                } else {
+                    modelMeshletCull = {};
+                }
+            }
+
+            //動いたインスタンスに合わせて範囲を直し、クリックした画面上の点からレイを飛ばして当たったものを調べる
+            sceneBVH.Refit();
+            if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !ImGui::GetIO().WantCaptureMouse) {
+                Vector2Int mousePosition = camera->GetMousePosition();
+                Ray pickRay = ScreenPointToRay({ float(mousePosition.x), float(mousePosition.y) }, { float(kClientWidth), float(kClientHeigth) },
+                    Inverse(viewProjectionMatrix));
+                const auto pickStart = std::chrono::steady_clock::now();
+                pickHit = sceneBVH.Raycast(pickRay.origin, pickRay.direction);
+                pickMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - pickStart).count();
+            }
+            ImGui::Begin("Picking");
+            if (pickHit.IsHit()) {
+                ImGui::Text("%s, triangle %u, distance %.3f", pickHit.instance == sphereInstance ? "Sphere" : "Model", pickHit.triangle, pickHit.distance);
+            } else {
+                ImGui::Text("No hit");
+            }
+            ImGui::Text("Raycast %.2fus (%zu instances)", pickMicroseconds, sceneBVH.GetInstanceCount());
+            ImGui::End();
 
             //スプライト用のWVPMatrixを作る
             //WVPMatrixに変換するだけで後の処理はDirectXが勝手にやってくれる
-            Matrix4x4 worldMatrixSprite = MakeAffineMatrix(transformSprite.scale, transformSprite.rotate, transformSprite.translate);
-            Matrix4x4 viewMatrixSprite = MakeIdentity4x4();
-            Matrix4x4 projectionMatrixSprite = MakeOrthographicMatrix(0.0f, 0.0f, float(kClientWidth), float(kClientHeigth), 0.0f, 100.0f);
-            Matrix4x4 worldViewProjectionMatrixSprite = Multiply(worldMatrixSprite, Multiply(viewMatrixSprite, projectionMatrixSprite));
+            Matrix3x4 worldMatrixSprite = MakeAffineMatrix3x4(transformSprite.scale, transformSprite.rotate, transformSprite.translate);
+            //ビューと射影は画面サイズだけで決まるのでコンパイル時に計算しておく
+            constexpr Matrix4x4 viewMatrixSprite = MakeIdentity4x4();
+            constexpr Matrix4x4 projectionMatrixSprite = MakeOrthographicMatrix(0.0f, 0.0f, float(kClientWidth), float(kClientHeigth), 0.0f, 100.0f);
+            constexpr Matrix4x4 viewProjectionMatrixSprite = Multiply(viewMatrixSprite, projectionMatrixSprite);
+            Matrix4x4 worldViewProjectionMatrixSprite = Multiply(worldMatrixSprite, viewProjectionMatrixSprite);
 
             transformationMatrixDataSprite->WVP = worldViewProjectionMatrixSprite;
             transformationMatrixDataSprite->World = worldMatrixSprite;
@@ -791,17 +978,39 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
             ImGui::Begin("Texture");
             ImGui::Checkbox("useMonsterBall", &useMonsterBall);
             ImGui::Checkbox("isDrawSprite ", &isDrawSprite);
+            ImGui::Text("Textures %zu (%zu loading)", textureLoader.GetTextureCount(), textureLoader.GetPendingCount());
             ImGui::End();
 
             ImGui::Begin("Light");
             ImGui::SliderFloat3("direction", &directionalLightData->direction.x, -2 * M_PI, 2 * M_PI);
-            directionalLightData->direction = Normalize(directionalLightData->direction);
+            directionalLightData->direction = Normalize<Precision::Fast>(directionalLightData->direction);
             ImGui::End();
 
             //ここまで
             //ImGuiの内部コマンドを生成
             ImGui::Render();
 
+            //読み終わったテクスチャをこのフレームのコマンドリストで転送し、ハンドルのSRVをプレースホルダーから差し替える
+            //新しいSRVの場所はまだGPUから使われていないので、描画中でも書き込める
+            textureResources.resize(textureLoader.GetTextureCount(), nullptr);
+            textureSrvHandlesGPU.resize(textureLoader.GetTextureCount(), placeholderSrvHandleGPU);
+            textureLoader.ProcessCompleted([&](DecodedTexture&& texture) {
+                const std::string filePath = textureLoader.GetFilePath(texture.handle).string();
+                if (!texture.isSucceeded) {
+                    Log(std::format("Failed to load texture:{}\n", filePath));
+                    return;
+                }
+                const uint32_t srvIndex = kTextureSrvStart + texture.handle;
+                assert(srvIndex < kSrvDescriptorCount);
+                const DirectX::TexMetadata& metadata = texture.mipImages.GetMetadata();
+                ID3D12Resource* resource = CreateTextureResources(device, metadata);
+                textureIntermediateResources.push_back(UploadTextureData(resource, texture.mipImages, device, commandList));
+                CreateTextureShaderResourceView(device, resource, metadata, GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvIndex));
+                textureResources[texture.handle] = resource;
+                textureSrvHandlesGPU[texture.handle] = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvIndex);
+                Log(std::format("Load Texture:{}, {}x{}, {:.3f}s\n", filePath, metadata.width, metadata.height, texture.decodeSeconds));
+            });
+
             //これから書き込むバックバッファのインデックスを取得
             UINT backBufferIndex = swapChain->GetCurrentBackBufferIndex();
 
@@ -836,8 +1045,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
             commandList->RSSetScissorRects(1, &scissorRect);
             //RootSignatureを設定。PSOに設定しているけど別途設定が必要
             commandList->SetGraphicsRootSignature(rootSignature);
-            commandList->SetPipelineState(graphicsPipelineState);
+            commandList->SetPipelineState(quantizedPipelineState);
             commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+            commandList->IASetIndexBuffer(&indexBufferView);
             //形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考えておけばよい
             commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
             //マテリアルCBufferの場所を設定
@@ -847,16 +1057,34 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
             //wvp用のCBufferの場所を設定
             commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResource->GetGPUVirtualAddress());
             //SRVのDescriptorTableの先頭を設定。2はrootParameter[2]である
-            commandList->SetGraphicsRootDescriptorTable(2, useMonsterBall ? textureSrvHandleGPU2 : textureSrvHandleGPU);
+            commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandlesGPU[useMonsterBall ? monsterBallTexture : uvCheckerTexture]);
             //描画!(DrawCall/ドローコール)。3頂点で1つのインスタンス。インスタンスについては今後
-            commandList->DrawInstanced(vertexNumber, 1, 0, 0);
+            if (isSphereVisible) {
+                //見えるメッシュレットの範囲だけを描く。隣り合うメッシュレットは1回にまとめてある
+                const MeshLevel& level = sphereLevels[sphereLOD];
+                for (uint32_t i = 0; i < sphereMeshletCull.rangeCount; ++i) {
+                    const IndexRange& range = sphereDrawRanges[i];
+                    commandList->DrawIndexedInstanced(range.indexCount, 1, level.startIndex + range.startIndex, level.baseVertex, 0);
+                }
+            }
+            //モデルの描画。頂点はVertexDataのままなので通常のPSOを使う
+            commandList->SetPipelineState(graphicsPipelineState);
+            if (isModelVisible) {
+                commandList->IASetVertexBuffers(0, 1, &vertexBufferViewModel);
+                commandList->IASetIndexBuffer(&indexBufferViewModel);
+                commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResourceModel->GetGPUVirtualAddress());
+                commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandlesGPU[uvCheckerTexture]);
+                for (uint32_t i = 0; i < modelMeshletCull.rangeCount; ++i) {
+                    commandList->DrawIndexedInstanced(modelDrawRanges[i].indexCount, 1, modelDrawRanges[i].startIndex, 0, 0);
+                }
+            }
             //スプライトの描画。変更が必要なものだけ変更する
             commandList->IASetVertexBuffers(0, 1, &vertexBufferViewSprite);
             commandList->SetGraphicsRootConstantBufferView(0, materialResourceSprite->GetGPUVirtualAddress());
             //TransformationMatrixCBufferの場所を設定
             commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResourceSprite->GetGPUVirtualAddress());
             //テクスチャの選択
-            commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandleGPU);
+            commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandlesGPU[uvCheckerTexture]);
             //描画
             if (isDrawSprite) {
                 commandList->DrawInstanced(6, 1, 0, 0);
@@ -874,6 +1102,11 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
             //すべてのコマンドを積んでから実行すること
             PushCommandList(commandList, commandAllocator, commandQueue, swapChain, fence, fenceValue, fenceEvent);
+            //GPUを待ったので、テクスチャの転送に使った中間リソースを解放する
+            for (ID3D12Resource* resource : textureIntermediateResources) {
+                resource->Release();
+            }
+            textureIntermediateResources.clear();
         }
     }
 
@@ -883,15 +1116,26 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
 
-    textureResource->Release();
+    for (ID3D12Resource* resource : textureResources) {
+        if (resource) {
+            resource->Release();
+        }
+    }
+    placeholderTextureResource->Release();
     materialResourceSprite->Release();
     materialResource->Release();
     transformationMatrixResourceSprite->Release();
+    transformationMatrixResourceModel->Release();
+    if (bufferResourceModel) {
+        bufferResourceModel->Release();
+    }
     vertexResourceSprite->Release();
     transformationMatrixResource->Release();
     vertexResource->Release();
+    indexResource->Release();
     depthStencilResource->Release();
     dsvDescriptorHeap->Release();
+    quantizedPipelineState->Release();
     graphicsPipelineState->Release();
     signatureBlob->Release();
     if (errorBlob) {
@@ -899,6 +1143,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     }
     rootSignature->Release();
     pixelShaderBlob->Release();
+    quantizedVertexShaderBlob->Release();
     vertexShaderBlob->Release();
 
     CloseHandle(fenceEvent);
@@ -1089,22 +1334,6 @@ ID3D12DescriptorHeap* CreateDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTO
     return DescriptorHeap;
 }
 
-DirectX::ScratchImage LoadTexture(const std::string& filePath) {
-    //テクスチャファイルを読んでプログラムで扱えるようにする
-    DirectX::ScratchImage image{};
-    std::wstring filePathW = ConvertString(filePath);
-    HRESULT hr = DirectX::LoadFromWICFile(filePathW.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
-    assert(SUCCEEDED(hr));
-
-    //ミニマップの作成
-    DirectX::ScratchImage mipImages{};
-    hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, mipImages);
-    assert(SUCCEEDED(hr));
-
-    //ミニマップ付きのデータを返す
-    return mipImages;
-}
-
 ID3D12Resource* CreateTextureResources(ID3D12Device* device, const DirectX::TexMetadata& metadata) {
     //1.metadataを基にResourceの設定
     D3D12_RESOURCE_DESC resourceDesc{};
@@ -1140,6 +1369,17 @@ ID3D12Resource* CreateTextureResources(ID3D12Device* device, const DirectX::TexM
     return resource;
 }
 
+void CreateTextureShaderResourceView(ID3D12Device* device, ID3D12Resource* texture, const DirectX::TexMetadata& metadata, D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+    //metaDataを基にSRVの設定
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+    srvDesc.Format = metadata.format;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;//2Dテクスチャ
+    srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
+    //SRVの生成
+    device->CreateShaderResourceView(texture, &srvDesc, handle);
+}
+
 //特殊なケースの場合
 void UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages) {
     //Meta情報を取得